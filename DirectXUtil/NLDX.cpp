@@ -114,7 +114,7 @@ Arg NLDXContext::LocateArg(const LateBindVar& var, bool create) noexcept
 
 size_t NLDXContext::GetKernelCount() const noexcept
 {
-    return common::linq::FromIterable(OutputBlocks)
+    return common::linq::FromIterable(GetConfigContext().OutputBlocks)
         .Where([](const auto& blk) { return blk.Type == xcomp::OutputBlock::BlockType::Instance; })
         .Count();
 }
@@ -494,7 +494,7 @@ xcomp::XCNLStructHandler& NLDXRuntime::GetStructHandler() noexcept { return Stru
     GENV(PPCAT(pfx, 3),  type, bit, minBits, 3), \
     GENV(PPCAT(pfx, 4),  type, bit, minBits, 4)
 
-static constexpr auto DXTypeLookup = BuildStaticLookup(uint32_t, std::u32string_view,
+static constexpr auto DXTypeLookup = BuildStaticHashLookup(uint32_t, std::u32string_view,
     PERPFX(min12uint,    Unsigned, 12, true),
     PERPFX(min16uint,    Unsigned, 16, true),
     PERPFX(uint16_t,     Unsigned, 16, false),
@@ -669,7 +669,70 @@ void NLDXRuntime::HandleInstanceArg(const xcomp::InstanceArgInfo& arg, xcomp::In
     }
 }
 
-void NLDXRuntime::BeforeFinishOutput(std::u32string&, std::u32string& structs, std::u32string&, std::u32string&)
+std::unique_ptr<xcomp::XCNLRuntime> NLDXRuntime::CreateInstanceWorker()
+{
+    auto context = std::make_shared<NLDXContext>(Context.Device, common::CLikeDefines{});
+    context->CompilerFlags  = Context.CompilerFlags;
+    context->MinSMVer       = Context.MinSMVer;
+    context->AllowDebug     = Context.AllowDebug;
+    context->Enable16Bit    = Context.Enable16Bit;
+    return std::make_unique<NLDXRuntime>(Logger, std::move(context));
+}
+
+void NLDXRuntime::MergeInstance(xcomp::XCNLRuntime& worker_, const xcomp::OutputBlock& block)
+{
+    auto& worker = static_cast<NLDXRuntime&>(worker_);
+    auto& src = worker.Context;
+    const auto srcId = worker.MergedKernels++;
+    Expects(srcId < src.KernelNames.size() && src.KernelNames[srcId] == block.Name());
+    const auto kerId = Context.KernelNames.size();
+    if (kerId >= 250)
+        NLRT_THROW_EX(u"Too many kernels being defined, at most 250"sv);
+    Context.KernelNames.emplace_back(block.Name());
+
+    // worker only sees reusable args from its own kernels, so match them again with all merged kernels
+    const auto MergeItems = [&](auto& pool, auto& idList, const auto& srcPool, const auto& srcIdList)
+    {
+        const char srcIdChar = static_cast<char>(srcId), kerIdChar = static_cast<char>(kerId);
+        for (uint32_t idx = 0; idx < srcPool.size(); ++idx)
+        {
+            const auto& item = srcPool[idx];
+            if (item.KernelIds.find(srcIdChar) == std::string::npos)
+                continue;
+            const Arg* source = nullptr;
+            for (const auto& [holder, id] : srcIdList)
+            {
+                if (id == idx)
+                {
+                    source = &holder; break;
+                }
+            }
+            if (source)
+            {
+                bool exist = false;
+                for (const auto& [holder, id] : idList)
+                {
+                    if (holder.GetCustom().Call<&CustomVar::Handler::CompareSameClass>(source->GetCustom()).IsEqual())
+                    {
+                        pool[id].KernelIds.push_back(kerIdChar);
+                        exist = true; break;
+                    }
+                }
+                if (exist)
+                    continue;
+                idList.emplace_back(*source, static_cast<uint32_t>(pool.size()));
+            }
+            auto& target = pool.emplace_back(item);
+            target.KernelIds.assign(1, kerIdChar);
+            target.Name     = Context.StrPool.AllocateString(src.StrPool.GetStringView(item.Name));
+            target.DataType = Context.StrPool.AllocateString(src.StrPool.GetStringView(item.DataType));
+        }
+    };
+    MergeItems(Context.BindResoures,    Context.ReusableResIds, src.BindResoures,    src.ReusableResIds);
+    MergeItems(Context.ShaderConstants, Context.ReusableSCIds,  src.ShaderConstants, src.ReusableSCIds);
+}
+
+void NLDXRuntime::BeforeFinishOutput(xcomp::U32Rope&, xcomp::U32Rope& structs, xcomp::U32Rope&, xcomp::U32Rope&)
 {
     std::u32string bindings = U"\r\n/* Bounded Resources */\r\n"s;
 
@@ -780,7 +843,7 @@ void NLDXRuntime::BeforeFinishOutput(std::u32string&, std::u32string& structs, s
         bindings.append(U"};\r\n\r\n");
     }
 
-    structs.append(bindings);
+    structs.Append(bindings);
 }
 
 xcomp::VTypeInfo NLDXRuntime::TryParseVecType(const std::u32string_view type, bool allowMinBits) const noexcept
@@ -199,10 +199,14 @@ protected:
     NLDXConfigurator Configurator;
     NLDXRawExecutor RawExecutor;
     NLDXStructHandler StructHandler;
+    // kernels of this worker runtime which have been merged back, they are merged in the same order being generated
+    size_t MergedKernels = 0;
 
     [[nodiscard]] xcomp::OutputBlock::BlockType GetBlockType(const RawBlock& block, MetaFuncs metas) const noexcept final;
     void HandleInstanceArg(const xcomp::InstanceArgInfo& arg, xcomp::InstanceContext& ctx, const xziar::nailang::FuncPack& meta, const xziar::nailang::Arg* source) final;
-    void BeforeFinishOutput(std::u32string& prefixes, std::u32string& structs, std::u32string& globals, std::u32string& kernels) final;
+    void BeforeFinishOutput(xcomp::U32Rope& prefixes, xcomp::U32Rope& structs, xcomp::U32Rope& globals, xcomp::U32Rope& kernels) final;
+    [[nodiscard]] std::unique_ptr<xcomp::XCNLRuntime> CreateInstanceWorker() final;
+    void MergeInstance(xcomp::XCNLRuntime& worker, const xcomp::OutputBlock& block) final;
 public:
     [[nodiscard]] static std::u32string_view GetDXTypeName(xcomp::VTypeInfo info) noexcept;
     NLDXRuntime(common::mlog::MiniLogger<false>& logger, std::shared_ptr<NLDXContext> evalCtx);
@@ -96,6 +96,7 @@ private:
     void(*BGR10A2ToRGBAf    )(float*    __restrict dest, const uint32_t* __restrict src, size_t count, float mulVal) noexcept = nullptr;
 public:
     IMGUTILAPI [[nodiscard]] static common::span<const PathInfo> GetSupportMap() noexcept;
+    IMGUTILAPI [[nodiscard]] static common::span<const BenchmarkInfo> GetBenchmarks() noexcept;
     IMGUTILAPI ColorConvertor(common::span<const VarItem> requests = {}) noexcept;
     IMGUTILAPI ~ColorConvertor();
     IMGUTILAPI [[nodiscard]] bool IsComplete() const noexcept final;
@@ -520,6 +521,7 @@ private:
     }
 public:
     IMGUTILAPI [[nodiscard]] static common::span<const PathInfo> GetSupportMap() noexcept;
+    IMGUTILAPI [[nodiscard]] static common::span<const BenchmarkInfo> GetBenchmarks() noexcept;
     IMGUTILAPI YCCConvertor(common::span<const VarItem> requests = {}) noexcept;
     IMGUTILAPI ~YCCConvertor();
     IMGUTILAPI [[nodiscard]] bool IsComplete() const noexcept final;
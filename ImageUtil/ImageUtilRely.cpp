@@ -247,9 +247,19 @@ DEFINE_FASTPATH_BASIC(ColorConvertor,
     RGB565ToRGB8, BGR565ToRGB8, RGB565ToRGBA8, BGR565ToRGBA8,
     RGB10ToRGBf, BGR10ToRGBf, RGB10ToRGBAf, BGR10ToRGBAf, RGB10A2ToRGBAf, BGR10A2ToRGBAf)
 
+DEFINE_FASTPATH_BENCHMARKS(ColorConvertor,
+    G8ToGA8, G8ToRGB8, G8ToRGBA8, GA8ToRGB8, GA8ToRGBA8, G16ToGA16, G16ToRGB16, G16ToRGBA16, GA16ToRGB16, GA16ToRGBA16, GfToGAf, GfToRGBf, GfToRGBAf, GAfToRGBf, GAfToRGBAf,
+    RGB8ToRGBA8, BGR8ToRGBA8, RGBA8ToRGB8, RGBA8ToBGR8, RGB16ToRGBA16, BGR16ToRGBA16, RGBA16ToRGB16, RGBA16ToBGR16, RGBfToRGBAf, BGRfToRGBAf, RGBAfToRGBf, RGBAfToBGRf,
+    RGB8ToBGR8, RGBA8ToBGRA8, RGB16ToBGR16, RGBA16ToBGRA16, RGBfToBGRf, RGBAfToBGRAf,
+    RGB8ToR8, RGB8ToG8, RGB8ToB8, RGB16ToR16, RGB16ToG16, RGB16ToB16, RGBAfToRf, RGBAfToGf, RGBAfToBf, RGBAfToAf, RGBfToRf, RGBfToGf, RGBfToBf,
+    G8ToG16, G16ToG8,
+    RGB555ToRGB8, BGR555ToRGB8, RGB555ToRGBA8, BGR555ToRGBA8, RGB5551ToRGBA8, BGR5551ToRGBA8,
+    RGB565ToRGB8, BGR565ToRGB8, RGB565ToRGBA8, BGR565ToRGBA8,
+    RGB10ToRGBf, BGR10ToRGBf, RGB10ToRGBAf, BGR10ToRGBAf, RGB10A2ToRGBAf, BGR10A2ToRGBAf) // Extract/Combine take pointer arrays
+
 const ColorConvertor& ColorConvertor::Get() noexcept
 {
-    static ColorConvertor convertor;
+    static ColorConvertor convertor(ColorConvertor::StartupRequests());
     return convertor;
 }
 
@@ -261,9 +271,15 @@ DEFINE_FASTPATH_BASIC(YCCConvertor,
     YCbCr8ToRGB8, YCbCr8ToRGBA8,
     RGB8ToYCbCr8PlanarFast, RGB8ToYCbCr8Planar, RGBA8ToYCbCr8PlanarFast, RGBA8ToYCbCr8Planar)
 
+DEFINE_FASTPATH_BENCHMARKS(YCCConvertor,
+    RGB8ToYCbCr8Fast, RGB8ToYCbCr8, RGBA8ToYCbCr8Fast, RGBA8ToYCbCr8,
+    RGB8ToAYUV8Fast, RGB8ToAYUV8, RGBA8ToAYUV8Fast, RGBA8ToAYUV8,
+    RGB8ToY410, RGBA8ToY410,
+    YCbCr8ToRGB8, YCbCr8ToRGBA8) // planar ones take pointer arrays
+
 const YCCConvertor& YCCConvertor::Get() noexcept
 {
-    static YCCConvertor convertor;
+    static YCCConvertor convertor(YCCConvertor::StartupRequests());
     return convertor;
 }
 
@@ -77,21 +77,24 @@ AutoVarHandlerBase::AccessorBuilder& AutoVarHandlerBase::AccessorBuilder::SetCon
 }
 
 
-AutoVarHandlerBase::AutoVarHandlerBase(std::u32string_view typeName) : TypeName(typeName)
+AutoVarHandlerBase::AutoVarHandlerBase(std::u32string_view typeName) : TypeName(typeName), NamePool(true)
 { }
 AutoVarHandlerBase::~AutoVarHandlerBase() { }
 
 AutoVarHandlerBase::Accessor* AutoVarHandlerBase::FindMember(std::u32string_view name, bool create)
 {
     const common::str::HashedStrView hsv(name);
-    for (auto& [pos, acc] : MemberList)
+    if (const auto piece = NamePool.Find(hsv); piece)
     {
-        if (NamePool.GetHashedStr(pos) == hsv)
-            return &acc;
+        for (auto& [pos, acc] : MemberList)
+        {
+            if (NamePool.IsSame(pos, *piece))
+                return &acc;
+        }
     }
     if (create)
     {
-        const auto piece = NamePool.AllocateString(name);
+        const auto piece = NamePool.AllocateString(hsv);
         return &MemberList.emplace_back(piece, Accessor{}).second;
     }
     return nullptr;
@@ -966,23 +966,22 @@ void ReplaceEngine::OnReplaceFunction(std::u32string&, void*, std::u32string_vie
     NLPS_THROW_EX(u"ReplaceFunction unimplemented"sv);
 }
 
-std::u32string ReplaceEngine::ProcessOptBlock(const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie)
+void ReplaceEngine::ProcessOptBlock(common::str::StringRope<char32_t>& output, const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie)
 {
     Expects(!prefix.empty() && !suffix.empty()); // Illegal prefix/suffix
     common::parser::ParserContext context(source);
     ContextReader reader(context);
-    std::u32string output;
     while (true)
     {
         auto before = reader.ReadUntil(prefix);
         if (before.empty()) // reaching end
         {
-            output.append(reader.ReadAll());
+            output.AppendSlice(reader.ReadAll());
             break;
         }
         {
             before.remove_suffix(prefix.size());
-            output.append(before);
+            output.AppendSlice(before);
         }
         reader.ReadWhile(IgnoreBlank);
         if (reader.ReadNext() != U'{')
@@ -1001,29 +1000,27 @@ std::u32string ReplaceEngine::ProcessOptBlock(const std::u32string_view source,
         }
         str.remove_suffix(suffix.size());
         // find a opt block replacement
-        OnReplaceOptBlock(output, cookie, TrimStrBlank(cond), str);
+        output.AppendGenerated([&](std::u32string& buf) { OnReplaceOptBlock(buf, cookie, TrimStrBlank(cond), str); });
         reader.ReadLine();
     }
-    return output;
 }
 
-std::u32string ReplaceEngine::ProcessVariable(const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie)
+void ReplaceEngine::ProcessVariable(common::str::StringRope<char32_t>& output, const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie)
 {
     Expects(!prefix.empty() && !suffix.empty()); // Illegal prefix/suffix
     common::parser::ParserContext context(source);
     ContextReader reader(context);
-    std::u32string output;
     while (true)
     {
         auto before = reader.ReadUntil(prefix);
         if (before.empty()) // reaching end
         {
-            output.append(reader.ReadAll());
+            output.AppendSlice(reader.ReadAll());
             break;
         }
         {
             before.remove_suffix(prefix.size());
-            output.append(before);
+            output.AppendSlice(before);
         }
         reader.ReadWhile(IgnoreBlank);
         auto var = reader.ReadUntil(suffix);
@@ -1036,28 +1033,26 @@ std::u32string ReplaceEngine::ProcessVariable(const std::u32string_view source,
         }
         var.remove_suffix(suffix.size());
         // find a variable replacement
-        OnReplaceVariable(output, cookie, TrimStrBlank(var));
+        output.AppendGenerated([&](std::u32string& buf) { OnReplaceVariable(buf, cookie, TrimStrBlank(var)); });
     }
-    return output;
 }
 
-std::u32string ReplaceEngine::ProcessFunction(const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie)
+void ReplaceEngine::ProcessFunction(common::str::StringRope<char32_t>& output, const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie)
 {
     Expects(!prefix.empty()); // Illegal suffix
     common::parser::ParserContext context(source);
     ContextReader reader(context);
-    std::u32string output;
     while (true)
     {
         auto before = reader.ReadUntil(prefix);
         if (before.empty()) // reaching end
         {
-            output.append(reader.ReadAll());
+            output.AppendSlice(reader.ReadAll());
             break;
         }
         {
             before.remove_suffix(prefix.size());
-            output.append(before);
+            output.AppendSlice(before);
         }
         reader.ReadWhile(IgnoreBlank);
         auto funcName = reader.ReadUntil(U"("sv);
@@ -1163,9 +1158,27 @@ std::u32string ReplaceEngine::ProcessFunction(const std::u32string_view source,
             }
         }
         // find a function replacement
-        OnReplaceFunction(output, cookie, TrimStrBlank(funcName), args);
+        output.AppendGenerated([&](std::u32string& buf) { OnReplaceFunction(buf, cookie, TrimStrBlank(funcName), args); });
     }
-    return output;
+}
+
+std::u32string ReplaceEngine::ProcessOptBlock(const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie)
+{
+    common::str::StringRope<char32_t> output;
+    ProcessOptBlock(output, source, prefix, suffix, cookie);
+    return output.Materialize();
+}
+std::u32string ReplaceEngine::ProcessVariable(const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie)
+{
+    common::str::StringRope<char32_t> output;
+    ProcessVariable(output, source, prefix, suffix, cookie);
+    return output.Materialize();
+}
+std::u32string ReplaceEngine::ProcessFunction(const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie)
+{
+    common::str::StringRope<char32_t> output;
+    ProcessFunction(output, source, prefix, suffix, cookie);
+    return output.Materialize();
 }
 
 ReplaceEngine::~ReplaceEngine()
@@ -2,6 +2,7 @@
 #include "NailangStruct.h"
 #include "SystemCommon/Exceptions.h"
 #include "common/parser/ParserBase.hpp"
+#include "common/StringRope.hpp"
 #include <optional>
 #include <any>
 
@@ -152,6 +153,10 @@ protected:
     virtual void OnReplaceOptBlock(std::u32string& output, void* cookie, std::u32string_view cond, std::u32string_view content);
     virtual void OnReplaceVariable(std::u32string& output, void* cookie, std::u32string_view var);
     virtual void OnReplaceFunction(std::u32string& output, void* cookie, std::u32string_view func, common::span<const std::u32string_view> args);
+    // output of OnReplaceXXX only holds generated pieces, unchanged source is kept as slice in the rope
+    void ProcessOptBlock(common::str::StringRope<char32_t>& output, const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie = nullptr);
+    void ProcessVariable(common::str::StringRope<char32_t>& output, const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie = nullptr);
+    void ProcessFunction(common::str::StringRope<char32_t>& output, const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie = nullptr);
     std::u32string ProcessOptBlock(const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie = nullptr);
     std::u32string ProcessVariable(const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie = nullptr);
     std::u32string ProcessFunction(const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie = nullptr);
@@ -209,7 +209,7 @@ public:
 
 
 #define ENUM_PAIR(name, op) { name, static_cast<uint16_t>(op) }
-constexpr auto OpSymbolLookup = BuildStaticLookup(common::str::ShortStrVal<3>, uint16_t,
+constexpr auto OpSymbolLookup = BuildStaticHashLookup(common::str::ShortStrVal<3>, uint16_t,
     ENUM_PAIR("==",  EmbedOps::Equal),
     ENUM_PAIR("!=",  EmbedOps::NotEqual),
     ENUM_PAIR("<",   EmbedOps::Less),
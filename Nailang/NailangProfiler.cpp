@@ -0,0 +1,212 @@
+#include "NailangPch.h"
+#include "NailangProfiler.h"
+#include <map>
+
+
+namespace xziar::nailang
+{
+using namespace std::string_view_literals;
+#define APPEND_FMT(dst, syntax, ...) common::str::Formatter<typename std::decay_t<decltype(dst)>::value_type>{}\
+    .FormatToStatic(dst, FmtString(syntax), __VA_ARGS__)
+
+
+NailangProfiler::NailangProfiler(size_t maxEvents) : MaxEvents(maxEvents)
+{
+    // Leave is called from scope's destructor, so it should never allocate
+    Events.reserve(MaxEvents);
+    Reset();
+}
+NailangProfiler::~NailangProfiler()
+{ }
+
+void NailangProfiler::Reset()
+{
+    Expects(Stack.empty()); // should not reset when profiling
+    NamePool.Clear();
+    Nodes.clear();
+    Events.clear();
+    DroppedEvents = 0;
+    Nodes.emplace_back(common::StringPiece<char32_t>{}, UINT32_MAX, EntryType::Root);
+    Origin = Clock::now();
+}
+
+uint32_t NailangProfiler::LocateNode(uint32_t parent, EntryType type, std::u32string_view name)
+{
+    auto* prevLink = &Nodes[parent].FirstChild;
+    for (auto idx = *prevLink; idx != UINT32_MAX; idx = Nodes[idx].NextSibling)
+    {
+        const auto& node = Nodes[idx];
+        if (node.Type == type && GetName(node) == name)
+            return idx;
+        prevLink = &Nodes[idx].NextSibling;
+    }
+    const auto idx = gsl::narrow_cast<uint32_t>(Nodes.size());
+    *prevLink = idx; // link before emplace, since emplace may invalidate the pointer
+    Nodes.emplace_back(NamePool.AllocateString(name), parent, type);
+    return idx;
+}
+
+void NailangProfiler::Enter(EntryType type, std::u32string_view name)
+{
+    const auto parent = Stack.empty() ? 0u : Stack.back().NodeIdx;
+    const auto nodeIdx = LocateNode(parent, type, name);
+    Stack.push_back({ Clock::now(), 0, nodeIdx });
+}
+
+void NailangProfiler::Leave() noexcept
+{
+    Expects(!Stack.empty());
+    const auto now = Clock::now();
+    const auto entry = Stack.back();
+    Stack.pop_back();
+    const auto elapse = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - entry.Begin).count());
+    auto& node = Nodes[entry.NodeIdx];
+    node.Count++;
+    node.InclusiveNs += elapse;
+    node.ExclusiveNs += elapse > entry.ChildNs ? elapse - entry.ChildNs : 0;
+    if (!Stack.empty())
+        Stack.back().ChildNs += elapse;
+    if (Events.size() < MaxEvents)
+    {
+        const auto begin = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(entry.Begin - Origin).count());
+        Events.push_back({ begin, elapse, entry.NodeIdx, gsl::narrow_cast<uint32_t>(Stack.size()) });
+    }
+    else if (MaxEvents > 0)
+        DroppedEvents++;
+}
+
+bool NailangProfiler::Retag(EntryType from, EntryType to)
+{
+    if (Stack.empty())
+        return false;
+    auto& entry = Stack.back();
+    const auto& node = Nodes[entry.NodeIdx];
+    if (node.Type != from)
+        return false;
+    const std::u32string name(GetName(node)); // copy since pool may be reallocated
+    entry.NodeIdx = LocateNode(node.Parent, to, name);
+    return true;
+}
+
+std::string_view NailangProfiler::GetTypeName(EntryType type) noexcept
+{
+    switch (type)
+    {
+    case EntryType::Root:       return "Root"sv;
+    case EntryType::FuncCall:   return "FuncCall"sv;
+    case EntryType::Native:     return "Native"sv;
+    case EntryType::LocalFunc:  return "LocalFunc"sv;
+    case EntryType::Block:      return "Block"sv;
+    default:                    return "Unknown"sv;
+    }
+}
+
+std::vector<NailangProfiler::Stat> NailangProfiler::GetStats() const
+{
+    std::map<std::pair<EntryType, std::u32string_view>, size_t> lookup;
+    std::vector<Stat> stats;
+    for (uint32_t i = 1; i < Nodes.size(); ++i)
+    {
+        const auto& node = Nodes[i];
+        if (node.Count == 0) // retagged or still active
+            continue;
+        const auto name = GetName(node);
+        const auto [it, isNew] = lookup.try_emplace(std::pair{ node.Type, name }, stats.size());
+        if (isNew)
+            stats.push_back({ name, node.Type, 0, 0, 0 });
+        auto& stat = stats[it->second];
+        stat.Count += node.Count;
+        stat.ExclusiveNs += node.ExclusiveNs;
+        bool isRecursive = false;
+        for (auto p = node.Parent; p != 0 && !isRecursive; p = Nodes[p].Parent)
+            isRecursive = Nodes[p].Type == node.Type && GetName(Nodes[p]) == name;
+        if (!isRecursive)
+            stat.InclusiveNs += node.InclusiveNs;
+    }
+    return stats;
+}
+
+static void AppendJsonStr(std::string& output, std::string_view str)
+{
+    for (const auto ch : str)
+    {
+        switch (ch)
+        {
+        case '"':   output.append("\\\""sv); break;
+        case '\\':  output.append("\\\\"sv); break;
+        case '\n':  output.append("\\n"sv); break;
+        case '\r':  output.append("\\r"sv); break;
+        case '\t':  output.append("\\t"sv); break;
+        default:
+            if (static_cast<uint8_t>(ch) < 0x20)
+                APPEND_FMT(output, "\\u{:04x}"sv, static_cast<uint8_t>(ch));
+            else
+                output.push_back(ch);
+            break;
+        }
+    }
+}
+
+std::string NailangProfiler::ExportChromeTrace() const
+{
+    std::vector<std::string> names;
+    names.reserve(Nodes.size());
+    for (const auto& node : Nodes)
+        names.emplace_back(common::str::to_string(GetName(node), common::str::Encoding::UTF8, common::str::Encoding::UTF32));
+
+    std::string output = "{\"traceEvents\":[";
+    bool isFirst = true;
+    for (const auto& evt : Events)
+    {
+        const auto& node = Nodes[evt.NodeIdx];
+        if (!isFirst)
+            output.push_back(',');
+        isFirst = false;
+        output.append("\n{\"name\":\""sv);
+        AppendJsonStr(output, names[evt.NodeIdx]);
+        output.append("\",\"cat\":\""sv).append(GetTypeName(node.Type));
+        APPEND_FMT(output, "\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":{:.3f},\"dur\":{:.3f},\"args\":{{\"depth\":{}}}}}"sv,
+            evt.BeginNs / 1000.0, evt.DurationNs / 1000.0, evt.Depth);
+    }
+    output.append("\n],\"displayTimeUnit\":\"ns\"}"sv);
+    return output;
+}
+
+std::string NailangProfiler::GetNodePath(uint32_t idx) const
+{
+    std::vector<uint32_t> path;
+    for (; idx != 0; idx = Nodes[idx].Parent)
+        path.push_back(idx);
+    std::string ret;
+    for (auto it = path.rbegin(); it != path.rend(); ++it)
+    {
+        const auto& node = Nodes[*it];
+        if (!ret.empty())
+            ret.push_back(';');
+        // folded format uses ';' and ' ' as separators
+        auto name = common::str::to_string(GetName(node), common::str::Encoding::UTF8, common::str::Encoding::UTF32);
+        for (auto& ch : name)
+            if (ch == ';' || ch == ' ')
+                ch = '_';
+        ret.append(GetTypeName(node.Type)).push_back(':');
+        ret.append(name);
+    }
+    return ret;
+}
+
+std::string NailangProfiler::ExportFoldedStacks() const
+{
+    std::string output;
+    for (uint32_t i = 1; i < Nodes.size(); ++i)
+    {
+        const auto& node = Nodes[i];
+        if (node.ExclusiveNs == 0)
+            continue;
+        output.append(GetNodePath(i));
+        APPEND_FMT(output, " {}\n"sv, node.ExclusiveNs);
+    }
+    return output;
+}
+
+
+}
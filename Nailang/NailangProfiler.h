@@ -0,0 +1,117 @@
+#pragma once
+
+#include "NailangRely.h"
+#include "common/StringPool.hpp"
+#include <chrono>
+#include <vector>
+
+#if COMMON_COMPILER_MSVC
+#   pragma warning(push)
+#   pragma warning(disable:4275 4251)
+#endif
+
+namespace xziar::nailang
+{
+
+
+class NAILANGAPI NailangProfiler
+{
+public:
+    enum class EntryType : uint8_t { Root = 0, FuncCall, Native, LocalFunc, Block };
+    struct Stat
+    {
+        std::u32string_view Name;
+        EntryType Type;
+        uint64_t Count;
+        uint64_t InclusiveNs;
+        uint64_t ExclusiveNs;
+    };
+    class Scope
+    {
+        NailangProfiler* Host;
+    public:
+        forceinline Scope(NailangProfiler* host, EntryType type, std::u32string_view name) : Host(host)
+        {
+            IF_UNLIKELY(Host)
+                Host->Enter(type, name);
+        }
+        COMMON_NO_COPY(Scope)
+        COMMON_NO_MOVE(Scope)
+        forceinline ~Scope()
+        {
+            IF_UNLIKELY(Host)
+                Host->Leave();
+        }
+    };
+private:
+    using Clock = std::chrono::steady_clock;
+    struct Node
+    {
+        common::StringPiece<char32_t> Name;
+        uint32_t Parent;
+        uint32_t FirstChild = UINT32_MAX;
+        uint32_t NextSibling = UINT32_MAX;
+        EntryType Type;
+        uint64_t Count = 0;
+        uint64_t InclusiveNs = 0;
+        uint64_t ExclusiveNs = 0;
+        Node(common::StringPiece<char32_t> name, uint32_t parent, EntryType type) noexcept :
+            Name(name), Parent(parent), Type(type) { }
+    };
+    struct ActiveEntry
+    {
+        Clock::time_point Begin;
+        uint64_t ChildNs;
+        uint32_t NodeIdx;
+    };
+    struct TraceEvent
+    {
+        uint64_t BeginNs;
+        uint64_t DurationNs;
+        uint32_t NodeIdx;
+        uint32_t Depth;
+    };
+    common::StringPool<char32_t> NamePool;
+    std::vector<Node> Nodes;
+    std::vector<ActiveEntry> Stack;
+    std::vector<TraceEvent> Events;
+    Clock::time_point Origin;
+    size_t MaxEvents;
+    uint64_t DroppedEvents = 0;
+
+    [[nodiscard]] uint32_t LocateNode(uint32_t parent, EntryType type, std::u32string_view name);
+    [[nodiscard]] std::u32string_view GetName(const Node& node) const noexcept { return NamePool.GetStringView(node.Name); }
+    [[nodiscard]] std::string GetNodePath(uint32_t idx) const;
+public:
+    /**
+     * @brief create a profiler
+     * @param maxEvents max count of trace events being recorded, 0 means only aggregated stats are kept.
+     *        storage of events is reserved up front
+    */
+    NailangProfiler(size_t maxEvents = 0);
+    ~NailangProfiler();
+    COMMON_NO_COPY(NailangProfiler)
+
+    void Enter(EntryType type, std::u32string_view name);
+    void Leave() noexcept;
+    // change the type of current entry if it matches, used when a dispatch turns out to be a local function
+    bool Retag(EntryType from, EntryType to);
+    void Reset();
+
+    [[nodiscard]] constexpr uint64_t GetDroppedEventCount() const noexcept { return DroppedEvents; }
+    // flat stats, inclusive time of recursive calls is only counted at the outermost one
+    [[nodiscard]] std::vector<Stat> GetStats() const;
+    // chrome://tracing or perfetto compatible json
+    [[nodiscard]] std::string ExportChromeTrace() const;
+    // folded stacks for flamegraph, weight is the exclusive time in ns
+    [[nodiscard]] std::string ExportFoldedStacks() const;
+
+    [[nodiscard]] static std::string_view GetTypeName(EntryType type) noexcept;
+};
+
+
+}
+
+#if COMMON_COMPILER_MSVC
+#   pragma warning(pop)
+#endif
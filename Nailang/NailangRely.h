@@ -32,6 +32,7 @@
 #include <cstdio>
 #include <optional>
 #include <memory>
+#include <atomic>
 
 
 namespace xziar::nailang
@@ -1,10 +1,13 @@
 #include "NailangPch.h"
 #include "NailangRuntime.h"
 #include "NailangParser.h"
+#include "NailangProfiler.h"
 #include "common/Linq2.hpp"
 #include "common/StrParsePack.hpp"
 #include <cmath>
 #include <cassert>
+#include <mutex>
+#include <unordered_set>
 
 
 namespace xziar::nailang
@@ -43,6 +46,76 @@ NailangCodeException::NailangCodeException(const std::u32string_view msg, detail
 { }
 
 
+TempArgArena::TempArgArena() noexcept
+{ }
+TempArgArena::~TempArgArena()
+{
+    Expects(ChunkIdx == 0 && Offset == 0);
+}
+TempArgArena::Holder TempArgArena::Allocate(const size_t count)
+{
+    const auto prevChunkIdx = ChunkIdx, prevOffset = Offset;
+    if (count == 0)
+        return { *this, {}, prevChunkIdx, prevOffset };
+    if (ChunkIdx >= Chunks.size() || Offset + count > Chunks[ChunkIdx].Size)
+    { // move to next chunk
+        const auto nextIdx = Chunks.empty() ? 0 : ChunkIdx + 1;
+        const auto size = std::max(count, DefaultChunkSize);
+        if (nextIdx == Chunks.size())
+            Chunks.push_back({ std::make_unique<Arg[]>(size), size });
+        else if (Chunks[nextIdx].Size < count) // chunks after top are not in use
+            Chunks[nextIdx] = { std::make_unique<Arg[]>(size), size };
+        ChunkIdx = nextIdx;
+        Offset = 0;
+    }
+    const common::span<Arg> args(Chunks[ChunkIdx].Args.get() + Offset, count);
+    Offset += count;
+    return { *this, args, prevChunkIdx, prevOffset };
+}
+
+
+struct IdentifierPoolData
+{
+    static constexpr size_t ChunkSize = 4096;
+    std::mutex Lock;
+    std::unordered_set<std::u32string_view> Names;
+    std::vector<std::unique_ptr<char32_t[]>> Chunks;
+    char32_t* Cursor = nullptr;
+    size_t Remain = 0;
+    std::u32string_view Intern(const std::u32string_view name)
+    {
+        std::lock_guard<std::mutex> lock(Lock);
+        if (const auto it = Names.find(name); it != Names.end())
+            return *it;
+        if (name.size() > Remain)
+        {
+            const auto size = std::max(name.size(), ChunkSize);
+            Cursor = Chunks.emplace_back(std::make_unique<char32_t[]>(size)).get();
+            Remain = size;
+        }
+        std::char_traits<char32_t>::copy(Cursor, name.data(), name.size());
+        const std::u32string_view ret(Cursor, name.size());
+        Cursor += name.size();
+        Remain -= name.size();
+        Names.insert(ret);
+        return ret;
+    }
+};
+std::u32string_view IdentifierPool::Intern(const std::u32string_view name)
+{
+    static IdentifierPoolData Pool;
+    // names are never released, so each thread can keep the interned views without lock
+    thread_local std::unordered_set<std::u32string_view> LocalNames;
+    if (name.empty())
+        return {};
+    if (const auto it = LocalNames.find(name); it != LocalNames.end())
+        return *it;
+    const auto ret = Pool.Intern(name);
+    LocalNames.insert(ret);
+    return ret;
+}
+
+
 EvaluateContext::~EvaluateContext()
 { }
 
@@ -50,6 +123,13 @@ EvaluateContext::~EvaluateContext()
 BasicEvaluateContext::~BasicEvaluateContext()
 { }
 
+void BasicEvaluateContext::CopyFrom(const BasicEvaluateContext& other)
+{
+    LocalFuncArgNames = other.LocalFuncArgNames;
+    LocalFuncCapturedArgs = other.LocalFuncCapturedArgs;
+    HasFunc = other.HasFunc;
+}
+
 std::pair<uint32_t, uint32_t> BasicEvaluateContext::InsertCaptures(
     common::span<std::pair<std::u32string_view, Arg>> capture)
 {
@@ -98,6 +178,7 @@ bool BasicEvaluateContext::SetFunc(const Block* block, common::span<std::pair<st
 {
     const auto argRange  = InsertCaptures(capture);
     const auto nameRange = InsertNames(capture, args);
+    HasFunc = true;
     return SetFuncInside(block->Name, { block, argRange, nameRange });
 }
 
@@ -105,6 +186,7 @@ bool BasicEvaluateContext::SetFunc(const Block* block, common::span<std::pair<st
 {
     const auto argRange = InsertCaptures(capture);
     const auto nameRange = InsertNames(capture, args);
+    HasFunc = true;
     return SetFuncInside(block->Name, { block, argRange, nameRange });
 }
 
@@ -131,7 +213,7 @@ Arg LargeEvaluateContext::LocateArg(const LateBindVar& var, const bool create) n
         return { &it->second, ArgAccess::ReadWrite };
     if (create)
     { // need create
-        const auto [it, _] = ArgMap.insert_or_assign(std::u32string(var.Name), Arg{});
+        const auto [it, _] = ArgMap.insert_or_assign(IdentifierPool::Intern(var.Name), Arg{});
         return { &it->second, ArgAccess::WriteOnly };
     }
     return {};
@@ -151,6 +233,13 @@ size_t LargeEvaluateContext::GetFuncCount() const noexcept
 CompactEvaluateContext::~CompactEvaluateContext()
 { }
 
+void CompactEvaluateContext::CopyFrom(const CompactEvaluateContext& other)
+{
+    BasicEvaluateContext::CopyFrom(other);
+    Args = other.Args;
+    LocalFuncs = other.LocalFuncs;
+}
+
 bool CompactEvaluateContext::SetFuncInside(std::u32string_view name, LocalFuncHolder func)
 {
     for (auto& [key, val] : LocalFuncs)
@@ -178,8 +267,8 @@ BasicEvaluateContext::LocalFuncHolder CompactEvaluateContext::LookUpFuncInside(s
 Arg CompactEvaluateContext::LocateArg(const LateBindVar& var, const bool create) noexcept
 {
     const HashedStrView hsv(var.Name);
-    for (auto& [pos, val] : Args)
-        if (ArgNames.GetHashedStr(pos) == hsv)
+    for (auto& [name, val] : Args)
+        if (name == hsv)
         {
             if (!val.IsEmpty())
                 return { &val, ArgAccess::ReadWrite };
@@ -189,8 +278,7 @@ Arg CompactEvaluateContext::LocateArg(const LateBindVar& var, const bool create)
         }
     if (create)
     { // need create
-        const auto piece = ArgNames.AllocateString(var.Name);
-        Args.emplace_back(piece, Arg{});
+        Args.emplace_back(HashedStrView(hsv.Hash, IdentifierPool::Intern(var.Name)), Arg{});
         return { &Args.back().second, ArgAccess::WriteOnly };
     }
     return {};
@@ -297,6 +385,10 @@ NailangFrameStack::FrameHolderBase::~FrameHolderBase()
         return;
     Expects(Host && Frame);
     Expects(Host->TopFrame == Frame);
+    if (Host->FuncVersion == PrevVersion) // lookup chain is back to the one at push
+        Host->DispatchStamp = PrevStamp;
+    else
+        Host->InvalidateDispatch();
     const auto size = Frame->GetSize();
     Frame->~NailangFrame();
     Host->TopFrame = Frame->PrevFrame;
@@ -304,13 +396,45 @@ NailangFrameStack::FrameHolderBase::~FrameHolderBase()
     Ensures(ret);
 }
 
-NailangFrameStack::NailangFrameStack() : TrunckedContainer(4096, 4096)
+static uint64_t NewDispatchStamp() noexcept
+{
+    // 0 is reserved for empty cache, StaticStamp for name-only result
+    static std::atomic<uint64_t> Counter{ 0 };
+    const auto stamp = Counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (stamp >= FuncCallCache::StaticStamp) // exhausted, disable the cache instead of reusing stamps
+        return 0;
+    return stamp;
+}
+
+NailangFrameStack::NailangFrameStack() : TrunckedContainer(4096, 4096), DispatchStamp(NewDispatchStamp())
 { }
 NailangFrameStack::~NailangFrameStack()
 {
     Expects(GetAllocatedSlot() == 0);
 }
 
+void NailangFrameStack::EnterFuncFrame(const NailangFrame& frame) noexcept
+{
+    auto& last = LastFuncFrame;
+    if (last.ParentStamp == DispatchStamp && last.Version == FuncVersion && DispatchStamp != 0 &&
+        !last.Context.owner_before(frame.Context) && !frame.Context.owner_before(last.Context) && !last.Context.expired())
+    { // same context on the same chain with nothing changed
+        DispatchStamp = last.Stamp;
+        return;
+    }
+    last.Context = frame.Context;
+    last.ParentStamp = DispatchStamp;
+    last.Version = FuncVersion;
+    DispatchStamp = NewDispatchStamp();
+    last.Stamp = DispatchStamp;
+}
+
+void NailangFrameStack::InvalidateDispatch() noexcept
+{
+    FuncVersion++;
+    DispatchStamp = NewDispatchStamp();
+}
+
 NailangBlockFrame* NailangFrameStack::SetReturn(Arg returnVal) const noexcept
 {
     for (auto frame = TopFrame; frame; frame = frame->PrevFrame)
@@ -571,11 +695,10 @@ static NailangFormatExecutor NLFmtExecutor;
 std::u32string NailangBase::FormatString(const std::u32string_view formatter, common::span<const Arg> args)
 {
     using namespace common::str;
-    const auto result = FormatterParser::ParseString<char32_t>(formatter);
+    if (formatter.empty())
+        return {};
     try
     {
-        ParseResultBase::CheckErrorRuntime(result.ErrorPos, result.OpCount);
-        const auto strInfo = result.ToInfo(formatter);
         ArgInfo argsInfo;
         for (const auto& arg : args)
         {
@@ -590,7 +713,9 @@ std::u32string NailangBase::FormatString(const std::u32string_view formatter, co
             default: HandleException(CREATE_EXCEPTIONEX(NailangFormatException, formatter, &arg, u"Unsupported DataType")); break;
             }
         }
-        /*const auto mapping = */ArgChecker::CheckDD(strInfo, argsInfo);
+        // parsed and checked result is cached globally, since scripts tend to reuse the same formatters
+        const auto cached = FormatStringCache<char32_t>::Get(formatter, argsInfo);
+        const auto strInfo = cached.StrInfo.ToStrArgInfo();
         std::u32string dst;
         NailangFormatExecutor::Context ctx{ dst, formatter, args };
         auto opcodes = strInfo.Opcodes;
@@ -675,17 +800,15 @@ void NailangExecutor::EvalFuncArgs(const FuncCall& func, Arg* args, const Arg::T
         store.Reset();
     }
 }
-std::vector<Arg> NailangExecutor::EvalFuncAllArgs(const FuncCall& func)
+void NailangExecutor::EvalFuncAllArgs(const FuncCall& func, common::span<Arg> params)
 {
+    Expects(params.size() == func.Args.size());
     EvalTempStore store;
-    std::vector<Arg> params;
-    params.reserve(func.Args.size());
-    for (const auto& arg : func.Args)
+    for (size_t i = 0; i < params.size(); ++i)
     {
-        params.emplace_back(EvaluateExpr(arg, store));
+        params[i] = EvaluateExpr(func.Args[i], store);
         store.Reset();
     }
-    return params;
 }
 
 bool NailangExecutor::HandleMetaFuncs(MetaSet& allMetas)
@@ -904,81 +1027,119 @@ Arg NailangExecutor::EvaluateFunc(const FuncCall& func, EvalTempStore&, MetaSet*
         NLRT_THROW_EX(FMTSTR2(u"MetaFunc [{}] can not be evaluated here.", fullName), func);
     }
     NailangFrame::FuncInfoHolder holder(&GetFrame(), &func);
+    NailangProfiler::Scope callScope(Profiler, NailangProfiler::EntryType::FuncCall, fullName);
+    auto kind = GetDispatchCache(func).first;
     // only for plain function
-    if (func.Name->Info() == FuncName::FuncInfo::Empty && func.Name->PartCount == 1)
+    if (kind == DispatchKind::None && func.Name->Info() == FuncName::FuncInfo::Empty && func.Name->PartCount == 1)
     {
         switch (DJBHash::HashC(fullName))
         {
-        HashCase(fullName, U"Return")
-        {
-            const auto dst = Runtime->FrameStack.SetReturn(EvalFuncSingleArg(func, Arg::Type::Empty, ArgLimits::AtMost));
-            if (!dst)
-                NLRT_THROW_EX(u"[Return] can only be used inside FlowScope"sv, func);
-            return {};
-        }
-        HashCase(fullName, U"Break")
-        {
-            const auto dst = Runtime->FrameStack.SetBreak();
-            if (!dst)
-                NLRT_THROW_EX(u"[Break] can only be used inside LoopScope"sv, func);
-            return {};
-        }
-        HashCase(fullName, U"Continue")
-        {
-            const auto dst = Runtime->FrameStack.SetContinue();
-            if (!dst)
-                NLRT_THROW_EX(u"[Continue] can only be used inside LoopScope"sv, func);
-            return {};
-        }
-        HashCase(fullName, U"Throw")
-        {
-            const auto arg = EvalFuncSingleArg(func, Arg::Type::Empty, ArgLimits::AtMost);
-            Runtime->FrameStack.SetReturn({});
-            Runtime->HandleException(CREATE_EXCEPTION(NailangCodeException, arg.ToString().StrView(), func));
-            return {};
-        }
+        HashCase(fullName, U"Return")   kind = DispatchKind::Return;    break;
+        HashCase(fullName, U"Break")    kind = DispatchKind::Break;     break;
+        HashCase(fullName, U"Continue") kind = DispatchKind::Continue;  break;
+        HashCase(fullName, U"Throw")    kind = DispatchKind::Throw;     break;
         default: break;
         }
+        if (kind != DispatchKind::None)
+            SetStaticDispatchCache(func, kind);
     }
-    auto params = EvalFuncAllArgs(func);
-    FuncEvalPack pack(func, params, metas);
+    switch (kind)
+    {
+    case DispatchKind::Return:
+    {
+        const auto dst = Runtime->FrameStack.SetReturn(EvalFuncSingleArg(func, Arg::Type::Empty, ArgLimits::AtMost));
+        if (!dst)
+            NLRT_THROW_EX(u"[Return] can only be used inside FlowScope"sv, func);
+        return {};
+    }
+    case DispatchKind::Break:
+    {
+        const auto dst = Runtime->FrameStack.SetBreak();
+        if (!dst)
+            NLRT_THROW_EX(u"[Break] can only be used inside LoopScope"sv, func);
+        return {};
+    }
+    case DispatchKind::Continue:
+    {
+        const auto dst = Runtime->FrameStack.SetContinue();
+        if (!dst)
+            NLRT_THROW_EX(u"[Continue] can only be used inside LoopScope"sv, func);
+        return {};
+    }
+    case DispatchKind::Throw:
+    {
+        const auto arg = EvalFuncSingleArg(func, Arg::Type::Empty, ArgLimits::AtMost);
+        Runtime->FrameStack.SetReturn({});
+        Runtime->HandleException(CREATE_EXCEPTION(NailangCodeException, arg.ToString().StrView(), func));
+        return {};
+    }
+    default: break;
+    }
+    const auto params = Runtime->TempArgs.Allocate(func.Args.size());
+    EvalFuncAllArgs(func, params.Get());
+    FuncEvalPack pack(func, params.Get(), metas);
+    NailangProfiler::Scope nativeScope(Profiler, NailangProfiler::EntryType::Native, fullName);
     return EvaluateFunc(pack);
 }
 Arg NailangExecutor::EvaluateFunc(FuncEvalPack& func)
 {
     Expects(func.Name->PartCount > 0);
-    if (func.Name->PartCount == 1)
-    {
-        switch (const auto name = func.NamePart(0); DJBHash::HashC(name))
-        {
-        HashCase(name, U"Exists")
-        {
-            ThrowByParamTypes<1>(func, { Arg::Type::String });
-            const LateBindVar var(func.Params[0].GetStr().value());
-            return !Runtime->LocateArg(var, false).IsEmpty();
-        }
-        HashCase(name, U"Format")
-        {
-            ThrowByParamTypes<2, ArgLimits::AtLeast>(func, { Arg::Type::String, Arg::Type::Empty });
-            return FormatString(func.Params[0].GetStr().value(), func.Params.subspan(1));
-        }
-        default: break;
-        }
-    }
-    else
+    auto [kind, id] = GetDispatchCache(func);
+    if (kind == DispatchKind::None)
     {
-        if (func.NamePart(0) == U"Math"sv)
+        if (func.Name->PartCount == 1)
         {
-            if (auto ret = EvaluateExtendMathFunc(func); !ret.IsEmpty())
+            switch (const auto name = func.NamePart(0); DJBHash::HashC(name))
             {
-                return ret;
+            HashCase(name, U"Exists") kind = DispatchKind::Exists; break;
+            HashCase(name, U"Format") kind = DispatchKind::Format; break;
+            default: break;
             }
         }
+        else if (func.NamePart(0) == U"Math"sv)
+            kind = DispatchKind::MathFunc;
+        if (kind != DispatchKind::None)
+            SetStaticDispatchCache(*func.Site, kind);
+    }
+    switch (kind)
+    {
+    case DispatchKind::Exists:
+    {
+        ThrowByParamTypes<1>(func, { Arg::Type::String });
+        const LateBindVar var(func.Params[0].GetStr().value());
+        return !Runtime->LocateArg(var, false).IsEmpty();
+    }
+    case DispatchKind::Format:
+    {
+        ThrowByParamTypes<2, ArgLimits::AtLeast>(func, { Arg::Type::String, Arg::Type::Empty });
+        return FormatString(func.Params[0].GetStr().value(), func.Params.subspan(1));
+    }
+    case DispatchKind::MathFunc:
+    {
+        if (auto ret = EvaluateExtendMathFunc(func); !ret.IsEmpty())
+            return ret;
+    } break; // not handled, lookup without caching
+    case DispatchKind::LocalFunc:
+    {
+        if (Profiler)
+            Profiler->Retag(NailangProfiler::EntryType::Native, NailangProfiler::EntryType::LocalFunc);
+        const auto lcFunc = Runtime->DispatchFuncs[id]; // copy since it may be changed during execution
+        return EvaluateLocalFunc(lcFunc, func);
+    }
+    case DispatchKind::Unknown:
+        return EvaluateUnknwonFunc(func);
+    default: break;
     }
     if (const auto lcFunc = Runtime->LookUpFunc(func.FullFuncName()); lcFunc)
     {
+        if (kind == DispatchKind::None)
+            SetDispatchCache(func, DispatchKind::LocalFunc, Runtime->CacheLocalFunc(lcFunc));
+        if (Profiler)
+            Profiler->Retag(NailangProfiler::EntryType::Native, NailangProfiler::EntryType::LocalFunc);
         return EvaluateLocalFunc(lcFunc, func);
     }
+    if (kind == DispatchKind::None)
+        SetDispatchCache(func, DispatchKind::Unknown);
     return EvaluateUnknwonFunc(func);
 }
 Arg NailangExecutor::EvaluateExtendMathFunc(FuncEvalPack& func)
@@ -1381,6 +1542,7 @@ void NailangExecutor::EvaluateBlock(const Block& block, common::span<const FuncC
 void NailangExecutor::ExecuteFrame(NailangBlockFrame& frame)
 {
     Expects(&GetFrame() == &frame);
+    NailangProfiler::Scope blockScope(Profiler, NailangProfiler::EntryType::Block, frame.BlockScope->Name);
     EvalTempStore store;
     for (size_t idx = 0; idx < frame.BlockScope->Size();)
     {
@@ -1538,14 +1700,20 @@ Arg NailangRuntime::LocateArgForWrite(const LateBindVar& var, NilCheck nilCheck,
 bool NailangRuntime::SetFunc(const Block* block, common::span<std::pair<std::u32string_view, Arg>> capture, common::span<const Expr> args)
 {
     if (auto frame = CurFrame(); frame)
+    {
+        FrameStack.InvalidateDispatch();
         return frame->Context->SetFunc(block, capture, args);
+    }
     NLRT_THROW_EX(FMTSTR2(u"SetFunc [{}] without frame", block->Name));
     return false;
 }
 bool NailangRuntime::SetFunc(const Block* block, common::span<std::pair<std::u32string_view, Arg>> capture, common::span<const std::u32string_view> args)
 {
     if (auto frame = CurFrame(); frame)
+    {
+        FrameStack.InvalidateDispatch();
         return frame->Context->SetFunc(block, capture, args);
+    }
     NLRT_THROW_EX(FMTSTR2(u"SetFunc [{}] without frame", block->Name));
     return false;
 }
@@ -1570,6 +1738,19 @@ Arg NailangRuntime::LookUpArg(const LateBindVar& var, const bool checkNull) cons
     return ret;
 }
 
+uint32_t NailangRuntime::CacheLocalFunc(const LocalFunc& func)
+{
+    // ids are kept across stamps since stamps can be restored after pop
+    if (DispatchFuncs.size() >= MaxDispatchFuncs) // drop all cached results, mostly made under stale stamps
+    {
+        FrameStack.InvalidateDispatch();
+        DispatchFuncs.clear();
+    }
+    const auto id = gsl::narrow_cast<uint32_t>(DispatchFuncs.size());
+    DispatchFuncs.push_back(func);
+    return id;
+}
+
 LocalFunc NailangRuntime::LookUpFunc(std::u32string_view name) const
 {
     for (auto frame = CurFrame(); frame; frame = frame->PrevFrame)
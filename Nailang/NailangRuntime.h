@@ -16,6 +16,7 @@
 namespace xziar::nailang
 {
 class NAILANGAPI NailangRuntime;
+class NAILANGAPI NailangProfiler;
 
 
 struct LocalFunc
@@ -31,6 +32,9 @@ struct LocalFunc
 class NAILANGAPI EvaluateContext
 {
     friend NailangRuntime;
+protected:
+    // should be set once any local func is added, framestack checks it on push/pop without virtual call
+    bool HasFunc = false;
 public:
     virtual ~EvaluateContext();
     /**
@@ -43,6 +47,7 @@ public:
     virtual bool SetFunc(const Block* block, common::span<std::pair<std::u32string_view, Arg>> capture, common::span<const std::u32string_view> args) = 0;
     [[nodiscard]] virtual size_t GetArgCount() const noexcept = 0;
     [[nodiscard]] virtual size_t GetFuncCount() const noexcept = 0;
+    [[nodiscard]] constexpr bool HasLocalFunc() const noexcept { return HasFunc; }
 };
 
 class NAILANGAPI BasicEvaluateContext : public EvaluateContext
@@ -59,6 +64,8 @@ protected:
     using LocalFuncHolder = std::tuple<const Block*, std::pair<uint32_t, uint32_t>, std::pair<uint32_t, uint32_t>>;
     [[nodiscard]] virtual LocalFuncHolder LookUpFuncInside(std::u32string_view name) const = 0;
     virtual bool SetFuncInside(std::u32string_view name, LocalFuncHolder func) = 0;
+    // copy storage of local funcs, holders from other context remain valid after copy
+    void CopyFrom(const BasicEvaluateContext& other);
 public:
     ~BasicEvaluateContext() override;
 
@@ -70,7 +77,7 @@ public:
 class NAILANGAPI LargeEvaluateContext : public BasicEvaluateContext
 {
 protected:
-    std::map<std::u32string, Arg, std::less<>> ArgMap;
+    std::map<std::u32string_view, Arg, std::less<>> ArgMap; // key is interned by IdentifierPool
     std::map<std::u32string_view, LocalFuncHolder, std::less<>> LocalFuncMap;
 
     [[nodiscard]] LocalFuncHolder LookUpFuncInside(std::u32string_view name) const override;
@@ -85,18 +92,14 @@ public:
 
 class NAILANGAPI CompactEvaluateContext : public BasicEvaluateContext
 {
-private:
-    common::HashedStringPool<char32_t> ArgNames;
 protected:
-    std::vector<std::pair<common::StringPiece<char32_t>, Arg>> Args;
+    std::vector<std::pair<common::str::HashedStrView<char32_t>, Arg>> Args; // name is interned by IdentifierPool
     std::vector<std::pair<std::u32string_view, LocalFuncHolder>> LocalFuncs;
 
-    std::u32string_view GetStringView(common::StringPiece<char32_t> piece) const noexcept
-    {
-        return ArgNames.GetStringView(piece);
-    }
     [[nodiscard]] LocalFuncHolder LookUpFuncInside(std::u32string_view name) const override;
     bool SetFuncInside(std::u32string_view name, LocalFuncHolder func) override;
+    // replace all args and local funcs with the ones from other context
+    void CopyFrom(const CompactEvaluateContext& other);
 public:
     ~CompactEvaluateContext() override;
 
@@ -403,6 +406,54 @@ public:
         TempArg.clear();
     }
 };
+// LIFO arena for temporary args (e.g. function params), memory is kept among evaluations
+class NAILANGAPI TempArgArena
+{
+private:
+    struct Chunk
+    {
+        std::unique_ptr<Arg[]> Args;
+        size_t Size;
+    };
+    std::vector<Chunk> Chunks;
+    size_t ChunkIdx = 0, Offset = 0;
+public:
+    static constexpr size_t DefaultChunkSize = 256;
+    class [[nodiscard]] Holder
+    {
+        friend TempArgArena;
+    private:
+        TempArgArena& Host;
+        common::span<Arg> Args;
+        size_t PrevChunkIdx, PrevOffset;
+        Holder(TempArgArena& host, common::span<Arg> args, size_t prevChunkIdx, size_t prevOffset) noexcept :
+            Host(host), Args(args), PrevChunkIdx(prevChunkIdx), PrevOffset(prevOffset)
+        { }
+    public:
+        COMMON_NO_COPY(Holder)
+        COMMON_NO_MOVE(Holder)
+        ~Holder()
+        {
+            for (auto& arg : Args)
+                arg = Arg{};
+            Host.ChunkIdx = PrevChunkIdx;
+            Host.Offset = PrevOffset;
+        }
+        [[nodiscard]] constexpr common::span<Arg> Get() const noexcept { return Args; }
+    };
+    TempArgArena() noexcept;
+    ~TempArgArena();
+    COMMON_NO_COPY(TempArgArena)
+    // allocated args are empty, they will be reset when holder is released
+    [[nodiscard]] Holder Allocate(const size_t count);
+};
+// process-wide pool for identifier names, interned names are never released so views are always valid.
+// Identifiers are bounded by the source, lookup of known names goes through a thread-local set without lock
+class NAILANGAPI IdentifierPool
+{
+public:
+    [[nodiscard]] static std::u32string_view Intern(const std::u32string_view name);
+};
 class MetaSet
 {
     friend NailangExecutor;
@@ -451,8 +502,9 @@ public:
 struct FuncEvalPack : public FuncPack
 {
     MetaSet* const Metas;
+    const FuncCall* const Site; // original call site, which holds the dispatch cache
     constexpr FuncEvalPack(const FuncCall& call, common::span<Arg> params, MetaSet* metas) noexcept :
-        FuncPack(call, params), Metas(metas) { }
+        FuncPack(call, params), Metas(metas), Site(&call) { }
     forceinline common::span<FuncPack> GetPostMetas() const noexcept
     {
         return MetaSet::GetPostMetas(Metas);
@@ -560,14 +612,30 @@ private:
         return reinterpret_cast<T*>(space.data());
     }
     NailangFrame* TopFrame = nullptr;
+    // 0 means stamps are exhausted and dispatch cache is disabled
+    uint64_t DispatchStamp;
+    // bumped on every invalidation, stamp saved at push is restored at pop only when nothing changed
+    uint64_t FuncVersion = 0;
+    // stamp made for the last pushed frame with local functions, reused when the same context is pushed on the same chain
+    struct
+    {
+        std::weak_ptr<EvaluateContext> Context;
+        uint64_t ParentStamp = 0, Version = 0, Stamp = 0;
+    } LastFuncFrame;
+    // frame with local functions changes the lookup result
+    NAILANGAPI void EnterFuncFrame(const NailangFrame& frame) noexcept;
     class FrameHolderBase
     {
         friend NailangFrameStack;
     protected:
         NailangFrameStack* const Host;
         NailangFrame* Frame;
+        uint64_t PrevStamp, PrevVersion;
         constexpr FrameHolderBase(NailangFrameStack* host, NailangFrame* frame) noexcept :
-            Host(host), Frame(frame) 
+            Host(host), Frame(frame), PrevStamp(host->DispatchStamp), PrevVersion(host->FuncVersion)
+        { }
+        constexpr FrameHolderBase(NailangFrameStack* host, NailangFrame* frame, uint64_t prevStamp, uint64_t prevVersion) noexcept :
+            Host(host), Frame(frame), PrevStamp(prevStamp), PrevVersion(prevVersion)
         { }
         NAILANGAPI ~FrameHolderBase();
     };
@@ -583,10 +651,13 @@ public:
             FrameHolderBase(host, host->Create<T>(std::forward<Args>(args)...))
         { 
             Host->TopFrame = Frame;
+            if (Frame->Context && Frame->Context->HasLocalFunc())
+                Host->EnterFuncFrame(*Frame);
         }
     public:
         template<typename U>
-        forceinline FrameHolder(FrameHolder<U>&& other) noexcept : FrameHolderBase(other.Host, other.Frame)
+        forceinline FrameHolder(FrameHolder<U>&& other) noexcept : 
+            FrameHolderBase(other.Host, other.Frame, other.PrevStamp, other.PrevVersion)
         {
             static_assert(std::is_base_of_v<T, U>);
             other.Frame = nullptr;
@@ -621,6 +692,10 @@ public:
     NAILANGAPI NailangFrame* SetBreak() const noexcept;
     NAILANGAPI NailangFrame* SetContinue() const noexcept;
     NAILANGAPI std::vector<common::StackTraceItem> CollectStacks() const noexcept;
+    // drop all call-site dispatch cache made under current stamp
+    NAILANGAPI void InvalidateDispatch() noexcept;
+    // stamp for call-site dispatch cache, unique across all framestacks and never reused
+    [[nodiscard]] constexpr uint64_t GetDispatchStamp() const noexcept { return DispatchStamp; }
     template<typename T>
     T* SearchFrameType(NailangFrame* from = nullptr) const noexcept
     {
@@ -680,12 +755,19 @@ class NAILANGAPI NailangExecutor : public NailangBase
 {
     friend NailangRuntime;
     friend NailangBlockFrame;
+public:
+    enum class DispatchKind : uint8_t 
+    { 
+        None = 0, Return, Break, Continue, Throw, Exists, Format, MathFunc, LocalFunc, Unknown, 
+        Extension = 0x80, // kinds since Extension are reserved for derived executors
+    };
 private:
     void ExecuteFrame(NailangBlockFrame& frame);
     template<typename T, Arg(Arg::* F)(SubQuery<T>&)>
     [[nodiscard]] Arg EvaluateQuery(Arg target, SubQuery<T> query, EvalTempStore& store, bool forWrite);
 protected:
     NailangRuntime* Runtime = nullptr;
+    NailangProfiler* Profiler = nullptr;
     [[nodiscard]] forceinline constexpr NailangFrame& GetFrame() const noexcept;
     [[nodiscard]] forceinline constexpr xziar::nailang::NailangFrameStack& GetFrameStack() const noexcept;
     [[nodiscard]] forceinline std::shared_ptr<xziar::nailang::EvaluateContext> CreateContext() const;
@@ -716,11 +798,35 @@ protected:
         ThrowByParamType(func, arg, type, offset);
         return arg;
     }
-    std::vector<Arg> EvalFuncAllArgs(const FuncCall& func);
+    void EvalFuncAllArgs(const FuncCall& func, common::span<Arg> params);
+    /**
+     * @brief get the cached dispatch result of the call site, valid until local functions change
+     * @return kind and id, DispatchKind::None if not cached
+    */
+    [[nodiscard]] forceinline std::pair<DispatchKind, uint32_t> GetDispatchCache(const FuncCall& call) const noexcept;
+    [[nodiscard]] forceinline std::pair<DispatchKind, uint32_t> GetDispatchCache(const FuncEvalPack& func) const noexcept
+    {
+        return GetDispatchCache(*func.Site);
+    }
+    // result is valid until lookup chain changes, it's shared by all calls of the call site
+    forceinline void SetDispatchCache(const FuncCall& call, DispatchKind kind, uint32_t id = 0) const noexcept;
+    forceinline void SetDispatchCache(const FuncEvalPack& func, DispatchKind kind, uint32_t id = 0) const noexcept
+    {
+        SetDispatchCache(*func.Site, kind, id);
+    }
+    // result decided by func name only, valid under any stamp, so kinds of derived executors should not use it
+    forceinline void SetStaticDispatchCache(const FuncCall& call, DispatchKind kind) const noexcept
+    {
+        Expects(kind < DispatchKind::LocalFunc);
+        call.Cache.Set(FuncCallCache::StaticStamp, common::enum_cast(kind));
+    }
 public:
     enum class MetaFuncResult : uint8_t { Unhandled, Next, Skip, Return };
     NailangExecutor(NailangRuntime* runtime) noexcept;
     virtual ~NailangExecutor();
+    // profiler is not owned, set nullptr to disable profiling
+    forceinline void SetProfiler(NailangProfiler* profiler) noexcept { Profiler = profiler; }
+    [[nodiscard]] forceinline NailangProfiler* GetProfiler() const noexcept { return Profiler; }
     [[nodiscard]] virtual NailangFrameStack::FrameHolder<NailangFrame> PushFrame(std::shared_ptr<EvaluateContext> ctx, NailangFrame::FrameFlags flag);
     [[nodiscard]] virtual NailangFrameStack::FrameHolder<NailangBlockFrame> PushBlockFrame(std::shared_ptr<EvaluateContext> ctx, NailangFrame::FrameFlags flag, const Block* block, common::span<const FuncCall> metas = {});
     [[nodiscard]] virtual NailangFrameStack::FrameHolder<NailangRawBlockFrame> PushRawBlockFrame(std::shared_ptr<EvaluateContext> ctx, NailangFrame::FrameFlags flag, const RawBlock* block, common::span<const FuncCall> metas = {});
@@ -769,6 +875,14 @@ protected:
 
     constexpr NailangFrame* CurFrame() const noexcept { return FrameStack.TopFrame; }
 
+    TempArgArena TempArgs;
+    std::vector<LocalFunc> DispatchFuncs;
+    // all cached funcs are dropped once reaching it, so that long-running runtime does not keep growing
+    static constexpr uint32_t MaxDispatchFuncs = 1024;
+    static_assert(MaxDispatchFuncs <= FuncCallCache::MaxId);
+    // record the resolved local function for call-site dispatch cache, return its id
+    [[nodiscard]] uint32_t CacheLocalFunc(const LocalFunc& func);
+
     [[nodiscard]] std::shared_ptr<EvaluateContext> GetContext(bool innerScope) const;
     [[noreturn]] void HandleException(const NailangRuntimeException& ex) const override;
     /**
@@ -809,6 +923,15 @@ inline std::shared_ptr<xziar::nailang::EvaluateContext> NailangExecutor::CreateC
 {
     return Runtime->ConstructEvalContext();
 }
+inline std::pair<NailangExecutor::DispatchKind, uint32_t> NailangExecutor::GetDispatchCache(const FuncCall& call) const noexcept
+{
+    const auto [kind, id] = call.Cache.Get(Runtime->FrameStack.GetDispatchStamp());
+    return { static_cast<DispatchKind>(kind), id };
+}
+inline void NailangExecutor::SetDispatchCache(const FuncCall& call, DispatchKind kind, uint32_t id) const noexcept
+{
+    call.Cache.Set(Runtime->FrameStack.GetDispatchStamp(), common::enum_cast(kind), id);
+}
 
 
 class NAILANGAPI NailangBasicRuntime : public NailangRuntime
@@ -316,14 +316,15 @@ void ArrayRef::PrintToStr(std::u32string& str, std::u32string_view delim) const
 
 
 Arg::Arg(const Arg& other) noexcept :
-    Data0(other.Data0), Data1(other.Data1), Data2(other.Data2), Data3(other.Data3), TypeData(other.TypeData)
+    Val{ 0, 0 }, Data2(other.Data2), Data3(other.Data3), TypeData(other.TypeData)
 {
+    CopyPayload(other);
     if (IsCustom())
     {
         const auto& var = GetCustom();
         var.Host->IncreaseRef(var);
     }
-    else if (TypeData == Type::U32Str && Data1 > 0)
+    else if (HasSharedStr())
     {
         auto str = other.GetVar<Type::U32Str>();
         common::SharedString<char32_t>::PlacedIncrease(str);
@@ -332,19 +333,20 @@ Arg::Arg(const Arg& other) noexcept :
 
 Arg& Arg::operator=(const Arg& other) noexcept
 {
+    if (this == &other)
+        return *this;
     if (HAS_FIELD(TypeData, Type::OwnershipBit))
         Release();
-    Data0 = other.Data0;
-    Data1 = other.Data1;
     Data2 = other.Data2;
     Data3 = other.Data3;
     TypeData = other.TypeData;
+    CopyPayload(other);
     if (IsCustom())
     {
         const auto& var = GetCustom();
         var.Host->IncreaseRef(var);
     }
-    else if (TypeData == Type::U32Str && Data1 > 0)
+    else if (HasSharedStr())
     {
         auto str = other.GetVar<Type::U32Str>();
         common::SharedString<char32_t>::PlacedIncrease(str);
@@ -352,6 +354,16 @@ Arg& Arg::operator=(const Arg& other) noexcept
     return *this;
 }
 
+void Arg::SetSharedStr(const std::u32string_view str) noexcept
+{
+    PlainData data{ 0, str.size() };
+    if (!str.empty())
+        data.Data0 = reinterpret_cast<uint64_t>(common::SharedString<char32_t>::PlacedCreate(str).data());
+    Val = data; // str may point to InlineStr, so only overwrite after copied
+    Data3 = 4;
+    TypeData = Type::U32Str;
+}
+
 void Arg::Release() noexcept
 {
     if (IsCustom())
@@ -359,7 +371,7 @@ void Arg::Release() noexcept
         auto& var = GetCustom();
         var.Host->DecreaseRef(var);
     }
-    else if (TypeData == Type::U32Str && Data1 > 0)
+    else if (HasSharedStr())
     {
         auto str = GetVar<Type::U32Str>();
         common::SharedString<char32_t>::PlacedDecrease(str);
@@ -445,7 +457,10 @@ common::str::StrVariant<char32_t> Arg::ToString() const noexcept
     {
     default:
     case Type::Var:     return {};
-    case Type::U32Str:  return GetVar<Type::U32Str>();
+    case Type::U32Str:
+        if (IsInlineStr()) // view does not survive move of the Arg
+            return std::u32string(GetVar<Type::U32Str>());
+        return GetVar<Type::U32Str>();
     case Type::U32Sv:   return GetVar<Type::U32Sv>();
     case Type::Bool:    return GetVar<Type::Bool>() ? U"true"sv : U"false"sv;
     case Type::Uint: 
@@ -525,7 +540,7 @@ void Arg::Decay()
     else if (IsArgPtr())
     {
         const auto isConst = !HAS_FIELD(static_cast<ArgAccess>(Data3), ArgAccess::WriteOnly);
-        *this = *reinterpret_cast<const Arg*>(Data0.Uint);
+        *this = *reinterpret_cast<const Arg*>(Val.Data0.Uint);
         if (IsCustom() && isConst)
             TypeData |= Type::ConstBit;
     }
@@ -538,7 +553,7 @@ bool Arg::Set(Arg val)
     {
         if (!MATCH_FIELD(static_cast<ArgAccess>(Data3), ArgAccess::Assignable))
             return false;
-        *reinterpret_cast<Arg*>(Data0.Uint) = std::move(val);
+        *reinterpret_cast<Arg*>(Val.Data0.Uint) = std::move(val);
         return true;
     }
     if (IsCustom())
@@ -595,7 +610,7 @@ CompareResult Arg::NativeCompare(const Arg& right) const noexcept
         const auto r_ = right.GetStr();
         if (r_.has_value())
         {
-            const auto l = GetVar<Type::U32Sv, false>(), r = r_.value();
+            const auto l = GetStr().value(), r = r_.value();
             const auto ret = std::char_traits<char32_t>::compare(l.data(), r.data(), std::min(l.size(), r.size()));
             if (ret < 0)             return CompareResultCore::StrongOrder | CompareResultCore::Less;
             if (ret > 0)             return CompareResultCore::StrongOrder | CompareResultCore::Greater;
@@ -765,7 +780,7 @@ Arg Arg::HandleBinary(const EmbedOps op, const Arg& right) const
                 const auto r_ = right.GetStr();
                 if (r_.has_value())
                 {
-                    const auto l = GetVar<Type::U32Sv, false>(), r = r_.value();
+                    const auto l = GetStr().value(), r = r_.value();
                     std::u32string ret;
                     ret.reserve(l.size() + r.size());
                     ret.append(l).append(r);
@@ -530,58 +530,92 @@ public:
         Var    = CategoryCustom | ExTypeBit | OwnershipBit,
     };
 private:
-    detail::IntFPUnion Data0;
-    uint64_t Data1;
+    struct PlainData
+    {
+        detail::IntFPUnion Data0;
+        uint64_t Data1;
+    };
+    static constexpr uint16_t InlineStrFlag = 0x8000;
+    static constexpr size_t InlineStrCapacity = sizeof(PlainData) / sizeof(char32_t);
+    // short U32Str is stored in InlineStr, with length and flag in Data3
+    union
+    {
+        PlainData Val;
+        char32_t InlineStr[InlineStrCapacity];
+    };
     uint32_t Data2;
     uint16_t Data3;
+    [[nodiscard]] forceinline constexpr bool IsInlineStr() const noexcept
+    {
+        return TypeData == Type::U32Str && (Data3 & InlineStrFlag);
+    }
+    [[nodiscard]] forceinline constexpr bool HasSharedStr() const noexcept
+    {
+        return TypeData == Type::U32Str && !(Data3 & InlineStrFlag) && Val.Data1 > 0;
+    }
+    forceinline void CopyPayload(const Arg& other) noexcept
+    {
+        if (other.IsInlineStr())
+        {
+            for (size_t i = 0; i < InlineStrCapacity; ++i)
+                InlineStr[i] = other.InlineStr[i];
+        }
+        else
+            Val = other.Val;
+    }
+    // put string longer than InlineStrCapacity in SharedString
+    NAILANGAPI void SetSharedStr(const std::u32string_view str) noexcept;
     NAILANGAPI void Release() noexcept;
 public:
     Type TypeData;
 
-    Arg() noexcept : Data0(0), Data1(0), Data2(0), Data3(0), TypeData(Type::Empty)
+    Arg() noexcept : Val{ 0, 0 }, Data2(0), Data3(0), TypeData(Type::Empty)
     { }
-    Arg(const GetSet& getset) noexcept : Data0(reinterpret_cast<uint64_t>(getset.Host)),
-        Data1(getset.Ptr), Data2(getset.Idx), Data3(getset.Meta), TypeData(getset.Host ? Type::CategoryGetSet : Type::Empty)
+    Arg(const GetSet& getset) noexcept : Val{ reinterpret_cast<uint64_t>(getset.Host), getset.Ptr },
+        Data2(getset.Idx), Data3(getset.Meta), TypeData(getset.Host ? Type::CategoryGetSet : Type::Empty)
     { }
-    Arg(Arg* arg, ArgAccess access = ArgAccess::ReadWrite) noexcept : Data0(reinterpret_cast<uint64_t>(arg)),
-        Data1(0), Data2(0), Data3(common::enum_cast(access)), TypeData(arg ? Type::CategoryArgPtr : Type::Empty)
+    Arg(Arg* arg, ArgAccess access = ArgAccess::ReadWrite) noexcept : Val{ reinterpret_cast<uint64_t>(arg), 0 },
+        Data2(0), Data3(common::enum_cast(access)), TypeData(arg ? Type::CategoryArgPtr : Type::Empty)
     { }
-    Arg(const Arg* arg) noexcept : Data0(reinterpret_cast<uint64_t>(arg)),
-        Data1(0), Data2(0), Data3(common::enum_cast(ArgAccess::ReadOnly)), TypeData(arg ? Type::CategoryArgPtr : Type::Empty)
+    Arg(const Arg* arg) noexcept : Val{ reinterpret_cast<uint64_t>(arg), 0 },
+        Data2(0), Data3(common::enum_cast(ArgAccess::ReadOnly)), TypeData(arg ? Type::CategoryArgPtr : Type::Empty)
     { }
     Arg(const CustomVar& var) noexcept = delete;
     Arg(CustomVar&& var, bool isConst = false) noexcept;
     Arg(const ArrayRef arr) noexcept;
     Arg(const std::u32string& str) noexcept : 
-        Data0(0), Data1(0), Data2(0), Data3(4), TypeData(Type::U32Str)
+        Val{ 0, 0 }, Data2(0), Data3(4), TypeData(Type::U32Str)
     {
-        if (str.size() > 0)
+        if (str.size() <= InlineStrCapacity)
         {
-            const auto tmp = common::SharedString<char32_t>::PlacedCreate(str);
-            Data0 = reinterpret_cast<uint64_t>(tmp.data());
-            Data1 = str.size();
+            Data3 = static_cast<uint16_t>(InlineStrFlag | str.size());
+            for (size_t i = 0; i < InlineStrCapacity; ++i)
+                InlineStr[i] = i < str.size() ? str[i] : U'\0';
         }
+        else
+            SetSharedStr(str);
     }
     Arg(const std::u32string_view str) noexcept :
-        Data0(reinterpret_cast<uint64_t>(str.data())), Data1(str.size()),
+        Val{ reinterpret_cast<uint64_t>(str.data()), str.size() },
         Data2(0), Data3(5), TypeData(Type::U32Sv)
     { }
     Arg(const uint64_t num) noexcept :
-        Data0(num), Data1(0), Data2(0), Data3(6), TypeData(Type::Uint)
+        Val{ num, 0 }, Data2(0), Data3(6), TypeData(Type::Uint)
     { }
     Arg(const int64_t num) noexcept :
-        Data0(static_cast<uint64_t>(num)), Data1(0), Data2(0), Data3(7), TypeData(Type::Int)
+        Val{ static_cast<uint64_t>(num), 0 }, Data2(0), Data3(7), TypeData(Type::Int)
     { }
     Arg(const double num) noexcept :
-        Data0(num), Data1(0), Data2(0), Data3(8), TypeData(Type::FP)
+        Val{ num, 0 }, Data2(0), Data3(8), TypeData(Type::FP)
     { }
     Arg(const bool boolean) noexcept :
-        Data0(boolean ? 1 : 0), Data1(0), Data2(0), Data3(9), TypeData(Type::Bool)
+        Val{ boolean ? 1u : 0u, 0 }, Data2(0), Data3(9), TypeData(Type::Bool)
     { }
     ~Arg();
     Arg(Arg&& other) noexcept :
-        Data0(other.Data0), Data1(other.Data1), Data2(other.Data2), Data3(other.Data3), TypeData(other.TypeData)
+        Val{ 0, 0 }, Data2(other.Data2), Data3(other.Data3), TypeData(other.TypeData)
     {
+        CopyPayload(other);
         other.TypeData = Type::Empty;
     }
     forceinline Arg& operator=(Arg&& other) noexcept;
@@ -647,7 +681,9 @@ public:
     [[nodiscard]] NAILANGAPI std::optional<uint64_t>            GetUint()   const noexcept;
     [[nodiscard]] NAILANGAPI std::optional<int64_t>             GetInt()    const noexcept;
     [[nodiscard]] NAILANGAPI std::optional<double>              GetFP()     const noexcept;
+    // view of a short U32Str points into the Arg itself, it's invalidated when the Arg is moved or destroyed
     [[nodiscard]] NAILANGAPI std::optional<std::u32string_view> GetStr()    const noexcept;
+    // owns the string when it's stored inline, so it can outlive the Arg
     [[nodiscard]] NAILANGAPI common::str::StrVariant<char32_t>  ToString()  const noexcept;
 
 
@@ -691,15 +727,15 @@ struct NAILANGAPI CustomVar::Handler
     [[nodiscard]] virtual Arg ConvertToCommon(const CustomVar&, Arg::Type) noexcept;
 };
 
-inline Arg::Arg(CustomVar&& var, bool isConst) noexcept : Data0(reinterpret_cast<uint64_t>(var.Host)),
-    Data1(var.Meta0), Data2(var.Meta1), Data3(var.Meta2), TypeData((isConst ? Type::ConstBit : Type::Empty) | Type::Var)
+inline Arg::Arg(CustomVar&& var, bool isConst) noexcept : Val{ reinterpret_cast<uint64_t>(var.Host), var.Meta0 },
+    Data2(var.Meta1), Data3(var.Meta2), TypeData((isConst ? Type::ConstBit : Type::Empty) | Type::Var)
 {
     Expects(var.Host != nullptr);
     var.Host = nullptr;
     var.Meta0 = var.Meta1 = var.Meta2 = 0;
 }
 inline Arg::Arg(const ArrayRef arr) noexcept :
-    Data0(arr.DataPtr), Data1(0), Data2(arr.Length), Data3(common::enum_cast(arr.ElementType)),
+    Val{ arr.DataPtr, 0 }, Data2(arr.Length), Data3(common::enum_cast(arr.ElementType)),
     TypeData(Type::Array | (arr.IsReadOnly ? Type::ConstBit : Type::Empty))
 { }
 inline Arg::~Arg()
@@ -711,8 +747,7 @@ inline Arg& Arg::operator=(Arg&& other) noexcept
 {
     if (HAS_FIELD(TypeData, Type::OwnershipBit))
         Release();
-    Data0 = other.Data0;
-    Data1 = other.Data1;
+    CopyPayload(other);
     Data2 = other.Data2;
     Data3 = other.Data3;
     TypeData = other.TypeData;
@@ -729,21 +764,25 @@ template<Arg::Type T, bool Check>
         Expects((type & target) == target);
     }
     if constexpr (T == Type::Var)
-        return CustomVar{ reinterpret_cast<CustomVar::Handler*>(Data0.Uint), Data1, Data2, Data3 };
+        return CustomVar{ reinterpret_cast<CustomVar::Handler*>(Val.Data0.Uint), Val.Data1, Data2, Data3 };
     else if constexpr (T == Type::Array)
-        return ArrayRef{ static_cast<uintptr_t>(Data0.Uint), Data2, static_cast<ArrayRef::Type>(Data3), HAS_FIELD(TypeData, Type::ConstBit) };
+        return ArrayRef{ static_cast<uintptr_t>(Val.Data0.Uint), Data2, static_cast<ArrayRef::Type>(Data3), HAS_FIELD(TypeData, Type::ConstBit) };
     else if constexpr (T == Type::U32Str)
-        return std::u32string_view{ reinterpret_cast<const char32_t*>(Data0.Uint), static_cast<size_t>(Data1) };
+    {
+        if (IsInlineStr())
+            return std::u32string_view{ InlineStr, static_cast<size_t>(Data3 & ~InlineStrFlag) };
+        return std::u32string_view{ reinterpret_cast<const char32_t*>(Val.Data0.Uint), static_cast<size_t>(Val.Data1) };
+    }
     else if constexpr (T == Type::U32Sv)
-        return std::u32string_view{ reinterpret_cast<const char32_t*>(Data0.Uint), static_cast<size_t>(Data1) };
+        return std::u32string_view{ reinterpret_cast<const char32_t*>(Val.Data0.Uint), static_cast<size_t>(Val.Data1) };
     else if constexpr (T == Type::Uint)
-        return Data0.Uint;
+        return Val.Data0.Uint;
     else if constexpr (T == Type::Int)
-        return static_cast<int64_t>(Data0.Uint);
+        return static_cast<int64_t>(Val.Data0.Uint);
     else if constexpr (T == Type::FP)
-        return Data0.FP;
+        return Val.Data0.FP;
     else if constexpr (T == Type::Bool)
-        return Data0.Uint == 1;
+        return Val.Data0.Uint == 1;
     else
         static_assert(!common::AlwaysTrue2<T>, "Unknown Type");
 }
@@ -899,10 +938,54 @@ inline constexpr bool FuncName::IsMeta() const noexcept
 using TempFuncName = TempPartedName<FuncName>;
 
 
+// per call-site dispatch cache, filled by executor.
+// Packed as [stamp:40][kind:8][id:16] so that it can be shared by runtimes on different threads.
+// Stamps are never reused, StaticStamp marks results decided by name only, which stay valid under any stamp.
+// Copy does not inherit the cache, since only the original call site is stable.
+class FuncCallCache
+{
+private:
+    mutable std::atomic<uint64_t> Data;
+public:
+    static constexpr uint64_t StaticStamp = (uint64_t(1) << 40) - 1;
+    static constexpr uint32_t MaxId = 0xffffu;
+    constexpr FuncCallCache() noexcept : Data(0) { }
+    constexpr FuncCallCache(const FuncCallCache&) noexcept : Data(0) { }
+    FuncCallCache& operator=(const FuncCallCache&) noexcept 
+    { 
+        Reset();
+        return *this;
+    }
+    /**
+     * @brief get the cached dispatch result if it's made under the same stamp or is static
+     * @param stamp current stamp, 0 means cache is disabled
+     * @return kind and id, kind 0 means not cached
+    */
+    [[nodiscard]] forceinline std::pair<uint8_t, uint32_t> Get(const uint64_t stamp) const noexcept
+    {
+        const auto data = Data.load(std::memory_order_relaxed);
+        const auto dataStamp = data >> 24;
+        if (dataStamp != StaticStamp && (dataStamp != stamp || stamp == 0))
+            return { 0, 0 };
+        return { static_cast<uint8_t>(data >> 16), static_cast<uint32_t>(data & MaxId) };
+    }
+    forceinline void Set(const uint64_t stamp, const uint8_t kind, const uint32_t id = 0) const noexcept
+    {
+        Expects(stamp <= StaticStamp && id <= MaxId);
+        if (stamp != 0)
+            Data.store((stamp << 24) | (uint64_t(kind) << 16) | id, std::memory_order_relaxed);
+    }
+    forceinline void Reset() const noexcept
+    {
+        Data.store(0, std::memory_order_relaxed);
+    }
+};
+
 struct FuncCall : public WithPos
 {
     const FuncName* Name;
     common::span<const Expr> Args;
+    FuncCallCache Cache;
     constexpr FuncCall() noexcept : Name(nullptr) {}
     constexpr FuncCall(const FuncName* name, common::span<const Expr> args) noexcept : Name(name), Args(args) { }
     constexpr FuncCall(const FuncName* name, common::span<const Expr> args, const std::pair<uint32_t, uint32_t> pos) noexcept :
@@ -542,7 +542,7 @@ xcomp::XCNLStructHandler& NLCLRuntime::GetStructHandler() noexcept { return Stru
     GENV(PPCAT(pfx, 4),  type, bit, 4), \
     GENV(PPCAT(pfx, 8),  type, bit, 8), \
     GENV(PPCAT(pfx, 16), type, bit, 16)
-static constexpr auto CLTypeLookup = BuildStaticLookup(uint32_t, std::u32string_view,
+static constexpr auto CLTypeLookup = BuildStaticHashLookup(uint32_t, std::u32string_view,
     PERPFX(uchar,  Unsigned, 8),
     PERPFX(ushort, Unsigned, 16),
     PERPFX(uint,   Unsigned, 32),
@@ -714,7 +714,7 @@ void NLCLRuntime::HandleInstanceArg(const xcomp::InstanceArgInfo& arg, xcomp::In
     }
 }
 
-void NLCLRuntime::BeforeFinishOutput(std::u32string& prefixes, std::u32string&, std::u32string&, std::u32string&)
+void NLCLRuntime::BeforeFinishOutput(xcomp::U32Rope& prefixes, xcomp::U32Rope&, xcomp::U32Rope&, xcomp::U32Rope&)
 {
     std::u32string exts = U"/* Extensions */\r\n"s;
     // Output extensions
@@ -732,7 +732,7 @@ void NLCLRuntime::BeforeFinishOutput(std::u32string& prefixes, std::u32string&,
                 });
     }
     exts.append(U"\r\n"sv);
-    prefixes.insert(prefixes.begin(), exts.begin(), exts.end());
+    prefixes.Prepend(exts);
 }
 
 xcomp::VTypeInfo NLCLRuntime::TryParseVecType(const std::u32string_view type, bool) const noexcept
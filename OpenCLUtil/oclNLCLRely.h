@@ -209,7 +209,7 @@ protected:
 
     [[nodiscard]] xcomp::OutputBlock::BlockType GetBlockType(const RawBlock& block, MetaFuncs metas) const noexcept final;
     void HandleInstanceArg(const xcomp::InstanceArgInfo& arg, xcomp::InstanceContext& ctx, const xziar::nailang::FuncPack& meta, const xziar::nailang::Arg*) final;
-    void BeforeFinishOutput(std::u32string& prefixes, std::u32string& structs, std::u32string& globals, std::u32string& kernels) final;
+    void BeforeFinishOutput(xcomp::U32Rope& prefixes, xcomp::U32Rope& structs, xcomp::U32Rope& globals, xcomp::U32Rope& kernels) final;
 public:
     [[nodiscard]] static std::u32string_view GetCLTypeName(xcomp::VTypeInfo info) noexcept;
     NLCLRuntime(common::mlog::MiniLogger<false>& logger, std::shared_ptr<NLCLContext> evalCtx);
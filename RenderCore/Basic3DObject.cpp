@@ -46,6 +46,12 @@ void Pyramid::PrepareGL(const oglu::oglDrawProgram& prog, const map<string, stri
     SetVAO(prog, vao);
 }
 
+BoundingBox Pyramid::GetLocalBounds() const
+{
+    constexpr float sqrt3 = 1.73205080757f;
+    return { mbase::Vec3(-0.5f, 0.0f, -sqrt3 / 6) * Sidelen, mbase::Vec3(0.5f, sqrt3 / 2, sqrt3 / 3) * Sidelen };
+}
+
 void Pyramid::Serialize(SerializeUtil & context, xziar::ejson::JObject& jself) const
 {
     Drawable::Serialize(context, jself);
@@ -120,6 +126,11 @@ void Sphere::PrepareGL(const oglu::oglDrawProgram& prog, const map<string, strin
     SetVAO(prog, vao);
 }
 
+BoundingBox Sphere::GetLocalBounds() const
+{
+    return { mbase::Vec3(-Radius), mbase::Vec3(Radius) };
+}
+
 void Sphere::Serialize(SerializeUtil & context, xziar::ejson::JObject& jself) const
 {
     Drawable::Serialize(context, jself);
@@ -211,6 +222,11 @@ void Box::PrepareGL(const oglu::oglDrawProgram& prog, const map<string, string>&
     SetVAO(prog, vao);
 }
 
+BoundingBox Box::GetLocalBounds() const
+{
+    return { Size * -0.5f, Size * 0.5f };
+}
+
 void Box::Serialize(SerializeUtil & context, xziar::ejson::JObject& jself) const
 {
     Drawable::Serialize(context, jself);
@@ -252,6 +268,11 @@ void Plane::PrepareGL(const oglu::oglDrawProgram& prog, const map<string, string
     SetVAO(prog, vao);
 }
 
+BoundingBox Plane::GetLocalBounds() const
+{
+    return { mbase::Vec3(-SideLen, 0.0f, -SideLen), mbase::Vec3(SideLen, 0.0f, SideLen) };
+}
+
 void Plane::Serialize(SerializeUtil & context, xziar::ejson::JObject& jself) const
 {
     Drawable::Serialize(context, jself);
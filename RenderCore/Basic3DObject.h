@@ -20,6 +20,7 @@ public:
     Pyramid(const float len);
     ~Pyramid() override { }
     virtual void PrepareGL(const oglu::oglDrawProgram& prog, const std::map<string, string>& translator = std::map<string, string>()) override;
+    virtual BoundingBox GetLocalBounds() const override;
     RESPAK_DECL_COMP_DESERIALIZE("dizz#Drawable#Pyramid")
     virtual void Serialize(xziar::respak::SerializeUtil& context, xziar::ejson::JObject& object) const override;
     virtual void Deserialize(xziar::respak::DeserializeUtil& context, const xziar::ejson::JObjectRef<true>& object) override;
@@ -42,6 +43,7 @@ public:
     Sphere(const float r);
     ~Sphere() override { }
     virtual void PrepareGL(const oglu::oglDrawProgram& prog, const std::map<string, string>& translator = std::map<string, string>()) override;
+    virtual BoundingBox GetLocalBounds() const override;
     RESPAK_DECL_COMP_DESERIALIZE("dizz#Drawable#Sphere")
     virtual void Serialize(xziar::respak::SerializeUtil& context, xziar::ejson::JObject& object) const override;
     virtual void Deserialize(xziar::respak::DeserializeUtil& context, const xziar::ejson::JObjectRef<true>& object) override;
@@ -64,6 +66,7 @@ public:
     Box(const float length, const float height, const float width);
     ~Box() override { }
     virtual void PrepareGL(const oglu::oglDrawProgram& prog, const std::map<string, string>& translator = std::map<string, string>()) override;
+    virtual BoundingBox GetLocalBounds() const override;
     RESPAK_DECL_COMP_DESERIALIZE("dizz#Drawable#Box")
     virtual void Serialize(xziar::respak::SerializeUtil& context, xziar::ejson::JObject& object) const override;
     virtual void Deserialize(xziar::respak::DeserializeUtil& context, const xziar::ejson::JObjectRef<true>& object) override;
@@ -85,6 +88,7 @@ public:
     Plane(const float len = 500.0f, const float texRepeat = 1.0f);
     ~Plane() override { }
     virtual void PrepareGL(const oglu::oglDrawProgram& prog, const std::map<string, string>& translator = std::map<string, string>()) override;
+    virtual BoundingBox GetLocalBounds() const override;
     RESPAK_DECL_COMP_DESERIALIZE("dizz#Drawable#Plane")
     virtual void Serialize(xziar::respak::SerializeUtil& context, xziar::ejson::JObject& object) const override;
     virtual void Deserialize(xziar::respak::DeserializeUtil& context, const xziar::ejson::JObjectRef<true>& object) override;
@@ -34,6 +34,13 @@ Model::Model(ModelMesh mesh) : Drawable(this, TYPENAME), Mesh(mesh)
 Model::Model(const u16string& fname, const std::shared_ptr<TextureLoader>& texLoader, const std::shared_ptr<oglu::oglWorker>& asyncer)
     : Model(detail::_ModelMesh::GetModel(fname, texLoader, asyncer)) {}
 
+common::PromiseResult<std::shared_ptr<Model>> Model::LoadAsync(const u16string& fname, const std::shared_ptr<TextureLoader>& texLoader,
+    const std::shared_ptr<oglu::oglWorker>& asyncer, common::asyexe::AsyncManager& loader)
+{
+    return common::StagedResult::TwoStage(detail::_ModelMesh::GetModelAsync(fname, texLoader, asyncer, loader),
+        [](ModelMesh mesh) { return std::shared_ptr<Model>(new Model(std::move(mesh))); });
+}
+
 Model::~Model()
 {
     const auto mfname = Mesh->mfname;
@@ -63,6 +70,14 @@ void Model::Draw(Drawcall& drawcall) const
         .Draw(GetVAO(drawcall.Drawer.GetProg()));
 }
 
+BoundingBox Model::GetLocalBounds() const
+{
+    if (!Mesh)
+        return {};
+    const auto half = Mesh->size * 0.5f;
+    return { Mesh->center - half, Mesh->center + half };
+}
+
 void Model::Serialize(SerializeUtil & context, xziar::ejson::JObject& jself) const
 {
     Drawable::Serialize(context, jself);
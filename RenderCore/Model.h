@@ -23,8 +23,12 @@ public:
     ModelMesh Mesh;
     Model(const u16string& fname, const std::shared_ptr<TextureLoader>& texLoader, const std::shared_ptr<oglu::oglWorker>& asyncer = {});
     ~Model() override;
+    // load mesh through the shared cache on loader, concurrent requests of the same file share one load
+    static common::PromiseResult<std::shared_ptr<Model>> LoadAsync(const u16string& fname, const std::shared_ptr<TextureLoader>& texLoader,
+        const std::shared_ptr<oglu::oglWorker>& asyncer, common::asyexe::AsyncManager& loader);
     virtual void PrepareGL(const oglu::oglDrawProgram& prog, const std::map<string, string>& translator = std::map<string, string>()) override;
     virtual void Draw(Drawcall& drawcall) const override;
+    virtual BoundingBox GetLocalBounds() const override;
     RESPAK_DECL_COMP_DESERIALIZE("dizz#Drawable#Model")
     virtual void Serialize(xziar::respak::SerializeUtil& context, xziar::ejson::JObject& object) const override;
     virtual void Deserialize(xziar::respak::DeserializeUtil& context, const xziar::ejson::JObjectRef<true>& object) override;
@@ -0,0 +1,173 @@
+#pragma once
+#include "RenderCoreRely.h"
+#include <algorithm>
+
+namespace dizz::detail
+{
+
+
+// reorder triangles for post-transform vertex cache and vertices for fetch locality
+namespace meshopt
+{
+
+// average cache miss ratio (misses per triangle) of a FIFO cache
+inline float CalcACMR(common::span<const uint32_t> indexs, const size_t vertCount, const uint32_t cacheSize)
+{
+    if (indexs.size() < 3)
+        return 0.f;
+    std::vector<uint32_t> stamps(vertCount, 0);
+    uint32_t time = cacheSize + 1, misses = 0;
+    for (const auto idx : indexs)
+    {
+        // FIFO only changes on miss, so a vertex is still inside if less than cacheSize misses happened after it
+        if (time - stamps[idx] > cacheSize)
+        {
+            stamps[idx] = time++;
+            misses++;
+        }
+    }
+    return misses * 3.f / static_cast<float>(indexs.size());
+}
+
+// Tipsify, see "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw" (Sander et al. 2007).
+// It's linear in triangle count, which matters more than the last few percent of ACMR for loading
+class Tipsifier
+{
+private:
+    std::vector<uint32_t> LocalIds;     // global vertex -> local vertex, UINT32_MAX when absent
+    std::vector<uint32_t> GlobalIds;    // local vertex -> global vertex
+    std::vector<uint32_t> AdjOffsets;   // local vertex -> range in AdjTris
+    std::vector<uint32_t> AdjTris;
+    std::vector<uint32_t> LiveCount;
+    std::vector<uint32_t> Stamps;
+    std::vector<uint32_t> DeadEnds;
+    std::vector<uint32_t> Candidates;
+    std::vector<uint32_t> Output;
+    std::vector<bool> Emitted;
+    uint32_t CacheSize;
+public:
+    Tipsifier(const size_t vertCount, const uint32_t cacheSize = 16) : LocalIds(vertCount, UINT32_MAX), CacheSize(cacheSize)
+    { }
+    // reorder triangles inside the range, each range is handled separately so groups are kept
+    void Optimize(common::span<uint32_t> indexs)
+    {
+        const auto triCount = static_cast<uint32_t>(indexs.size() / 3);
+        if (triCount < 2)
+            return;
+        const auto idxCount = triCount * 3;
+        // compact vertex ids, so cost is only related to the range
+        GlobalIds.clear();
+        for (uint32_t i = 0; i < idxCount; ++i)
+        {
+            auto& local = LocalIds[indexs[i]];
+            if (local == UINT32_MAX)
+            {
+                local = static_cast<uint32_t>(GlobalIds.size());
+                GlobalIds.push_back(indexs[i]);
+            }
+            indexs[i] = local;
+        }
+        const auto vertCount = static_cast<uint32_t>(GlobalIds.size());
+        // build vertex-triangle adjacency
+        LiveCount.assign(vertCount, 0);
+        for (uint32_t i = 0; i < idxCount; ++i)
+            LiveCount[indexs[i]]++;
+        AdjOffsets.resize(vertCount + 1);
+        AdjOffsets[0] = 0;
+        for (uint32_t v = 0; v < vertCount; ++v)
+            AdjOffsets[v + 1] = AdjOffsets[v] + LiveCount[v];
+        AdjTris.resize(idxCount);
+        {
+            std::vector<uint32_t> cursor(AdjOffsets.begin(), AdjOffsets.end() - 1);
+            for (uint32_t i = 0; i < idxCount; ++i)
+                AdjTris[cursor[indexs[i]]++] = i / 3;
+        }
+        Stamps.assign(vertCount, 0);
+        Emitted.assign(triCount, false);
+        DeadEnds.clear();
+        Output.clear();
+        Output.reserve(idxCount);
+
+        uint32_t time = CacheSize + 1, cursor = 1;
+        int64_t fanning = 0;
+        while (fanning >= 0)
+        {
+            const auto f = static_cast<uint32_t>(fanning);
+            Candidates.clear();
+            for (auto j = AdjOffsets[f]; j < AdjOffsets[f + 1]; ++j)
+            {
+                const auto tri = AdjTris[j];
+                if (Emitted[tri])
+                    continue;
+                for (uint32_t k = 0; k < 3; ++k)
+                {
+                    const auto v = indexs[tri * 3 + k];
+                    Output.push_back(v);
+                    DeadEnds.push_back(v);
+                    Candidates.push_back(v);
+                    LiveCount[v]--;
+                    if (time - Stamps[v] > CacheSize)
+                        Stamps[v] = time++;
+                }
+                Emitted[tri] = true;
+            }
+            // pick the candidate that stays in cache after its remaining triangles are emitted, oldest first
+            fanning = -1;
+            int64_t best = -1;
+            for (const auto v : Candidates)
+            {
+                if (LiveCount[v] == 0)
+                    continue;
+                int64_t priority = 0;
+                if (time - Stamps[v] + 2 * LiveCount[v] <= CacheSize)
+                    priority = time - Stamps[v];
+                if (priority > best)
+                    best = priority, fanning = v;
+            }
+            if (fanning < 0) // dead end, try recently used vertices, then next vertex in input order
+            {
+                while (!DeadEnds.empty() && fanning < 0)
+                {
+                    const auto v = DeadEnds.back();
+                    DeadEnds.pop_back();
+                    if (LiveCount[v] > 0)
+                        fanning = v;
+                }
+                while (cursor < vertCount && LiveCount[cursor] == 0)
+                    ++cursor;
+                if (fanning < 0 && cursor < vertCount)
+                    fanning = cursor;
+            }
+        }
+        Expects(Output.size() == idxCount);
+        for (uint32_t i = 0; i < idxCount; ++i)
+            indexs[i] = GlobalIds[Output[i]];
+        for (const auto v : GlobalIds)
+            LocalIds[v] = UINT32_MAX;
+    }
+};
+
+// renumber vertices in order of first use, unused vertices are dropped
+template<typename T>
+inline void OptimizeVertexFetch(std::vector<T>& vertices, common::span<uint32_t> indexs)
+{
+    std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+    std::vector<T> output;
+    output.reserve(vertices.size());
+    for (auto& idx : indexs)
+    {
+        auto& newIdx = remap[idx];
+        if (newIdx == UINT32_MAX)
+        {
+            newIdx = static_cast<uint32_t>(output.size());
+            output.push_back(vertices[idx]);
+        }
+        idx = newIdx;
+    }
+    vertices = std::move(output);
+}
+
+}
+
+
+}
@@ -0,0 +1,201 @@
+#pragma once
+#include "RenderCoreRely.h"
+#include "SystemCommon/MiniLogger.h"
+#include "common/SpinLock.hpp"
+
+namespace dizz::detail
+{
+
+
+// items keyed by path and validated by modify time, T should provide GetMemorySize.
+// Concurrent requests of the same file share one load, unused items are kept in LRU order until exceeding budget
+template<typename T>
+class ModelCache
+{
+public:
+    using Item = std::shared_ptr<T>;
+private:
+    struct Entry
+    {
+        Item Mesh;
+        fs::file_time_type ModifyTime;
+        // requests waiting for the loading one
+        std::vector<common::BasicPromise<Item>> Waiters;
+        uint64_t LastUse = 0;
+        bool IsLoading = false;
+    };
+    mutable common::SpinLocker Lock;
+    std::map<u16string, Entry, std::less<>> Entries;
+    common::mlog::MiniLogger<false>* Logger;
+    uint64_t UseCounter = 0;
+    size_t Budget = 256 * 1024 * 1024;
+
+    static fs::file_time_type GetModifyTime(const u16string& fname) noexcept
+    {
+        std::error_code ec;
+        const auto time = fs::last_write_time(fs::path(fname), ec);
+        return ec ? fs::file_time_type{} : time;
+    }
+    // should be called with lock held
+    size_t GetTotalSize() const noexcept
+    {
+        size_t total = 0;
+        for (const auto& [name, entry] : Entries)
+            if (entry.Mesh)
+                total += entry.Mesh->GetMemorySize();
+        return total;
+    }
+    // should be called with lock held
+    void TrimUnused()
+    {
+        auto total = GetTotalSize();
+        while (total > Budget)
+        {
+            // only evict unused ones, in-use meshes won't be freed anyway
+            auto victim = Entries.end();
+            for (auto it = Entries.begin(); it != Entries.end(); ++it)
+            {
+                if (it->second.Mesh && it->second.Mesh.use_count() == 1 && (victim == Entries.end() || it->second.LastUse < victim->second.LastUse))
+                    victim = it;
+            }
+            if (victim == Entries.end())
+                break;
+            if (Logger)
+                Logger->Verbose(u"evict model [{}] from cache\n", victim->first);
+            total -= victim->second.Mesh->GetMemorySize();
+            Entries.erase(victim);
+        }
+    }
+    void FinishLoad(const u16string& fname, const fs::file_time_type modifyTime, const Item& mesh)
+    {
+        std::vector<common::BasicPromise<Item>> waiters;
+        {
+            const auto lock = Lock.LockScope();
+            auto& entry = Entries[fname];
+            waiters = std::move(entry.Waiters);
+            entry = Entry{ mesh, modifyTime, {}, ++UseCounter, false };
+            TrimUnused();
+        }
+        for (const auto& waiter : waiters)
+            waiter.SetData(mesh);
+    }
+    template<typename E>
+    void FailLoad(const u16string& fname, const E& ex)
+    {
+        std::vector<common::BasicPromise<Item>> waiters;
+        {
+            const auto lock = Lock.LockScope();
+            if (const auto it = Entries.find(fname); it != Entries.end())
+            {
+                waiters = std::move(it->second.Waiters);
+                Entries.erase(it);
+            }
+        }
+        for (const auto& waiter : waiters)
+            waiter.SetException(ex);
+    }
+public:
+    // held by the loading task, waiters are failed if the task is dropped without running
+    class LoadTicket
+    {
+    private:
+        ModelCache& Cache;
+        u16string FileName;
+        bool Taken = false;
+    public:
+        LoadTicket(ModelCache& cache, const u16string& fname) : Cache(cache), FileName(fname) { }
+        ~LoadTicket()
+        {
+            if (!Taken)
+                Cache.FailLoad(FileName, CREATE_EXCEPTION(BaseException, u"model loading task is dropped"));
+        }
+        COMMON_NO_COPY(LoadTicket)
+        void Take() noexcept { Taken = true; }
+    };
+    enum class LookupResult : uint8_t { Hit, Waiting, NeedLoad };
+
+    ModelCache(common::mlog::MiniLogger<false>* logger = nullptr) noexcept : Logger(logger) { }
+    // find a valid mesh, or join the loading one, or mark it loading so that caller should load it
+    LookupResult Lookup(const u16string& fname, fs::file_time_type& modifyTime, Item& mesh, common::PromiseResult<Item>& waiter)
+    {
+        modifyTime = GetModifyTime(fname);
+        const auto lock = Lock.LockScope();
+        auto& entry = Entries[fname];
+        if (entry.IsLoading)
+        {
+            common::BasicPromise<Item> pms;
+            waiter = pms.GetPromiseResult();
+            entry.Waiters.push_back(std::move(pms));
+            return LookupResult::Waiting;
+        }
+        if (entry.Mesh && entry.ModifyTime == modifyTime)
+        {
+            entry.LastUse = ++UseCounter;
+            mesh = entry.Mesh;
+            return LookupResult::Hit;
+        }
+        if (entry.Mesh && Logger)
+            Logger->Debug(u"model [{}] is modified, reload it\n", fname);
+        entry.Mesh.reset(); // users still hold the stale one
+        entry.IsLoading = true;
+        return LookupResult::NeedLoad;
+    }
+    // should only be called after Lookup returns NeedLoad, creator builds the mesh
+    template<typename F>
+    Item Load(const u16string& fname, const fs::file_time_type modifyTime, F&& creator)
+    {
+        try
+        {
+            Item mesh = creator();
+            FinishLoad(fname, modifyTime, mesh);
+            return mesh;
+        }
+        catch (const BaseException& be)
+        {
+            FailLoad(fname, be);
+            throw;
+        }
+        catch (...)
+        {
+            FailLoad(fname, std::current_exception());
+            throw;
+        }
+    }
+    void Put(const u16string& fname, const Item& mesh)
+    {
+        const auto modifyTime = GetModifyTime(fname);
+        const auto lock = Lock.LockScope();
+        auto& entry = Entries[fname];
+        if (entry.IsLoading) // let the loading one finish
+            return;
+        entry.Mesh = mesh;
+        entry.ModifyTime = modifyTime;
+        entry.LastUse = ++UseCounter;
+        TrimUnused();
+    }
+    void Trim()
+    {
+        const auto lock = Lock.LockScope();
+        TrimUnused();
+    }
+    void SetBudget(const size_t budget)
+    {
+        const auto lock = Lock.LockScope();
+        Budget = budget;
+        TrimUnused();
+    }
+    [[nodiscard]] bool IsCached(const u16string& fname) const
+    {
+        const auto lock = Lock.LockScope();
+        const auto it = Entries.find(fname);
+        return it != Entries.end() && it->second.Mesh;
+    }
+    [[nodiscard]] size_t GetCachedSize() const
+    {
+        const auto lock = Lock.LockScope();
+        return GetTotalSize();
+    }
+};
+
+
+}
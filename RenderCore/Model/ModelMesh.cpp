@@ -3,6 +3,9 @@
 #include "OBJLoader.hpp"
 #include "MTLLoader.hpp"
 #include "OBJSaver.hpp"
+#include "MeshOptimizer.hpp"
+#include "ModelCache.hpp"
+#include "VertexSoA.hpp"
 #include "OpenGLUtil/oglWorker.h"
 #include "OpenGLUtil/PointEnhance.hpp"
 
@@ -10,89 +13,93 @@ namespace dizz::detail
 {
 using std::vector;
 using common::str::Encoding;
-using common::container::FindInMap;
 using common::asyexe::AsyncAgent;
 using oglu::PointEx;
 using xziar::respak::SerializeUtil;
 using xziar::respak::DeserializeUtil;
 
 
-#if COMMON_COMPILER_GCC
-#   pragma GCC diagnostic push
-#   pragma GCC diagnostic ignored "-Wpedantic"
-#elif COMMON_COMPILER_CLANG
-#   pragma clang diagnostic push
-#   pragma clang diagnostic ignored "-Wnested-anon-types"
-#   pragma clang diagnostic ignored "-Wgnu-anonymous-struct"
-#elif COMMON_COMPILER_MSVC
-#   pragma warning(push)
-#   pragma warning(disable:4201)
-#endif
-union alignas(uint64_t)PTstub
+// reorder within each group, since groups are drawn by index range
+static void OptimizeMesh(vector<PointEx>& pts, vector<uint32_t>& indexs, const vector<std::pair<string, uint32_t>>& groups)
 {
-    uint64_t num;
-    struct
+    const auto acmr = meshopt::CalcACMR(indexs, pts.size(), 32);
+    meshopt::Tipsifier tipsifier(pts.size(), 16);
+    uint32_t last = 0;
+    for (const auto& group : groups)
     {
-        uint32_t numhi, numlow;
-    };
-    struct
-    {
-        uint16_t vid, nid, tid, tposid;
-    };
-    PTstub(int32_t vid_, int32_t nid_, int32_t tid_)
-        :vid((uint16_t)vid_), nid((uint16_t)nid_), tid((uint16_t)tid_), tposid(0)
-    { }
-    bool operator== (const PTstub& other) const
-    {
-        return num == other.num;
+        tipsifier.Optimize(common::span<uint32_t>(indexs.data() + last, group.second - last));
+        last = group.second;
     }
-    bool operator< (const PTstub& other) const
+    tipsifier.Optimize(common::span<uint32_t>(indexs.data() + last, indexs.size() - last));
+    meshopt::OptimizeVertexFetch(pts, indexs);
+    dizzLog().Debug(u"vertex-cache ACMR {:.3f} -> {:.3f}\n", acmr, meshopt::CalcACMR(indexs, pts.size(), 32));
+}
+
+using MeshCache = ModelCache<_ModelMesh>;
+static MeshCache MODEL_CACHE(&dizzLog());
+
+ModelMesh _ModelMesh::GetModel(DeserializeUtil& context, const string& id)
+{
+    ModelMesh m = context.DeserializeShare<_ModelMesh>(id);
+    MODEL_CACHE.Put(m->mfname, m);
+    return m;
+}
+
+ModelMesh _ModelMesh::LoadModel(const u16string& fname, const fs::file_time_type modifyTime, const std::shared_ptr<TextureLoader>& texLoader, const std::shared_ptr<oglu::oglWorker>& asyncer)
+{
+    return MODEL_CACHE.Load(fname, modifyTime, [&]() { return ModelMesh(new _ModelMesh(fname, texLoader, asyncer)); });
+}
+
+ModelMesh _ModelMesh::GetModel(const u16string& fname, const std::shared_ptr<TextureLoader>& texLoader, const std::shared_ptr<oglu::oglWorker>& asyncer)
+{
+    fs::file_time_type modifyTime;
+    ModelMesh mesh;
+    common::PromiseResult<ModelMesh> waiter;
+    switch (MODEL_CACHE.Lookup(fname, modifyTime, mesh, waiter))
     {
-        return num < other.num;
+    case MeshCache::LookupResult::Hit:      return mesh;
+    case MeshCache::LookupResult::Waiting:  return AsyncAgent::SafeWait(waiter);
+    default:                                return LoadModel(fname, modifyTime, texLoader, asyncer);
     }
-};
-#if COMMON_COMPILER_GCC
-#   pragma GCC diagnostic pop
-#elif COMMON_COMPILER_CLANG
-#   pragma clang diagnostic pop
-#elif COMMON_COMPILER_MSVC
-#   pragma warning(pop)
-#endif
+}
 
-struct PTstubHasher
+common::PromiseResult<ModelMesh> _ModelMesh::GetModelAsync(const u16string& fname, const std::shared_ptr<TextureLoader>& texLoader,
+    const std::shared_ptr<oglu::oglWorker>& asyncer, common::asyexe::AsyncManager& loader)
 {
-    size_t operator()(const PTstub& p) const
+    fs::file_time_type modifyTime;
+    ModelMesh mesh;
+    common::PromiseResult<ModelMesh> waiter;
+    switch (MODEL_CACHE.Lookup(fname, modifyTime, mesh, waiter))
     {
-        return p.numhi * 33 + p.numlow;
+    case MeshCache::LookupResult::Hit:      return common::FinishedResult<ModelMesh>::Get(std::move(mesh));
+    case MeshCache::LookupResult::Waiting:  return waiter;
+    default:
+    {
+        // also covers AddTask throwing, since the lambda is destroyed then
+        auto ticket = std::make_shared<MeshCache::LoadTicket>(MODEL_CACHE, fname);
+        return loader.AddTask([=, ticket = std::move(ticket)](const AsyncAgent&)
+        {
+            ticket->Take();
+            return LoadModel(fname, modifyTime, texLoader, asyncer);
+        }, fs::path(fname).filename().u16string(), common::asyexe::StackSize::Big);
     }
-};
-
-static std::map<u16string, ModelMesh> MODEL_CACHE;
+    }
+}
 
-ModelMesh _ModelMesh::GetModel(DeserializeUtil& context, const string& id)
+void _ModelMesh::ReleaseModel(const u16string&)
 {
-    ModelMesh m = context.DeserializeShare<_ModelMesh>(id);
-    MODEL_CACHE.insert_or_assign(m->mfname, m);
-    return m;
+    MODEL_CACHE.Trim();
 }
 
-ModelMesh _ModelMesh::GetModel(const u16string& fname, const std::shared_ptr<TextureLoader>& texLoader, const std::shared_ptr<oglu::oglWorker>& asyncer)
+void _ModelMesh::SetCacheBudget(const size_t bytes)
 {
-    if (auto md = FindInMap(MODEL_CACHE, fname))
-        return *md;
-    ModelMesh m(new _ModelMesh(fname, texLoader, asyncer));
-    MODEL_CACHE.insert_or_assign(fname, m);
-    return m;
+    MODEL_CACHE.SetBudget(bytes);
 }
 
-#pragma warning(disable:4996)
-void _ModelMesh::ReleaseModel(const u16string& fname)
+size_t _ModelMesh::GetMemorySize() const noexcept
 {
-    if (auto md = FindInMap(MODEL_CACHE, fname))
-        if (md->use_count() == 1)
-            MODEL_CACHE.erase(fname);
+    return pts.size() * sizeof(PointEx) + indexs.size() * sizeof(uint32_t);
 }
-#pragma warning(default:4996)
 
 void _ModelMesh::PrepareVAO(oglu::oglVAO_::VAOPrep& vaoPrep) const
 {
@@ -116,116 +123,44 @@ void _ModelMesh::PrepareVAO(oglu::oglVAO_::VAOPrep& vaoPrep) const
 
 void _ModelMesh::loadOBJ(const fs::path& objpath, const std::shared_ptr<TextureLoader>& texLoader) try
 {
-    using mbase::IVec4;
     OBJLoder ldr(objpath);
     MTLLoader mtlLoader(texLoader);
-    vector<mbase::Vec3> points{ mbase::Vec3(0.f,0.f,0.f) };
-    vector<mbase::Normal> normals{ mbase::Normal(0.f,0.f,0.f) };
-    vector<mbase::Vec2> texcs{ mbase::Vec2(0.f,0.f) };
-    std::unordered_map<PTstub, uint32_t, PTstubHasher> idxmap;
-    idxmap.reserve(32768);
-    pts.clear();
-    indexs.clear();
-    groups.clear();
-    mbase::Vec3 maxv(-10e6f, -10e6f, -10e6f), minv(10e6f, 10e6f, 10e6f);
-    OBJLoder::TextLine line;
     common::SimpleTimer tstTimer;
-    while ((line = ldr.ReadLine()))
-    {
-        switch (line.Type)
-        {
-        case "EMPTY"_hash:
-            break;
-        case "#"_hash:
-            dizzLog().Verbose(u"--obj-note [{}]\n", line.ToUString());
-            break;
-        case "v"_hash://vertex
-            {
-                auto tmp = line.ParamsToFloat3(1);
-                //Vec3 tmp(atof(line.Params[1].data()), atof(line.Params[2].data()), atof(line.Params[3].data()));
-                maxv = Max(maxv, tmp);
-                minv = Min(minv, tmp);
-                points.push_back(tmp);
-            }break;
-        case "vn"_hash://normal
-            {
-                mbase::Vec3 tmp = line.ParamsToFloat3(1);
-                //Vec3 tmp(atof(line.Params[1].data()), atof(line.Params[2].data()), atof(line.Params[3].data()));
-                normals.push_back(tmp);
-            }break;
-        case "vt"_hash://texcoord
-            {
-                auto tmpc = line.ParamsToFloat2(1);
-                //Coord2D tmpc(atof(line.Params[1].data()), atof(line.Params[2].data()));
-                float intpart;
-                tmpc.X = std::abs(std::modf(tmpc.X, &intpart));
-                tmpc.Y = std::abs(std::modf(tmpc.Y, &intpart));
-                // tmpc.regulized_mirror();
-                texcs.push_back(tmpc);
-            }break;
-        case "f"_hash://face
-            {
-                mbase::IVec4 tmpidx;
-                const auto lim = common::min((size_t)4, line.Params.size() - 1);
-                if (lim < 3)
-                {
-                    dizzLog().Warning(u"too few params for face, ignored : {}\n", line.Line);
-                    break;
-                }
-                for (uint32_t a = 0; a < lim; ++a)
-                {
-                    int32_t tmpi[3] = { 0 };
-                    line.ParseInts(static_cast<uint8_t>(a + 1), tmpi);//vert,texc,norm
-                    PTstub stub(tmpi[0], tmpi[2], tmpi[1]);
-                    auto[it, isAdd] = idxmap.try_emplace(stub, static_cast<uint32_t>(pts.size()));
-                    if (isAdd)
-                        pts.push_back(PointEx(points[stub.vid], normals[stub.nid],
-                            texcs[stub.tid]));
-                    tmpidx[a] = it->second;
-                }
-                if (lim == 3)
-                {
-                    if (tmpidx.X == tmpidx.Y || tmpidx.Y == tmpidx.Z || tmpidx.X == tmpidx.Z)
-                    {
-                        dizzLog().Warning(u"repeat index for face, ignored : {}\n", line.Line);
-                        break;
-                    }
-                    indexs.push_back(tmpidx.X);
-                    indexs.push_back(tmpidx.Y);
-                    indexs.push_back(tmpidx.Z);
-                }
-                else//4 vertex-> 3 vertex
-                {
-                    indexs.push_back(tmpidx.X);
-                    indexs.push_back(tmpidx.Y);
-                    indexs.push_back(tmpidx.Z);
-                    indexs.push_back(tmpidx.X);
-                    indexs.push_back(tmpidx.Z);
-                    indexs.push_back(tmpidx.W);
-                }
-            }break;
-        case "usemtl"_hash://each mtl is a group
-            {
-                string mtlName(line.Rest(1));
-                groups.push_back({ mtlName,(uint32_t)indexs.size() });
-            }break;
-        case "mtllib"_hash://import mtl file
-            mtlLoader.LoadMTL(objpath.parent_path() / string(line.Rest(1)));
-            break;
-        default:
-            break;
-        }
-    }//END of WHILE
     tstTimer.Start();
-    for (uint32_t i = 0, total = (uint32_t)indexs.size(); i < total; i += 3)
+    const auto mesh = ldr.ParseMesh();
+    tstTimer.Stop();
+    dizzLog().Debug(u"obj-parse cost {} us\n", tstTimer.ElapseUs());
+    for (const auto note : mesh.Notes)
+        dizzLog().Verbose(u"--obj-note [{}]\n", common::str::to_u16string(note, ldr.chset));
+    for (const auto face : mesh.BadFaces)
+        dizzLog().Warning(u"too few params or repeat index for face, ignored : {}\n", face);
+    groups.clear();
+    for (const auto& directive : mesh.Directives)
     {
-        oglu::FixInvertNormal(pts[indexs[i]], pts[indexs[i + 1]], pts[indexs[i + 2]]);
-        oglu::GenerateTanPoint(pts[indexs[i]], pts[indexs[i + 1]], pts[indexs[i + 2]]);
+        if (directive.Type == OBJMesh::LineType::UseMtl)//each mtl is a group
+            groups.push_back({ string(directive.Param), static_cast<uint32_t>(directive.Offset) });
+        else//import mtl file
+            mtlLoader.LoadMTL(objpath.parent_path() / string(directive.Param));
     }
+    tstTimer.Start();
+    VertexSoA verts;
+    BuildVertices(mesh, verts, indexs);
+    tstTimer.Stop();
+    dizzLog().Debug(u"vertex-dedup cost {} us\n", tstTimer.ElapseUs());
+    tstTimer.Start();
+    verts.FixInvertNormals(indexs);
+    verts.GenerateTangents(indexs);
     tstTimer.Stop();
     dizzLog().Debug(u"tangent-generate cost {} us\n", tstTimer.ElapseUs());
-    size = maxv - minv;
-    dizzLog().Success(u"read {} vertex, {} normal, {} texcoord\n", points.size(), normals.size(), texcs.size());
+    const auto [minV, maxV] = verts.CalcBounds();
+    size = maxV - minV;
+    center = (minV + maxV) * 0.5f;
+    verts.ToInterleaved(pts);
+    tstTimer.Start();
+    OptimizeMesh(pts, indexs, groups);
+    tstTimer.Stop();
+    dizzLog().Debug(u"mesh-optimize cost {} us\n", tstTimer.ElapseUs());
+    dizzLog().Success(u"read {} vertex, {} normal, {} texcoord\n", mesh.Points.size(), mesh.Normals.size(), mesh.Texcs.size());
     dizzLog().Success(u"OBJ:\t{} points, {} indexs, {} triangles\n", pts.size(), indexs.size(), indexs.size() / 3);
     dizzLog().Info(u"OBJ size:\t [{:.5},{:.5},{:.5}]\n", size.X, size.Y, size.Z);
     MaterialMap = mtlLoader.GetMaterialMap();
@@ -288,6 +223,7 @@ void _ModelMesh::Serialize(SerializeUtil & context, xziar::ejson::JObject& jself
     jself.Add("size", ToJArray(context, size));
     jself.Add("pts", context.PutResource(pts.data(), pts.size() * sizeof(oglu::PointEx)));
     jself.Add("indexs", context.PutResource(indexs.data(), indexs.size() * sizeof(uint32_t)));
+    jself.Add("optimized", true);
     auto groupArray = context.NewArray();
     for (const auto&[name, count] : groups)
     {
@@ -309,6 +245,11 @@ void _ModelMesh::Deserialize(DeserializeUtil& context, const xziar::ejson::JObje
         const auto ptsData = context.GetResource(object.Get<string>("pts"));
         pts.resize(ptsData.GetSize() / sizeof(oglu::PointEx));
         memcpy_s(pts.data(), pts.size() * sizeof(oglu::PointEx), ptsData.GetRawPtr(), ptsData.GetSize());
+        // center is not packed, restore it from points
+        auto minV = pts.empty() ? mbase::Vec3::Zeros() : pts[0].pos, maxV = minV;
+        for (const auto& pt : pts)
+            minV = Min(minV, pt.pos), maxV = Max(maxV, pt.pos);
+        center = (minV + maxV) * 0.5f;
     }
     {
         const auto idxData = context.GetResource(object.Get<string>("indexs"));
@@ -319,6 +260,8 @@ void _ModelMesh::Deserialize(DeserializeUtil& context, const xziar::ejson::JObje
         .Cast<xziar::ejson::JObjectRef<true>>()
         .Select([](const xziar::ejson::JObjectRef<true>& obj) { return std::pair{ obj.Get<string>("Name"), obj.Get<uint32_t>("Offset") }; })
         .ToVector();
+    if (!object.Get<bool>("optimized", false)) // packed before mesh optimization, do it once here
+        OptimizeMesh(pts, indexs, groups);
     MaterialMap.clear();
     common::linq::FromContainer(object.GetObject("materials"))
         .IntoMap(MaterialMap, 
@@ -3,6 +3,7 @@
 #include "../RenderCoreRely.h"
 #include "../Material.h"
 #include "OpenGLUtil/PointEnhance.hpp"
+#include "SystemCommon/AsyncAgent.h"
 
 namespace dizz
 {
@@ -16,11 +17,16 @@ class alignas(mbase::Vec3)_ModelMesh : public common::NonCopyable, public xziar:
 {
     friend class ::dizz::Model;
 private:
+    static std::shared_ptr<_ModelMesh> LoadModel(const u16string& fname, const fs::file_time_type modifyTime, const std::shared_ptr<TextureLoader>& texLoader, const std::shared_ptr<oglu::oglWorker>& asyncer);
     static std::shared_ptr<_ModelMesh> GetModel(xziar::respak::DeserializeUtil& context, const string& id);
     static std::shared_ptr<_ModelMesh> GetModel(const u16string& fname, const std::shared_ptr<TextureLoader>& texLoader, const std::shared_ptr<oglu::oglWorker>& asyncer = {});
+    static common::PromiseResult<std::shared_ptr<_ModelMesh>> GetModelAsync(const u16string& fname, const std::shared_ptr<TextureLoader>& texLoader,
+        const std::shared_ptr<oglu::oglWorker>& asyncer, common::asyexe::AsyncManager& loader);
     static void ReleaseModel(const u16string& fname);
 public:
-    mbase::Vec3 size;
+    // budget of cached meshes' memory, only unused meshes are evicted
+    static void SetCacheBudget(const size_t bytes);
+    mbase::Vec3 size, center;
 private:
     std::vector<oglu::PointEx> pts;
     std::vector<uint32_t> indexs;
@@ -36,6 +42,7 @@ private:
     _ModelMesh(const u16string& fname, const std::shared_ptr<TextureLoader>& texLoader, const std::shared_ptr<oglu::oglWorker>& asyncer = {});
 public:
     void PrepareVAO(oglu::oglVAO_::VAOPrep& vaoPrep) const;
+    [[nodiscard]] size_t GetMemorySize() const noexcept;
 
     RESPAK_DECL_COMP_DESERIALIZE("dizz#ModelMesh")
     virtual void Serialize(xziar::respak::SerializeUtil& context, xziar::ejson::JObject& object) const override;
@@ -1,12 +1,62 @@
 #pragma once
 #include "RenderCoreRely.h"
+#include "VertexSoA.hpp"
 #include "SystemCommon/StringDetect.h"
 #include "SystemCommon/CharConvs.h"
+#include "SystemCommon/ThreadEx.h"
+#include <algorithm>
+#include <unordered_map>
 
 namespace dizz::detail
 {
 
 
+// run func(0..count-1) on the shared worker pool, returns after all finished
+template<typename F>
+inline void ParallelInvoke(const uint32_t count, F&& func)
+{
+    common::WorkerPool::ParallelRun(count, func);
+}
+// at least one thread, each thread handles at least grain workload
+inline uint32_t GetParallelCount(const size_t workload, const size_t grain)
+{
+    const size_t maxCount = common::WorkerPool::GetMaxThreadCount();
+    return static_cast<uint32_t>(std::min(maxCount, workload / grain + 1));
+}
+
+
+// geometry of an obj file
+struct OBJMesh
+{
+    enum class LineType : uint8_t { Other, Vertex, Normal, Texc, Face, UseMtl, MtlLib, Comment };
+    struct Corner
+    {
+        // index into arrays, 0 is the default element
+        uint32_t Vert, Texc, Norm;
+        constexpr bool operator==(const Corner& other) const noexcept
+        {
+            return Vert == other.Vert && Texc == other.Texc && Norm == other.Norm;
+        }
+    };
+    struct Directive
+    {
+        LineType Type;
+        std::string_view Param;
+        // count of corners before it
+        size_t Offset;
+    };
+    std::vector<mbase::Vec3> Points;
+    std::vector<mbase::Normal> Normals;
+    std::vector<mbase::Vec2> Texcs;
+    // 3 per triangle, polygon is triangulated as fan
+    std::vector<Corner> Corners;
+    // usemtl & mtllib, in order of file
+    std::vector<Directive> Directives;
+    std::vector<std::string_view> Notes;
+    std::vector<std::string_view> BadFaces;
+};
+
+
 class OBJLoder
 {
 private:
@@ -130,6 +180,14 @@ public:
         dizzLog().Debug(u"obj file[{}]--encoding[{}]\n", FilePath.u16string(), GetEncodingName(chset));
     }
 
+    // parse v/vn/vt/f/usemtl/mtllib in parallel, strings refer to the content
+    OBJMesh ParseMesh(uint32_t threadCount = 0) const
+    {
+        return ParseText({ reinterpret_cast<const char*>(Content.data()), Content.size() }, threadCount);
+    }
+    // text is split into threadCount chunks on line boundaries, 0 means decided by size
+    static OBJMesh ParseText(std::string_view text, uint32_t threadCount = 0);
+
     TextLine ReadLine()
     {
         using std::string_view;
@@ -173,4 +231,311 @@ public:
 };
 
 
+namespace objparse
+{
+using LineType = OBJMesh::LineType;
+
+forceinline constexpr bool IsSeparator(const char ch) noexcept
+{
+    return static_cast<uint8_t>(ch) < uint8_t(0x21) || static_cast<uint8_t>(ch) == uint8_t(0x7f);//non-graph character
+}
+forceinline constexpr bool IsLineEnd(const char ch) noexcept
+{
+    return ch == '\r' || ch == '\n';
+}
+// split next token without allocation
+forceinline std::string_view NextToken(const char*& cur, const char* end) noexcept
+{
+    while (cur < end && IsSeparator(*cur))
+        ++cur;
+    const auto begin = cur;
+    while (cur < end && !IsSeparator(*cur))
+        ++cur;
+    return { begin, static_cast<size_t>(cur - begin) };
+}
+inline std::string_view RestOfLine(const char* cur, const char* end) noexcept
+{
+    while (cur < end && IsSeparator(*cur))
+        ++cur;
+    while (end > cur && IsSeparator(end[-1]))
+        --end;
+    return { cur, static_cast<size_t>(end - cur) };
+}
+inline LineType GetLineType(const std::string_view token) noexcept
+{
+    if (token.empty())
+        return LineType::Other;
+    if (token[0] == '#')
+        return LineType::Comment;
+    if (token == "v")       return LineType::Vertex;
+    if (token == "vn")      return LineType::Normal;
+    if (token == "vt")      return LineType::Texc;
+    if (token == "f")       return LineType::Face;
+    if (token == "usemtl")  return LineType::UseMtl;
+    if (token == "mtllib")  return LineType::MtlLib;
+    return LineType::Other;
+}
+template<typename F>
+inline void ForEachLine(const char* cur, const char* end, F&& func)
+{
+    while (cur < end)
+    {
+        const auto lineBegin = cur;
+        while (cur < end && !IsLineEnd(*cur))
+            ++cur;
+        if (cur > lineBegin)
+            func(lineBegin, cur);
+        ++cur;
+    }
+}
+template<size_t N, typename T>
+forceinline void ParseFloats(const char* cur, const char* end, T& output) noexcept
+{
+    for (uint8_t i = 0; i < N; ++i)
+    {
+        const auto token = NextToken(cur, end);
+        if (token.empty())
+            break;
+        common::StrToFP(token, output[i]);
+    }
+}
+// count is the amount of elements before this line, total is amount of all elements
+forceinline uint32_t ResolveIndex(const std::string_view str, const uint32_t count, const uint32_t total) noexcept
+{
+    int64_t idx = 0;
+    if (str.empty())
+        return 0;
+    common::StrToInt(str, idx);
+    if (idx < 0) // relative index
+        idx += static_cast<int64_t>(count) + 1;
+    return (idx > 0 && idx <= static_cast<int64_t>(total)) ? static_cast<uint32_t>(idx) : 0u;
+}
+
+struct Chunk
+{
+    const char* Begin;
+    const char* End;
+    uint32_t Counts[3] = { 0, 0, 0 };
+    std::vector<OBJMesh::Corner> Corners;
+    std::vector<OBJMesh::Directive> Directives;
+    std::vector<std::string_view> Notes;
+    std::vector<std::string_view> BadFaces;
+    void Count() noexcept
+    {
+        ForEachLine(Begin, End, [&](const char* cur, const char* end)
+        {
+            switch (GetLineType(NextToken(cur, end)))
+            {
+            case LineType::Vertex:  Counts[0]++; break;
+            case LineType::Texc:    Counts[1]++; break;
+            case LineType::Normal:  Counts[2]++; break;
+            default:                break;
+            }
+        });
+    }
+    // bases are amount of elements before this chunk
+    void Parse(OBJMesh& mesh, const uint32_t(&bases)[3], const uint32_t(&totals)[3])
+    {
+        uint32_t counts[3] = { bases[0], bases[1], bases[2] };
+        std::vector<OBJMesh::Corner> face;
+        ForEachLine(Begin, End, [&](const char* cur, const char* end)
+        {
+            const auto lineBegin = cur;
+            switch (GetLineType(NextToken(cur, end)))
+            {
+            case LineType::Vertex:
+            {
+                mbase::Vec3 tmp;
+                ParseFloats<3>(cur, end, tmp);
+                mesh.Points[++counts[0]] = tmp;
+            } break;
+            case LineType::Texc:
+            {
+                mbase::Vec2 tmp;
+                ParseFloats<2>(cur, end, tmp);
+                float intpart;
+                tmp.X = std::abs(std::modf(tmp.X, &intpart));
+                tmp.Y = std::abs(std::modf(tmp.Y, &intpart));
+                mesh.Texcs[++counts[1]] = tmp;
+            } break;
+            case LineType::Normal:
+            {
+                mbase::Vec3 tmp;
+                ParseFloats<3>(cur, end, tmp);
+                mesh.Normals[++counts[2]] = tmp;
+            } break;
+            case LineType::Face:
+            {
+                face.clear();
+                for (auto token = NextToken(cur, end); !token.empty(); token = NextToken(cur, end))
+                {
+                    std::string_view parts[3];
+                    for (uint8_t i = 0; i < 3; ++i)
+                    {
+                        const auto pos = token.find('/');
+                        parts[i] = token.substr(0, pos);
+                        if (pos == std::string_view::npos)
+                            break;
+                        token.remove_prefix(pos + 1);
+                    }
+                    face.push_back({ ResolveIndex(parts[0], counts[0], totals[0]),
+                        ResolveIndex(parts[1], counts[1], totals[1]), ResolveIndex(parts[2], counts[2], totals[2]) });
+                }
+                if (face.size() < 3)
+                {
+                    BadFaces.push_back(RestOfLine(lineBegin, end));
+                    break;
+                }
+                for (size_t i = 1; i + 1 < face.size(); ++i)
+                {
+                    const auto &a = face[0], &b = face[i], &c = face[i + 1];
+                    if (a == b || b == c || a == c)
+                    {
+                        BadFaces.push_back(RestOfLine(lineBegin, end));
+                        continue;
+                    }
+                    Corners.push_back(a);
+                    Corners.push_back(b);
+                    Corners.push_back(c);
+                }
+            } break;
+            case LineType::UseMtl:
+                Directives.push_back({ LineType::UseMtl, RestOfLine(cur, end), Corners.size() });
+                break;
+            case LineType::MtlLib:
+                Directives.push_back({ LineType::MtlLib, RestOfLine(cur, end), Corners.size() });
+                break;
+            case LineType::Comment:
+                Notes.push_back(RestOfLine(lineBegin, end));
+                break;
+            default:
+                break;
+            }
+        });
+    }
+};
+}
+
+
+inline OBJMesh OBJLoder::ParseText(std::string_view text, uint32_t threadCount)
+{
+    const auto size = text.size();
+    if (threadCount == 0)
+        threadCount = GetParallelCount(size, 1024 * 1024);
+    // split on line boundaries
+    std::vector<objparse::Chunk> chunks(threadCount);
+    size_t begin = 0;
+    for (uint32_t i = 0; i < threadCount; ++i)
+    {
+        size_t end = i + 1 == threadCount ? size : std::max(begin, size * (i + 1) / threadCount);
+        while (end < size && end > 0 && !objparse::IsLineEnd(text[end - 1]))
+            ++end;
+        chunks[i].Begin = text.data() + begin;
+        chunks[i].End = text.data() + end;
+        begin = end;
+    }
+    // count first, so elements can be placed directly and relative indexes can be resolved
+    ParallelInvoke(threadCount, [&](const uint32_t i) { chunks[i].Count(); });
+    uint32_t totals[3] = { 0, 0, 0 };
+    std::vector<std::array<uint32_t, 3>> bases(threadCount);
+    for (uint32_t i = 0; i < threadCount; ++i)
+    {
+        for (uint8_t j = 0; j < 3; ++j)
+        {
+            bases[i][j] = totals[j];
+            totals[j] += chunks[i].Counts[j];
+        }
+    }
+    OBJMesh mesh;
+    mesh.Points.resize(totals[0] + 1);
+    mesh.Texcs.resize(totals[1] + 1);
+    mesh.Normals.resize(totals[2] + 1, mbase::Normal(0.f, 0.f, 0.f));
+    ParallelInvoke(threadCount, [&](const uint32_t i)
+    {
+        const uint32_t base[3] = { bases[i][0], bases[i][1], bases[i][2] };
+        chunks[i].Parse(mesh, base, totals);
+    });
+    // merge with offsets
+    size_t cornerCount = 0;
+    for (const auto& chunk : chunks)
+        cornerCount += chunk.Corners.size();
+    mesh.Corners.reserve(cornerCount);
+    for (auto& chunk : chunks)
+    {
+        for (auto dir : chunk.Directives)
+        {
+            dir.Offset += mesh.Corners.size();
+            mesh.Directives.push_back(dir);
+        }
+        mesh.Corners.insert(mesh.Corners.end(), chunk.Corners.begin(), chunk.Corners.end());
+        mesh.Notes.insert(mesh.Notes.end(), chunk.Notes.begin(), chunk.Notes.end());
+        mesh.BadFaces.insert(mesh.BadFaces.end(), chunk.BadFaces.begin(), chunk.BadFaces.end());
+        chunk.Corners = {};
+    }
+    return mesh;
+}
+
+
+struct CornerHasher
+{
+    static constexpr uint64_t Hash(const OBJMesh::Corner& c) noexcept
+    {
+        uint64_t hash = c.Vert * 0x9e3779b97f4a7c15u;
+        hash = (hash ^ (hash >> 29)) + c.Texc * 0xbf58476d1ce4e5b9u;
+        hash = (hash ^ (hash >> 31)) + c.Norm * 0x94d049bb133111ebu;
+        return hash ^ (hash >> 32);
+    }
+    size_t operator()(const OBJMesh::Corner& c) const noexcept
+    {
+        return static_cast<size_t>(Hash(c));
+    }
+};
+
+// dedup corners into vertices, vertices are in order of first occurrence, same as serial dedup.
+// threadCount being 0 means decided by corner count
+inline void BuildVertices(const OBJMesh& mesh, VertexSoA& verts, std::vector<uint32_t>& indexs, uint32_t threadCount = 0)
+{
+    const auto& corners = mesh.Corners;
+    const auto total = static_cast<uint32_t>(corners.size());
+    if (threadCount == 0)
+        threadCount = GetParallelCount(total, 65536);
+    // each thread finds first occurrences for a partition of hash
+    std::vector<uint32_t> firstOf(total);
+    ParallelInvoke(threadCount, [&](const uint32_t part)
+    {
+        std::unordered_map<OBJMesh::Corner, uint32_t, CornerHasher> lookup;
+        lookup.reserve(total / threadCount / 2 + 16);
+        for (uint32_t i = 0; i < total; ++i)
+        {
+            // use high bits to partition, so that low bits used by buckets are still spread
+            if ((CornerHasher::Hash(corners[i]) >> 40) % threadCount != part)
+                continue;
+            firstOf[i] = lookup.try_emplace(corners[i], i).first->second;
+        }
+    });
+    std::vector<uint32_t> firsts;
+    indexs.resize(total);
+    for (uint32_t i = 0; i < total; ++i)
+    {
+        if (firstOf[i] == i)
+        {
+            indexs[i] = static_cast<uint32_t>(firsts.size());
+            firsts.push_back(i);
+        }
+        else
+            indexs[i] = indexs[firstOf[i]];
+    }
+    verts.Resize(firsts.size());
+    ParallelInvoke(threadCount, [&](const uint32_t part)
+    {
+        const auto from = firsts.size() * part / threadCount, to = firsts.size() * (part + 1) / threadCount;
+        for (auto i = from; i < to; ++i)
+        {
+            const auto& corner = corners[firsts[i]];
+            verts.Set(i, mesh.Points[corner.Vert], mesh.Normals[corner.Norm], mesh.Texcs[corner.Texc]);
+        }
+    });
+}
+
+
 }
\ No newline at end of file
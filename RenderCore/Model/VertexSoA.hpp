@@ -0,0 +1,163 @@
+#pragma once
+#include "RenderCoreRely.h"
+#include "OpenGLUtil/PointEnhance.hpp"
+#include "common/simd/SIMD128.hpp"
+
+namespace dizz::detail
+{
+
+
+// columnar vertices for CPU-side processing, each attribute component is continuous so kernels only touch what they need.
+// It's converted to interleaved PointEx only for upload
+class VertexSoA
+{
+private:
+    using F32x4 = COMMON_SIMD_NAMESPACE::F32x4;
+    size_t Count = 0;
+    // gather one component of 4 vertices
+    static forceinline F32x4 Gather(const std::vector<float>& col, const uint32_t(&idx)[4]) noexcept
+    {
+        return F32x4(col[idx[0]], col[idx[1]], col[idx[2]], col[idx[3]]);
+    }
+    static forceinline F32x4 Length(const F32x4& x, const F32x4& y, const F32x4& z) noexcept
+    {
+        return x.MulAdd(x, y.MulAdd(y, z * z)).Sqrt();
+    }
+public:
+    std::vector<float> Pos[3], Norm[3], Texc[2], Tan[4];
+
+    [[nodiscard]] size_t Size() const noexcept { return Count; }
+    void Resize(const size_t count)
+    {
+        Count = count;
+        for (auto& col : Pos)
+            col.assign(count, 0.f);
+        for (auto& col : Norm)
+            col.assign(count, 0.f);
+        for (auto& col : Texc)
+            col.assign(count, 0.f);
+        for (auto& col : Tan)
+            col.assign(count, 0.f);
+    }
+    forceinline void Set(const size_t idx, const mbase::Vec3& pos, const mbase::Vec3& norm, const mbase::Vec2& texc) noexcept
+    {
+        Pos[0][idx] = pos.X, Pos[1][idx] = pos.Y, Pos[2][idx] = pos.Z;
+        Norm[0][idx] = norm.X, Norm[1][idx] = norm.Y, Norm[2][idx] = norm.Z;
+        Texc[0][idx] = texc.X, Texc[1][idx] = texc.Y;
+    }
+
+    // min & max of positions
+    [[nodiscard]] std::pair<mbase::Vec3, mbase::Vec3> CalcBounds() const noexcept
+    {
+        if (Count == 0)
+            return { mbase::Vec3::Zeros(), mbase::Vec3::Zeros() };
+        float minV[3], maxV[3];
+        for (uint8_t c = 0; c < 3; ++c)
+        {
+            const auto* ptr = Pos[c].data();
+            F32x4 vmin(ptr[0]), vmax(ptr[0]);
+            size_t i = 0;
+            for (; i + 4 <= Count; i += 4)
+            {
+                const F32x4 dat(ptr + i);
+                vmin = vmin.Min(dat), vmax = vmax.Max(dat);
+            }
+            minV[c] = std::min({ vmin.Val[0], vmin.Val[1], vmin.Val[2], vmin.Val[3] });
+            maxV[c] = std::max({ vmax.Val[0], vmax.Val[1], vmax.Val[2], vmax.Val[3] });
+            for (; i < Count; ++i)
+                minV[c] = std::min(minV[c], ptr[i]), maxV[c] = std::max(maxV[c], ptr[i]);
+        }
+        return { mbase::Vec3(minV[0], minV[1], minV[2]), mbase::Vec3(maxV[0], maxV[1], maxV[2]) };
+    }
+
+    // flip vertex normals facing against the triangle, in triangle order since triangles share vertices
+    void FixInvertNormals(common::span<const uint32_t> indexs) noexcept
+    {
+        for (size_t t = 0; t + 3 <= indexs.size(); t += 3)
+        {
+            const uint32_t v[3] = { indexs[t], indexs[t + 1], indexs[t + 2] };
+            float e1[3], e2[3];
+            for (uint8_t c = 0; c < 3; ++c)
+                e1[c] = Pos[c][v[1]] - Pos[c][v[0]], e2[c] = Pos[c][v[2]] - Pos[c][v[0]];
+            const float fn[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            for (const auto idx : v)
+            {
+                if (fn[0] * Norm[0][idx] + fn[1] * Norm[1][idx] + fn[2] * Norm[2][idx] < 0)
+                    Norm[0][idx] = -Norm[0][idx], Norm[1][idx] = -Norm[1][idx], Norm[2][idx] = -Norm[2][idx];
+            }
+        }
+    }
+
+    // accumulate per-triangle tangent into vertices, same math as oglu::GenerateTanPoint.
+    // 4 triangles are computed at once, accumulation is scalar in triangle order
+    void GenerateTangents(common::span<const uint32_t> indexs) noexcept
+    {
+        const auto triCount = indexs.size() / 3;
+        for (size_t t = 0; t < triCount; t += 4)
+        {
+            const auto lanes = static_cast<uint8_t>(std::min<size_t>(4, triCount - t));
+            uint32_t idx[3][4];
+            for (uint8_t k = 0; k < 3; ++k)
+                for (uint8_t l = 0; l < 4; ++l) // pad with the last triangle
+                    idx[k][l] = indexs[(t + std::min<uint8_t>(l, lanes - 1)) * 3 + k];
+            F32x4 e1[3], e2[3];
+            for (uint8_t c = 0; c < 3; ++c)
+            {
+                const auto p0 = Gather(Pos[c], idx[0]);
+                e1[c] = Gather(Pos[c], idx[1]) - p0, e2[c] = Gather(Pos[c], idx[2]) - p0;
+            }
+            const auto u0 = Gather(Texc[0], idx[0]), v0 = Gather(Texc[1], idx[0]);
+            const auto du1 = Gather(Texc[0], idx[1]) - u0, dv1 = Gather(Texc[1], idx[1]) - v0,
+                du2 = Gather(Texc[0], idx[2]) - u0, dv2 = Gather(Texc[1], idx[2]) - v0;
+            const auto r = F32x4(1.f) / (du1 * dv2 - dv1 * du2);
+            F32x4 tan[3], bitan_[3];
+            for (uint8_t c = 0; c < 3; ++c)
+            {
+                tan[c] = (e1[c] * dv2 - e2[c] * dv1) * r;
+                bitan_[c] = e2[c] * du1 - e1[c] * du2;
+            }
+            {
+                const auto len = Length(tan[0], tan[1], tan[2]);
+                for (auto& tc : tan)
+                    tc = tc / len;
+            }
+            for (uint8_t k = 0; k < 3; ++k)
+            {
+                const F32x4 n[3] = { Gather(Norm[0], idx[k]), Gather(Norm[1], idx[k]), Gather(Norm[2], idx[k]) };
+                // bitan = cross(tangent, norm)
+                const F32x4 bitan[3] = { tan[1] * n[2] - tan[2] * n[1], tan[2] * n[0] - tan[0] * n[2], tan[0] * n[1] - tan[1] * n[0] };
+                const auto dotNT = n[0].MulAdd(tan[0], n[1].MulAdd(tan[1], n[2] * tan[2]));
+                F32x4 newTan[3];
+                for (uint8_t c = 0; c < 3; ++c)
+                    newTan[c] = tan[c] - n[c] * dotNT;
+                const auto len = Length(newTan[0], newTan[1], newTan[2]);
+                for (auto& tc : newTan)
+                    tc = tc / len;
+                const auto handness = bitan_[0].MulAdd(bitan[0], bitan_[1].MulAdd(bitan[1], bitan_[2] * bitan[2])) * r;
+                for (uint8_t l = 0; l < lanes; ++l)
+                {
+                    const auto vid = idx[k][l];
+                    for (uint8_t c = 0; c < 3; ++c)
+                        Tan[c][vid] += newTan[c].Val[l];
+                    Tan[3][vid] += handness.Val[l] > 0 ? 1.0f : -1.0f;
+                }
+            }
+        }
+    }
+
+    void ToInterleaved(std::vector<oglu::PointEx>& pts) const
+    {
+        pts.resize(Count);
+        for (size_t i = 0; i < Count; ++i)
+        {
+            auto& pt = pts[i];
+            pt.pos = mbase::Vec3(Pos[0][i], Pos[1][i], Pos[2][i]);
+            static_cast<mbase::Vec3&>(pt.norm) = mbase::Vec3(Norm[0][i], Norm[1][i], Norm[2][i]); // already normalized
+            pt.tcoord = mbase::Vec2(Texc[0][i], Texc[1][i]);
+            pt.tan = mbase::Vec4(Tan[0][i], Tan[1][i], Tan[2][i], Tan[3][i]);
+        }
+    }
+};
+
+
+}
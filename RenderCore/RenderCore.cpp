@@ -13,7 +13,6 @@
 #include "TextureUtil/TexUtilWorker.h"
 #include "TextureUtil/TexMipmap.h"
 #include <thread>
-#include <future>
 
 
 namespace dizz
@@ -123,6 +122,14 @@ RenderCore::RenderCore(oglu::GLHost& host)
     }
     GLWorker = std::make_shared<oglu::oglWorker>(u"Core");
     GLWorker->Start();
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        auto& loader = *ModelLoaders.emplace_back(std::make_unique<common::asyexe::AsyncManager>(FMTSTR2(u"ModelLoader{}", i)));
+        loader.Start([&loader]
+        {
+            loader.GetThread()->SetName(u"ModelLoader");
+        });
+    }
     TexWorker = std::make_shared<texutil::TexUtilWorker>(GLContext->NewContext(true), CLSharedContext);
     MipMapper = std::make_shared<texutil::TexMipmap>(TexWorker);
     TexLoader = std::make_shared<TextureLoader>(MipMapper);
@@ -154,6 +161,8 @@ RenderCore::RenderCore(oglu::GLHost& host)
 
 RenderCore::~RenderCore()
 {
+    for (auto& loader : ModelLoaders)
+        loader->Stop();
 }
 
 void RenderCore::RefreshContext() const
@@ -234,44 +243,33 @@ vector<std::shared_ptr<common::Controllable>> RenderCore::GetControllables() con
 
 void RenderCore::LoadModelAsync(const u16string & fname, std::function<void(std::shared_ptr<Model>)> onFinish, std::function<void(const BaseException&)> onError) const
 {
-    std::thread([onFinish, onError, this](const u16string name)
+    // callback runs on the thread finishing the load, no extra thread is needed just for waiting
+    LoadModelAsync2(fname)->OnComplete([onFinish, onError, fname](const common::PromiseResult<std::shared_ptr<Model>>& pms)
     {
-        common::ThreadObject::GetCurrentThreadObject().SetName(u"AsyncLoader for Model");
         try
         {
-            auto mod = std::make_shared<Model>(name, TexLoader, GLWorker);
-            mod->Name = u"model";
-            onFinish(mod);
+            onFinish(pms->Get());
         }
         catch (const BaseException& be)
         {
-            dizzLog().Error(u"failed to load model by file {}\n", name);
+            dizzLog().Error(u"failed to load model by file {}\n", fname);
             if (onError)
                 onError(be);
             else
                 onFinish(std::shared_ptr<Model>());
         }
-    }, fname).detach();
+    });
 }
 
 common::PromiseResult<std::shared_ptr<Model>> RenderCore::LoadModelAsync2(const u16string& fname) const
 {
-    auto fut = std::async(std::launch::async, [&](const u16string name)
+    auto& loader = *ModelLoaders[ModelLoaderIdx++ % ModelLoaders.size()];
+    return common::StagedResult::TwoStage(Model::LoadAsync(fname, TexLoader, GLWorker, loader),
+        [](std::shared_ptr<Model> mod)
         {
-            common::ThreadObject::GetCurrentThreadObject().SetName(u"AsyncLoader for Model");
-            try
-            {
-                auto mod = std::make_shared<Model>(name, TexLoader, GLWorker);
-                mod->Name = u"model";
-                return mod;
-            }
-            catch (const BaseException& be)
-            {
-                dizzLog().Error(u"failed to load model by file {}\n", name);
-                throw be;
-            }
-        }, fname);
-    return common::PromiseResultSTD<std::shared_ptr<Model>>::Get(std::move(fut));
+            mod->Name = u"model";
+            return mod;
+        });
 }
 
 void RenderCore::LoadShaderAsync(const u16string & fname, const u16string & shdName, std::function<void(std::shared_ptr<DefaultRenderPass>)> onFinish, std::function<void(const BaseException&)> onError) const
@@ -337,14 +335,6 @@ void RenderCore::Serialize(const fs::path & fpath) const
     RefreshContext();
     SerializeUtil serializer(fpath);
     serializer.IsPretty = true;
-    serializer.AddFilter([](const string_view& serType)
-    {
-        if (serType == detail::_ModelMesh::SERIALIZE_TYPE)
-            return "/meshes";
-        else if (serType == detail::_FakeTex::SERIALIZE_TYPE)
-            return "/textures";
-        return "";
-    });
     {
         auto jprogs = serializer.NewArray();
         for (const auto& pass : RenderPasses)
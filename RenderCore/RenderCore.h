@@ -1,6 +1,7 @@
 #pragma once
 
 #include "RenderCoreRely.h"
+#include "SystemCommon/AsyncAgent.h"
 
 
 namespace dizz
@@ -31,6 +32,8 @@ private:
     std::shared_ptr<ThumbnailManager> ThumbMan;
     std::shared_ptr<PostProcessor> PostProc;
     std::shared_ptr<oglu::oglWorker> GLWorker;
+    std::vector<std::unique_ptr<common::asyexe::AsyncManager>> ModelLoaders;
+    mutable std::atomic<uint32_t> ModelLoaderIdx{ 0 };
     std::set<std::shared_ptr<RenderPass>> RenderPasses;
     std::shared_ptr<Scene> TheScene;
     std::set<std::shared_ptr<RenderPipeLine>> PipeLines;
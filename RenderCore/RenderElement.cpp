@@ -180,6 +180,14 @@ auto Drawable::DefaultBind(const oglu::oglDrawProgram& prog, oglu::oglVAO& vao,
         .SetDrawId());
 }
 
+mbase::Mat4 Drawable::GetModelMatrix() const
+{
+    const auto normMat = math::RotateMatXYZ<msimd::Mat3>(Rotation.As<msimd::Vec3>());
+    const auto modelMat = math::TranslateMat<msimd::Mat4>(Position.As<msimd::Vec3>()) *
+        math::ToHomoCoord<msimd::Mat4>(normMat * math::ScaleMat<msimd::Mat3>(Scale.As<msimd::Vec3>()));
+    return modelMat.As<mbase::Mat4>();
+}
+
 oglu::ProgDraw& Drawable::DrawPosition(Drawcall& drawcall) const
 {
     const auto normMat  = math::RotateMatXYZ<msimd::Mat3>(Rotation.As<msimd::Vec3>());
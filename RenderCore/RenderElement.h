@@ -2,6 +2,7 @@
 
 #include "RenderCoreRely.h"
 #include "Material.h"
+#include "SceneCulling.h"
 
 namespace dizz
 {
@@ -41,6 +42,10 @@ public:
     ///<param name="translator">mapping from common resource name to program's resource name</param>
     virtual void PrepareGL(const oglu::oglDrawProgram& prog, const std::map<string,string>& translator = std::map<string, string>()) = 0;
     virtual void Draw(Drawcall& drawcall) const;
+    ///<summary>Bounds in local space, used for culling</summary>  
+    ///<returns>empty box means unbounded, it's never culled</returns>
+    virtual BoundingBox GetLocalBounds() const { return {}; }
+    mbase::Mat4 GetModelMatrix() const;
 
     u16string GetType() const;
     const boost::uuids::uuid& GetUid() const { return Uid; };
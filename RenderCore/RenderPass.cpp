@@ -97,6 +97,27 @@ void RenderPass::Draw(RenderPassContext & context)
     OnDraw(context);
 }
 
+std::vector<std::shared_ptr<Drawable>> RenderPass::GetDrawList(const RenderPassContext& context, const mbase::Mat4& pvMat) const
+{
+    const auto& scene = context.GetScene();
+    std::vector<const Drawable*> visibles;
+    for (const auto& drw : scene->Cull(pvMat))
+        visibles.push_back(drw.get());
+    std::sort(visibles.begin(), visibles.end());
+    const auto& sceneDrawables = scene->GetDrawables();
+    // keep the pass's own order, drawables not added to the scene have no bounds there and are never culled
+    std::vector<std::shared_ptr<Drawable>> drawables;
+    for (const auto& d : Drawables)
+    {
+        auto drw = d.lock();
+        if (!drw || !drw->ShouldRender)
+            continue;
+        if (std::binary_search(visibles.begin(), visibles.end(), drw.get()) || sceneDrawables.find(drw->GetUid()) == sceneDrawables.end())
+            drawables.push_back(std::move(drw));
+    }
+    return drawables;
+}
+
 void RenderPass::Serialize(SerializeUtil & context, xziar::ejson::JObject& jself) const
 {
     jself.Add("Name", common::str::to_u8string(GetName()));
@@ -152,11 +173,8 @@ void DefaultRenderPass::OnDraw(RenderPassContext& context)
     Program->SetVec("@vecCamPos", cam->Position);
     {
         Drawable::Drawcall drawcall(Program, projMat, viewMat);
-        for (const auto& d : Drawables)
+        for (const auto& drw : GetDrawList(context, drawcall.PVMat))
         {
-            const auto drw = d.lock();
-            if (!drw || !drw->ShouldRender)
-                continue;
             const auto maker = GLContext->DeclareRange(u"Draw-" + drw->Name);
             drw->Draw(drawcall);
             drawcall.Drawer.Restore();
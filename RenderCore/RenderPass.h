@@ -49,6 +49,8 @@ protected:
     virtual void OnPrepare(RenderPassContext&) {}
     // do actual rendering
     virtual void OnDraw(RenderPassContext&) {}
+    // drawables of this pass which may be visible in the frustum, in the pass's own order; ones not in the scene are always kept
+    std::vector<std::shared_ptr<Drawable>> GetDrawList(const RenderPassContext& context, const mbase::Mat4& pvMat) const;
 public:
     virtual u16string GetName() const { return u""; }
     virtual void SetName(const u16string&) { }
@@ -0,0 +1,261 @@
+#include "RenderCorePch.h"
+#include "SceneCulling.h"
+#include "common/simd/SIMD128.hpp"
+#include <algorithm>
+#include <numeric>
+
+
+namespace dizz
+{
+using F32x4 = COMMON_SIMD_NAMESPACE::F32x4;
+using common::simd::CountTralingZero;
+
+
+BoundingBox BoundingBox::Transform(const mbase::Mat4& mat) const noexcept
+{
+    if (IsEmpty())
+        return {};
+    // center is transformed as point, extent is transformed by |M| (Arvo's method)
+    const auto center = Center(), extent = Extent();
+    mbase::Vec3 newCenter, newExtent;
+    for (uint8_t r = 0; r < 3; ++r)
+    {
+        const auto& row = mat[r];
+        newCenter[r] = row.X * center.X + row.Y * center.Y + row.Z * center.Z + row.W;
+        newExtent[r] = std::abs(row.X) * extent.X + std::abs(row.Y) * extent.Y + std::abs(row.Z) * extent.Z;
+    }
+    return { newCenter - newExtent, newCenter + newExtent };
+}
+
+
+namespace detail
+{
+
+Frustum::Frustum(const mbase::Mat4& pvMat) noexcept
+{
+    // left, right, bottom, top, near, far are row3 +/- row[0~2], not normalized since only sign matters.
+    // With 0~1 depth or reversed-z one of z planes is just looser, infinite far plane becomes (0,0,0,+), so it's still conservative
+    for (uint8_t p = 0; p < 8; ++p)
+    {
+        float plane[4] = { 0.f, 0.f, 0.f, 1.f };
+        if (p < 6)
+        {
+            const auto& row = pvMat[p / 2];
+            const float sign = (p & 1) ? -1.f : 1.f;
+            for (uint8_t c = 0; c < 4; ++c)
+                plane[c] = pvMat[3][c] + sign * row[c];
+        }
+        for (uint8_t c = 0; c < 4; ++c)
+            Planes[c][p] = plane[c];
+        for (uint8_t c = 0; c < 3; ++c)
+            Planes[4 + c][p] = std::abs(plane[c]);
+    }
+}
+
+Frustum::Result Frustum::Test(const BoundingBox& box) const noexcept
+{
+    const auto center = box.Center(), extent = box.Extent();
+    const F32x4 cx(center.X), cy(center.Y), cz(center.Z), ex(extent.X), ey(extent.Y), ez(extent.Z);
+    uint32_t outside = 0, partial = 0;
+    for (uint8_t i = 0; i < 8; i += 4)
+    {
+        // signed distance of center and projected radius of box on plane normal
+        const auto dist = F32x4(Planes[0] + i).MulAdd(cx, F32x4(Planes[1] + i).MulAdd(cy, F32x4(Planes[2] + i).MulAdd(cz, F32x4(Planes[3] + i))));
+        const auto rad  = F32x4(Planes[4] + i).MulAdd(ex, F32x4(Planes[5] + i).MulAdd(ey, F32x4(Planes[6] + i) * ez));
+        outside |= (dist + rad).ExtractSignBit();
+        partial |= (dist - rad).ExtractSignBit();
+    }
+    if (outside)
+        return Result::Outside;
+    return partial ? Result::Intersect : Result::Inside;
+}
+
+
+void BVH::Reset(std::vector<BoundingBox> boxes)
+{
+    Boxes = std::move(boxes);
+    NeedRebuild = true;
+}
+
+void BVH::SetBox(const uint32_t idx, const BoundingBox& box)
+{
+    Boxes[idx] = box;
+    if (NeedRebuild)
+        return;
+    const auto leaf = ItemLeaf[idx];
+    if (!NodeDirty[leaf])
+    {
+        NodeDirty[leaf] = true;
+        DirtyNodes.push_back(leaf);
+    }
+}
+
+void BVH::Build(const uint32_t nodeIdx, std::vector<mbase::Vec3>& centers)
+{
+    const auto begin = Nodes[nodeIdx].Begin, count = Nodes[nodeIdx].Count;
+    BoundingBox box, centerBox;
+    for (auto i = begin; i < begin + count; ++i)
+    {
+        const auto item = Items[i];
+        box.Merge(Boxes[item]);
+        centerBox.Merge({ centers[item], centers[item] });
+    }
+    Nodes[nodeIdx].Box = box;
+    if (count <= LeafSize)
+    {
+        for (auto i = begin; i < begin + count; ++i)
+            ItemLeaf[Items[i]] = nodeIdx;
+        return;
+    }
+    // median split along the longest axis of centers
+    const auto size = centerBox.Max - centerBox.Min;
+    const uint8_t axis = size.X >= size.Y ? (size.X >= size.Z ? 0 : 2) : (size.Y >= size.Z ? 1 : 2);
+    const auto mid = begin + count / 2;
+    std::nth_element(Items.begin() + begin, Items.begin() + mid, Items.begin() + begin + count,
+        [&](const uint32_t l, const uint32_t r) { return centers[l][axis] < centers[r][axis]; });
+    const auto left = static_cast<uint32_t>(Nodes.size());
+    Nodes.resize(left + 2);
+    Nodes[nodeIdx].Left = left;
+    Nodes[left].Begin = begin, Nodes[left].Count = mid - begin, Nodes[left].Parent = nodeIdx;
+    Nodes[left + 1].Begin = mid, Nodes[left + 1].Count = begin + count - mid, Nodes[left + 1].Parent = nodeIdx;
+    Build(left, centers);
+    Build(left + 1, centers);
+}
+
+void BVH::Refit()
+{
+    // children always have larger index than parent, so refit in descending order
+    for (size_t i = 0; i < DirtyNodes.size(); ++i)
+    {
+        const auto idx = DirtyNodes[i];
+        if (idx == 0)
+            continue;
+        const auto parent = Nodes[idx].Parent;
+        if (!NodeDirty[parent])
+        {
+            NodeDirty[parent] = true;
+            DirtyNodes.push_back(parent);
+        }
+    }
+    std::sort(DirtyNodes.begin(), DirtyNodes.end(), std::greater<>{});
+    for (const auto idx : DirtyNodes)
+    {
+        auto& node = Nodes[idx];
+        BoundingBox box;
+        if (node.IsLeaf())
+        {
+            for (auto i = node.Begin; i < node.Begin + node.Count; ++i)
+                box.Merge(Boxes[Items[i]]);
+        }
+        else
+        {
+            box = Nodes[node.Left].Box;
+            box.Merge(Nodes[node.Left + 1].Box);
+        }
+        Cost += box.HalfArea() - node.Box.HalfArea();
+        node.Box = box;
+        NodeDirty[idx] = false;
+    }
+    DirtyNodes.clear();
+}
+
+void BVH::Update()
+{
+    if (!NeedRebuild && !DirtyNodes.empty())
+    {
+        Refit();
+        // moved items make nodes overlap more, rebuild once it's much worse than a fresh tree
+        if (Cost > BuiltCost * 2.f)
+            NeedRebuild = true;
+    }
+    if (!NeedRebuild)
+        return;
+    const auto count = static_cast<uint32_t>(Boxes.size());
+    Nodes.clear();
+    DirtyNodes.clear();
+    Items.resize(count);
+    std::iota(Items.begin(), Items.end(), 0u);
+    ItemLeaf.assign(count, 0);
+    if (count > 0)
+    {
+        std::vector<mbase::Vec3> centers;
+        centers.reserve(count);
+        for (const auto& box : Boxes)
+            centers.push_back(box.Center());
+        Nodes.reserve(count / LeafSize * 2 + 1);
+        Nodes.emplace_back();
+        Nodes[0].Count = count;
+        Build(0, centers);
+    }
+    NodeDirty.assign(Nodes.size(), false);
+    Cost = 0.f;
+    for (const auto& node : Nodes)
+        Cost += node.Box.HalfArea();
+    BuiltCost = Cost;
+    NeedRebuild = false;
+}
+
+void BVH::Cull(common::span<const Frustum> frusta, common::span<std::vector<uint32_t>> outs) const
+{
+    Expects(!NeedRebuild && DirtyNodes.empty());
+    Expects(frusta.size() <= MaxFrustum && outs.size() >= frusta.size());
+    if (Nodes.empty() || frusta.empty())
+        return;
+    // each frustum is tracked by one bit, it's dropped when node is outside, and moved to inside mask when node is fully inside
+    struct Entry
+    {
+        uint32_t Node, Partial, Inside;
+    };
+    const auto emitRange = [&](const Node& node, uint32_t mask)
+    {
+        for (; mask; mask &= mask - 1)
+        {
+            auto& out = outs[CountTralingZero(mask)];
+            out.insert(out.end(), Items.begin() + node.Begin, Items.begin() + node.Begin + node.Count);
+        }
+    };
+    std::vector<Entry> stack;
+    stack.reserve(64);
+    stack.push_back({ 0, frusta.size() == 32 ? UINT32_MAX : (1u << frusta.size()) - 1, 0 });
+    while (!stack.empty())
+    {
+        auto [nodeIdx, partial, inside] = stack.back();
+        stack.pop_back();
+        const auto& node = Nodes[nodeIdx];
+        for (auto mask = partial; mask; mask &= mask - 1)
+        {
+            const auto fid = CountTralingZero(mask);
+            const auto ret = frusta[fid].Test(node.Box);
+            if (ret != Frustum::Result::Intersect)
+            {
+                partial &= ~(1u << fid);
+                if (ret == Frustum::Result::Inside)
+                    inside |= 1u << fid;
+            }
+        }
+        if (partial == 0 || node.IsLeaf())
+            emitRange(node, inside);
+        if (partial == 0)
+            continue;
+        if (node.IsLeaf())
+        {
+            for (auto i = node.Begin; i < node.Begin + node.Count; ++i)
+            {
+                const auto item = Items[i];
+                for (auto mask = partial; mask; mask &= mask - 1)
+                {
+                    const auto fid = CountTralingZero(mask);
+                    if (frusta[fid].Test(Boxes[item]) != Frustum::Result::Outside)
+                        outs[fid].push_back(item);
+                }
+            }
+            continue;
+        }
+        stack.push_back({ node.Left + 1, partial, inside });
+        stack.push_back({ node.Left, partial, inside });
+    }
+}
+
+}
+
+}
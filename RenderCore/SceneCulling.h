@@ -0,0 +1,93 @@
+#pragma once
+#include "RenderCoreRely.h"
+#include <limits>
+
+namespace dizz
+{
+
+// axis-aligned bounding box, default constructed one is empty
+struct RENDERCOREAPI BoundingBox
+{
+    mbase::Vec3 Min = mbase::Vec3(std::numeric_limits<float>::max());
+    mbase::Vec3 Max = mbase::Vec3(std::numeric_limits<float>::lowest());
+    BoundingBox() noexcept { }
+    BoundingBox(const mbase::Vec3& min, const mbase::Vec3& max) noexcept : Min(min), Max(max) { }
+
+    [[nodiscard]] bool IsEmpty() const noexcept { return Min.X > Max.X || Min.Y > Max.Y || Min.Z > Max.Z; }
+    [[nodiscard]] mbase::Vec3 Center() const noexcept { return (Min + Max) * 0.5f; }
+    [[nodiscard]] mbase::Vec3 Extent() const noexcept { return (Max - Min) * 0.5f; }
+    // half of surface area, used as SAH cost
+    [[nodiscard]] float HalfArea() const noexcept
+    {
+        if (IsEmpty())
+            return 0.f;
+        const auto d = Max - Min;
+        return d.X * d.Y + d.Y * d.Z + d.Z * d.X;
+    }
+    void Merge(const BoundingBox& other) noexcept
+    {
+        Min.X = std::min(Min.X, other.Min.X), Min.Y = std::min(Min.Y, other.Min.Y), Min.Z = std::min(Min.Z, other.Min.Z);
+        Max.X = std::max(Max.X, other.Max.X), Max.Y = std::max(Max.Y, other.Max.Y), Max.Z = std::max(Max.Z, other.Max.Z);
+    }
+    // bounds of the transformed box, mat should be affine
+    [[nodiscard]] BoundingBox Transform(const mbase::Mat4& mat) const noexcept;
+};
+
+
+namespace detail
+{
+
+// 6 clip planes extracted from projection*view matrix, box test is done on 4 planes at once
+class RENDERCOREAPI Frustum
+{
+private:
+    // nx, ny, nz, d, |nx|, |ny|, |nz| of each plane, padded to 8 planes with ones always passing
+    alignas(16) float Planes[7][8];
+public:
+    enum class Result : uint8_t { Outside, Intersect, Inside };
+    explicit Frustum(const mbase::Mat4& pvMat) noexcept;
+    [[nodiscard]] Result Test(const BoundingBox& box) const noexcept;
+};
+
+
+// BVH over item bounds, items are referenced by index.
+// Transform changes only refit touched nodes, tree is rebuilt when refitting degrades it too much
+class RENDERCOREAPI BVH
+{
+public:
+    struct Node
+    {
+        BoundingBox Box;
+        uint32_t Begin = 0, Count = 0;  // range in item order
+        uint32_t Left = 0;              // children are Left & Left+1, 0 for leaf
+        uint32_t Parent = 0;
+        [[nodiscard]] bool IsLeaf() const noexcept { return Left == 0; }
+    };
+    static constexpr uint32_t LeafSize = 4;
+    static constexpr size_t MaxFrustum = 32;
+private:
+    std::vector<Node> Nodes;
+    std::vector<BoundingBox> Boxes;     // item -> bounds
+    std::vector<uint32_t> Items;        // items in leaf order
+    std::vector<uint32_t> ItemLeaf;     // item -> leaf node
+    std::vector<uint32_t> DirtyNodes;
+    std::vector<bool> NodeDirty;
+    float BuiltCost = 0.f, Cost = 0.f;
+    bool NeedRebuild = true;
+    void Build(const uint32_t nodeIdx, std::vector<mbase::Vec3>& centers);
+    void Refit();
+public:
+    [[nodiscard]] size_t Size() const noexcept { return Boxes.size(); }
+    [[nodiscard]] common::span<const Node> GetNodes() const noexcept { return Nodes; }
+    [[nodiscard]] bool IsRebuildPending() const noexcept { return NeedRebuild; }
+    void Reset(std::vector<BoundingBox> boxes);
+    void SetBox(const uint32_t idx, const BoundingBox& box);
+    // rebuild or refit after changes, should be called before Cull
+    void Update();
+    // items intersecting each frustum are appended to the matching output, all frusta share one traversal
+    void Cull(common::span<const Frustum> frusta, common::span<std::vector<uint32_t>> outs) const;
+};
+
+}
+
+}
@@ -23,14 +23,92 @@ Scene::Scene()
 
 void Scene::PrepareDrawable()
 {
-    if (!SceneChanges.Extract(SceneChange::Object))
-        return;
-    for (const auto& drawable : WaitDrawables)
+    if (SceneChanges.Extract(SceneChange::Object))
+    {
+        for (const auto& drawable : WaitDrawables)
+        {
+            drawable->PrepareMaterial();
+            drawable->AssignMaterial();
+        }
+        WaitDrawables.clear();
+    }
+    PrepareBounds();
+}
+
+static bool IsSameVec(const mbase::Vec3& left, const mbase::Vec3& right) noexcept
+{
+    return left.X == right.X && left.Y == right.Y && left.Z == right.Z;
+}
+
+void Scene::PrepareBounds()
+{
+    if (NeedRebuildBVH)
+    {
+        CullDrawables.clear();
+        CullTransforms.clear();
+        UnboundDrawables.clear();
+        std::vector<BoundingBox> boxes;
+        for (const auto& drw : ValSet(Drawables))
+        {
+            const auto bounds = drw->GetLocalBounds();
+            if (bounds.IsEmpty())
+            {
+                UnboundDrawables.push_back(drw);
+                continue;
+            }
+            CullDrawables.push_back(drw);
+            CullTransforms.push_back({ drw->Position, drw->Rotation, drw->Scale });
+            boxes.push_back(bounds.Transform(drw->GetModelMatrix()));
+        }
+        DrawableBVH.Reset(std::move(boxes));
+        NeedRebuildBVH = false;
+    }
+    else
+    {
+        // transforms are changed directly, so check them every frame and only refit moved ones
+        for (uint32_t i = 0; i < CullDrawables.size(); ++i)
+        {
+            const auto& drw = *CullDrawables[i];
+            auto& trans = CullTransforms[i];
+            if (IsSameVec(trans.Position, drw.Position) && IsSameVec(trans.Rotation, drw.Rotation) && IsSameVec(trans.Scale, drw.Scale))
+                continue;
+            trans = { drw.Position, drw.Rotation, drw.Scale };
+            DrawableBVH.SetBox(i, drw.GetLocalBounds().Transform(drw.GetModelMatrix()));
+        }
+    }
+    DrawableBVH.Update();
+}
+
+std::vector<std::shared_ptr<Drawable>> Scene::Cull(const mbase::Mat4& pvMat) const
+{
+    return std::move(Cull(common::span<const mbase::Mat4>(&pvMat, 1))[0]);
+}
+
+std::vector<std::vector<std::shared_ptr<Drawable>>> Scene::Cull(common::span<const mbase::Mat4> pvMats) const
+{
+    std::vector<std::vector<std::shared_ptr<Drawable>>> ret(pvMats.size());
+    if (DrawableBVH.IsRebuildPending()) // not prepared yet, nothing can be culled
+    {
+        for (auto& list : ret)
+            for (const auto& drw : ValSet(Drawables))
+                list.push_back(drw);
+        return ret;
+    }
+    std::vector<detail::Frustum> frustums;
+    frustums.reserve(pvMats.size());
+    for (const auto& pvMat : pvMats)
+        frustums.emplace_back(pvMat);
+    std::vector<std::vector<uint32_t>> items(pvMats.size());
+    DrawableBVH.Cull(frustums, items);
+    for (size_t i = 0; i < ret.size(); ++i)
     {
-        drawable->PrepareMaterial();
-        drawable->AssignMaterial();
+        auto& list = ret[i];
+        list.reserve(items[i].size() + UnboundDrawables.size());
+        for (const auto idx : items[i])
+            list.push_back(CullDrawables[idx]);
+        list.insert(list.end(), UnboundDrawables.begin(), UnboundDrawables.end());
     }
-    WaitDrawables.clear();
+    return ret;
 }
 
 void Scene::PrepareLight()
@@ -61,6 +139,7 @@ bool Scene::AddObject(const std::shared_ptr<Drawable>& drawable)
         return false;
     WaitDrawables.insert(drawable);
     SceneChanges.Add(SceneChange::Object);
+    NeedRebuildBVH = true;
     dizzLog().Success(u"Add an Drawable [{}][{}]:  {}\n", Drawables.size() - 1, drawable->GetType(), drawable->Name);
     return true;
 }
@@ -80,6 +159,7 @@ bool Scene::DelObject(const boost::uuids::uuid& uid)
         return false;
     WaitDrawables.erase(it->second);
     Drawables.erase(it);
+    NeedRebuildBVH = true;
     return true;
 }
 
@@ -134,6 +214,7 @@ void Scene::Deserialize(DeserializeUtil& context, const xziar::ejson::JObjectRef
             if (Drawables.try_emplace(drw->GetUid(), drw).second)
                 WaitDrawables.insert(drw);
         }
+        NeedRebuildBVH = true;
         ReportChanged(SceneChange::Object);
     }
     MainCam = context.DeserializeShare<Camera>(object.GetObject("Camera"));
@@ -28,6 +28,17 @@ private:
     oglu::oglUBO LightUBO;
     uint32_t LightOnCount;
     common::AtomicBitfield<SceneChange> SceneChanges = SceneChange::Light;
+    // culling data, drawables with bounds are items of the BVH, others are always drawn
+    struct CullTransform
+    {
+        mbase::Vec3 Position, Rotation, Scale;
+    };
+    detail::BVH DrawableBVH;
+    std::vector<std::shared_ptr<Drawable>> CullDrawables;
+    std::vector<CullTransform> CullTransforms;
+    std::vector<std::shared_ptr<Drawable>> UnboundDrawables;
+    bool NeedRebuildBVH = true;
+    void PrepareBounds();
 public:
     Scene();
     RESPAK_DECL_SIMP_DESERIALIZE("dizz#Scene")
@@ -42,6 +53,12 @@ public:
 
     void PrepareLight();
     void PrepareDrawable();
+    ///<summary>Drawables that may be visible, unbounded drawables are always included</summary>  
+    ///<param name="pvMat">projection * view matrix</param>
+    std::vector<std::shared_ptr<Drawable>> Cull(const mbase::Mat4& pvMat) const;
+    ///<summary>Cull for multiple frustums (e.g. shadow cascades) in one BVH traversal</summary>  
+    ///<param name="pvMats">projection * view matrix of each frustum, no more than 32</param>
+    std::vector<std::vector<std::shared_ptr<Drawable>>> Cull(common::span<const mbase::Mat4> pvMats) const;
 
     bool AddObject(const std::shared_ptr<Drawable>& drawable);
     bool AddLight(const std::shared_ptr<Light>& light);
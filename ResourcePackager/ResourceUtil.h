@@ -29,6 +29,17 @@ public:
         common::span<const std::byte> dat(reinterpret_cast<const std::byte*>(data), size);
         return common::DigestFunc.SHA256(dat);
     }
+    // non-cryptographic 128bit, only used to find duplicated data
+    template<typename T>
+    forceinline static std::array<uint64_t, 2> FastHash(const T& data)
+    {
+        return common::DigestFunc.XXH3_128(common::to_span(data));
+    }
+    forceinline static std::array<uint64_t, 2> FastHash(const void* data, const size_t size)
+    {
+        common::span<const std::byte> dat(reinterpret_cast<const std::byte*>(data), size);
+        return common::DigestFunc.XXH3_128(dat);
+    }
 };
 
 }
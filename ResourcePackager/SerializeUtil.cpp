@@ -3,13 +3,22 @@
 #include "ResourceUtil.h"
 #include "SystemCommon/MiniLogger.h"
 #include "SystemCommon/FileEx.h"
+#include "SystemCommon/FileMapperEx.h"
 #include "SystemCommon/StackTrace.h"
 #include "SystemCommon/Exceptions.h"
 #include "SystemCommon/MiscIntrins.h"
+#include "SystemCommon/ThreadEx.h"
 #include "common/Linq2.hpp"
+#include "zlib-ng/zlib.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <future>
+#include <limits>
 
 // ResFile Structure
 // |------------|
+// |  padding   |
 // |ResourceItem|
 // | resource 1 |
 // |------------|
@@ -21,6 +30,9 @@
 // |  res list  |
 // |ResourceItem|
 // |------------|
+// padding makes resource data aligned (see GetResourceAlign), so that it can be directly used from mapping.
+// Offset in ResourceItem points to the ResourceItem, older files without padding are still readable.
+// Compressed resource stores codec and stored size in Dummy, Size and SHA256 are always of the raw data.
 
 
 
@@ -34,14 +46,30 @@ using common::BaseException;
 using common::fs::path;
 using common::file::OpenFlag;
 using common::file::FileObject;
-using common::file::FileInputStream;
 using common::file::FileOutputStream;
+using common::file::RawFileObject;
+using common::file::FileMappingObject;
+using common::file::MappingFlag;
 using common::container::FindInMap;
 
 common::mlog::MiniLogger<false>& rpakLog();
 
 static constexpr std::string_view TypeFieldName = "#Type";
+// shared objects are streamed as the first member of root, so the rest can be parsed without them
+static constexpr std::string_view SharedFieldName = "#shared";
+static constexpr std::string_view SharedPath = "/#shared";
 static constexpr size_t RESITEM_SIZE = sizeof(detail::ResourceItem);
+static constexpr size_t RES_PAGE_ALIGN = 4096;
+// resources smaller than this are never compressed
+static constexpr size_t RES_MIN_COMPRESS = 512;
+// max bytes of resources waiting to be written before PutResource blocks
+static constexpr size_t RES_MAX_PENDING = 256 * 1024 * 1024;
+
+// large resource starts at page boundary, small one only needs cacheline alignment to avoid wasting space
+static constexpr size_t GetResourceAlign(const size_t size) noexcept
+{
+    return size >= RES_PAGE_ALIGN ? RES_PAGE_ALIGN : RESITEM_SIZE;
+}
 
 
 namespace detail
@@ -68,6 +96,28 @@ uint32_t ResourceItem::GetIndex() const
 {
     return FromLEByteArray<uint32_t>(Index);
 }
+ResourceCodec ResourceItem::GetCodec() const
+{
+    return static_cast<ResourceCodec>(Dummy[0]);
+}
+uint64_t ResourceItem::GetStoredSize() const
+{
+    if (GetCodec() == ResourceCodec::None)
+        return GetSize();
+    bytearray<8> storedSize;
+    std::copy_n(Dummy.data() + 4, 8, storedSize.data());
+    return FromLEByteArray<uint64_t>(storedSize);
+}
+void ResourceItem::SetStorage(const ResourceCodec codec, const uint64_t storedSize)
+{
+    Dummy = { std::byte(0) };
+    Dummy[0] = static_cast<byte>(codec);
+    if (codec != ResourceCodec::None)
+    {
+        const auto storedSizeLE = ToLEByteArray(storedSize);
+        std::copy_n(storedSizeLE.data(), 8, Dummy.data() + 4);
+    }
+}
 bool ResourceItem::CheckSHA(const bytearray<32>& sha256) const
 {
     for (uint32_t i = 0; i < 32; ++i)
@@ -88,14 +138,67 @@ bool ResourceItem::operator!=(const ResourceItem& other) const
 
 }
 
-SerializeUtil::SerializeUtil(const path& fileName)
+
+struct EncodedResource
+{
+    std::vector<byte> Data;
+    ResourceCodec Codec;
+};
+
+static EncodedResource EncodeResource(std::vector<byte> raw, const ResourceCodec codec, const int32_t level)
+{
+    if (codec == ResourceCodec::Deflate && raw.size() >= RES_MIN_COMPRESS && raw.size() <= std::numeric_limits<uLong>::max())
+    {
+        auto outSize = compressBound(static_cast<uLong>(raw.size()));
+        std::vector<byte> output(outSize);
+        const auto ret = compress2(reinterpret_cast<Bytef*>(output.data()), &outSize, 
+            reinterpret_cast<const Bytef*>(raw.data()), static_cast<uLong>(raw.size()), level);
+        // only keep compressed one when it saves at least 1/8
+        if (ret == Z_OK && outSize <= raw.size() - raw.size() / 8)
+        {
+            output.resize(outSize);
+            return { std::move(output), ResourceCodec::Deflate };
+        }
+    }
+    return { std::move(raw), ResourceCodec::None };
+}
+
+
+// encoding jobs run on the shared worker pool, resources are written in submission order by the serializer
+class SerializeUtil::ResourcePipeline
+{
+public:
+    struct PendingResource
+    {
+        std::future<EncodedResource> Result;
+        size_t RawSize;
+        uint32_t Index;
+    };
+    std::deque<PendingResource> Pending;
+    size_t PendingBytes = 0;
+
+    // exception is passed through the future
+    template<typename F>
+    static std::future<std::invoke_result_t<F>> Submit(F&& func)
+    {
+        // packaged_task is move-only, while std::function requires copyable
+        auto task = std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(std::forward<F>(func));
+        auto ret = task->get_future();
+        common::WorkerPool::Post([task]() { (*task)(); });
+        return ret;
+    }
+};
+
+
+SerializeUtil::SerializeUtil(const path& fileName, const uint32_t workerCount)
     : DocWriter(std::make_unique<FileOutputStream>(FileObject::OpenThrow(path(fileName).replace_extension(u".xzrp.json"), OpenFlag::CreateNewBinary))),
     ResWriter(std::make_unique<FileOutputStream>(FileObject::OpenThrow(path(fileName).replace_extension(u".xzrp"), OpenFlag::CreateNewBinary))),
-    SharedMap(DocRoot.Add("#global_map", DocRoot.NewObject()).GetObject("#global_map")), Root(DocRoot)
+    SharedMap(DocRoot.Add("#global_map", DocRoot.NewObject()).GetObject("#global_map")),
+    WorkerCount(workerCount > 0 ? workerCount : common::WorkerPool::GetMaxThreadCount()), Root(DocRoot)
 {
     auto config = DocRoot.NewObject();
     config.Add("identity", "xziar-respak");
-    config.Add("version", 0.1);
+    config.Add("version", 0.2);
     DocRoot.Add("#config", config);
 }
 
@@ -131,12 +234,69 @@ void SerializeUtil::AddObject(const string& name, ejson::JDoc& node)
     DocRoot.Add(name, node);
 }
 
+// escape string content, also used to locate streamed shared object since its key is not unescaped
+static void AppendJsonEscaped(string& output, string_view str)
+{
+    for (const auto ch : str)
+    {
+        switch (ch)
+        {
+        case '"':   output.append("\\\""); break;
+        case '\\':  output.append("\\\\"); break;
+        case '\n':  output.append("\\n"); break;
+        case '\r':  output.append("\\r"); break;
+        case '\t':  output.append("\\t"); break;
+        default:
+            if (static_cast<uint8_t>(ch) < 0x20)
+            {
+                constexpr char Hex[] = "0123456789abcdef";
+                output.append("\\u00").push_back(Hex[static_cast<uint8_t>(ch) >> 4]);
+                output.push_back(Hex[ch & 0xf]);
+            }
+            else
+                output.push_back(ch);
+            break;
+        }
+    }
+}
+
+void SerializeUtil::WriteShared(string_view id, const ejson::JObject& object)
+{
+    string prefix;
+    if (SharedCount++ == 0)
+        prefix.append(IsPretty ? "{\n    \"" : "{\"").append(SharedFieldName).append("\":{");
+    else
+        prefix.push_back(',');
+    if (IsPretty)
+        prefix.append("\n        ");
+    prefix.push_back('"');
+    AppendJsonEscaped(prefix, id);
+    prefix.append("\":");
+    DocWriter->Write(prefix.size(), prefix.data());
+    object.Stringify(*DocWriter, IsPretty);
+}
+
 string SerializeUtil::AddObject(const Serializable& object, string id)
 {
     CheckFinished();
     if (id.empty())
         id = std::to_string(reinterpret_cast<intptr_t>(&object));
-    return AddObject(Serialize(object), id);
+    if (const auto it = FindInMap(ObjectLookup, id); it != nullptr)
+        return *it;
+    // use a standalone pool, so that memory is released once it's written
+    ScopeDocs.emplace_back();
+    try
+    {
+        auto jobj = Serialize(object);
+        auto handle = AddObject(std::move(jobj), std::move(id));
+        ScopeDocs.pop_back();
+        return handle;
+    }
+    catch (...)
+    {
+        ScopeDocs.pop_back();
+        throw;
+    }
 }
 string SerializeUtil::AddObject(ejson::JObject&& jobj, string id)
 {
@@ -144,16 +304,10 @@ string SerializeUtil::AddObject(ejson::JObject&& jobj, string id)
     if (const auto it = FindInMap(ObjectLookup, id); it != nullptr)
         return *it;
 
-    const auto serType = jobj.Get<string_view>(TypeFieldName);
-    const auto ptPath = common::linq::FromIterable(Filters)
-        .Select([&](const auto& filter) { return filter(serType); })
-        .Where([](const string& path) { return !path.empty(); })
-        .TryGetFirst().value_or("/#globals");
-
-    Root.GetOrCreateObjectFromPath(ptPath).Add(id, jobj);
+    WriteShared(id, jobj);
     const auto handle = '$' + id;
     ObjectLookup.emplace(id, handle);
-    SharedMap.Add(handle, ptPath);
+    SharedMap.Add(handle, SharedPath);
     return handle;
 }
 
@@ -181,23 +335,128 @@ void SerializeUtil::AddObject(ejson::JArrayRef<false>& target, const Serializabl
     target.Push(Serialize(object));
 }
 
-string SerializeUtil::PutResource(const void * data, const size_t size, const string& id)
+void SerializeUtil::WriteResource(const uint32_t index, const byte* data, const size_t size, const ResourceCodec codec)
 {
-    CheckFinished();
-    detail::ResourceItem metadata(ResourceUtil::SHA256(data, size), size, ResOffset, ResCount);
-
-    const auto findres = FindInMap(ResourceSet, metadata.SHA256, std::in_place);
-    if (findres)
-        return ResourceList[findres.value()].ExtractHandle();
-    ResourceSet.try_emplace(metadata.SHA256, ResCount);
+    static constexpr std::byte Zeros[RES_PAGE_ALIGN] = {};
+    // compressed resource will be decoded into new buffer, no need to align
+    const auto align = codec == ResourceCodec::None ? GetResourceAlign(size) : RESITEM_SIZE;
+    const auto padding = (align - (ResOffset + RESITEM_SIZE) % align) % align;
+    auto& metadata = ResourceList[index];
+    metadata.Offset = detail::ToLEByteArray(ResOffset + padding);
+    metadata.SetStorage(codec, size);
+    if (padding > 0)
+        ResWriter->Write(static_cast<size_t>(padding), Zeros);
     ResWriter->Write(metadata);
     ResWriter->Write(size, data);
-    ResourceList.push_back(metadata);
+    ResOffset += padding + RESITEM_SIZE + size;
+}
+
+void SerializeUtil::FlushResources(const bool waitAll)
+{
+    if (!Pipeline)
+        return;
+    auto& pending = Pipeline->Pending;
+    while (!pending.empty())
+    {
+        auto& front = pending.front();
+        // write finished ones eagerly, only wait when there's too much pending
+        if (!waitAll && Pipeline->PendingBytes <= RES_MAX_PENDING && pending.size() <= WorkerCount &&
+            front.Result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            break;
+        const auto encoded = front.Result.get();
+        WriteResource(front.Index, encoded.Data.data(), encoded.Data.size(), encoded.Codec);
+        Pipeline->PendingBytes -= front.RawSize;
+        pending.pop_front();
+    }
+}
+
+std::optional<uint32_t> SerializeUtil::FindResource(const ResourceKey& key) const
+{
+    const auto it = ResourceSet.find(key);
+    if (it == ResourceSet.end())
+        return {};
+    return it->second;
+}
+
+string SerializeUtil::AddResource(const ResourceKey& key, bytearray<32>&& sha256, const byte* data, string_view id)
+{
+    const auto size = static_cast<size_t>(key.Size);
+    const auto index = ResCount++;
+    ResourceSet.emplace(key, index);
+    // offset and storage will be filled when being written
+    ResourceList.emplace_back(std::move(sha256), size, 0, index);
     if (!id.empty())
-        ResourceLookup.insert_or_assign(id, ResCount);
-    ResCount++;
-    ResOffset += RESITEM_SIZE + size;
-    return metadata.ExtractHandle();
+        ResourceLookup.insert_or_assign(string(id), index);
+
+    const bool noEncode = Codec == ResourceCodec::None || size < RES_MIN_COMPRESS;
+    if (noEncode && (!Pipeline || Pipeline->Pending.empty()))
+        WriteResource(index, data, size, ResourceCodec::None);
+    else
+    {
+        if (!Pipeline)
+            Pipeline = std::make_unique<ResourcePipeline>();
+        std::vector<byte> raw(data, data + size);
+        Pipeline->Pending.push_back({ Pipeline->Submit([raw = std::move(raw), codec = noEncode ? ResourceCodec::None : Codec, level = CompressLevel]() mutable
+            {
+                return EncodeResource(std::move(raw), codec, level);
+            }), size, index });
+        Pipeline->PendingBytes += size;
+        FlushResources(false);
+    }
+    return ResourceList[index].ExtractHandle();
+}
+
+string SerializeUtil::PutResource(const void * data, const size_t size, const string& id)
+{
+    CheckFinished();
+    const ResourceKey key{ ResourceUtil::FastHash(data, size), size };
+    if (const auto index = FindResource(key); index)
+        return ResourceList[*index].ExtractHandle();
+    // sha256 is only needed by stored resource
+    return AddResource(key, ResourceUtil::SHA256(data, size), reinterpret_cast<const byte*>(data), id);
+}
+
+std::vector<string> SerializeUtil::PutResources(common::span<const ResourceBlob> resources)
+{
+    CheckFinished();
+    // ParallelRun returns after all finished, so no job refers to caller's data after return
+    const auto parallelFor = [&](const size_t count, const auto& func)
+    {
+        std::atomic<size_t> nextIdx = 0;
+        common::WorkerPool::ParallelRun(static_cast<uint32_t>(std::min<size_t>(WorkerCount, count)), [&](uint32_t)
+            {
+                for (auto i = nextIdx++; i < count; i = nextIdx++)
+                    func(i);
+            });
+    };
+    std::vector<ResourceKey> keys(resources.size());
+    parallelFor(resources.size(), [&](const size_t i)
+        {
+            keys[i] = { common::DigestFunc.XXH3_128(resources[i].Data), resources[i].Data.size() };
+        });
+    // only the first one of each new data gets stored, so only they need sha256
+    std::unordered_map<ResourceKey, size_t, ResourceKeyHasher> batchSet;
+    std::vector<size_t> newItems;
+    for (size_t i = 0; i < resources.size(); ++i)
+    {
+        if (!FindResource(keys[i]) && batchSet.emplace(keys[i], i).second)
+            newItems.push_back(i);
+    }
+    std::vector<bytearray<32>> sha256s(newItems.size());
+    parallelFor(newItems.size(), [&](const size_t i)
+        {
+            sha256s[i] = common::DigestFunc.SHA256(resources[newItems[i]].Data);
+        });
+    std::vector<string> handles;
+    handles.reserve(resources.size());
+    for (size_t i = 0, j = 0; i < resources.size(); ++i)
+    {
+        if (j < newItems.size() && newItems[j] == i)
+            handles.push_back(AddResource(keys[i], std::move(sha256s[j++]), resources[i].Data.data(), resources[i].Id));
+        else // duplicates inside the batch are found as well, since AddResource updates ResourceSet
+            handles.push_back(ResourceList[*FindResource(keys[i])].ExtractHandle());
+    }
+    return handles;
 }
 
 string SerializeUtil::LookupResource(const string & id) const
@@ -209,6 +468,7 @@ string SerializeUtil::LookupResource(const string & id) const
 void SerializeUtil::Finish()
 {
     CheckFinished();
+    FlushResources(true);
     ResWriter->Write(ResCount * RESITEM_SIZE, ResourceList.data());
     detail::ResourceItem sumdata(ResourceUtil::SHA256(ResourceList.data(), ResourceList.size() * RESITEM_SIZE), 0, ResOffset, ResCount);
     sumdata.Dummy[0] = byte('X');
@@ -217,7 +477,18 @@ void SerializeUtil::Finish()
     sumdata.Dummy[3] = byte('K');
     ResWriter->Write(sumdata);
     ResWriter->Flush();
-    DocRoot.Stringify(*DocWriter, IsPretty);
+
+    // close shared objects, then append the rest of root, which is small since shared objects are excluded
+    string output;
+    if (SharedCount == 0)
+        output.append(IsPretty ? "{\n    \"" : "{\"").append(SharedFieldName).append("\":{");
+    output.append(IsPretty && SharedCount > 0 ? "\n    }" : "}");
+    const auto rest = DocRoot.Stringify(IsPretty);
+    Expects(rest.size() >= 2 && rest.front() == '{');
+    if (rest.find_first_not_of(" \t\r\n", 1) != rest.size() - 1) // has member
+        output.push_back(',');
+    output.append(rest, 1, string::npos);
+    DocWriter->Write(output.size(), output.data());
     DocWriter->Flush();
     HasFinished = true;
 }
@@ -235,21 +506,136 @@ uint32_t DeserializeUtil::RegistDeserializer(const std::string_view& type, const
     return 0;
 }
 
+// only finds boundaries of json values, content is validated by rapidjson when being parsed
+class JsonScanner
+{
+private:
+    char* Ptr;
+    char* const End;
+public:
+    JsonScanner(char* begin, char* end) noexcept : Ptr(begin), End(end) { }
+    [[nodiscard]] char* Current() const noexcept { return Ptr; }
+    void SkipSpace() noexcept
+    {
+        while (Ptr < End && (*Ptr == ' ' || *Ptr == '\t' || *Ptr == '\r' || *Ptr == '\n'))
+            Ptr++;
+    }
+    [[nodiscard]] bool Expect(const char ch) noexcept
+    {
+        SkipSpace();
+        if (Ptr < End && *Ptr == ch)
+        {
+            Ptr++;
+            return true;
+        }
+        return false;
+    }
+    // returns string content without unescaping
+    [[nodiscard]] std::optional<string_view> RawString() noexcept
+    {
+        if (!Expect('"'))
+            return {};
+        const auto begin = Ptr;
+        for (; Ptr < End; ++Ptr)
+        {
+            if (*Ptr == '\\')
+                Ptr++;
+            else if (*Ptr == '"')
+                return string_view(begin, static_cast<size_t>(Ptr++ - begin));
+        }
+        return {};
+    }
+    [[nodiscard]] bool SkipValue() noexcept
+    {
+        SkipSpace();
+        if (Ptr == End)
+            return false;
+        if (*Ptr == '"')
+            return RawString().has_value();
+        if (*Ptr == '{' || *Ptr == '[')
+        {
+            size_t depth = 0;
+            while (Ptr < End)
+            {
+                const auto ch = *Ptr;
+                if (ch == '"')
+                {
+                    if (!RawString())
+                        return false;
+                    continue;
+                }
+                Ptr++;
+                if (ch == '{' || ch == '[')
+                    depth++;
+                else if ((ch == '}' || ch == ']') && --depth == 0)
+                    return true;
+            }
+            return false;
+        }
+        while (Ptr < End && *Ptr != ',' && *Ptr != '}' && *Ptr != ']' && *Ptr != ' ' && *Ptr != '\t' && *Ptr != '\r' && *Ptr != '\n')
+            Ptr++;
+        return true;
+    }
+};
+
+ejson::JObject DeserializeUtil::LoadDocument(common::AlignedBuffer& data, std::map<string, LazyObject, std::less<>>& sharedObjects)
+{
+    const auto begin = data.GetRawPtr<char>(), end = begin + data.GetSize();
+    JsonScanner scanner(begin, end);
+    // index streamed shared objects, then turn the rest into a standalone object: `,"a":1}` -> `{"a":1}`
+    if (scanner.Expect('{') && scanner.RawString() == SharedFieldName && scanner.Expect(':') && scanner.Expect('{'))
+    {
+        if (!scanner.Expect('}'))
+        {
+            do
+            {
+                const auto id = scanner.RawString();
+                if (!id || !scanner.Expect(':'))
+                    COMMON_THROWEX(BaseException, u"wrong format of shared objects");
+                scanner.SkipSpace();
+                const auto offset = static_cast<size_t>(scanner.Current() - begin);
+                if (!scanner.SkipValue())
+                    COMMON_THROWEX(BaseException, u"wrong format of shared objects");
+                sharedObjects.try_emplace(string(*id), LazyObject{ offset, {} });
+            } while (scanner.Expect(','));
+            if (!scanner.Expect('}'))
+                COMMON_THROWEX(BaseException, u"wrong format of shared objects");
+        }
+        scanner.SkipSpace();
+        const auto rest = scanner.Current();
+        if (scanner.Expect('}'))
+            return ejson::JObject();
+        if (!scanner.Expect(','))
+            COMMON_THROWEX(BaseException, u"wrong format of respak json");
+        *rest = '{';
+        if (!JsonScanner(rest, end).SkipValue())
+            COMMON_THROWEX(BaseException, u"wrong format of respak json");
+        return ejson::JObject(ejson::JDoc::ParseInsitu(rest, true));
+    }
+    // not streamed (or modified by hand), parse the whole document
+    sharedObjects.clear();
+    if (!JsonScanner(begin, end).SkipValue())
+        COMMON_THROWEX(BaseException, u"wrong format of respak json");
+    return ejson::JObject(ejson::JDoc::ParseInsitu(begin, true));
+}
+
 DeserializeUtil::DeserializeUtil(const path & fileName)
-    : ResReader(std::make_unique<FileInputStream>(FileObject::OpenThrow(path(fileName).replace_extension(u".xzrp"), OpenFlag::ReadBinary))),
-    DocRoot(ejson::JDoc::Parse(common::file::ReadAllText(path(fileName).replace_extension(u".xzrp.json")))),
+    : ResData(FileMappingObject::AsBuffer(FileMappingObject::OpenThrow(
+        RawFileObject::OpenThrow(path(fileName).replace_extension(u".xzrp"), OpenFlag::ReadBinary), MappingFlag::ReadOnly))),
+    DocData(FileMappingObject::AsBuffer(FileMappingObject::OpenThrow(
+        RawFileObject::OpenThrow(path(fileName).replace_extension(u".xzrp.json"), OpenFlag::ReadBinary), MappingFlag::CopyOnWrite))),
+    DocRoot(LoadDocument(DocData, SharedObjects)),
     Root(ejson::JObjectRef<true>(DocRoot))
 {
     common::linq::FromEnumerableObject(Root.GetObject("#global_map"))
         .IntoMap(SharedObjectLookup, [](const auto& kvpair) { return kvpair.first; },
             [](const auto& kvpair) { return kvpair.second.template AsValue<string_view>(); });
 
-    const auto size = ResReader->GetSize();
+    const auto size = ResData.GetSize();
     if (size < RESITEM_SIZE)
         COMMON_THROWEX(BaseException, u"wrong respak size");
     detail::ResourceItem sumdata;
-    ResReader->SetPos(size - RESITEM_SIZE);
-    ResReader->Read(sumdata);
+    memcpy(&sumdata, ResData.GetRawPtr() + size - RESITEM_SIZE, RESITEM_SIZE);
     if (sumdata.Dummy[0] != byte('X') || sumdata.Dummy[1] != byte('Z') || sumdata.Dummy[2] != byte('P') || sumdata.Dummy[3] != byte('K'))
         COMMON_THROWEX(BaseException, u"wrong respak signature");
     const auto itemcount = sumdata.GetIndex();
@@ -258,8 +644,7 @@ DeserializeUtil::DeserializeUtil(const path & fileName)
     if (offset + indexsize != size - sizeof(sumdata))
         COMMON_THROWEX(BaseException, u"wrong respak size");
     ResourceList.resize(itemcount);
-    ResReader->SetPos(offset);
-    ResReader->Read(indexsize, ResourceList.data());
+    memcpy(ResourceList.data(), ResData.GetRawPtr() + offset, indexsize);
     if (!sumdata.CheckSHA(ResourceUtil::SHA256(ResourceList.data(), indexsize)))
         COMMON_THROWEX(BaseException, u"wrong checksum for resource index");
     if (common::linq::FromIterable(ResourceList)
@@ -287,16 +672,36 @@ common::AlignedBuffer DeserializeUtil::GetResource(const string& handle, const b
     if (!findres)
         return {};
     const auto& metadata = ResourceList[findres.value()];
-    ResReader->SetPos(metadata.GetOffset());
+    const auto offset = metadata.GetOffset(), size = metadata.GetStoredSize();
+    const uint64_t dataEnd = ResData.GetSize() - RESITEM_SIZE; // index and sumdata are placed after all resources
+    if (offset > dataEnd || dataEnd - offset < RESITEM_SIZE || size > dataEnd - offset - RESITEM_SIZE)
+        COMMON_THROWEX(BaseException, u"resource out of respak range");
     detail::ResourceItem item;
-    ResReader->Read(item);
+    memcpy(&item, ResData.GetRawPtr() + offset, RESITEM_SIZE);
     if (metadata != item)
         COMMON_THROWEX(BaseException, u"unmatch resource metadata with resource index");
-    common::AlignedBuffer ret((size_t)metadata.GetSize());
-    ResReader->Read((size_t)metadata.GetSize(), ret.GetRawPtr());
-    if (cache)
-        ResourceCache.emplace(handle, ret.CreateSubBuffer());
-    return ret;
+    const auto data = ResData.GetRawPtr() + offset + RESITEM_SIZE;
+    switch (metadata.GetCodec())
+    {
+    case ResourceCodec::None:
+        return ResData.CreateSubBuffer(static_cast<size_t>(offset + RESITEM_SIZE), static_cast<size_t>(size));
+    case ResourceCodec::Deflate:
+    {
+        const auto rawSize = metadata.GetSize();
+        if (rawSize > std::numeric_limits<uLong>::max() || size > std::numeric_limits<uLong>::max())
+            COMMON_THROWEX(BaseException, u"compressed resource too large");
+        common::AlignedBuffer ret(static_cast<size_t>(rawSize));
+        auto outSize = static_cast<uLong>(rawSize);
+        const auto err = uncompress(reinterpret_cast<Bytef*>(ret.GetRawPtr()), &outSize, reinterpret_cast<const Bytef*>(data), static_cast<uLong>(size));
+        if (err != Z_OK || outSize != rawSize)
+            COMMON_THROWEX(BaseException, u"failed to decompress resource");
+        if (cache)
+            ResourceCache.emplace(handle, ret.CreateSubBuffer());
+        return ret;
+    }
+    default:
+        COMMON_THROWEX(BaseException, u"unknown resource codec");
+    }
 }
 
 std::unique_ptr<xziar::respak::Serializable> DeserializeUtil::InnerDeserialize(const ejson::JObjectRef<true>& object, 
@@ -313,10 +718,22 @@ std::unique_ptr<xziar::respak::Serializable> DeserializeUtil::InnerDeserialize(c
 
 ejson::JObjectRef<true> DeserializeUtil::InnerFindShare(const string_view & id)
 {
-    if (const auto& path = FindInMap(SharedObjectLookup, id); path)
-        return ejson::JObjectRef<true>(DocRoot.GetFromPath(*path)).GetObject(id.substr(1));
-    else
+    const auto& path = FindInMap(SharedObjectLookup, id);
+    if (!path)
         return ejson::JNull();
+    if (*path == SharedPath && !SharedObjects.empty())
+    {
+        string key;
+        AppendJsonEscaped(key, id.substr(1));
+        const auto obj = FindInMap(SharedObjects, key);
+        if (!obj)
+            return ejson::JNull();
+        // parse in-situ when first used, it will stay the same node so ObjectCache still works
+        if (!obj->Object)
+            obj->Object.emplace(ejson::JDoc::ParseInsitu(DocData.GetRawPtr<char>() + obj->Offset, true));
+        return ejson::JObjectRef<true>(*obj->Object);
+    }
+    return ejson::JObjectRef<true>(DocRoot.GetFromPath(*path)).GetObject(id.substr(1));
 }
 
 }
@@ -4,6 +4,7 @@
 #include "common/FileBase.hpp"
 #include "common/EasierJson.hpp"
 #include <map>
+#include <optional>
 #include <unordered_map>
 #include <variant>
 #include <functional>
@@ -21,6 +22,9 @@ namespace xziar::respak
 class SerializeUtil;
 class DeserializeUtil;
 
+// codec of resource data, stored in ResourceItem
+enum class ResourceCodec : uint8_t { None = 0, Deflate = 1 };
+
 class RESPAKAPI Serializable
 {
     friend class SerializeUtil;
@@ -79,13 +83,17 @@ public:
     bytearray<8> Size;
     bytearray<8> Offset;
     bytearray<4> Index;
-    bytearray<12> Dummy = { std::byte(0) };
+    bytearray<12> Dummy = { std::byte(0) }; // [0] is codec, [4,12) is stored size when compressed
     ResourceItem() {}
     ResourceItem(bytearray<32>&& sha256, const uint64_t size, const uint64_t offset, const uint32_t index);
     std::string ExtractHandle() const;
     uint64_t GetSize() const;
     uint64_t GetOffset() const;
     uint32_t GetIndex() const;
+    ResourceCodec GetCodec() const;
+    // size of data in file, equals to Size when not compressed
+    uint64_t GetStoredSize() const;
+    void SetStorage(const ResourceCodec codec, const uint64_t storedSize);
     bool CheckSHA(const bytearray<32>& sha256) const;
     bool operator==(const ResourceItem& other) const;
     bool operator!=(const ResourceItem& other) const;
@@ -96,28 +104,63 @@ public:
 class RESPAKAPI SerializeUtil : public common::NonCopyable, public common::NonMovable
 {
 public:
-    using FilterFunc = std::function<std::string(const std::string_view&)>;
+    struct ResourceBlob
+    {
+        common::span<const std::byte> Data;
+        std::string_view Id;
+    };
 private:
+    class ResourcePipeline;
+    // raw data with the same size and xxh3-128 are treated as identical
+    struct ResourceKey
+    {
+        std::array<uint64_t, 2> FastHash;
+        uint64_t Size;
+        bool operator==(const ResourceKey& other) const noexcept { return FastHash == other.FastHash && Size == other.Size; }
+    };
+    struct ResourceKeyHasher
+    {
+        size_t operator()(const ResourceKey& key) const noexcept { return static_cast<size_t>(key.FastHash[0]); }
+    };
     std::unique_ptr<common::io::RandomOutputStream> DocWriter;
     std::unique_ptr<common::io::RandomOutputStream> ResWriter;
     ejson::JObject DocRoot;
     ejson::JObjectRef<false> SharedMap;
-    std::vector<FilterFunc> Filters;
+    // each shared object being serialized owns a memory pool, released once it's streamed out
+    std::vector<ejson::JObject> ScopeDocs;
 
     // lookup table for global object
     std::unordered_map<std::string, std::string> ObjectLookup;
     std::vector<detail::ResourceItem> ResourceList;
-    std::unordered_map<bytearray<32>, uint32_t, detail::SHA256Hash> ResourceSet;
+    std::unordered_map<ResourceKey, uint32_t, ResourceKeyHasher> ResourceSet;
     std::unordered_map<std::string, uint32_t> ResourceLookup;
+    std::unique_ptr<ResourcePipeline> Pipeline;
     uint64_t ResOffset = 0;
     uint32_t ResCount = 0;
+    uint32_t SharedCount = 0;
+    uint32_t WorkerCount;
     bool HasFinished = false;
+    ejson::DocumentHandle& CurrentDoc() noexcept { return ScopeDocs.empty() ? DocRoot : ScopeDocs.back(); }
     ejson::JObject Serialize(const Serializable& object);
+    void WriteShared(std::string_view id, const ejson::JObject& object);
     void CheckFinished() const;
+    std::optional<uint32_t> FindResource(const ResourceKey& key) const;
+    std::string AddResource(const ResourceKey& key, bytearray<32>&& sha256, const std::byte* data, std::string_view id);
+    void WriteResource(const uint32_t index, const std::byte* data, const size_t size, const ResourceCodec codec);
+    void FlushResources(const bool waitAll);
 public:
     ejson::JObjectRef<false> Root;
     bool IsPretty = false;
-    SerializeUtil(const common::fs::path& fileName);
+    // codec used for following resources, small or incompressible resource is still kept raw
+    ResourceCodec Codec = ResourceCodec::Deflate;
+    // zlib level for Deflate, 1 is the fastest
+    int32_t CompressLevel = 1;
+    /**
+     * @brief create a serializer
+     * @param fileName path of the package, extension will be replaced
+     * @param workerCount max resources being hashed or compressed at the same time on the shared worker pool, 0 means hardware concurrency
+    */
+    SerializeUtil(const common::fs::path& fileName, const uint32_t workerCount = 0);
     ~SerializeUtil();
 
     //template<typename... Ts>
@@ -130,20 +173,19 @@ public:
     //{
     //    return (... && (dynamic_cast<const common::remove_cvref_t<Ts>*>(&object) != nullptr));
     //}
-    void AddFilter(const FilterFunc& filter) { Filters.push_back(filter); }
-
+    // nodes created when serializing a shared object are only valid until it has been added
     template<typename T>
-    ejson::JObject NewObject(const T& data) { return DocRoot.NewObject(data); }
+    ejson::JObject NewObject(const T& data) { return CurrentDoc().NewObject(data); }
     template<typename T>
-    ejson::JArray NewArray(const T& data) { return DocRoot.NewArray(data); }
-    ejson::JObject NewObject() { return DocRoot.NewObject(); }
-    ejson::JArray NewArray() { return DocRoot.NewArray(); }
+    ejson::JArray NewArray(const T& data) { return CurrentDoc().NewArray(data); }
+    ejson::JObject NewObject() { return CurrentDoc().NewObject(); }
+    ejson::JArray NewArray() { return CurrentDoc().NewArray(); }
 
     //simply add node to docroot, bypassing filter
     void AddObject(const std::string& name, ejson::JDoc& node);
-    //simply add a global object, will be filtered to get proper path
+    //simply add a global object, it's streamed to file immediately
     std::string AddObject(const Serializable& object, std::string id = "");
-    //simply add a global object (already parssed), will be filtered to get proper path
+    //simply add a global object (already parssed), it's streamed to file immediately
     std::string AddObject(ejson::JObject&& object, std::string id);
     //string LookupObject(const Serializable& object) const;
     //add object to an object, bypassing filter
@@ -153,7 +195,11 @@ public:
     void AddObject(ejson::JArray& target, const Serializable& object);
     void AddObject(ejson::JArrayRef<false>& target, const Serializable& object);
 
+    // data is hashed on caller thread and compressed by workers, it can be released after return.
+    // duplicated data is found by fast hash, confirmed by size & sha256, returns the handle of the existing one
     std::string PutResource(const void* data, const size_t size, const std::string& id = "");
+    // hashed & compressed by workers, handles are in the same order, file layout is the same as calling PutResource in order
+    std::vector<std::string> PutResources(common::span<const ResourceBlob> resources);
     std::string LookupResource(const std::string& id) const;
 
     void Finish();
@@ -179,8 +225,18 @@ private:
         static constexpr bool Check() { return decltype(HasDoDes<T>(0))::value; }
     };
 
+    struct LazyObject
+    {
+        size_t Offset;
+        std::optional<ejson::JObject> Object;
+    };
     static std::unordered_map<std::string_view, DeserializeFunc>& DeserializeMap();
-    std::unique_ptr<common::io::RandomInputStream> ResReader;
+    // whole respak file mapped as read-only, resources are sub-buffers of it
+    common::AlignedBuffer ResData;
+    // json file mapped as copy-on-write, parsed in-situ
+    common::AlignedBuffer DocData;
+    // streamed shared objects [escaped id->object], only parsed when being used
+    std::map<std::string, LazyObject, std::less<>> SharedObjects;
     ejson::JObject DocRoot;
     
     // store cookies injected by deserialize host
@@ -189,12 +245,13 @@ private:
     std::unordered_map<ejson::JObjectRef<true>, std::shared_ptr<Serializable>, ejson::JNodeHash> ObjectCache;
     // store share object lookup
     std::map<std::string_view, std::string_view, std::less<>> SharedObjectLookup;
-    // store deserialized shared resource acoording to res-handle
+    // store decompressed resource acoording to res-handle, uncompressed one directly comes from mapping
     std::unordered_map<std::string, common::AlignedBuffer> ResourceCache;
     // resource index
     std::vector<detail::ResourceItem> ResourceList;
     // resource lookup [handle->residx]
     std::unordered_map<std::string, uint32_t> ResourceSet;
+    static ejson::JObject LoadDocument(common::AlignedBuffer& data, std::map<std::string, LazyObject, std::less<>>& sharedObjects);
     std::unique_ptr<Serializable> InnerDeserialize(const ejson::JObjectRef<true>& object, std::unique_ptr<Serializable>(*fallback)(DeserializeUtil&, const ejson::JObjectRef<true>&));
     ejson::JObjectRef<true> InnerFindShare(const std::string_view& id);
 public:
@@ -218,6 +275,8 @@ public:
         else 
             return nullptr;
     }
+    // uncompressed resource aliases the mapped respak and should be treated as read-only.
+    // cache only applies to compressed resource, mapped resources are always shared
     common::AlignedBuffer GetResource(const std::string& handle, const bool cache = true);
 
     template<typename T = Serializable>
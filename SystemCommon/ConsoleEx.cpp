@@ -1,5 +1,6 @@
 #include "SystemCommonPch.h"
 #include "ConsoleEx.h"
+#include "Format.h"
 
 #include <boost/container/small_vector.hpp>
 
@@ -699,14 +700,20 @@ struct InitMessageHandler final : detail::InitMessage::Handler
     ~InitMessageHandler() final {}
     void Handle(mlog::LogLevel level, std::string_view host, std::string_view msg) noexcept final
     {
-        std::u16string txt;
-        txt.reserve(host.size() + msg.size() + 2);
-        if (!host.empty())
+        using Fmter = str::Formatter<char16_t>;
+        str::StackSink<char16_t, 256> sink;
         {
-            txt.append(u"[").append(host.begin(), host.end()).append(u"]");
+            str::SinkBuffer<char16_t> buffer(sink);
+            if (!host.empty())
+            {
+                buffer.push_back(u'[');
+                Fmter::PutString(buffer, host, nullptr);
+                buffer.push_back(u']');
+            }
+            Fmter::PutString(buffer, msg, nullptr);
+            buffer.Flush();
         }
-        txt.append(msg.begin(), msg.end());
-        Console->Print(common::detail::GetLogColor(level), txt);
+        Console->Print(common::detail::GetLogColor(level), sink.View());
     }
 };
 
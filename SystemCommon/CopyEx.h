@@ -52,6 +52,7 @@ private:
     void(*CvtF64F32  )(float * dest, const double* src, size_t count) noexcept = nullptr;
 public:
     SYSCOMMONAPI [[nodiscard]] static common::span<const PathInfo> GetSupportMap() noexcept;
+    SYSCOMMONAPI [[nodiscard]] static common::span<const BenchmarkInfo> GetBenchmarks() noexcept;
     SYSCOMMONAPI CopyManager(common::span<const VarItem> requests = {}) noexcept;
     SYSCOMMONAPI ~CopyManager();
     SYSCOMMONAPI [[nodiscard]] bool IsComplete() const noexcept final;
@@ -71,4 +71,7 @@ DEFINE_FASTPATH_PARTIAL(MiscIntrins, A32)
 DEFINE_FASTPATH_PARTIAL(DigestFuncs, A32)
 {
     REGISTER_FASTPATH_VARIANTS(Sha256, SHA2, NAIVE);
+    REGISTER_FASTPATH_VARIANTS(Crc32c, CRC32, NAIVE);
+    REGISTER_FASTPATH_VARIANTS(Xxh3, NEON, NAIVE);
+    REGISTER_FASTPATH_VARIANTS(Xxh128, NEON, NAIVE);
 }
@@ -71,4 +71,7 @@ DEFINE_FASTPATH_PARTIAL(MiscIntrins, AVX2)
 DEFINE_FASTPATH_PARTIAL(DigestFuncs, AVX2)
 {
     REGISTER_FASTPATH_VARIANTS(Sha256, SHANIAVX2, SHANI, NAIVE);
+    REGISTER_FASTPATH_VARIANTS(Crc32c, CRC32, NAIVE);
+    REGISTER_FASTPATH_VARIANTS(Xxh3, AVX2, SSE2, NAIVE);
+    REGISTER_FASTPATH_VARIANTS(Xxh128, AVX2, SSE2, NAIVE);
 }
@@ -241,6 +241,17 @@ struct SHA2
 #endif
     }
 };
+struct CRC32
+{
+    static bool RuntimeCheck() noexcept
+    {
+#if COMMON_ARCH_X86
+        return CheckCPUFeature("sse4_2");
+#else
+        return CheckCPUFeature("crc32");
+#endif
+    }
+};
 struct WAITPKG
 {
     static bool RuntimeCheck() noexcept
@@ -52,98 +52,139 @@ DEFINE_FASTPATH_BASIC(CopyManager,
     CvtI32F32, CvtI16F32, CvtI8F32, CvtU32F32, CvtU16F32, CvtU8F32,
     CvtF32I32, CvtF32I16, CvtF32I8, CvtF32U16, CvtF32U8,
     CvtF16F32, CvtF32F16, CvtF32F64, CvtF64F32)
-const CopyManager CopyEx;
+DEFINE_FASTPATH_BENCHMARKS(CopyManager,
+    SwapRegion, Reverse1, Reverse2, Reverse3, Reverse4, Reverse8,
+    Broadcast2, Broadcast4,
+    ZExtCopy12, ZExtCopy14, ZExtCopy24, ZExtCopy28, ZExtCopy48,
+    SExtCopy12, SExtCopy14, SExtCopy24, SExtCopy28, SExtCopy48,
+    TruncCopy21, TruncCopy41, TruncCopy42, TruncCopy82, TruncCopy84,
+    CvtI32F32, CvtI16F32, CvtI8F32, CvtU32F32, CvtU16F32, CvtU8F32,
+    CvtF32I32, CvtF32I16, CvtF32I8, CvtF32U16, CvtF32U8,
+    CvtF16F32, CvtF32F16, CvtF32F64, CvtF64F32)
+const CopyManager CopyEx(CopyManager::StartupRequests());
 
 
 DEFINE_FASTPATH_BASIC(MiscIntrins,
     LeadZero32, LeadZero64, TailZero32, TailZero64, PopCount32, PopCount64, PopCounts, Hex2Str, PauseCycles)
-const MiscIntrins MiscIntrin;
+DEFINE_FASTPATH_BENCHMARKS(MiscIntrins, PopCounts, Hex2Str)
+const MiscIntrins MiscIntrin(MiscIntrins::StartupRequests());
 
 
-DEFINE_FASTPATH_BASIC(DigestFuncs, Sha256)
-const DigestFuncs DigestFunc;
+DEFINE_FASTPATH_BASIC(DigestFuncs, Sha256, Crc32c, Xxh3, Xxh128)
+DEFINE_FASTPATH_BENCHMARKS(DigestFuncs, Sha256, Crc32c, Xxh3, Xxh128)
+const DigestFuncs DigestFunc(DigestFuncs::StartupRequests());
 
 
 namespace spinlock
 {
 
-template<typename FL, typename FF> 
-forceinline void WaitFramework(FL&& lock, FF&& fix)
+#if SYSCOMMON_SPINLOCK_PARK
+template<typename T>
+forceinline T LoadFlag(const std::atomic<T>& flag) noexcept { return flag.load(); }
+forceinline bool LoadFlag(const std::atomic_flag& flag) noexcept { return flag.test(); }
+#endif
+
+// lock() should be stateless and only fail when the lock is taken or the flag has changed,
+// otherwise a parked waiter may sleep on an unchanged flag.
+template<typename F, typename FL>
+forceinline void LockWaiter::Wait([[maybe_unused]] F& flag, FL&& lock) noexcept
 {
-    for (uint32_t i = 0; i < 16; ++i)
+    IF_LIKELY(lock()) return;
+    if (Stats)
+        Stats->Contended.fetch_add(1, std::memory_order_relaxed);
+    for (uint32_t i = 1; i < 16; ++i)
     {
-        IF_LIKELY(lock()) return;
-        fix();
         COMMON_PAUSE();
+        IF_LIKELY(lock()) return;
     }
+    uint32_t delays[2] = { 512, 256 };
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        MiscIntrin.Pause(delays[0]);
+        delays[0] <<= 1;
+        IF_LIKELY(lock()) return;
+        MiscIntrin.Pause(delays[1]);
+        delays[1] <<= 1;
+        IF_LIKELY(lock()) return;
+    }
+#if SYSCOMMON_SPINLOCK_PARK
+    if (Stats)
+        Stats->Parked.fetch_add(1, std::memory_order_relaxed);
+    // register before observing the flag, so unlocker either sees the count or the observed value is stale
+    ParkCount.fetch_add(1);
+    while (true)
+    {
+        const auto observed = LoadFlag(flag);
+        if (lock()) break;
+        flag.wait(observed); // returns immediately if flag has changed
+    }
+    ParkCount.fetch_sub(1);
+#else
     while (true)
     {
-        uint32_t delays[2] = { 512, 256 };
-        for (uint32_t i = 0; i < 8; ++i)
-        {
-            IF_LIKELY(lock()) return;
-            fix();
-            MiscIntrin.Pause(delays[0]);
-            delays[0] <<= 1;
-            IF_LIKELY(lock()) return;
-            fix();
-            MiscIntrin.Pause(delays[1]);
-            delays[1] <<= 1;
-        }
         std::this_thread::yield();
+        IF_LIKELY(lock()) return;
     }
+#endif
 }
 
 void SpinLocker::Lock() noexcept
 {
-    WaitFramework([&]() { return !Flag.test_and_set(); }, []() {});
+    Wait(Flag, [&]() { return !Flag.test_and_set(); });
 }
 
 void PreferSpinLock::LockWeak() noexcept
 {
-    uint32_t expected = Flag.load() & 0x0000ffff; // assume no strong
-    WaitFramework([&]() { return Flag.load() == expected && Flag.compare_exchange_strong(expected, expected + 1); },
-        [&]() { expected &= 0x0000ffff; });
+    Wait(Flag, [&]()
+        {
+            auto expected = Flag.load();
+            return (expected & 0xffff0000u) == 0 && Flag.compare_exchange_strong(expected, expected + 1); // no strong
+        });
 }
 
 void PreferSpinLock::LockStrong() noexcept
 {
     Flag.fetch_add(0x00010000);
     // loop until no weak
-    WaitFramework([&]() { return (Flag.load() & 0x0000ffff) == 0; }, []() {});
+    Wait(Flag, [&]() { return (Flag.load() & 0x0000ffff) == 0; });
 }
 
 void WRSpinLock::LockRead() noexcept
 {
-    uint32_t expected = Flag.load() & 0x7fffffffu; // assume no writer
-    WaitFramework([&]() { return Flag.load() == expected && Flag.compare_exchange_weak(expected, expected + 1); },
-        [&]() { expected &= 0x7fffffffu; });
+    Wait(Flag, [&]()
+        {
+            auto expected = Flag.load();
+            return (expected & 0x80000000u) == 0 && Flag.compare_exchange_strong(expected, expected + 1); // no writer
+        });
 }
 
 void WRSpinLock::LockWrite() noexcept
 {
-    uint32_t expected = Flag.load() & 0x7fffffffu;
-    // assume no other writer
-    WaitFramework([&]() { return Flag.load() == expected && Flag.compare_exchange_weak(expected, expected + 0x80000000u); },
-        [&]() { expected &= 0x7fffffffu; });
+    Wait(Flag, [&]()
+        {
+            auto expected = Flag.load();
+            return (expected & 0x80000000u) == 0 && Flag.compare_exchange_strong(expected, expected + 0x80000000u); // no other writer
+        });
     // loop until no reader
-    WaitFramework([&]() { return (Flag.load() & 0x7fffffffu) == 0; }, []() {});
+    Wait(Flag, [&]() { return (Flag.load() & 0x7fffffffu) == 0; });
 }
 
 void RWSpinLock::LockRead() noexcept
 {
     Flag++;
     // loop until no writer
-    WaitFramework([&]() { return (Flag.load() & 0x80000000u) == 0; }, []() {});
+    Wait(Flag, [&]() { return (Flag.load() & 0x80000000u) == 0; });
 }
 
 void RWSpinLock::LockWrite() noexcept
 {
-    uint32_t expected = 0; // assume no other locker
-    WaitFramework([&]() { return Flag.load() == expected && Flag.compare_exchange_weak(expected, 0x80000000u); },
-        [&]() { expected = 0; });
+    Wait(Flag, [&]()
+        {
+            uint32_t expected = 0; // no other locker
+            return Flag.load() == expected && Flag.compare_exchange_strong(expected, 0x80000000u);
+        });
 }
 
 }
 
-}
\ No newline at end of file
+}
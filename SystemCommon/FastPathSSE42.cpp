@@ -77,4 +77,7 @@ DEFINE_FASTPATH_PARTIAL(MiscIntrins, SSE42)
 DEFINE_FASTPATH_PARTIAL(DigestFuncs, SSE42)
 {
     REGISTER_FASTPATH_VARIANTS(Sha256, SHANI, NAIVE);
+    REGISTER_FASTPATH_VARIANTS(Crc32c, CRC32, NAIVE);
+    REGISTER_FASTPATH_VARIANTS(Xxh3, SSE2, NAIVE);
+    REGISTER_FASTPATH_VARIANTS(Xxh128, SSE2, NAIVE);
 }
@@ -285,6 +285,21 @@ FileMappingObject::~FileMappingObject()
 #endif
 }
 
+struct FileMappingObject::Holder final : public AlignedBuffer::ExternBufInfo
+{
+    std::shared_ptr<const FileMappingObject> Host;
+    Holder(std::shared_ptr<const FileMappingObject> host) : Host(std::move(host)) {}
+    ~Holder() final {}
+    [[nodiscard]] size_t GetSize() const noexcept final { return Host->Size; }
+    [[nodiscard]] byte* GetPtr() const noexcept final { return Host->Ptr; }
+};
+
+AlignedBuffer FileMappingObject::AsBuffer(std::shared_ptr<const FileMappingObject> mapping) noexcept
+{
+    Expects(mapping);
+    return AlignedBuffer::CreateBuffer(std::make_unique<Holder>(std::move(mapping)), gsl::narrow_cast<size_t>(GetMappingAlign()));
+}
+
 
 FileMappingStream::FileMappingStream(std::shared_ptr<FileMappingObject> && mapping) noexcept
     : MappingObject(std::move(mapping)) {
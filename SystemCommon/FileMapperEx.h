@@ -36,6 +36,7 @@ public:
 #endif
 private:
     MAKE_ENABLER();
+    struct Holder;
     std::shared_ptr<RawFileObject> RawFile;
     uint64_t Offset;
     HandleType MappingHandle;
@@ -59,6 +60,9 @@ public:
         const std::pair<uint64_t, uint64_t>& region = { 0, UINT64_MAX });
     SYSCOMMONAPI [[nodiscard]] static std::shared_ptr<FileMappingObject> OpenThrow(std::shared_ptr<RawFileObject> rawFile, const MappingFlag flag,
         const std::pair<uint64_t, uint64_t>& region = { 0, UINT64_MAX });
+    // zero-copy view of the whole mapping, the buffer (and its sub-buffers) keeps the mapping alive.
+    // content of a ReadOnly mapping should not be modified through it
+    SYSCOMMONAPI [[nodiscard]] static AlignedBuffer AsBuffer(std::shared_ptr<const FileMappingObject> mapping) noexcept;
 };
 
 
@@ -10,6 +10,9 @@
 #include "3rdParty/half/half.hpp"
 #include "3rdParty/fmt/include/fmt/compile.h"
 #include "3rdParty/fmt/src/format.cc"
+#include <shared_mutex>
+#include <mutex>
+#include <unordered_map>
 #pragma message("Compiling SystemCommon with fmt[" STRINGIZE(FMT_VERSION) "]" )
 
 
@@ -435,9 +438,10 @@ struct FormatterHelper : public FormatterBase
             return ConvertSpecIntSign(sign);
         }
     }
-    template<typename Dst, typename Src>
-    static forceinline void PutString(std::basic_string<Dst>& ret, const Src* __restrict str, size_t len, const fmt::format_specs* __restrict spec)
+    template<typename Src, typename Out>
+    static forceinline void PutString(Out& ret, const Src* __restrict str, size_t len, const fmt::format_specs* __restrict spec)
     {
+        using Dst = typename Out::value_type;
         if constexpr (std::is_same_v<Dst, Src>)
         {
             if (spec)
@@ -447,34 +451,34 @@ struct FormatterHelper : public FormatterBase
         }
         else if constexpr (sizeof(Dst) == sizeof(Src))
         {
-            PutString<Dst, Dst>(ret, reinterpret_cast<const Dst*>(str), len, spec);
+            PutString(ret, reinterpret_cast<const Dst*>(str), len, spec);
         }
         else if constexpr (std::is_same_v<Dst, char>)
         {
             const auto newStr = str::to_string(str, len, Encoding::UTF8);
-            PutString<char, char>(ret, newStr.data(), newStr.size(), spec);
+            PutString(ret, newStr.data(), newStr.size(), spec);
         }
         else if constexpr (std::is_same_v<Dst, char16_t>)
         {
             const auto newStr = str::to_u16string(str, len);
-            PutString<char16_t, char16_t>(ret, newStr.data(), newStr.size(), spec);
+            PutString(ret, newStr.data(), newStr.size(), spec);
         }
         else if constexpr (std::is_same_v<Dst, char32_t>)
         {
             const auto newStr = str::to_u32string(str, len);
-            PutString<char32_t, char32_t>(ret, newStr.data(), newStr.size(), spec);
+            PutString(ret, newStr.data(), newStr.size(), spec);
         }
         else if constexpr (std::is_same_v<Dst, wchar_t>)
         {
             if constexpr (sizeof(wchar_t) == sizeof(char16_t))
             {
                 const auto newStr = str::to_u16string(str, len);
-                PutString<wchar_t, wchar_t>(ret, reinterpret_cast<const wchar_t*>(newStr.data()), newStr.size(), spec);
+                PutString(ret, reinterpret_cast<const wchar_t*>(newStr.data()), newStr.size(), spec);
             }
             else if constexpr (sizeof(wchar_t) == sizeof(char32_t))
             {
                 const auto newStr = str::to_u32string(str, len);
-                PutString<wchar_t, wchar_t>(ret, reinterpret_cast<const wchar_t*>(newStr.data()), newStr.size(), spec);
+                PutString(ret, reinterpret_cast<const wchar_t*>(newStr.data()), newStr.size(), spec);
             }
             else
                 static_assert(!common::AlwaysTrue<Src>, "not supported");
@@ -483,7 +487,7 @@ struct FormatterHelper : public FormatterBase
         else if constexpr (std::is_same_v<Dst, char8_t>)
         {
             const auto newStr = str::to_u8string(str, len);
-            PutString<char8_t, char8_t>(ret, newStr.data(), newStr.size(), spec);
+            PutString(ret, newStr.data(), newStr.size(), spec);
         }
 #endif
         else
@@ -664,7 +668,8 @@ struct WrapSpec
 
 
 template<typename Char>
-void Formatter<Char>::PutString(StrType& ret, const void* str, size_t len, StringType type, const OpaqueFormatSpec& spec)
+template<typename Out>
+void Formatter<Char>::PutString(Out& ret, const void* str, size_t len, StringType type, const OpaqueFormatSpec& spec)
 {
     //if (spec)
     {
@@ -687,7 +692,8 @@ void Formatter<Char>::PutString(StrType& ret, const void* str, size_t len, Strin
 }
 
 template<typename Char>
-void Formatter<Char>::PutInteger(StrType& ret, uint32_t val, bool isSigned, const OpaqueFormatSpec& spec)
+template<typename Out>
+void Formatter<Char>::PutInteger(Out& ret, uint32_t val, bool isSigned, const OpaqueFormatSpec& spec)
 {
     WrapSpec<Char> spec_(spec);
     const auto& fmtSpec = *spec_.Ptr;
@@ -696,7 +702,8 @@ void Formatter<Char>::PutInteger(StrType& ret, uint32_t val, bool isSigned, cons
     fmt::detail::write_int<Char>(std::back_inserter(ret), arg, fmtSpec);
 }
 template<typename Char>
-void Formatter<Char>::PutInteger(StrType& ret, uint64_t val, bool isSigned, const OpaqueFormatSpec& spec)
+template<typename Out>
+void Formatter<Char>::PutInteger(Out& ret, uint64_t val, bool isSigned, const OpaqueFormatSpec& spec)
 {
     WrapSpec<Char> spec_(spec);
     const auto& fmtSpec = *spec_.Ptr;
@@ -706,14 +713,16 @@ void Formatter<Char>::PutInteger(StrType& ret, uint64_t val, bool isSigned, cons
 }
 
 template<typename Char>
-void Formatter<Char>::PutFloat(StrType& ret, float  val, const OpaqueFormatSpec& spec)
+template<typename Out>
+void Formatter<Char>::PutFloat(Out& ret, float  val, const OpaqueFormatSpec& spec)
 {
     WrapSpec<Char> spec_(spec);
     const auto& fmtSpec = *spec_.Ptr;
     fmt::detail::write_float<Char>(std::back_inserter(ret), val, fmtSpec, {});
 }
 template<typename Char>
-void Formatter<Char>::PutFloat(StrType& ret, double val, const OpaqueFormatSpec& spec)
+template<typename Out>
+void Formatter<Char>::PutFloat(Out& ret, double val, const OpaqueFormatSpec& spec)
 {
     WrapSpec<Char> spec_(spec);
     const auto& fmtSpec = *spec_.Ptr;
@@ -721,7 +730,8 @@ void Formatter<Char>::PutFloat(StrType& ret, double val, const OpaqueFormatSpec&
 }
 
 template<typename Char>
-void Formatter<Char>::PutPointer(StrType& ret, uintptr_t val, const OpaqueFormatSpec& spec)
+template<typename Out>
+void Formatter<Char>::PutPointer(Out& ret, uintptr_t val, const OpaqueFormatSpec& spec)
 {
     WrapSpec<Char> spec_(spec);
     const auto& fmtSpec = *spec_.Ptr;
@@ -784,17 +794,20 @@ static StrVariant<char> ColorToStr(ScreenColor color, const FormatSpec* spec)
 
 
 template<typename Char>
-void Formatter<Char>::PutColor(StrType&, ScreenColor) {}
+template<typename Out>
+void Formatter<Char>::PutColor(Out&, ScreenColor) {}
 
 template<typename Char>
-void Formatter<Char>::PutColorStr(StrType& ret, ScreenColor color, const FormatSpec* spec)
+template<typename Out>
+void Formatter<Char>::PutColorStr(Out& ret, ScreenColor color, const FormatSpec* spec)
 {
     const auto txt = ColorToStr(color, spec);
     FormatterHelper::PutString(ret, txt.data(), txt.size(), nullptr);
 }
 
 template<typename Char>
-void Formatter<Char>::PutString(StrType& ret, const void* str, size_t len, StringType type, const FormatSpec* spec)
+template<typename Out>
+void Formatter<Char>::PutString(Out& ret, const void* str, size_t len, StringType type, const FormatSpec* spec)
 {
     if (spec)
     {
@@ -819,7 +832,8 @@ void Formatter<Char>::PutString(StrType& ret, const void* str, size_t len, Strin
 }
 
 template<typename Char>
-void Formatter<Char>::PutInteger(StrType& ret, uint32_t val, bool isSigned, const FormatSpec* spec)
+template<typename Out>
+void Formatter<Char>::PutInteger(Out& ret, uint32_t val, bool isSigned, const FormatSpec* spec)
 {
     const auto prefix = FormatterHelper::ProcessIntSign(val, isSigned, spec ? spec->SignFlag : FormatSpec::Sign::None);
     const fmt::detail::write_int_arg<uint32_t> arg{ val, prefix };
@@ -834,7 +848,8 @@ void Formatter<Char>::PutInteger(StrType& ret, uint32_t val, bool isSigned, cons
         fmt::detail::write_int<Char>(std::back_inserter(ret), arg, FormatterHelper::BaseFmtSpec);
 }
 template<typename Char>
-void Formatter<Char>::PutInteger(StrType& ret, uint64_t val, bool isSigned, const FormatSpec* spec)
+template<typename Out>
+void Formatter<Char>::PutInteger(Out& ret, uint64_t val, bool isSigned, const FormatSpec* spec)
 {
     const auto prefix = FormatterHelper::ProcessIntSign(val, isSigned, spec ? spec->SignFlag : FormatSpec::Sign::None);
     const fmt::detail::write_int_arg<uint64_t> arg{ val, prefix };
@@ -850,7 +865,8 @@ void Formatter<Char>::PutInteger(StrType& ret, uint64_t val, bool isSigned, cons
 }
 
 template<typename Char>
-void Formatter<Char>::PutFloat(StrType& ret, float val, const FormatSpec* spec)
+template<typename Out>
+void Formatter<Char>::PutFloat(Out& ret, float val, const FormatSpec* spec)
 {
     if (spec)
     {
@@ -864,7 +880,8 @@ void Formatter<Char>::PutFloat(StrType& ret, float val, const FormatSpec* spec)
         fmt::detail::write_float<Char>(std::back_inserter(ret), val, FormatterHelper::BaseFmtSpec, {});
 }
 template<typename Char>
-void Formatter<Char>::PutFloat(StrType& ret, double val, const FormatSpec* spec)
+template<typename Out>
+void Formatter<Char>::PutFloat(Out& ret, double val, const FormatSpec* spec)
 {
     if (spec)
     {
@@ -879,7 +896,8 @@ void Formatter<Char>::PutFloat(StrType& ret, double val, const FormatSpec* spec)
 }
 
 template<typename Char>
-void Formatter<Char>::PutPointer(StrType& ret, uintptr_t val, const FormatSpec* spec)
+template<typename Out>
+void Formatter<Char>::PutPointer(Out& ret, uintptr_t val, const FormatSpec* spec)
 {
     if (spec)
     {
@@ -911,13 +929,13 @@ constexpr auto GetDateStr() noexcept
         return ""sv;
 }
 
-template<typename Char>
-struct DateWriter : public fmt::detail::tm_writer<std::back_insert_iterator<std::basic_string<Char>>, Char, std::chrono::microseconds>
+template<typename Char, typename Out>
+struct DateWriter : public fmt::detail::tm_writer<std::back_insert_iterator<Out>, Char, std::chrono::microseconds>
 {
-    using TMT = fmt::detail::tm_writer<std::back_insert_iterator<std::basic_string<Char>>, Char, std::chrono::microseconds>;
+    using TMT = fmt::detail::tm_writer<std::back_insert_iterator<Out>, Char, std::chrono::microseconds>;
     const DateStructure& Date;
-    std::basic_string<Char>& Str;
-    DateWriter(const DateStructure& date, const std::chrono::microseconds* subsec, std::basic_string<Char>& ret) noexcept :
+    Out& Str;
+    DateWriter(const DateStructure& date, const std::chrono::microseconds* subsec, Out& ret) noexcept :
         TMT({}, std::back_inserter(ret), date.Base, subsec), Date(date), Str(ret)
     { }
 
@@ -954,7 +972,7 @@ struct DateWriter : public fmt::detail::tm_writer<std::back_insert_iterator<std:
             Str.append(Date.Zone.begin(), Date.Zone.end());
     }
     
-    static void Format(std::basic_string<Char>& ret, std::basic_string_view<Char> fmtStr, const DateStructure& date)
+    static void Format(Out& ret, std::basic_string_view<Char> fmtStr, const DateStructure& date)
     {
         if (fmtStr.empty())
             fmtStr = GetDateStr<Char>();
@@ -965,40 +983,48 @@ struct DateWriter : public fmt::detail::tm_writer<std::back_insert_iterator<std:
     }
 };
 
-template<typename Char>
-static forceinline void DirectPutDate(std::basic_string<Char>& ret, std::basic_string_view<Char> fmtStr, const DateStructure& date)
+template<typename Out>
+static forceinline void DirectPutDate(Out& ret, std::basic_string_view<typename Out::value_type> fmtStr, const DateStructure& date)
 {
+    using Char = typename Out::value_type;
 #if COMMON_OS_ANDROID || COMMON_OS_IOS // android's std::time_put is limited to char/wchar_t
     if constexpr (std::is_same_v<Char, char> || std::is_same_v<Char, wchar_t>)
     {
-        DateWriter<Char>::Format(ret, fmtStr, date);
+        DateWriter<Char, Out>::Format(ret, fmtStr, date);
+    }
+    else if constexpr (!std::is_same_v<Out, std::basic_string<Char>>)
+    {
+        std::basic_string<Char> tmp;
+        DirectPutDate(tmp, fmtStr, date);
+        ret.append(tmp.data(), tmp.size());
     }
     else if constexpr (sizeof(Char) == sizeof(wchar_t))
     {
-        DateWriter<wchar_t>::Format(*reinterpret_cast<std::wstring*>(&ret), *reinterpret_cast<std::wstring_view*>(&fmtStr), date);
+        DateWriter<wchar_t, std::wstring>::Format(*reinterpret_cast<std::wstring*>(&ret), *reinterpret_cast<std::wstring_view*>(&fmtStr), date);
     }
     else if constexpr (sizeof(Char) == sizeof(char))
     {
-        DateWriter<char>::Format(*reinterpret_cast<std::string*>(&ret), *reinterpret_cast<std::string_view*>(&fmtStr), date);
+        DateWriter<char, std::string>::Format(*reinterpret_cast<std::string*>(&ret), *reinterpret_cast<std::string_view*>(&fmtStr), date);
     }
     else
     {
         const auto fmtStr_ = to_string(fmtStr, Encoding::UTF8);
         std::string tmp;
-        DateWriter<char>::Format(tmp, fmtStr_, date);
+        DateWriter<char, std::string>::Format(tmp, fmtStr_, date);
         if constexpr (std::is_same_v<Char, char16_t>)
             ret.append(to_u16string(tmp, Encoding::UTF8));
         else
             ret.append(to_u32string(tmp, Encoding::UTF8));
     }
 #else
-    DateWriter<Char>::Format(ret, fmtStr, date);
+    DateWriter<Char, Out>::Format(ret, fmtStr, date);
 #endif
 }
 
 
 template<typename Char>
-void Formatter<Char>::PutDate(StrType& ret, const void* fmtStr, size_t len, StringType type, const DateStructure& date)
+template<typename Out>
+void Formatter<Char>::PutDate(Out& ret, const void* fmtStr, size_t len, StringType type, const DateStructure& date)
 {
     switch (type)
     {
@@ -1047,11 +1073,18 @@ void Formatter<Char>::PutDate(StrType& ret, const void* fmtStr, size_t len, Stri
 template<typename Char>
 void Formatter<Char>::FormatToDynamic_(std::basic_string<Char>& dst, std::basic_string_view<Char> format, const ArgInfo& argInfo, span<const uint16_t> argStore)
 {
-    const auto result = FormatterParser::ParseString<Char>(format);
-    ParseResultBase::CheckErrorRuntime(result.ErrorPos, result.ErrorNum);
-    const auto res = result.ToInfo(format);
-    const auto mapping = ArgChecker::CheckDD(res, argInfo);
-    FormatTo(dst, res, argInfo, argStore, mapping);
+    if (format.empty())
+        return;
+    const auto cached = FormatStringCache<Char>::Get(format, argInfo);
+    FormatTo(dst, cached.StrInfo.ToStrArgInfo(), argInfo, argStore, cached.Mapping);
+}
+template<typename Char>
+void Formatter<Char>::FormatToDynamic_(FormatSink<Char>& sink, std::basic_string_view<Char> format, const ArgInfo& argInfo, span<const uint16_t> argStore)
+{
+    if (format.empty())
+        return;
+    const auto cached = FormatStringCache<Char>::Get(format, argInfo);
+    FormatTo(sink, cached.StrInfo.ToStrArgInfo(), argInfo, argStore, cached.Mapping);
 }
 
 
@@ -1354,11 +1387,11 @@ struct FormatCookie
 };
 
 
-template<typename Char>
-forceinline static void OnCustomArg(std::basic_string<Char>& dst, const detail::FmtWithPair& fmtPair, const FormatSpec* spec)
+template<typename Char, typename Out>
+forceinline static void OnCustomArg(Out& dst, const detail::FmtWithPair& fmtPair, const FormatSpec* spec)
 {
-    DirectHost<Char> host;
-    typename DirectHost<Char>::Context context{ dst };
+    DirectHost<Char, Out> host;
+    typename DirectHost<Char, Out>::Context context{ dst };
     fmtPair.Executor(fmtPair.Data, host, context, spec);
 }
 template<typename Char>
@@ -1400,10 +1433,11 @@ forceinline static DateStructure GetDate(ArgRealType argType, const uint16_t* ar
     }
     return date;
 }
-template<typename Char>
-forcenoinline static void PutDate(Formatter<Char>& fmter, std::basic_string<Char>& dst, std::basic_string_view<Char> fmtStr, ArgRealType argType, const uint16_t* argPtr)
+template<typename Char, typename Out>
+forcenoinline static void PutDate(Formatter<Char>& fmter, Out& dst, std::basic_string_view<Char> fmtStr, ArgRealType argType, const uint16_t* argPtr)
 {
-    fmter.PutDate(dst, fmtStr, GetDate(argType, argPtr));
+    constexpr auto StrType = sizeof(Char) == 1 ? StringType::UTF8 : (sizeof(Char) == 2 ? StringType::UTF16 : StringType::UTF32);
+    fmter.PutDate(dst, fmtStr.data(), fmtStr.size(), StrType, GetDate(argType, argPtr));
 }
 template<typename Char, typename Ctx>
 forcenoinline static void PutDate(FormatterHost& host, Ctx& ctx, std::basic_string_view<Char> fmtStr, ArgRealType argType, const uint16_t* argPtr)
@@ -1561,8 +1595,8 @@ inline static void UniversalOnArg(const StrArgInfoCh<Char>& strInfo, const ArgIn
                 const auto& pair = *reinterpret_cast<const detail::FmtWithPair*>(argPtr);
                 if constexpr (std::is_base_of_v<Formatter<Char>, std::decay_t<Host>>)
                 {
-                    static_assert(std::is_same_v<std::basic_string<Char>, Ctx>);
-                    OnCustomArg(ctx, pair, spec);
+                    static_assert(std::is_same_v<typename Ctx::value_type, Char>);
+                    OnCustomArg<Char>(ctx, pair, spec);
                 }
                 else
                 {
@@ -1642,19 +1676,23 @@ inline static void UniversalOnArg(const StrArgInfoCh<Char>& strInfo, const ArgIn
 }
 
 
-template<typename Char>
-void BasicExecutor<Char>::OnArg(FormatterContext& ctx, uint8_t argIdx, bool isNamed, const uint8_t* spec)
+template<typename Char, typename Out>
+void BasicExecutor<Char, Out>::OnArg(FormatterContext& ctx, uint8_t argIdx, bool isNamed, const uint8_t* spec)
 {
     auto& context = static_cast<Context&>(ctx);
     UniversalOnArg<Char>(context.StrInfo, context.TheArgInfo, context.ArgStore.data(), context.Mapping, *this, ctx, spec, argIdx, isNamed);
 }
-template SYSCOMMONTPL void BasicExecutor<char>    ::OnArg(FormatterContext& context, uint8_t argIdx, bool isNamed, const uint8_t* spec);
-template SYSCOMMONTPL void BasicExecutor<wchar_t> ::OnArg(FormatterContext& context, uint8_t argIdx, bool isNamed, const uint8_t* spec);
-template SYSCOMMONTPL void BasicExecutor<char16_t>::OnArg(FormatterContext& context, uint8_t argIdx, bool isNamed, const uint8_t* spec);
-template SYSCOMMONTPL void BasicExecutor<char32_t>::OnArg(FormatterContext& context, uint8_t argIdx, bool isNamed, const uint8_t* spec);
+#define BASIC_EXECUTOR_INST(Char)                                                                                                         \
+template SYSCOMMONTPL void BasicExecutor<Char>::OnArg(FormatterContext& context, uint8_t argIdx, bool isNamed, const uint8_t* spec);      \
+template SYSCOMMONTPL void BasicExecutor<Char, SinkBuffer<Char>>::OnArg(FormatterContext& context, uint8_t argIdx, bool isNamed, const uint8_t* spec);
+BASIC_EXECUTOR_INST(char)
+BASIC_EXECUTOR_INST(wchar_t)
+BASIC_EXECUTOR_INST(char16_t)
+BASIC_EXECUTOR_INST(char32_t)
 #if defined(__cpp_char8_t) && __cpp_char8_t >= 201811L
-template SYSCOMMONTPL void BasicExecutor<char8_t> ::OnArg(FormatterContext& context, uint8_t argIdx, bool isNamed, const uint8_t* spec);
+BASIC_EXECUTOR_INST(char8_t)
 #endif
+#undef BASIC_EXECUTOR_INST
 
 
 bool FormatSpecCacher::Cache(const StrArgInfo& strInfo, const ArgInfo& argInfo, const NamedMapper& mapper) noexcept
@@ -1700,14 +1738,14 @@ bool FormatSpecCacher::Cache(const StrArgInfo& strInfo, const ArgInfo& argInfo,
     return true;
 }
 
-template<typename Char>
-void FormatSpecCacherCh<Char>::FormatTo(std::basic_string<Char>& dst, span<const uint16_t> argStore)
+template<typename Char, typename Out>
+static void FormatCachedTo(const FormatSpecCacherCh<Char>& cache, Out& dst, span<const uint16_t> argStore)
 {
     struct RecordedSpecExecutor final : public Formatter<Char>
     {
         struct Context
         {
-            std::basic_string<Char>& Dst;
+            Out& Dst;
             span<const uint16_t> ArgStore;
         };
         const FormatSpecCacherCh<Char>& Cache;
@@ -1742,16 +1780,181 @@ void FormatSpecCacherCh<Char>::FormatTo(std::basic_string<Char>& dst, span<const
         constexpr RecordedSpecExecutor(const FormatSpecCacherCh<Char>& cache) noexcept : Cache(cache) {}
     };
     typename RecordedSpecExecutor::Context context{ dst, argStore };
-    RecordedSpecExecutor executor{ *this };
-    auto opcodes = StrInfo.Opcodes;
+    RecordedSpecExecutor executor{ cache };
+    auto opcodes = cache.StrInfo.Opcodes;
     FormatExecute(opcodes, executor, context);
 }
-template SYSCOMMONTPL void FormatSpecCacherCh<char>    ::FormatTo(std::basic_string<char>    & dst, span<const uint16_t> argStore);
-template SYSCOMMONTPL void FormatSpecCacherCh<wchar_t> ::FormatTo(std::basic_string<wchar_t> & dst, span<const uint16_t> argStore);
-template SYSCOMMONTPL void FormatSpecCacherCh<char16_t>::FormatTo(std::basic_string<char16_t>& dst, span<const uint16_t> argStore);
-template SYSCOMMONTPL void FormatSpecCacherCh<char32_t>::FormatTo(std::basic_string<char32_t>& dst, span<const uint16_t> argStore);
+template<typename Char>
+void FormatSpecCacherCh<Char>::FormatTo(std::basic_string<Char>& dst, span<const uint16_t> argStore)
+{
+    FormatCachedTo(*this, dst, argStore);
+}
+template<typename Char>
+void FormatSpecCacherCh<Char>::FormatTo(FormatSink<Char>& sink, span<const uint16_t> argStore)
+{
+    SinkBuffer<Char> dst(sink);
+    FormatCachedTo(*this, dst, argStore);
+    dst.Flush();
+}
+#define SPEC_CACHER_INST(Char)                                                                                  \
+template SYSCOMMONTPL void FormatSpecCacherCh<Char>::FormatTo(std::basic_string<Char>& dst, span<const uint16_t> argStore); \
+template SYSCOMMONTPL void FormatSpecCacherCh<Char>::FormatTo(FormatSink<Char>& sink, span<const uint16_t> argStore);
+SPEC_CACHER_INST(char)
+SPEC_CACHER_INST(wchar_t)
+SPEC_CACHER_INST(char16_t)
+SPEC_CACHER_INST(char32_t)
 #if defined(__cpp_char8_t) && __cpp_char8_t >= 201811L
-template SYSCOMMONTPL void FormatSpecCacherCh<char8_t> ::FormatTo(std::basic_string<char8_t> & dst, span<const uint16_t> argStore);
+SPEC_CACHER_INST(char8_t)
+#endif
+#undef SPEC_CACHER_INST
+
+
+template<typename Char>
+struct FormatStringCacheData
+{
+    struct Entry
+    {
+        DynamicTrimedResultCh<Char> StrInfo;
+        std::basic_string_view<Char> Key; // points to string inside StrInfo
+        // checked against index-only args
+        ArgRealType IndexTypes[ParseResultCommon::IdxArgSlots] = { ArgRealType::Error };
+        uint8_t IdxArgCount = 0;
+        bool HasChecked = false;
+        std::atomic_bool Referenced = true;
+        Entry(DynamicTrimedResultCh<Char>&& strInfo) noexcept : StrInfo(std::move(strInfo)), 
+            Key(StrInfo.ToStrArgInfo().FormatString) { }
+        [[nodiscard]] bool MatchArgs(const ArgInfo& argInfo) const noexcept
+        {
+            return HasChecked && argInfo.NamedArgCount == 0 && argInfo.IdxArgCount == IdxArgCount &&
+                std::equal(IndexTypes, IndexTypes + IdxArgCount, argInfo.IndexTypes);
+        }
+    };
+    std::shared_mutex Lock;
+    std::unordered_map<std::basic_string_view<Char>, std::unique_ptr<Entry>> Map;
+    std::vector<Entry*> Ring; // for clock eviction
+    size_t Hand = 0;
+    size_t Capacity = FormatStringCache<Char>::DefaultCapacity;
+    std::atomic<uint64_t> Hits = 0, Misses = 0;
+
+    // need to hold unique lock
+    Entry& Insert(std::unique_ptr<Entry> entry)
+    {
+        auto& ret = *entry;
+        if (Ring.size() < Capacity)
+            Ring.push_back(&ret);
+        else
+        {
+            while (true) // second chance for recently used ones
+            {
+                auto& victim = Ring[Hand];
+                if (!victim->Referenced.exchange(false, std::memory_order_relaxed))
+                {
+                    Map.erase(victim->Key);
+                    victim = &ret;
+                    Hand = (Hand + 1) % Ring.size();
+                    break;
+                }
+                Hand = (Hand + 1) % Ring.size();
+            }
+        }
+        const auto key = ret.Key;
+        Map.insert_or_assign(key, std::move(entry));
+        return ret;
+    }
+    static FormatStringCacheData& Get() noexcept
+    {
+        static FormatStringCacheData Data;
+        return Data;
+    }
+};
+
+template<typename Char>
+typename FormatStringCache<Char>::Result FormatStringCache<Char>::Get(std::basic_string_view<Char> format, const ArgInfo& argInfo)
+{
+    Expects(!format.empty());
+    using Entry = typename FormatStringCacheData<Char>::Entry;
+    auto& data = FormatStringCacheData<Char>::Get();
+    {
+        std::shared_lock<std::shared_mutex> lock(data.Lock);
+        if (const auto it = data.Map.find(format); it != data.Map.end())
+        {
+            data.Hits.fetch_add(1, std::memory_order_relaxed);
+            auto& entry = *it->second;
+            entry.Referenced.store(true, std::memory_order_relaxed);
+            if (entry.MatchArgs(argInfo))
+                return { entry.StrInfo, ArgChecker::EmptyMapper };
+            Result ret{ entry.StrInfo, {} };
+            lock.unlock();
+            ret.Mapping = ArgChecker::CheckDD(ret.StrInfo.ToStrArgInfo(), argInfo);
+            if (argInfo.NamedArgCount == 0)
+            {
+                std::unique_lock<std::shared_mutex> lock2(data.Lock);
+                // entry may be evicted in between
+                if (const auto it2 = data.Map.find(format); it2 != data.Map.end() && !it2->second->HasChecked)
+                {
+                    auto& entry2 = *it2->second;
+                    std::copy_n(argInfo.IndexTypes, argInfo.IdxArgCount, entry2.IndexTypes);
+                    entry2.IdxArgCount = argInfo.IdxArgCount;
+                    entry2.HasChecked = true;
+                }
+            }
+            return ret;
+        }
+    }
+    data.Misses.fetch_add(1, std::memory_order_relaxed);
+    const auto result = FormatterParser::ParseString<Char>(format);
+    ParseResultBase::CheckErrorRuntime(result.ErrorPos, result.ErrorNum);
+    auto entry = std::make_unique<Entry>(DynamicTrimedResultCh<Char>(result, format));
+    const auto mapping = ArgChecker::CheckDD(entry->StrInfo.ToStrArgInfo(), argInfo);
+    if (argInfo.NamedArgCount == 0)
+    {
+        std::copy_n(argInfo.IndexTypes, argInfo.IdxArgCount, entry->IndexTypes);
+        entry->IdxArgCount = argInfo.IdxArgCount;
+        entry->HasChecked = true;
+    }
+    Result ret{ entry->StrInfo, mapping };
+    std::unique_lock<std::shared_mutex> lock(data.Lock);
+    if (data.Capacity > 0 && data.Map.find(format) == data.Map.end())
+        data.Insert(std::move(entry));
+    return ret;
+}
+template<typename Char>
+void FormatStringCache<Char>::SetCapacity(size_t capacity)
+{
+    auto& data = FormatStringCacheData<Char>::Get();
+    std::unique_lock<std::shared_mutex> lock(data.Lock);
+    data.Capacity = capacity;
+    if (data.Ring.size() > capacity)
+    {
+        data.Map.clear();
+        data.Ring.clear();
+        data.Hand = 0;
+    }
+}
+template<typename Char>
+void FormatStringCache<Char>::Clear()
+{
+    auto& data = FormatStringCacheData<Char>::Get();
+    std::unique_lock<std::shared_mutex> lock(data.Lock);
+    data.Map.clear();
+    data.Ring.clear();
+    data.Hand = 0;
+    data.Hits = 0;
+    data.Misses = 0;
+}
+template<typename Char>
+typename FormatStringCache<Char>::Stats FormatStringCache<Char>::GetStats() noexcept
+{
+    auto& data = FormatStringCacheData<Char>::Get();
+    std::shared_lock<std::shared_mutex> lock(data.Lock);
+    return { data.Hits.load(std::memory_order_relaxed), data.Misses.load(std::memory_order_relaxed), data.Map.size() };
+}
+template class FormatStringCache<char>;
+template class FormatStringCache<wchar_t>;
+template class FormatStringCache<char16_t>;
+template class FormatStringCache<char32_t>;
+#if defined(__cpp_char8_t) && __cpp_char8_t >= 201811L
+template class FormatStringCache<char8_t>;
 #endif
 
 
@@ -1800,14 +2003,14 @@ template SYSCOMMONTPL void FormatterBase::NestedExecute(FormatterHost& host, For
 #endif
 
 
-template<typename Char>
-void Formatter<Char>::FormatTo(std::basic_string<Char>& ret, const StrArgInfoCh<Char>& strInfo, const ArgInfo& argInfo, span<const uint16_t> argStore, const NamedMapper& mapping)
+template<typename Char, typename Out>
+static void StaticFormatTo(Out& ret, const StrArgInfoCh<Char>& strInfo, const ArgInfo& argInfo, span<const uint16_t> argStore, const NamedMapper& mapping)
 {
     struct StaticExecutor
     {
         struct Context
         {
-            std::basic_string<Char>& Dst;
+            Out& Dst;
             const StrArgInfoCh<Char>& StrInfo;
             const ArgInfo& TheArgInfo;
             span<const uint16_t> ArgStore;
@@ -1837,29 +2040,56 @@ void Formatter<Char>::FormatTo(std::basic_string<Char>& ret, const StrArgInfoCh<
     auto opcodes = strInfo.Opcodes;
     FormatExecute(opcodes, executor, context);
 }
-
 template<typename Char>
-DirectHost<Char>::~DirectHost() {}
+void Formatter<Char>::FormatTo(std::basic_string<Char>& ret, const StrArgInfoCh<Char>& strInfo, const ArgInfo& argInfo, span<const uint16_t> argStore, const NamedMapper& mapping)
+{
+    StaticFormatTo(ret, strInfo, argInfo, argStore, mapping);
+}
 template<typename Char>
-DirectExecutor<Char>::~DirectExecutor() {}
-
-template struct Formatter<char>;
-template struct Formatter<wchar_t>;
-template struct Formatter<char16_t>;
-template struct Formatter<char32_t>;
-template SYSCOMMONTPL DirectHost<char    >::~DirectHost();
-template SYSCOMMONTPL DirectHost<wchar_t >::~DirectHost();
-template SYSCOMMONTPL DirectHost<char16_t>::~DirectHost();
-template SYSCOMMONTPL DirectHost<char32_t>::~DirectHost();
-template SYSCOMMONTPL DirectExecutor<char    >::~DirectExecutor();
-template SYSCOMMONTPL DirectExecutor<wchar_t >::~DirectExecutor();
-template SYSCOMMONTPL DirectExecutor<char16_t>::~DirectExecutor();
-template SYSCOMMONTPL DirectExecutor<char32_t>::~DirectExecutor();
+void Formatter<Char>::FormatTo(FormatSink<Char>& sink, const StrArgInfoCh<Char>& strInfo, const ArgInfo& argInfo, span<const uint16_t> argStore, const NamedMapper& mapping)
+{
+    SinkBuffer<Char> ret(sink);
+    StaticFormatTo(ret, strInfo, argInfo, argStore, mapping);
+    ret.Flush();
+}
+
+template<typename Char, typename Out>
+DirectHost<Char, Out>::~DirectHost() {}
+template<typename Char, typename Out>
+DirectExecutor<Char, Out>::~DirectExecutor() {}
+
+#define FORMATTER_OUT_INST(Char, Out)                                                                                                           \
+template SYSCOMMONTPL void Formatter<Char>::PutString (Out& ret, const void* str, size_t len, StringType type, const OpaqueFormatSpec& spec);   \
+template SYSCOMMONTPL void Formatter<Char>::PutInteger(Out& ret, uint32_t val, bool isSigned, const OpaqueFormatSpec& spec);                   \
+template SYSCOMMONTPL void Formatter<Char>::PutInteger(Out& ret, uint64_t val, bool isSigned, const OpaqueFormatSpec& spec);                   \
+template SYSCOMMONTPL void Formatter<Char>::PutFloat  (Out& ret, float  val, const OpaqueFormatSpec& spec);                                    \
+template SYSCOMMONTPL void Formatter<Char>::PutFloat  (Out& ret, double val, const OpaqueFormatSpec& spec);                                    \
+template SYSCOMMONTPL void Formatter<Char>::PutPointer(Out& ret, uintptr_t val, const OpaqueFormatSpec& spec);                                 \
+template SYSCOMMONTPL void Formatter<Char>::PutColorStr(Out& ret, ScreenColor color, const FormatSpec* spec);                                  \
+template SYSCOMMONTPL void Formatter<Char>::PutString (Out& ret, const void* str, size_t len, StringType type, const FormatSpec* spec);         \
+template SYSCOMMONTPL void Formatter<Char>::PutInteger(Out& ret, uint32_t val, bool isSigned, const FormatSpec* spec);                         \
+template SYSCOMMONTPL void Formatter<Char>::PutInteger(Out& ret, uint64_t val, bool isSigned, const FormatSpec* spec);                         \
+template SYSCOMMONTPL void Formatter<Char>::PutFloat  (Out& ret, float  val, const FormatSpec* spec);                                          \
+template SYSCOMMONTPL void Formatter<Char>::PutFloat  (Out& ret, double val, const FormatSpec* spec);                                          \
+template SYSCOMMONTPL void Formatter<Char>::PutPointer(Out& ret, uintptr_t val, const FormatSpec* spec);                                       \
+template SYSCOMMONTPL void Formatter<Char>::PutColor  (Out& ret, ScreenColor color);                                                          \
+template SYSCOMMONTPL void Formatter<Char>::PutDate   (Out& ret, const void* fmtStr, size_t len, StringType type, const DateStructure& date);  \
+template SYSCOMMONTPL DirectHost<Char, Out>::~DirectHost();                                                                                    \
+template SYSCOMMONTPL DirectExecutor<Char, Out>::~DirectExecutor();
+#define FORMATTER_INST(Char)                                \
+template struct Formatter<Char>;                            \
+FORMATTER_OUT_INST(Char, std::basic_string<Char>)           \
+FORMATTER_OUT_INST(Char, SinkBuffer<Char>)
+
+FORMATTER_INST(char)
+FORMATTER_INST(wchar_t)
+FORMATTER_INST(char16_t)
+FORMATTER_INST(char32_t)
 #if defined(__cpp_char8_t) && __cpp_char8_t >= 201811L
-template struct Formatter<char8_t>;
-template SYSCOMMONTPL DirectHost<char8_t>::~DirectHost();
-template SYSCOMMONTPL DirectExecutor<char8_t>::~DirectExecutor();
+FORMATTER_INST(char8_t)
 #endif
+#undef FORMATTER_INST
+#undef FORMATTER_OUT_INST
 
 
 }
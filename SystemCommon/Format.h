@@ -2433,6 +2433,161 @@ struct ArgChecker
 };
 
 
+template<typename Char>
+struct FormatSink
+{
+    virtual ~FormatSink() {}
+    virtual void Write(std::basic_string_view<Char> str) = 0;
+};
+
+// write into caller-provided buffer, content exceeding the buffer is dropped but still counted
+template<typename Char>
+struct SpanSink final : public FormatSink<Char>
+{
+    span<Char> Buffer;
+    size_t Written = 0;
+    size_t Required = 0;
+    constexpr SpanSink(span<Char> buffer) noexcept : Buffer(buffer) { }
+    void Write(std::basic_string_view<Char> str) override
+    {
+        const auto count = std::min(str.size(), Buffer.size() - Written);
+        std::char_traits<Char>::copy(Buffer.data() + Written, str.data(), count);
+        Written  += count;
+        Required += str.size();
+    }
+    [[nodiscard]] constexpr bool IsTruncated() const noexcept { return Required > Written; }
+    [[nodiscard]] constexpr std::basic_string_view<Char> View() const noexcept { return { Buffer.data(), Written }; }
+};
+
+// write into inline buffer, spill into heap string when exceeded
+template<typename Char, size_t N>
+struct StackSink final : public FormatSink<Char>
+{
+    Char Buffer[N];
+    size_t Size = 0;
+    std::basic_string<Char> Spill;
+    void Write(std::basic_string_view<Char> str) override
+    {
+        IF_LIKELY(Spill.empty() && Size + str.size() <= N)
+        {
+            std::char_traits<Char>::copy(Buffer + Size, str.data(), str.size());
+            Size += str.size();
+            return;
+        }
+        if (Spill.empty())
+        {
+            Spill.reserve(std::max(N * 2, Size + str.size()));
+            Spill.assign(Buffer, Size);
+        }
+        Spill.append(str);
+    }
+    [[nodiscard]] constexpr bool IsSpilled() const noexcept { return !Spill.empty(); }
+    [[nodiscard]] constexpr std::basic_string_view<Char> View() const noexcept
+    {
+        if (!Spill.empty())
+            return Spill;
+        return { Buffer, Size };
+    }
+    void Clear() noexcept
+    {
+        Size = 0;
+        Spill.clear();
+    }
+};
+
+template<typename Char, typename It>
+struct IteratorSink final : public FormatSink<Char>
+{
+    It Output;
+    constexpr IteratorSink(It output) noexcept(std::is_nothrow_move_constructible_v<It>) : Output(std::move(output)) { }
+    void Write(std::basic_string_view<Char> str) override
+    {
+        for (const auto ch : str)
+            *Output++ = ch;
+    }
+};
+template<typename Char, typename It>
+[[nodiscard]] constexpr IteratorSink<Char, It> MakeIteratorSink(It output)
+{
+    return IteratorSink<Char, It>(std::move(output));
+}
+
+// string-like output for Formatter's primitives, batches small writes into a local buffer before passing them to the sink.
+// Flush should be called after formatting finished
+template<typename Char>
+class SinkBuffer
+{
+private:
+    static constexpr size_t Capacity = 256;
+    FormatSink<Char>& Sink;
+    size_t Flushed = 0;
+    size_t Size = 0;
+    Char Buffer[Capacity];
+public:
+    using value_type = Char;
+    explicit SinkBuffer(FormatSink<Char>& sink) noexcept : Sink(sink) { }
+    COMMON_NO_COPY(SinkBuffer)
+    COMMON_NO_MOVE(SinkBuffer)
+    void Flush()
+    {
+        if (Size > 0)
+        {
+            Sink.Write({ Buffer, Size });
+            Flushed += Size;
+            Size = 0;
+        }
+    }
+    // total count of chars written, including the buffered ones
+    [[nodiscard]] constexpr size_t size() const noexcept { return Flushed + Size; }
+    void push_back(Char ch)
+    {
+        IF_UNLIKELY(Size == Capacity)
+            Flush();
+        Buffer[Size++] = ch;
+    }
+    void append(const Char* str, size_t len)
+    {
+        IF_LIKELY(Size + len <= Capacity)
+        {
+            std::char_traits<Char>::copy(Buffer + Size, str, len);
+            Size += len;
+            return;
+        }
+        Flush();
+        if (len >= Capacity) // write through
+        {
+            Sink.Write({ str, len });
+            Flushed += len;
+        }
+        else
+        {
+            std::char_traits<Char>::copy(Buffer, str, len);
+            Size = len;
+        }
+    }
+    void append(std::basic_string_view<Char> str)
+    {
+        append(str.data(), str.size());
+    }
+    void append(size_t count, Char ch)
+    {
+        for (size_t i = 0; i < count; ++i)
+            push_back(ch);
+    }
+    template<typename It>
+    void append(It first, It last)
+    {
+        if constexpr (std::is_same_v<std::decay_t<It>, const Char*> || std::is_same_v<std::decay_t<It>, Char*>)
+            append(first, static_cast<size_t>(last - first));
+        else
+        {
+            for (; first != last; ++first)
+                push_back(static_cast<Char>(*first));
+        }
+    }
+};
+
+
 template<typename Char>
 struct Formatter;
 struct FormatterBase
@@ -2528,49 +2683,50 @@ struct Formatter : public DateFormatter<Formatter<Char>, std::basic_string<Char>
 {
     using StrType = std::basic_string<Char>;
 public:
-    SYSCOMMONAPI static void PutString(StrType& ret, const void* str, size_t len, StringType type, const OpaqueFormatSpec& spec);
-    SYSCOMMONAPI static void PutInteger(StrType& ret, uint32_t val, bool isSigned, const OpaqueFormatSpec& spec);
-    SYSCOMMONAPI static void PutInteger(StrType& ret, uint64_t val, bool isSigned, const OpaqueFormatSpec& spec);
-    SYSCOMMONAPI static void PutFloat(StrType& ret, float  val, const OpaqueFormatSpec& spec);
-    SYSCOMMONAPI static void PutFloat(StrType& ret, double val, const OpaqueFormatSpec& spec);
-    SYSCOMMONAPI static void PutPointer(StrType& ret, uintptr_t val, const OpaqueFormatSpec& spec);
+    // Out is either StrType or SinkBuffer<Char>, both are instantiated
+    template<typename Out> SYSCOMMONAPI static void PutString(Out& ret, const void* str, size_t len, StringType type, const OpaqueFormatSpec& spec);
+    template<typename Out> SYSCOMMONAPI static void PutInteger(Out& ret, uint32_t val, bool isSigned, const OpaqueFormatSpec& spec);
+    template<typename Out> SYSCOMMONAPI static void PutInteger(Out& ret, uint64_t val, bool isSigned, const OpaqueFormatSpec& spec);
+    template<typename Out> SYSCOMMONAPI static void PutFloat(Out& ret, float  val, const OpaqueFormatSpec& spec);
+    template<typename Out> SYSCOMMONAPI static void PutFloat(Out& ret, double val, const OpaqueFormatSpec& spec);
+    template<typename Out> SYSCOMMONAPI static void PutPointer(Out& ret, uintptr_t val, const OpaqueFormatSpec& spec);
 
-    SYSCOMMONAPI static void PutColorStr(StrType& ret, ScreenColor color, const FormatSpec* spec);
+    template<typename Out> SYSCOMMONAPI static void PutColorStr(Out& ret, ScreenColor color, const FormatSpec* spec);
 
-    SYSCOMMONAPI static void PutString(StrType& ret, const void* str, size_t len, StringType type, const FormatSpec* spec);
-    SYSCOMMONAPI static void PutInteger(StrType& ret, uint32_t val, bool isSigned, const FormatSpec* spec);
-    SYSCOMMONAPI static void PutInteger(StrType& ret, uint64_t val, bool isSigned, const FormatSpec* spec);
-    SYSCOMMONAPI static void PutFloat(StrType& ret, float  val, const FormatSpec* spec);
-    SYSCOMMONAPI static void PutFloat(StrType& ret, double val, const FormatSpec* spec);
-    SYSCOMMONAPI static void PutPointer(StrType& ret, uintptr_t val, const FormatSpec* spec);
+    template<typename Out> SYSCOMMONAPI static void PutString(Out& ret, const void* str, size_t len, StringType type, const FormatSpec* spec);
+    template<typename Out> SYSCOMMONAPI static void PutInteger(Out& ret, uint32_t val, bool isSigned, const FormatSpec* spec);
+    template<typename Out> SYSCOMMONAPI static void PutInteger(Out& ret, uint64_t val, bool isSigned, const FormatSpec* spec);
+    template<typename Out> SYSCOMMONAPI static void PutFloat(Out& ret, float  val, const FormatSpec* spec);
+    template<typename Out> SYSCOMMONAPI static void PutFloat(Out& ret, double val, const FormatSpec* spec);
+    template<typename Out> SYSCOMMONAPI static void PutPointer(Out& ret, uintptr_t val, const FormatSpec* spec);
 
-    SYSCOMMONAPI static void PutColor(StrType& ret, ScreenColor color);
-    SYSCOMMONAPI static void PutDate(StrType& ret, const void* fmtStr, size_t len, StringType type, const DateStructure& date);
+    template<typename Out> SYSCOMMONAPI static void PutColor(Out& ret, ScreenColor color);
+    template<typename Out> SYSCOMMONAPI static void PutDate(Out& ret, const void* fmtStr, size_t len, StringType type, const DateStructure& date);
 
 
-    template<typename Spec>
-    forceinline static void PutString(StrType& ret, ::std::string_view str, const Spec& spec)
+    template<typename Out, typename Spec>
+    forceinline static void PutString(Out& ret, ::std::string_view str, const Spec& spec)
     {
         PutString(ret, str.data(), str.size(), StringType::UTF8, spec);
     }
-    template<typename Spec>
-    forceinline static void PutString(StrType& ret, ::std::wstring_view str, const Spec& spec)
+    template<typename Out, typename Spec>
+    forceinline static void PutString(Out& ret, ::std::wstring_view str, const Spec& spec)
     {
         PutString(ret, str.data(), str.size(), sizeof(wchar_t) == sizeof(char16_t) ? StringType::UTF16 : StringType::UTF32, spec);
     }
-    template<typename Spec>
-    forceinline static void PutString(StrType& ret, ::std::u16string_view str, const Spec& spec)
+    template<typename Out, typename Spec>
+    forceinline static void PutString(Out& ret, ::std::u16string_view str, const Spec& spec)
     {
         PutString(ret, str.data(), str.size(), StringType::UTF16, spec);
     }
-    template<typename Spec>
-    forceinline static void PutString(StrType& ret, ::std::u32string_view str, const Spec& spec)
+    template<typename Out, typename Spec>
+    forceinline static void PutString(Out& ret, ::std::u32string_view str, const Spec& spec)
     {
         PutString(ret, str.data(), str.size(), StringType::UTF32, spec);
     }
 #if defined(__cpp_char8_t) && __cpp_char8_t >= 201811L
-    template<typename Spec>
-    forceinline static void PutString(StrType& ret, ::std::u8string_view str, const Spec& spec)
+    template<typename Out, typename Spec>
+    forceinline static void PutString(Out& ret, ::std::u8string_view str, const Spec& spec)
     {
         PutString(ret, str.data(), str.size(), StringType::UTF8, spec);
     }
@@ -2609,6 +2765,36 @@ public:
         FormatToDynamic(ret, format, std::forward<Args>(args)...);
         return ret;
     }
+    // content is written into sink through a small local buffer, no intermediate string is involved
+    template<typename T, typename... Args>
+    forceinline void FormatToStatic(FormatSink<Char>& sink, const T&, Args&&... args)
+    {
+        static_assert(std::is_same_v<typename std::decay_t<T>::CharType, Char>);
+        static constexpr auto Mapping = ArgChecker::CheckSS<T, Args...>();
+        static constexpr T StrInfo;
+        static constexpr auto ArgsInfo = ArgInfo::ParseArgs<Args...>();
+        const auto argStore = ArgInfo::PackArgsStatic(std::forward<Args>(args)...);
+        FormatTo(sink, StrInfo, ArgsInfo, argStore.ArgStore, Mapping);
+    }
+    template<typename... Args>
+    forceinline void FormatToDynamic(FormatSink<Char>& sink, std::basic_string_view<Char> format, Args&&... args)
+    {
+        static constexpr auto ArgsInfo = ArgInfo::ParseArgs<Args...>();
+        const auto argStore = ArgInfo::PackArgsStatic(std::forward<Args>(args)...);
+        FormatToDynamic_(sink, format, ArgsInfo, argStore.ArgStore);
+    }
+    // size of formatted content, can be used to prepare buffer for SpanSink
+    template<typename T, typename... Args>
+    [[nodiscard]] forceinline size_t FormattedSize(const T& res, Args&&... args)
+    {
+        struct CountSink final : public FormatSink<Char>
+        {
+            size_t Count = 0;
+            void Write(std::basic_string_view<Char> str) override { Count += str.size(); }
+        } sink;
+        FormatToStatic(sink, res, std::forward<Args>(args)...);
+        return sink.Count;
+    }
     template<typename T>
     forceinline void DirectFormatTo(std::basic_string<Char>& dst, const T& target, const FormatSpec* spec = nullptr)
     {
@@ -2625,9 +2811,11 @@ public:
         return ret;
     }
     SYSCOMMONAPI void FormatTo(std::basic_string<Char>& ret, const StrArgInfoCh<Char>& strInfo, const ArgInfo& argInfo, span<const uint16_t> argStore, const NamedMapper& mapping);
+    SYSCOMMONAPI void FormatTo(FormatSink<Char>& sink, const StrArgInfoCh<Char>& strInfo, const ArgInfo& argInfo, span<const uint16_t> argStore, const NamedMapper& mapping);
 private:
     SYSCOMMONAPI void DirectFormatTo_(std::basic_string<Char>& dst, const detail::FmtWithPair& fmtPair, const FormatSpec* spec);
     SYSCOMMONAPI void FormatToDynamic_(std::basic_string<Char>& dst, std::basic_string_view<Char> format, const ArgInfo& argInfo, span<const uint16_t> argStore);
+    SYSCOMMONAPI void FormatToDynamic_(FormatSink<Char>& sink, std::basic_string_view<Char> format, const ArgInfo& argInfo, span<const uint16_t> argStore);
 };
 
 
@@ -171,6 +171,33 @@ public:
 };
 
 
+// global cache of parsed runtime format strings, keyed by content.
+// Checked mapping is also cached when there's no named arg, since named arg's name is not owned.
+template<typename Char>
+class FormatStringCache
+{
+public:
+    struct Result
+    {
+        DynamicTrimedResultCh<Char> StrInfo;
+        NamedMapper Mapping;
+    };
+    struct Stats
+    {
+        uint64_t Hits;
+        uint64_t Misses;
+        size_t Count;
+    };
+    static constexpr size_t DefaultCapacity = 1024;
+    // format should not be empty, throws when parse or check failed
+    SYSCOMMONAPI [[nodiscard]] static Result Get(std::basic_string_view<Char> format, const ArgInfo& argInfo);
+    // 0 disables the cache
+    SYSCOMMONAPI static void SetCapacity(size_t capacity);
+    SYSCOMMONAPI static void Clear();
+    SYSCOMMONAPI [[nodiscard]] static Stats GetStats() noexcept;
+};
+
+
 struct DynamicArgPack
 {
     boost::container::small_vector<uint16_t, 36> ArgStore;
@@ -213,6 +240,7 @@ struct FormatSpecCacherCh : private FormatSpecCacher
         Cache(StrInfo, TheArgInfo, Mapping);
     }
     SYSCOMMONAPI void FormatTo(std::basic_string<Char>& dst, span<const uint16_t> argStore);
+    SYSCOMMONAPI void FormatTo(FormatSink<Char>& sink, span<const uint16_t> argStore);
     template<typename... Args>
     auto Format(std::basic_string<Char>& dst, Args&&... args)
     {
@@ -222,6 +250,14 @@ struct FormatSpecCacherCh : private FormatSpecCacher
         const auto argStore = ArgInfo::PackArgsStatic(std::forward<Args>(args)...);
         FormatTo(dst, argStore.ArgStore);
     }
+    template<typename... Args>
+    auto Format(FormatSink<Char>& sink, Args&&... args)
+    {
+        static constexpr auto ArgsInfo = ArgInfo::ParseArgs<Args...>();
+        [[maybe_unused]] const auto mapping = ArgChecker::CheckDD(StrInfo, ArgsInfo);
+        const auto argStore = ArgInfo::PackArgsStatic(std::forward<Args>(args)...);
+        FormatTo(sink, argStore.ArgStore);
+    }
 };
 template<typename T, typename... Args>
 auto FormatSpecCacher::CreateFrom(const T&, Args&&...)
@@ -234,15 +270,16 @@ auto FormatSpecCacher::CreateFrom(const T&, Args&&...)
 }
 
 
-template<typename Char>
+// Out is either std::basic_string<Char> or SinkBuffer<Char>
+template<typename Char, typename Out = std::basic_string<Char>>
 struct DirectHost : public FormatterHost
 {
     using CTX = FormatterContext;
     using Fmter = Formatter<Char>;
     struct Context : public CTX
     {
-        std::basic_string<Char>& Dst;
-        constexpr Context(std::basic_string<Char>& dst) noexcept : Dst(dst) { }
+        Out& Dst;
+        constexpr Context(Out& dst) noexcept : Dst(dst) { }
     };
     SYSCOMMONAPI virtual ~DirectHost() override;
 
@@ -323,16 +360,16 @@ struct DirectHost : public FormatterHost
 };
 
 
-template<typename Char>
-struct DirectExecutor : public FormatterOpExecutor, public DirectHost<Char>
+template<typename Char, typename Out = std::basic_string<Char>>
+struct DirectExecutor : public FormatterOpExecutor, public DirectHost<Char, Out>
 {
     using CTX = FormatterContext;
     using Fmter = Formatter<Char>;
-    struct Context : public DirectHost<Char>::Context
+    struct Context : public DirectHost<Char, Out>::Context
     {
         std::basic_string_view<Char> FmtStr;
-        constexpr Context(std::basic_string<Char>& dst, std::basic_string_view<Char> fmtstr) noexcept : 
-            DirectHost<Char>::Context(dst), FmtStr(fmtstr) { }
+        constexpr Context(Out& dst, std::basic_string_view<Char> fmtstr) noexcept : 
+            DirectHost<Char, Out>::Context(dst), FmtStr(fmtstr) { }
     };
     SYSCOMMONAPI ~DirectExecutor() override;
 protected:
@@ -354,27 +391,27 @@ private:
     }
 };
 
-template<typename Char>
-struct BasicExecutor : public DirectExecutor<Char>
+template<typename Char, typename Out = std::basic_string<Char>>
+struct BasicExecutor : public DirectExecutor<Char, Out>
 {
-    struct Context : public DirectExecutor<Char>::Context
+    struct Context : public DirectExecutor<Char, Out>::Context
     {
         const StrArgInfoCh<Char>& StrInfo;
         const ArgInfo& TheArgInfo;
         span<const uint16_t> ArgStore;
         NamedMapper Mapping;
-        constexpr Context(std::basic_string<Char>& dst, const StrArgInfoCh<Char>& strInfo, const ArgInfo& argInfo, span<const uint16_t> argStore, const NamedMapper& mapping) noexcept :
-            DirectExecutor<Char>::Context(dst, strInfo.FormatString), StrInfo(strInfo), TheArgInfo(argInfo), ArgStore(argStore), Mapping(mapping) {}
+        constexpr Context(Out& dst, const StrArgInfoCh<Char>& strInfo, const ArgInfo& argInfo, span<const uint16_t> argStore, const NamedMapper& mapping) noexcept :
+            DirectExecutor<Char, Out>::Context(dst, strInfo.FormatString), StrInfo(strInfo), TheArgInfo(argInfo), ArgStore(argStore), Mapping(mapping) {}
     };
 
-    void FormatTo(std::basic_string<Char>& dst, const StrArgInfoCh<Char>& strInfo, const ArgInfo& argInfo, span<const uint16_t> argStore, const NamedMapper& mapping)
+    void FormatTo(Out& dst, const StrArgInfoCh<Char>& strInfo, const ArgInfo& argInfo, span<const uint16_t> argStore, const NamedMapper& mapping)
     {
         Context context(dst, strInfo, argInfo, argStore, mapping);
         auto opcodes = strInfo.Opcodes;
         FormatterOpExecutor::Execute(opcodes, context);
     }
     template<typename T, typename... Args>
-    forceinline void FormatToStatic(std::basic_string<Char>& dst, const T&, Args&&... args)
+    forceinline void FormatToStatic(Out& dst, const T&, Args&&... args)
     {
         static_assert(std::is_same_v<typename std::decay_t<T>::CharType, Char>);
         static constexpr auto Mapping = ArgChecker::CheckSS<T, Args...>();
@@ -4,6 +4,7 @@
 #include "FileEx.h"
 #include "ThreadEx.h"
 #include "ConsoleEx.h"
+#include "MiscIntrins.h"
 #include "common/AlignedBase.hpp"
 #include <thread>
 #include <array>
@@ -152,20 +153,31 @@ std::u16string_view GetLogLevelStr(const LogLevel level)
 }
 
 
-LoggerQBackend::LoggerQBackend(const size_t initSize) :
-    LoopBase(LoopBase::GetThreadedExecutor), MsgQueue(initSize)
+struct LoggerQBackend::OverflowNode
+{
+    uintptr_t Msg;
+    OverflowNode* Next;
+};
+
+LoggerQBackend::LoggerQBackend(const size_t capacity) :
+    LoopBase(LoopBase::GetThreadedExecutor), MsgQueue(capacity)
 { }
 LoggerQBackend::~LoggerQBackend()
 {
     //release the msgs left
-    LogMessage* msg;
-    while (MsgQueue.pop(msg))
-        LogMessage::Consume(msg);
+    uintptr_t ptr = 0;
+    while (PopMsg(ptr))
+    {
+        if (ptr % 4 == 0)
+            LogMessage::Consume(reinterpret_cast<LogMessage*>(ptr));
+        else
+            reinterpret_cast<common::BasicPromise<void>*>(ptr - 1)->SetData();
+    }
 }
 
 bool LoggerQBackend::SleepCheck() noexcept
 {
-    return MsgQueue.empty();
+    return MsgQueue.IsEmpty() && !OverflowPending && !Overflow.load(std::memory_order_relaxed);
 }
 bool LoggerQBackend::OnStart(const ThreadObject&, std::any&) noexcept
 {
@@ -183,12 +195,18 @@ void LoggerQBackend::OnStop() noexcept
 loop::LoopBase::LoopAction LoggerQBackend::OnLoop()
 {
     uintptr_t ptr = 0;
-    for (uint32_t i = 16; !MsgQueue.pop(ptr) && i--;)
+    // short spin before going to sleep, producers wake it up anyway
+    for (uint32_t i = 16; !PopMsg(ptr) && i--;)
     {
-        std::this_thread::yield();
+        MiscIntrin.Pause(2000);
     }
     if (ptr == 0)
         return LoopAction::Sleep();
+    HandleMsg(ptr);
+    return LoopAction::Continue();
+}
+void LoggerQBackend::HandleMsg(uintptr_t ptr)
+{
     switch (ptr % 4)
     {
     case 0:
@@ -196,18 +214,57 @@ loop::LoopBase::LoopAction LoggerQBackend::OnLoop()
         const auto msg = reinterpret_cast<LogMessage*>(ptr);
         OnPrint(*msg);
         LogMessage::Consume(msg);
-        return LoopAction::Continue();
-    }
+    } break;
     case 1:
     {
         const auto pms = reinterpret_cast<common::BasicPromise<void>*>(ptr - 1);
         pms->SetData();
-        return LoopAction::Continue();
-    }
+    } break;
     default:
-        Expects(false);
-        return LoopAction::Continue(); // Shuld not enter
+        Expects(false); // Shuld not enter
+        break;
+    }
+}
+
+// msgs in Overflow are newer than those in MsgQueue, since producers keep using Overflow once it's not empty
+bool LoggerQBackend::PopMsg(uintptr_t& ptr) noexcept
+{
+    if (!OverflowPending)
+    {
+        if (MsgQueue.TryPop(ptr))
+            return true;
+        // reverse the stack to get FIFO order
+        auto node = Overflow.exchange(nullptr, std::memory_order_acquire);
+        while (node)
+        {
+            const auto next = node->Next;
+            node->Next = OverflowPending;
+            OverflowPending = node;
+            node = next;
+        }
+        if (!OverflowPending)
+            return false;
     }
+    const auto node = OverflowPending;
+    OverflowPending = node->Next;
+    ptr = node->Msg;
+    delete node;
+    return true;
+}
+
+bool LoggerQBackend::PushMsg(uintptr_t msg) noexcept
+{
+    // never wait for the consumer, the caller may be the consumer itself (e.g. logging inside OnPrint)
+    if (Overflow.load(std::memory_order_relaxed) || !MsgQueue.TryPush(msg))
+    {
+        const auto node = new (std::nothrow) OverflowNode{ msg, Overflow.load(std::memory_order_relaxed) };
+        if (!node)
+            return false;
+        while (!Overflow.compare_exchange_weak(node->Next, node, std::memory_order_release, std::memory_order_relaxed))
+        { }
+    }
+    Wakeup();
+    return true;
 }
 
 void LoggerQBackend::EnsureRunning()
@@ -224,8 +281,8 @@ void LoggerQBackend::Print(LogMessage* msg)
     }
     else
     {
-        MsgQueue.push(reinterpret_cast<uintptr_t>(msg));
-        Wakeup();
+        if (!PushMsg(reinterpret_cast<uintptr_t>(msg)))
+            LogMessage::Consume(msg);
     }
 }
 
@@ -236,8 +293,8 @@ PromiseResult<void> LoggerQBackend::Synchronize()
     const auto pms = new common::BasicPromise<void>();
     const auto ptr = reinterpret_cast<uintptr_t>(pms);
     Ensures(ptr % 4 == 0);
-    MsgQueue.push(ptr + 1);
-    Wakeup();
+    if (!PushMsg(ptr + 1))
+        pms->SetData();
     return pms->GetPromiseResult();
 }
 
@@ -328,6 +385,16 @@ void LoggerFormatter<Char>::Reset() noexcept
     Seperator->Segments.clear();
 }
 
+// formats straight into a sink, used for generating messages without heap string
+struct SinkLoggerFormatter final : public str::BasicExecutor<char16_t, str::SinkBuffer<char16_t>>
+{
+    ColorSeperator Seperator;
+    void PutColor(str::FormatterContext& ctx, ScreenColor color) final
+    {
+        Seperator.HandleColor(color, static_cast<Context&>(ctx).Dst.size());
+    }
+};
+
 template struct LoggerFormatter<char>;
 template struct LoggerFormatter<wchar_t>;
 template struct LoggerFormatter<char16_t>;
@@ -340,10 +407,15 @@ template struct LoggerFormatter<char8_t>;
 //template<typename Char>
 LogMessage* MiniLoggerBase::GenerateMessage(const LogLevel level, const str::StrArgInfoCh<char16_t>& strInfo, const str::ArgInfo& argInfo, span<const uint16_t> argStore, const str::NamedMapper& mapping) const
 {
-    LoggerFormatter<char16_t> formatter;
-    formatter.FormatTo(formatter.Str, strInfo, argInfo, argStore, mapping);
-    //str::FormatterBase::FormatTo(formatter, formatter.Str, strInfo, argInfo, argStore, mapping);
-    const auto segs = to_span(formatter.GetColorSegements());
+    SinkLoggerFormatter formatter;
+    str::StackSink<char16_t, 1024> sink;
+    {
+        str::SinkBuffer<char16_t> buffer(sink);
+        formatter.FormatTo(buffer, strInfo, argInfo, argStore, mapping);
+        buffer.Flush();
+    }
+    const auto txt = sink.View();
+    const auto segs = to_span(formatter.Seperator.Segments);
     // if constexpr (!std::is_same_v<Char, char16_t>)
     // {
     //     const auto str16 = str::to_u16string(formatter.Str);
@@ -351,7 +423,7 @@ LogMessage* MiniLoggerBase::GenerateMessage(const LogLevel level, const str::Str
     // }
     // else
     // {
-    return LogMessage::MakeMessage(this->Prefix, formatter.Str.data(), formatter.Str.size(), segs, level);
+    return LogMessage::MakeMessage(this->Prefix, txt.data(), txt.size(), segs, level);
     // }
 }
 // template SYSCOMMONTPL LogMessage* MiniLoggerBase::GenerateMessage(const LogLevel level, const str::StrArgInfoCh<char    >& strInfo, const str::ArgInfo& argInfo, const str::ArgPack& argPack) const;
@@ -361,11 +433,13 @@ LogMessage* MiniLoggerBase::GenerateMessage(const LogLevel level, const str::Str
 LogMessage* MiniLoggerBase::GenerateMessage(const LogLevel level, std::basic_string_view<char16_t> formatter, const str::ArgInfo& argInfo, span<const uint16_t> argStore) const
 {
     using namespace str;
-    const auto result = FormatterParser::ParseString(formatter);
-    ParseResultBase::CheckErrorRuntime(result.ErrorPos, result.OpCount);
-    const auto fmtInfo = result.ToInfo(formatter);
-    const auto mapping = ArgChecker::CheckDD(fmtInfo, argInfo);
-    return GenerateMessage(level, fmtInfo, argInfo, argStore, mapping);
+    if (formatter.empty())
+    {
+        const auto result = FormatterParser::ParseString(formatter);
+        return GenerateMessage(level, result.ToInfo(formatter), argInfo, argStore, ArgChecker::EmptyMapper);
+    }
+    const auto cached = FormatStringCache<char16_t>::Get(formatter, argInfo);
+    return GenerateMessage(level, cached.StrInfo.ToStrArgInfo(), argInfo, argStore, cached.Mapping);
 }
 
 }
@@ -3,14 +3,7 @@
 #include "MiniLogger.h"
 #include "LoopBase.h"
 #include "PromiseTask.h"
-#if defined(_MSC_VER)
-#   define _SILENCE_CXX17_OLD_ALLOCATOR_MEMBERS_DEPRECATION_WARNING 1
-#   pragma warning(disable:4996)
-#   include "boost/lockfree/queue.hpp"
-#   pragma warning(default:4996)
-#else
-#   include "boost/lockfree/queue.hpp"
-#endif
+#include "common/LockFreeQueue.hpp"
 
 
 namespace common::mlog
@@ -19,16 +12,24 @@ namespace common::mlog
 class SYSCOMMONAPI LoggerQBackend : private loop::LoopBase, public LoggerBackend
 {
 private:
-    boost::lockfree::queue<uintptr_t> MsgQueue;
+    struct OverflowNode;
+    container::MPMCBoundedQueue<uintptr_t> MsgQueue;
+    // unbounded fallback when MsgQueue is full, pushed as a stack by producers
+    std::atomic<OverflowNode*> Overflow{ nullptr };
+    // taken from Overflow in FIFO order, only touched by consumer
+    OverflowNode* OverflowPending = nullptr;
     uintptr_t CleanerId = 0;
     LoopAction OnLoop() override;
     bool SleepCheck() noexcept override; // double check if should sleep
+    void HandleMsg(uintptr_t ptr);
+    bool PopMsg(uintptr_t& ptr) noexcept;
+    bool PushMsg(uintptr_t msg) noexcept;
 protected:
     bool OnStart(const ThreadObject&, std::any&) noexcept override;
     void OnStop() noexcept override;
     void EnsureRunning();
 public:
-    LoggerQBackend(const size_t initSize = 64);
+    LoggerQBackend(const size_t capacity = 4096);
     ~LoggerQBackend() override;
     void Print(LogMessage* msg) final;
     PromiseResult<void> Synchronize();
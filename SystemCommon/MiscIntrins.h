@@ -21,6 +21,7 @@ private:
     bool(*PauseCycles)(uint32_t) noexcept = nullptr;
 public:
     SYSCOMMONAPI [[nodiscard]] static common::span<const PathInfo> GetSupportMap() noexcept;
+    SYSCOMMONAPI [[nodiscard]] static common::span<const BenchmarkInfo> GetBenchmarks() noexcept;
     SYSCOMMONAPI MiscIntrins(common::span<const VarItem> requests = {}) noexcept;
     SYSCOMMONAPI ~MiscIntrins();
     SYSCOMMONAPI [[nodiscard]] bool IsComplete() const noexcept final;
@@ -107,8 +108,12 @@ public:
     using bytearray = std::array<std::byte, N>;
 private:
     bytearray<32>(*Sha256)(const std::byte*, const size_t) noexcept = nullptr;
+    uint32_t(*Crc32c)(uint32_t, const std::byte*, size_t) noexcept = nullptr;
+    uint64_t(*Xxh3)(const std::byte*, const size_t) noexcept = nullptr;
+    std::array<uint64_t, 2>(*Xxh128)(const std::byte*, const size_t) noexcept = nullptr;
 public:
     SYSCOMMONAPI [[nodiscard]] static common::span<const PathInfo> GetSupportMap() noexcept;
+    SYSCOMMONAPI [[nodiscard]] static common::span<const BenchmarkInfo> GetBenchmarks() noexcept;
     SYSCOMMONAPI DigestFuncs(common::span<const VarItem> requests = {}) noexcept;
     SYSCOMMONAPI ~DigestFuncs();
     SYSCOMMONAPI [[nodiscard]] bool IsComplete() const noexcept final;
@@ -119,6 +124,27 @@ public:
         const common::span<const std::byte> bytes = common::as_bytes(data);
         return Sha256(bytes.data(), bytes.size());
     }
+    // CRC32C (Castagnoli), pass previous result as crc to continue
+    template<typename T>
+    uint32_t CRC32C(const common::span<T> data, const uint32_t crc = 0) const noexcept
+    {
+        const common::span<const std::byte> bytes = common::as_bytes(data);
+        return Crc32c(crc, bytes.data(), bytes.size());
+    }
+    // XXH3 64bit with default secret and seed 0, non-cryptographic
+    template<typename T>
+    uint64_t XXH3_64(const common::span<T> data) const noexcept
+    {
+        const common::span<const std::byte> bytes = common::as_bytes(data);
+        return Xxh3(bytes.data(), bytes.size());
+    }
+    // XXH3 128bit with default secret and seed 0, { low64, high64 }, non-cryptographic
+    template<typename T>
+    std::array<uint64_t, 2> XXH3_128(const common::span<T> data) const noexcept
+    {
+        const common::span<const std::byte> bytes = common::as_bytes(data);
+        return Xxh128(bytes.data(), bytes.size());
+    }
 };
 
 SYSCOMMONAPI extern const DigestFuncs DigestFunc;
@@ -8,6 +8,9 @@
 
 #include <atomic>
 #include <bit>
+#if COMMON_ARCH_ARM && defined(__ARM_FEATURE_CRC32)
+#   include <arm_acle.h>
+#endif
 
 #define LeadZero32Info  (uint32_t)(const uint32_t num)
 #define LeadZero64Info  (uint32_t)(const uint64_t num)
@@ -19,6 +22,9 @@
 #define Hex2StrInfo     (::std::string)(const uint8_t* data, size_t size, bool isCapital)
 #define PauseCyclesInfo (bool)(uint32_t cycles)
 #define Sha256Info      (::std::array<std::byte, 32>)(const std::byte* data, const size_t size)
+#define Crc32cInfo      (uint32_t)(uint32_t crc, const std::byte* data, size_t size)
+#define Xxh3Info        (uint64_t)(const std::byte* data, const size_t size)
+#define Xxh128Info      (::std::array<uint64_t, 2>)(const std::byte* data, const size_t size)
 
 
 #if COMMON_ARCH_X86
@@ -49,7 +55,7 @@ DEFINE_FASTPATHS(MiscIntrins,
     LeadZero32, LeadZero64, TailZero32, TailZero64, PopCount32, PopCount64, PopCounts, Hex2Str, PauseCycles)
 
 
-DEFINE_FASTPATHS(DigestFuncs, Sha256)
+DEFINE_FASTPATHS(DigestFuncs, Sha256, Crc32c, Xxh3, Xxh128)
 
 
 DEFINE_FASTPATH_METHOD(PauseCycles, COMPILER)
@@ -1259,4 +1265,544 @@ DEFINE_FASTPATH_METHOD(Sha256, SHANIAVX512BW)
 #endif
 
 
+alignas(64) constexpr uint8_t XXH3Secret[192] =
+{
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+inline constexpr uint32_t XXH3Prime32[] = { 0x9E3779B1u, 0x85EBCA77u, 0xC2B2AE3Du };
+inline constexpr uint64_t XXH3Prime64[] = { 0x9E3779B185EBCA87u, 0xC2B2AE3D27D4EB4Fu, 0x165667B19E3779F9u, 0x85EBCA77C2B2AE63u, 0x27D4EB2F165667C5u };
+inline constexpr uint64_t XXH3PrimeMX1 = 0x165667919E3779F9u, XXH3PrimeMX2 = 0x9FB21C651E98DF25u;
+
+// XXH3 64bit & 128bit with default secret and seed 0, based on xxHash v0.8 by Yann Collet (BSD-2 license).
+// Short inputs are handled by scalar code, Acc only handles the long-input loop.
+struct XXH3Base
+{
+    forceinline static uint32_t Read32(const void* ptr) noexcept
+    {
+        uint32_t val;
+        memcpy(&val, ptr, sizeof(val));
+        return val;
+    }
+    forceinline static uint64_t Read64(const void* ptr) noexcept
+    {
+        uint64_t val;
+        memcpy(&val, ptr, sizeof(val));
+        return val;
+    }
+    // { lo, hi }
+    forceinline static std::array<uint64_t, 2> Mul128(const uint64_t lhs, const uint64_t rhs) noexcept
+    {
+#if COMMON_COMPILER_MSVC && COMMON_ARCH_X86 && COMMON_OSBIT == 64
+        uint64_t hi = 0;
+        const auto lo = _umul128(lhs, rhs, &hi);
+        return { lo, hi };
+#elif defined(__SIZEOF_INT128__)
+        const auto product = static_cast<unsigned __int128>(lhs) * rhs;
+        return { static_cast<uint64_t>(product), static_cast<uint64_t>(product >> 64) };
+#else
+        const uint64_t loLo = (lhs & 0xffffffffu) * (rhs & 0xffffffffu);
+        const uint64_t hiLo = (lhs >> 32) * (rhs & 0xffffffffu);
+        const uint64_t loHi = (lhs & 0xffffffffu) * (rhs >> 32);
+        const uint64_t hiHi = (lhs >> 32) * (rhs >> 32);
+        const uint64_t cross = (loLo >> 32) + (hiLo & 0xffffffffu) + loHi;
+        const uint64_t hi = (hiLo >> 32) + (cross >> 32) + hiHi;
+        const uint64_t lo = (cross << 32) | (loLo & 0xffffffffu);
+        return { lo, hi };
+#endif
+    }
+    forceinline static uint64_t Mul128Fold64(const uint64_t lhs, const uint64_t rhs) noexcept
+    {
+        const auto [lo, hi] = Mul128(lhs, rhs);
+        return lo ^ hi;
+    }
+    forceinline static uint64_t Avalanche(uint64_t h) noexcept
+    {
+        h ^= h >> 37;
+        h *= XXH3PrimeMX1;
+        return h ^ (h >> 32);
+    }
+    forceinline static uint64_t XXH64Avalanche(uint64_t h) noexcept
+    {
+        h ^= h >> 33;
+        h *= XXH3Prime64[1];
+        h ^= h >> 29;
+        h *= XXH3Prime64[2];
+        return h ^ (h >> 32);
+    }
+    forceinline static uint64_t RRMXMX(uint64_t h, const uint64_t len) noexcept
+    {
+        h ^= std::rotl(h, 49) ^ std::rotl(h, 24);
+        h *= XXH3PrimeMX2;
+        h ^= (h >> 35) + len;
+        h *= XXH3PrimeMX2;
+        return h ^ (h >> 28);
+    }
+    forceinline static uint64_t Mix16B(const std::byte* data, const uint8_t* secret) noexcept
+    {
+        return Mul128Fold64(Read64(data) ^ Read64(secret), Read64(data + 8) ^ Read64(secret + 8));
+    }
+    static uint64_t HashShort(const std::byte* data, const size_t size) noexcept
+    {
+        const auto secret = XXH3Secret;
+        if (size > 8)
+        {
+            const auto lo = Read64(data) ^ (Read64(secret + 24) ^ Read64(secret + 32));
+            const auto hi = Read64(data + size - 8) ^ (Read64(secret + 40) ^ Read64(secret + 48));
+            const auto acc = size + common::ByteSwap(lo) + hi + Mul128Fold64(lo, hi);
+            return Avalanche(acc);
+        }
+        if (size >= 4)
+        {
+            const auto input = Read32(data + size - 4) + (static_cast<uint64_t>(Read32(data)) << 32);
+            return RRMXMX(input ^ (Read64(secret + 8) ^ Read64(secret + 16)), size);
+        }
+        if (size > 0)
+        {
+            const auto c1 = std::to_integer<uint32_t>(data[0]), c2 = std::to_integer<uint32_t>(data[size >> 1]), 
+                c3 = std::to_integer<uint32_t>(data[size - 1]);
+            const uint32_t combined = (c1 << 16) | (c2 << 24) | c3 | (static_cast<uint32_t>(size) << 8);
+            return XXH64Avalanche(combined ^ static_cast<uint64_t>(Read32(secret) ^ Read32(secret + 4)));
+        }
+        return XXH64Avalanche(Read64(secret + 56) ^ Read64(secret + 64));
+    }
+    static uint64_t HashMid(const std::byte* data, const size_t size) noexcept
+    {
+        const auto secret = XXH3Secret;
+        uint64_t acc = size * XXH3Prime64[0];
+        if (size <= 128)
+        {
+            if (size > 32)
+            {
+                if (size > 64)
+                {
+                    if (size > 96)
+                    {
+                        acc += Mix16B(data + 48, secret + 96);
+                        acc += Mix16B(data + size - 64, secret + 112);
+                    }
+                    acc += Mix16B(data + 32, secret + 64);
+                    acc += Mix16B(data + size - 48, secret + 80);
+                }
+                acc += Mix16B(data + 16, secret + 32);
+                acc += Mix16B(data + size - 32, secret + 48);
+            }
+            acc += Mix16B(data, secret);
+            acc += Mix16B(data + size - 16, secret + 16);
+            return Avalanche(acc);
+        }
+        // 129~240
+        const auto rounds = size / 16;
+        for (size_t i = 0; i < 8; ++i)
+            acc += Mix16B(data + 16 * i, secret + 16 * i);
+        acc = Avalanche(acc);
+        for (size_t i = 8; i < rounds; ++i)
+            acc += Mix16B(data + 16 * i, secret + 16 * (i - 8) + 3);
+        acc += Mix16B(data + size - 16, secret + 136 - 17);
+        return Avalanche(acc);
+    }
+    static uint64_t MergeAccs(const uint64_t(&acc)[8], const uint8_t* secret, uint64_t result) noexcept
+    {
+        for (size_t i = 0; i < 4; ++i)
+            result += Mul128Fold64(acc[2 * i] ^ Read64(secret + 16 * i), acc[2 * i + 1] ^ Read64(secret + 16 * i + 8));
+        return Avalanche(result);
+    }
+    // size > 240
+    template<typename Acc>
+    static void HashLong(const std::byte* data, const size_t size, uint64_t(&result)[8]) noexcept
+    {
+        constexpr size_t StripeCount = (sizeof(XXH3Secret) - 64) / 8, BlockSize = 64 * StripeCount;
+        Acc acc;
+        const auto blocks = (size - 1) / BlockSize;
+        for (size_t n = 0; n < blocks; ++n)
+        {
+            const auto block = data + n * BlockSize;
+            for (size_t s = 0; s < StripeCount; ++s)
+                acc.Accumulate(block + s * 64, XXH3Secret + s * 8);
+            acc.Scramble(XXH3Secret + sizeof(XXH3Secret) - 64);
+        }
+        const auto block = data + blocks * BlockSize;
+        const auto stripes = ((size - 1) - blocks * BlockSize) / 64;
+        for (size_t s = 0; s < stripes; ++s)
+            acc.Accumulate(block + s * 64, XXH3Secret + s * 8);
+        acc.Accumulate(data + size - 64, XXH3Secret + sizeof(XXH3Secret) - 64 - 7);
+        acc.Save(result);
+    }
+    template<typename Acc>
+    static uint64_t Hash(const std::byte* data, const size_t size) noexcept
+    {
+        if (size <= 16)
+            return HashShort(data, size);
+        if (size <= 240)
+            return HashMid(data, size);
+        uint64_t result[8];
+        HashLong<Acc>(data, size, result);
+        return MergeAccs(result, XXH3Secret + 11, size * XXH3Prime64[0]);
+    }
+
+    static std::array<uint64_t, 2> HashShort128(const std::byte* data, const size_t size) noexcept
+    {
+        const auto secret = XXH3Secret;
+        if (size > 8)
+        {
+            const auto flipLo = Read64(secret + 32) ^ Read64(secret + 40), flipHi = Read64(secret + 48) ^ Read64(secret + 56);
+            const auto inLo = Read64(data);
+            auto inHi = Read64(data + size - 8);
+            auto [mLo, mHi] = Mul128(inLo ^ inHi ^ flipLo, XXH3Prime64[0]);
+            mLo += static_cast<uint64_t>(size - 1) << 54;
+            inHi ^= flipHi;
+            mHi += inHi + (inHi & 0xffffffffu) * (XXH3Prime32[1] - 1);
+            mLo ^= common::ByteSwap(mHi);
+            auto [hLo, hHi] = Mul128(mLo, XXH3Prime64[1]);
+            hHi += mHi * XXH3Prime64[1];
+            return { Avalanche(hLo), Avalanche(hHi) };
+        }
+        if (size >= 4)
+        {
+            const auto input = Read32(data) + (static_cast<uint64_t>(Read32(data + size - 4)) << 32);
+            const auto keyed = input ^ (Read64(secret + 16) ^ Read64(secret + 24));
+            auto [mLo, mHi] = Mul128(keyed, XXH3Prime64[0] + (static_cast<uint64_t>(size) << 2));
+            mHi += mLo << 1;
+            mLo ^= mHi >> 3;
+            mLo ^= mLo >> 35;
+            mLo *= XXH3PrimeMX2;
+            mLo ^= mLo >> 28;
+            return { mLo, Avalanche(mHi) };
+        }
+        if (size > 0)
+        {
+            const auto c1 = std::to_integer<uint32_t>(data[0]), c2 = std::to_integer<uint32_t>(data[size >> 1]),
+                c3 = std::to_integer<uint32_t>(data[size - 1]);
+            const uint32_t combinedLo = (c1 << 16) | (c2 << 24) | c3 | (static_cast<uint32_t>(size) << 8);
+            const uint32_t combinedHi = std::rotl(common::ByteSwap(combinedLo), 13);
+            return 
+            { 
+                XXH64Avalanche(combinedLo ^ static_cast<uint64_t>(Read32(secret) ^ Read32(secret + 4))),
+                XXH64Avalanche(combinedHi ^ static_cast<uint64_t>(Read32(secret + 8) ^ Read32(secret + 12)))
+            };
+        }
+        return { XXH64Avalanche(Read64(secret + 64) ^ Read64(secret + 72)), XXH64Avalanche(Read64(secret + 80) ^ Read64(secret + 88)) };
+    }
+    forceinline static void Mix32B(uint64_t& lo, uint64_t& hi, const std::byte* data1, const std::byte* data2, const uint8_t* secret) noexcept
+    {
+        lo += Mix16B(data1, secret);
+        lo ^= Read64(data2) + Read64(data2 + 8);
+        hi += Mix16B(data2, secret + 16);
+        hi ^= Read64(data1) + Read64(data1 + 8);
+    }
+    static std::array<uint64_t, 2> HashMid128(const std::byte* data, const size_t size) noexcept
+    {
+        const auto secret = XXH3Secret;
+        uint64_t lo = size * XXH3Prime64[0], hi = 0;
+        if (size <= 128)
+        {
+            if (size > 32)
+            {
+                if (size > 64)
+                {
+                    if (size > 96)
+                        Mix32B(lo, hi, data + 48, data + size - 64, secret + 96);
+                    Mix32B(lo, hi, data + 32, data + size - 48, secret + 64);
+                }
+                Mix32B(lo, hi, data + 16, data + size - 32, secret + 32);
+            }
+            Mix32B(lo, hi, data, data + size - 16, secret);
+        }
+        else // 129~240
+        {
+            for (size_t i = 0; i < 4; ++i)
+                Mix32B(lo, hi, data + 32 * i, data + 32 * i + 16, secret + 32 * i);
+            lo = Avalanche(lo);
+            hi = Avalanche(hi);
+            for (size_t i = 4; i < size / 32; ++i)
+                Mix32B(lo, hi, data + 32 * i, data + 32 * i + 16, secret + 32 * (i - 4) + 3);
+            Mix32B(lo, hi, data + size - 16, data + size - 32, secret + 136 - 17 - 16);
+        }
+        const auto retLo = lo + hi;
+        const auto retHi = lo * XXH3Prime64[0] + hi * XXH3Prime64[3] + size * XXH3Prime64[1];
+        return { Avalanche(retLo), 0 - Avalanche(retHi) };
+    }
+    template<typename Acc>
+    static std::array<uint64_t, 2> Hash128(const std::byte* data, const size_t size) noexcept
+    {
+        if (size <= 16)
+            return HashShort128(data, size);
+        if (size <= 240)
+            return HashMid128(data, size);
+        uint64_t result[8];
+        HashLong<Acc>(data, size, result);
+        return
+        {
+            MergeAccs(result, XXH3Secret + 11, size * XXH3Prime64[0]),
+            MergeAccs(result, XXH3Secret + sizeof(XXH3Secret) - 64 - 11, ~(size * XXH3Prime64[1]))
+        };
+    }
+};
+struct XXH3AccNaive
+{
+    uint64_t Acc[8] = { XXH3Prime32[2], XXH3Prime64[0], XXH3Prime64[1], XXH3Prime64[2], XXH3Prime64[3], XXH3Prime32[1], XXH3Prime64[4], XXH3Prime32[0] };
+    forceinline void Accumulate(const std::byte* data, const uint8_t* secret) noexcept
+    {
+        for (size_t i = 0; i < 8; ++i)
+        {
+            const auto val = XXH3Base::Read64(data + i * 8);
+            const auto key = val ^ XXH3Base::Read64(secret + i * 8);
+            Acc[i ^ 1] += val;
+            Acc[i] += (key & 0xffffffffu) * (key >> 32);
+        }
+    }
+    forceinline void Scramble(const uint8_t* secret) noexcept
+    {
+        for (size_t i = 0; i < 8; ++i)
+        {
+            auto acc = Acc[i];
+            acc ^= acc >> 47;
+            acc ^= XXH3Base::Read64(secret + i * 8);
+            Acc[i] = acc * XXH3Prime32[0];
+        }
+    }
+    forceinline void Save(uint64_t* dst) const noexcept
+    {
+        memcpy(dst, Acc, sizeof(Acc));
+    }
+};
+
+DEFINE_FASTPATH_METHOD(Xxh3, NAIVE)
+{
+    return XXH3Base::Hash<XXH3AccNaive>(data, size);
+}
+DEFINE_FASTPATH_METHOD(Xxh128, NAIVE)
+{
+    return XXH3Base::Hash128<XXH3AccNaive>(data, size);
+}
+
+#if COMMON_ARCH_X86 && COMMON_SIMD_LV >= 20
+# pragma message("Compiling DigestFuncs with SSE2")
+struct XXH3AccSSE2
+{
+    __m128i Acc[4];
+    XXH3AccSSE2() noexcept
+    {
+        const XXH3AccNaive init;
+        for (size_t i = 0; i < 4; ++i)
+            Acc[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(init.Acc + i * 2));
+    }
+    forceinline void VECCALL Accumulate(const std::byte* data, const uint8_t* secret) noexcept
+    {
+        for (size_t i = 0; i < 4; ++i)
+        {
+            const auto val = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data) + i);
+            const auto key = _mm_xor_si128(val, _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i));
+            const auto product = _mm_mul_epu32(key, _mm_shuffle_epi32(key, 0b10110001)); // lo32 * hi32
+            const auto swapped = _mm_shuffle_epi32(val, 0b01001110); // swap 64bit
+            Acc[i] = _mm_add_epi64(_mm_add_epi64(Acc[i], swapped), product);
+        }
+    }
+    forceinline void VECCALL Scramble(const uint8_t* secret) noexcept
+    {
+        const auto prime = _mm_set1_epi32(static_cast<int32_t>(XXH3Prime32[0]));
+        for (size_t i = 0; i < 4; ++i)
+        {
+            auto acc = _mm_xor_si128(Acc[i], _mm_srli_epi64(Acc[i], 47));
+            acc = _mm_xor_si128(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i));
+            const auto productLo = _mm_mul_epu32(acc, prime);
+            const auto productHi = _mm_mul_epu32(_mm_srli_epi64(acc, 32), prime);
+            Acc[i] = _mm_add_epi64(productLo, _mm_slli_epi64(productHi, 32));
+        }
+    }
+    forceinline void Save(uint64_t* dst) const noexcept
+    {
+        for (size_t i = 0; i < 4; ++i)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst) + i, Acc[i]);
+    }
+};
+DEFINE_FASTPATH_METHOD(Xxh3, SSE2)
+{
+    return XXH3Base::Hash<XXH3AccSSE2>(data, size);
+}
+DEFINE_FASTPATH_METHOD(Xxh128, SSE2)
+{
+    return XXH3Base::Hash128<XXH3AccSSE2>(data, size);
+}
+#endif
+
+#if COMMON_ARCH_X86 && COMMON_SIMD_LV >= 200
+# pragma message("Compiling DigestFuncs with AVX2")
+struct XXH3AccAVX2
+{
+    __m256i Acc[2];
+    XXH3AccAVX2() noexcept
+    {
+        const XXH3AccNaive init;
+        for (size_t i = 0; i < 2; ++i)
+            Acc[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(init.Acc + i * 4));
+    }
+    forceinline void VECCALL Accumulate(const std::byte* data, const uint8_t* secret) noexcept
+    {
+        for (size_t i = 0; i < 2; ++i)
+        {
+            const auto val = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data) + i);
+            const auto key = _mm256_xor_si256(val, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret) + i));
+            const auto product = _mm256_mul_epu32(key, _mm256_shuffle_epi32(key, 0b10110001)); // lo32 * hi32
+            const auto swapped = _mm256_shuffle_epi32(val, 0b01001110); // swap 64bit
+            Acc[i] = _mm256_add_epi64(_mm256_add_epi64(Acc[i], swapped), product);
+        }
+    }
+    forceinline void VECCALL Scramble(const uint8_t* secret) noexcept
+    {
+        const auto prime = _mm256_set1_epi32(static_cast<int32_t>(XXH3Prime32[0]));
+        for (size_t i = 0; i < 2; ++i)
+        {
+            auto acc = _mm256_xor_si256(Acc[i], _mm256_srli_epi64(Acc[i], 47));
+            acc = _mm256_xor_si256(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret) + i));
+            const auto productLo = _mm256_mul_epu32(acc, prime);
+            const auto productHi = _mm256_mul_epu32(_mm256_srli_epi64(acc, 32), prime);
+            Acc[i] = _mm256_add_epi64(productLo, _mm256_slli_epi64(productHi, 32));
+        }
+    }
+    forceinline void Save(uint64_t* dst) const noexcept
+    {
+        for (size_t i = 0; i < 2; ++i)
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst) + i, Acc[i]);
+    }
+};
+DEFINE_FASTPATH_METHOD(Xxh3, AVX2)
+{
+    return XXH3Base::Hash<XXH3AccAVX2>(data, size);
+}
+DEFINE_FASTPATH_METHOD(Xxh128, AVX2)
+{
+    return XXH3Base::Hash128<XXH3AccAVX2>(data, size);
+}
+#endif
+
+#if COMMON_ARCH_ARM && COMMON_SIMD_LV >= 10
+# pragma message("Compiling DigestFuncs with NEON")
+struct XXH3AccNEON
+{
+    uint64x2_t Acc[4];
+    XXH3AccNEON() noexcept
+    {
+        const XXH3AccNaive init;
+        for (size_t i = 0; i < 4; ++i)
+            Acc[i] = vld1q_u64(init.Acc + i * 2);
+    }
+    forceinline void VECCALL Accumulate(const std::byte* data, const uint8_t* secret) noexcept
+    {
+        for (size_t i = 0; i < 4; ++i)
+        {
+            const auto val = vreinterpretq_u64_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(data) + i * 16));
+            const auto key = veorq_u64(val, vreinterpretq_u64_u8(vld1q_u8(secret + i * 16)));
+            const auto swapped = vextq_u64(val, val, 1);
+            // lo32 * hi32
+            Acc[i] = vmlal_u32(vaddq_u64(Acc[i], swapped), vmovn_u64(key), vshrn_n_u64(key, 32));
+        }
+    }
+    forceinline void VECCALL Scramble(const uint8_t* secret) noexcept
+    {
+        for (size_t i = 0; i < 4; ++i)
+        {
+            auto acc = veorq_u64(Acc[i], vshrq_n_u64(Acc[i], 47));
+            acc = veorq_u64(acc, vreinterpretq_u64_u8(vld1q_u8(secret + i * 16)));
+            const auto productHi = vshlq_n_u64(vmull_n_u32(vshrn_n_u64(acc, 32), XXH3Prime32[0]), 32);
+            Acc[i] = vmlal_n_u32(productHi, vmovn_u64(acc), XXH3Prime32[0]);
+        }
+    }
+    forceinline void Save(uint64_t* dst) const noexcept
+    {
+        for (size_t i = 0; i < 4; ++i)
+            vst1q_u64(dst + i * 2, Acc[i]);
+    }
+};
+DEFINE_FASTPATH_METHOD(Xxh3, NEON)
+{
+    return XXH3Base::Hash<XXH3AccNEON>(data, size);
+}
+DEFINE_FASTPATH_METHOD(Xxh128, NEON)
+{
+    return XXH3Base::Hash128<XXH3AccNEON>(data, size);
+}
+#endif
+
+
+// CRC32C (Castagnoli), reflected polynomial 0x82F63B78
+struct CRC32CTables
+{
+    uint32_t Table[8][256] = {};
+    constexpr CRC32CTables() noexcept
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t crc = i;
+            for (uint32_t j = 0; j < 8; ++j)
+                crc = (crc >> 1) ^ ((crc & 1u) ? 0x82F63B78u : 0u);
+            Table[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            for (uint32_t t = 1; t < 8; ++t)
+                Table[t][i] = (Table[t - 1][i] >> 8) ^ Table[0][Table[t - 1][i] & 0xffu];
+        }
+    }
+};
+static constexpr CRC32CTables CRC32CTable;
+
+// slice-by-8
+DEFINE_FASTPATH_METHOD(Crc32c, NAIVE)
+{
+    const auto& tbl = CRC32CTable.Table;
+    crc = ~crc;
+    for (; size >= 8; size -= 8, data += 8)
+    {
+        const auto lo = XXH3Base::Read32(data) ^ crc, hi = XXH3Base::Read32(data + 4);
+        crc = tbl[7][lo & 0xffu] ^ tbl[6][(lo >> 8) & 0xffu] ^ tbl[5][(lo >> 16) & 0xffu] ^ tbl[4][lo >> 24] ^
+            tbl[3][hi & 0xffu] ^ tbl[2][(hi >> 8) & 0xffu] ^ tbl[1][(hi >> 16) & 0xffu] ^ tbl[0][hi >> 24];
+    }
+    for (; size > 0; --size, ++data)
+        crc = (crc >> 8) ^ tbl[0][(crc ^ std::to_integer<uint32_t>(*data)) & 0xffu];
+    return ~crc;
+}
+
+#if COMMON_ARCH_X86 && COMMON_SIMD_LV >= 42
+# pragma message("Compiling DigestFuncs with SSE4.2 CRC32")
+DEFINE_FASTPATH_METHOD(Crc32c, CRC32)
+{
+# if COMMON_OSBIT == 64
+    uint64_t crc64 = ~crc;
+    for (; size >= 8; size -= 8, data += 8)
+        crc64 = _mm_crc32_u64(crc64, XXH3Base::Read64(data));
+    crc = static_cast<uint32_t>(crc64);
+# else
+    crc = ~crc;
+# endif
+    for (; size >= 4; size -= 4, data += 4)
+        crc = _mm_crc32_u32(crc, XXH3Base::Read32(data));
+    for (; size > 0; --size, ++data)
+        crc = _mm_crc32_u8(crc, std::to_integer<uint8_t>(*data));
+    return ~crc;
+}
+#elif COMMON_ARCH_ARM && defined(__ARM_FEATURE_CRC32)
+# pragma message("Compiling DigestFuncs with ARMv8 CRC32")
+DEFINE_FASTPATH_METHOD(Crc32c, CRC32)
+{
+    crc = ~crc;
+    for (; size >= 8; size -= 8, data += 8)
+        crc = __crc32cd(crc, XXH3Base::Read64(data));
+    for (; size > 0; --size, ++data)
+        crc = __crc32cb(crc, std::to_integer<uint8_t>(*data));
+    return ~crc;
+}
+#endif
+
+
 }
@@ -48,6 +48,39 @@ struct PathInfo<R(*)(A...) noexcept>
 };
 
 
+inline constexpr size_t BenchmarkElementBytes = 16;
+inline constexpr size_t BenchmarkMaxPointers = 3;
+[[nodiscard]] constexpr size_t BenchmarkRegionSize(size_t count) noexcept
+{
+    return (count * BenchmarkElementBytes + 63) / 64 * 64;
+}
+// call a function with generated arguments: pointers get separated regions of scratch, size_t gets count, others get default value
+template <typename T> struct BenchmarkRunner;
+template <typename R, typename... A>
+struct BenchmarkRunner<R(*)(A...) noexcept>
+{
+    template<typename T>
+    forceinline static T PrepareArg([[maybe_unused]] std::byte* scratch, [[maybe_unused]] size_t count, [[maybe_unused]] size_t& ptrIdx) noexcept
+    {
+        if constexpr (std::is_pointer_v<T>)
+            return reinterpret_cast<T>(scratch + BenchmarkRegionSize(count) * (ptrIdx++));
+        else if constexpr (std::is_same_v<std::remove_cv_t<T>, size_t>)
+            return count;
+        else
+            return std::remove_cv_t<T>{};
+    }
+    static void Run(void* func, std::byte* scratch, size_t count) noexcept
+    {
+        static_assert((0 + ... + (std::is_pointer_v<A> ? 1 : 0)) <= BenchmarkMaxPointers, "too many pointers");
+        static_assert((... && !std::is_pointer_v<std::remove_cv_t<std::remove_pointer_t<A>>>), "pointer array is not supported");
+        const auto ptr = reinterpret_cast<R(*)(A...) noexcept>(func);
+        size_t ptrIdx = 0;
+        const std::tuple<A...> args{ PrepareArg<A>(scratch, count, ptrIdx)... }; // braced-init keeps order
+        static_cast<void>(std::apply(ptr, args));
+    }
+};
+
+
 }
 
 
@@ -115,6 +148,20 @@ static void clz##_GatherSupportMap(::std::vector<::common::FastPathBase::PathInf
     BOOST_PP_SEQ_FOR_EACH(MERGE_FASTPATH_PARTIAL, clz, BOOST_PP_VARIADIC_TO_SEQ(__VA_ARGS__))       \
 }
 
+#define FASTPATH_BENCHMARK_ITEM(r, clz, func) ret.push_back({ STRINGIZE(func), &::common::fastpath::BenchmarkRunner<decltype(clz::func)>::Run });
+#define DEFINE_FASTPATH_BENCHMARKS(clz, ...)                                                        \
+::common::span<const clz::BenchmarkInfo> clz::GetBenchmarks() noexcept                              \
+{                                                                                                   \
+    static auto list = []()                                                                         \
+    {                                                                                               \
+        ::std::vector<BenchmarkInfo> ret;                                                           \
+        BOOST_PP_SEQ_FOR_EACH(FASTPATH_BENCHMARK_ITEM, clz, BOOST_PP_VARIADIC_TO_SEQ(__VA_ARGS__))  \
+        return ret;                                                                                 \
+    }();                                                                                            \
+    return list;                                                                                    \
+}
+
+
 #define DEFINE_FASTPATH_SCOPE(scope) static bool PPCAT(FastPathCheck_,scope)() noexcept
 #define FASTPATH_ITEM(r, clz, func) ret.emplace_back(STRINGIZE(func), &::common::fastpath::PathHack::Access<clz, &clz::func>);
 #define CHECK_FASTPATH_FUNC(r, state, func) state && func
@@ -3,6 +3,12 @@
 #include "SystemCommonRely.h"
 #include "common/SpinLock.hpp"
 
+#if defined(__cpp_lib_atomic_wait) && __cpp_lib_atomic_wait >= 201907L
+#   define SYSCOMMON_SPINLOCK_PARK 1
+#else
+#   define SYSCOMMON_SPINLOCK_PARK 0
+#endif
+
 
 namespace common
 {
@@ -10,7 +16,39 @@ namespace common
 namespace spinlock
 {
 
-struct SpinLocker : private common::SpinLocker
+// optional contention counters, can be shared by multiple locks
+struct SpinLockStats
+{
+    std::atomic<uint64_t> Contended{ 0 }; // acquisitions failed at the first try
+    std::atomic<uint64_t> Parked{ 0 };    // acquisitions escalated to OS wait
+};
+
+
+// Spin with pause, then park on the lock word (futex/WaitOnAddress) when it's still contended.
+// Unlockers only notify when someone is parked, so the uncontended path stays syscall-free.
+class LockWaiter
+{
+protected:
+    std::atomic<uint32_t> ParkCount{ 0 };
+    SpinLockStats* Stats = nullptr;
+    template<typename F>
+    forceinline void NotifyParked([[maybe_unused]] F& flag) noexcept
+    {
+#if SYSCOMMON_SPINLOCK_PARK
+        IF_UNLIKELY(ParkCount.load() != 0)
+            flag.notify_all();
+#endif
+    }
+    template<typename F, typename FL>
+    void Wait(F& flag, FL&& lock) noexcept;
+public:
+    constexpr LockWaiter() noexcept { }
+    LockWaiter(LockWaiter&& other) noexcept : Stats(other.Stats) { }
+    // stats should outlive the lock, nullptr to detach
+    void SetStats(SpinLockStats* stats) noexcept { Stats = stats; }
+};
+
+struct SpinLocker : private common::SpinLocker, public LockWaiter
 {
 public:
     using common::SpinLocker::SpinLocker;
@@ -19,6 +57,7 @@ public:
     void Unlock() noexcept
     {
         common::SpinLocker::Unlock();
+        NotifyParked(Flag);
     }
     using ScopeType = detail::LockScope<SpinLocker, &SpinLocker::Lock, &SpinLocker::Unlock>;
     ScopeType LockScope() noexcept
@@ -28,18 +67,20 @@ public:
 };
 
 
-struct PreferSpinLock : private common::PreferSpinLock //Strong-first
+struct PreferSpinLock : private common::PreferSpinLock, public LockWaiter //Strong-first
 {
     using common::PreferSpinLock::PreferSpinLock;
     SYSCOMMONAPI void LockWeak() noexcept;
     void UnlockWeak() noexcept
     {
         common::PreferSpinLock::UnlockWeak();
+        NotifyParked(Flag);
     }
     SYSCOMMONAPI void LockStrong() noexcept;
     void UnlockStrong() noexcept
     {
         common::PreferSpinLock::UnlockStrong();
+        NotifyParked(Flag);
     }
     using WeakScopeType = detail::LockScope<PreferSpinLock, &PreferSpinLock::LockWeak, &PreferSpinLock::UnlockWeak>;
     WeakScopeType WeakScope() noexcept
@@ -53,18 +94,20 @@ struct PreferSpinLock : private common::PreferSpinLock //Strong-first
     }
 };
 
-struct WRSpinLock : private common::WRSpinLock //Writer-first
+struct WRSpinLock : private common::WRSpinLock, public LockWaiter //Writer-first
 {
     using common::WRSpinLock::WRSpinLock;
     SYSCOMMONAPI void LockRead() noexcept;
     void UnlockRead() noexcept
     {
         common::WRSpinLock::UnlockRead();
+        NotifyParked(Flag);
     }
     SYSCOMMONAPI void LockWrite() noexcept;
     void UnlockWrite() noexcept
     {
         common::WRSpinLock::UnlockWrite();
+        NotifyParked(Flag);
     }
     using ReadScopeType = detail::LockScope<WRSpinLock, &WRSpinLock::LockRead, &WRSpinLock::UnlockRead>;
     ReadScopeType ReadScope() noexcept
@@ -78,18 +121,20 @@ struct WRSpinLock : private common::WRSpinLock //Writer-first
     }
 };
 
-struct RWSpinLock : private common::RWSpinLock //Reader-first
+struct RWSpinLock : private common::RWSpinLock, public LockWaiter //Reader-first
 {
     using common::RWSpinLock::RWSpinLock;
     SYSCOMMONAPI void LockRead() noexcept;
     void UnlockRead() noexcept
     {
         common::RWSpinLock::UnlockRead();
+        NotifyParked(Flag);
     }
     SYSCOMMONAPI void LockWrite() noexcept;
     void UnlockWrite() noexcept
     {
         common::RWSpinLock::UnlockWrite();
+        NotifyParked(Flag);
     }
     using ReadScopeType = detail::LockScope<RWSpinLock, &RWSpinLock::LockRead, &RWSpinLock::UnlockRead>;
     ReadScopeType ReadScope() noexcept
@@ -101,7 +146,11 @@ struct RWSpinLock : private common::RWSpinLock //Reader-first
     {
         return WriteScopeType(this);
     }
-    SYSCOMMONAPI void DowngradeToRead() noexcept;
+    void DowngradeToRead() noexcept
+    {
+        common::RWSpinLock::DowngradeToRead();
+        NotifyParked(Flag);
+    }
 };
 
 
@@ -3,6 +3,7 @@
 #include "StringFormat.h"
 #include "ConsoleEx.h"
 #include "SpinLock.h"
+#include "RuntimeFastPath.h"
 #include "common/simd/SIMD.hpp"
 #include "common/StringLinq.hpp"
 #include <boost/version.hpp>
@@ -35,6 +36,7 @@
 #endif
 
 #include <cstdarg>
+#include <cstdio>
 #include <deque>
 #include <mutex>
 #include <shared_mutex>
@@ -621,6 +623,154 @@ void FastPathBase::MergeInto(std::vector<PathInfo>& dst, common::span<const Path
     }
 }
 
+std::vector<FastPathBase::VarItem> FastPathBase::Calibrate(common::span<const PathInfo> info, common::span<const BenchmarkInfo> benchmarks) noexcept
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr size_t Counts[] = { 64, 4096, 65536 };
+    constexpr auto MinBatchTime = std::chrono::microseconds(50);
+    const auto regionSize = fastpath::BenchmarkRegionSize(Counts[std::size(Counts) - 1]);
+    // 0x3c makes valid small floats/halfs, avoid denormal and nan
+    std::vector<std::byte> buffer(regionSize * fastpath::BenchmarkMaxPointers + 64, std::byte(0x3c));
+    const auto scratch = reinterpret_cast<std::byte*>((reinterpret_cast<uintptr_t>(buffer.data()) + 63) / 64 * 64);
+    // ns per call, best of several batches
+    const auto measure = [&](const BenchmarkInfo& bench, void* func, size_t count)
+    {
+        bench.Runner(func, scratch, count); // warm up
+        uint32_t loops = 1;
+        while (true)
+        {
+            const auto begin = Clock::now();
+            for (uint32_t i = 0; i < loops; ++i)
+                bench.Runner(func, scratch, count);
+            if (Clock::now() - begin >= MinBatchTime || loops >= (1u << 20))
+                break;
+            loops <<= 1;
+        }
+        double best = std::numeric_limits<double>::max();
+        for (uint32_t round = 0; round < 3; ++round)
+        {
+            const auto begin = Clock::now();
+            for (uint32_t i = 0; i < loops; ++i)
+                bench.Runner(func, scratch, count);
+            const std::chrono::duration<double, std::nano> elapsed = Clock::now() - begin;
+            best = std::min(best, elapsed.count() / loops);
+        }
+        return best;
+    };
+
+    std::vector<VarItem> ret;
+    for (const auto& path : info)
+    {
+        if (path.Variants.empty())
+            continue;
+        const BenchmarkInfo* bench = nullptr;
+        for (const auto& item : benchmarks)
+        {
+            if (path.FuncName == item.FuncName)
+            {
+                bench = &item;
+                break;
+            }
+        }
+        size_t bestIdx = 0;
+        if (bench && path.Variants.size() > 1)
+        {
+            std::vector<double> times;
+            times.reserve(path.Variants.size() * std::size(Counts));
+            for (const auto& var : path.Variants)
+            {
+                for (const auto count : Counts)
+                    times.push_back(measure(*bench, var.FuncPtr, count));
+            }
+            // every size class has the same weight, score is the sum of time relative to the fastest one
+            std::vector<double> scores(path.Variants.size(), 0.0);
+            for (size_t j = 0; j < std::size(Counts); ++j)
+            {
+                double fastest = std::numeric_limits<double>::max();
+                for (size_t i = 0; i < path.Variants.size(); ++i)
+                    fastest = std::min(fastest, times[i * std::size(Counts) + j]);
+                for (size_t i = 0; i < path.Variants.size(); ++i)
+                    scores[i] += times[i * std::size(Counts) + j] / std::max(fastest, 1e-3);
+            }
+            // prefer earlier variant unless it's noticeably slower, to avoid flipping due to noise
+            for (size_t i = 1; i < scores.size(); ++i)
+            {
+                if (scores[i] * 1.05 < scores[bestIdx])
+                    bestIdx = i;
+            }
+        }
+        ret.emplace_back(path.FuncName, path.Variants[bestIdx].MethodName);
+    }
+    return ret;
+}
+
+std::string FastPathBase::SerializeProfile(common::span<const VarItem> items)
+{
+    std::string ret;
+    for (const auto& [func, method] : items)
+        ret.append(func).append(1, '=').append(method).append(1, '\n');
+    return ret;
+}
+
+std::vector<FastPathBase::VarItem> FastPathBase::LoadProfile(common::span<const PathInfo> info, std::string_view profile) noexcept
+{
+    // returned items should refer to names inside info, since profile may be a temporary
+    std::vector<VarItem> ret;
+    for (const auto& path : info)
+    {
+        if (path.Variants.empty())
+            continue;
+        std::string_view method = path.Variants.front().MethodName;
+        for (const auto line : str::SplitStream(profile, '\n', false))
+        {
+            if (line.empty() || line[0] == '#')
+                continue;
+            const auto sep = line.find('=');
+            if (sep == std::string_view::npos || path.FuncName != line.substr(0, sep))
+                continue;
+            auto name = line.substr(sep + 1);
+            if (!name.empty() && name.back() == '\r')
+                name.remove_suffix(1);
+            for (const auto& var : path.Variants)
+            {
+                if (var.MethodName == name)
+                {
+                    method = var.MethodName;
+                    break;
+                }
+            }
+            break;
+        }
+        ret.emplace_back(path.FuncName, method);
+    }
+    return ret;
+}
+
+std::string_view FastPathBase::GetStartupProfile() noexcept
+{
+    // called when constructing global instances, so only rely on CRT here
+    static const std::string Profile = []()
+    {
+        std::string content;
+        const auto fileName = GetEnvVar("SYSCOMMON_FASTPATH_PROFILE");
+        if (fileName.empty())
+            return content;
+        if (const auto fp = fopen(fileName.c_str(), "rb"); fp)
+        {
+            char buf[4096];
+            size_t len = 0;
+            while ((len = fread(buf, 1, sizeof(buf), fp)) > 0)
+                content.append(buf, len);
+            fclose(fp);
+            detail::InitMessage::Enqueue(mlog::LogLevel::Verbose, "FastPath", "loaded startup profile from [" + fileName + "]\n");
+        }
+        else
+            detail::InitMessage::Enqueue(mlog::LogLevel::Warning, "FastPath", "failed to read startup profile [" + fileName + "]\n");
+        return content;
+    }();
+    return Profile;
+}
+
 }
 
 
@@ -158,6 +158,12 @@ public:
         PathInfo(std::string_view name) noexcept : FuncName(name) { }
     };
     using VarItem = std::pair<std::string_view, std::string_view>;
+    struct BenchmarkInfo
+    {
+        std::string_view FuncName;
+        // run func on scratch buffer with count elements, see fastpath::BenchmarkRunner
+        void(*Runner)(void* func, std::byte* scratch, size_t count) noexcept;
+    };
     COMMON_NO_COPY(FastPathBase)
     COMMON_NO_MOVE(FastPathBase)
     [[nodiscard]] virtual bool IsComplete() const noexcept = 0;
@@ -166,6 +172,14 @@ public:
         return VariantMap;
     }
     SYSCOMMONAPI static void MergeInto(std::vector<PathInfo>& dst, common::span<const PathInfo> src) noexcept;
+    // time each variant on several sizes and pick the fastest, functions without benchmark use the default one
+    SYSCOMMONAPI [[nodiscard]] static std::vector<VarItem> Calibrate(common::span<const PathInfo> info, common::span<const BenchmarkInfo> benchmarks) noexcept;
+    // one "func=method" per line, lines starting with '#' are ignored
+    SYSCOMMONAPI [[nodiscard]] static std::string SerializeProfile(common::span<const VarItem> items);
+    // unknown or unsupported items are skipped, missing functions use the default variant
+    SYSCOMMONAPI [[nodiscard]] static std::vector<VarItem> LoadProfile(common::span<const PathInfo> info, std::string_view profile) noexcept;
+    // content of the file named by env SYSCOMMON_FASTPATH_PROFILE, read once, empty when not provided or failed to read
+    SYSCOMMONAPI [[nodiscard]] static std::string_view GetStartupProfile() noexcept;
 protected:
     FastPathBase() noexcept {}
     SYSCOMMONAPI void Init(common::span<const PathInfo> info, common::span<const VarItem> requests) noexcept;
@@ -184,8 +198,20 @@ private:
 protected:
     void Init(common::span<const VarItem> requests) noexcept { Init(T::GetSupportMap(), requests); }
 public:
+    using FastPathBase::VarItem;
+    using FastPathBase::BenchmarkInfo;
     using FastPathBase::IsComplete;
     using FastPathBase::GetIntrinMap;
+    using FastPathBase::SerializeProfile;
+    // requires T::GetBenchmarks
+    [[nodiscard]] static std::vector<VarItem> Calibrate() noexcept { return FastPathBase::Calibrate(T::GetSupportMap(), T::GetBenchmarks()); }
+    [[nodiscard]] static std::vector<VarItem> LoadProfile(std::string_view profile) noexcept { return FastPathBase::LoadProfile(T::GetSupportMap(), profile); }
+    // used to build process-wide instances, empty means default variants
+    [[nodiscard]] static std::vector<VarItem> StartupRequests() noexcept
+    {
+        const auto profile = FastPathBase::GetStartupProfile();
+        return profile.empty() ? std::vector<VarItem>{} : LoadProfile(profile);
+    }
 };
 
 
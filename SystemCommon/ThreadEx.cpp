@@ -37,6 +37,9 @@ typedef int (*GetThreadNamePtr)(pthread_t __pthread, char* __buf, size_t __n);
 #   include <pthread/qos.h>
 #endif
 #include <map>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
 #include <inttypes.h>
 
 namespace common
@@ -253,6 +256,8 @@ void TopologyInfo::PrintTopology()
         PrintCache("L4", proc.cache.l4);
         printf("\n");
     }
+    for (const auto& node : CPUDomain::GetDomains(CPUDomain::Levels::NUMA))
+        printf("numa[%u]: %s\n", node.Id, node.Affinity.ToString().c_str());
 }
 
 
@@ -786,10 +791,14 @@ static void AssignMask(ThreadAffinity& affinity, uint32_t procId)
     for (const auto procId : procIds)
         AssignMask(partition.Affinity, procId);
 }
-static void AssignPartition(CPUPartition& partition, uint32_t idStart, uint32_t count)
+static void AssignMask(ThreadAffinity& affinity, uint32_t idStart, uint32_t count)
 {
     while (count--)
-        AssignMask(partition.Affinity, idStart++);
+        AssignMask(affinity, idStart++);
+}
+static void AssignPartition(CPUPartition& partition, uint32_t idStart, uint32_t count)
+{
+    AssignMask(partition.Affinity, idStart, count);
 }
 static void BuildPartition(std::vector<CPUPartition>& partitions) noexcept
 {
@@ -890,6 +899,304 @@ span<const CPUPartition> CPUPartition::GetPartitions() noexcept
 }
 
 
+#if COMMON_OS_LINUX
+// parse cpulist format like "0-3,8,10-11"
+template<typename F>
+static void ParseCPUList(std::string_view list, F&& func)
+{
+    while (!list.empty())
+    {
+        const auto sep = list.find(',');
+        const auto item = list.substr(0, sep);
+        list = sep == std::string_view::npos ? std::string_view{} : list.substr(sep + 1);
+        uint32_t from = 0, to = 0;
+        const auto ret = sscanf(std::string(item).c_str(), "%u-%u", &from, &to);
+        if (ret <= 0)
+            continue;
+        if (ret == 1)
+            to = from;
+        for (auto i = from; i <= to; ++i)
+            func(i);
+    }
+}
+static std::string ReadSysfsLine(const char* path)
+{
+    std::string ret;
+    if (auto fp = fopen(path, "r"); fp)
+    {
+        char buf[1024] = { '\0' };
+        if (fgets(buf, sizeof(buf), fp))
+            ret = buf;
+        fclose(fp);
+    }
+    while (!ret.empty() && (ret.back() == '\n' || ret.back() == '\r'))
+        ret.pop_back();
+    return ret;
+}
+#endif
+static void BuildNUMADomains(std::vector<CPUDomain>& domains)
+{
+    const span<const cpuinfo_processor> procs{ cpuinfo_get_processors(), cpuinfo_get_processors_count() };
+    const auto GetDomain = [&](uint32_t nodeId) -> CPUDomain&
+    {
+        for (auto& domain : domains)
+        {
+            if (domain.Id == nodeId)
+                return domain;
+        }
+        return domains.emplace_back(CPUDomain::Levels::NUMA, nodeId);
+    };
+#if COMMON_OS_WIN
+    for (uint32_t i = 0; i < procs.size(); ++i)
+    {
+        PROCESSOR_NUMBER procNum = {};
+        procNum.Group = gsl::narrow_cast<WORD>(procs[i].windows_group_id);
+        procNum.Number = gsl::narrow_cast<BYTE>(procs[i].windows_processor_id);
+        USHORT nodeId = 0;
+        if (!::GetNumaProcessorNodeEx(&procNum, &nodeId) || nodeId == MAXUSHORT)
+            nodeId = 0;
+        AssignMask(GetDomain(nodeId).Affinity, i);
+    }
+#elif COMMON_OS_LINUX
+    std::map<uint32_t, uint32_t> linuxIdMap;
+    for (uint32_t i = 0; i < procs.size(); ++i)
+        linuxIdMap.emplace(procs[i].linux_id, i);
+    ParseCPUList(ReadSysfsLine("/sys/devices/system/node/online"), [&](uint32_t nodeId)
+        {
+            char path[128] = { '\0' };
+            snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", nodeId);
+            ParseCPUList(ReadSysfsLine(path), [&](uint32_t linuxId)
+                {
+                    if (const auto it = linuxIdMap.find(linuxId); it != linuxIdMap.end())
+                        AssignMask(GetDomain(nodeId).Affinity, it->second);
+                });
+        });
+#endif
+    if (domains.empty()) // no NUMA info, treat as single node
+    {
+        auto& domain = GetDomain(0);
+        for (uint32_t i = 0; i < procs.size(); ++i)
+            AssignMask(domain.Affinity, i);
+    }
+    std::sort(domains.begin(), domains.end(), [](const auto& lhs, const auto& rhs) { return lhs.Id < rhs.Id; });
+}
+static std::vector<CPUDomain> BuildDomains(CPUDomain::Levels level)
+{
+    EnsureCPUInfoInited();
+    std::vector<CPUDomain> domains;
+    const auto AddCaches = [&](const cpuinfo_cache* caches, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            auto& domain = domains.emplace_back(level, i);
+            domain.CacheSize = caches[i].size;
+            AssignMask(domain.Affinity, caches[i].processor_start, caches[i].processor_count);
+        }
+    };
+    switch (level)
+    {
+    case CPUDomain::Levels::Core:
+        for (const auto& core : span<const cpuinfo_core>{ cpuinfo_get_cores(), cpuinfo_get_cores_count() })
+        {
+            auto& domain = domains.emplace_back(level, core.core_id);
+            AssignMask(domain.Affinity, core.processor_start, core.processor_count);
+        }
+        break;
+    case CPUDomain::Levels::L2: AddCaches(cpuinfo_get_l2_caches(), cpuinfo_get_l2_caches_count()); break;
+    case CPUDomain::Levels::L3: AddCaches(cpuinfo_get_l3_caches(), cpuinfo_get_l3_caches_count()); break;
+    case CPUDomain::Levels::NUMA: BuildNUMADomains(domains); break;
+    default: break;
+    }
+    return domains;
+}
+
+span<const CPUDomain> CPUDomain::GetDomains(Levels level) noexcept
+{
+    static const std::vector<CPUDomain> Domains[4] =
+    {
+        BuildDomains(Levels::Core), BuildDomains(Levels::L2), BuildDomains(Levels::L3), BuildDomains(Levels::NUMA),
+    };
+    const auto idx = static_cast<uint8_t>(level);
+    Expects(idx < 4);
+    return Domains[idx];
+}
+
+const CPUDomain* CPUDomain::Locate(uint32_t group, uint32_t idx, Levels level) noexcept
+{
+    for (const auto& domain : GetDomains(level))
+    {
+        if (domain.Affinity.Get(group, idx))
+            return &domain;
+    }
+    return nullptr;
+}
+
+std::vector<ThreadAffinity> CPUDomain::Split(const ThreadAffinity& affinity, Levels level)
+{
+    std::vector<ThreadAffinity> ret;
+    for (const auto& domain : GetDomains(level))
+    {
+        auto part = domain.Affinity;
+        part &= affinity;
+        if (part.GetCount() > 0)
+            ret.push_back(std::move(part));
+    }
+    return ret;
+}
+
+ThreadAffinity CPUDomain::ExcludeSMTSiblings(const ThreadAffinity& affinity) noexcept
+{
+    const auto& info = TopologyInfo::Get();
+    ThreadAffinity ret;
+    for (const auto& core : GetDomains(Levels::Core))
+    {
+        bool found = false;
+        for (uint32_t gid = 0; gid < info.GetGroupCount() && !found; ++gid)
+        {
+            const auto count = info.GetCountInGroup(gid);
+            for (uint32_t i = 0; i < count && !found; ++i)
+            {
+                if (core.Affinity.Get(gid, i) && affinity.Get(gid, i))
+                {
+                    ret.Set(gid, i, true);
+                    found = true;
+                }
+            }
+        }
+    }
+    return ret;
+}
+
+
+struct WorkerPoolHost
+{
+    static constexpr auto IdleTimeout = std::chrono::seconds(5);
+    std::mutex Mutex;
+    std::condition_variable NewTask;
+    std::deque<std::function<void()>> Tasks;
+    const uint32_t MaxThreadCount;
+    uint32_t ThreadCount = 0, IdleCount = 0;
+    WorkerPoolHost() noexcept : MaxThreadCount(std::max(TopologyInfo::Get().GetTotalProcessorCount(), 1u))
+    { }
+    void WorkerLoop() noexcept
+    {
+        ThreadObject::GetCurrentThreadObject().SetName(u"WorkerPool");
+        std::unique_lock<std::mutex> lock(Mutex);
+        while (true)
+        {
+            if (Tasks.empty())
+            {
+                IdleCount++;
+                const bool hasTask = NewTask.wait_for(lock, IdleTimeout, [&]() { return !Tasks.empty(); });
+                IdleCount--;
+                if (!hasTask)
+                {
+                    ThreadCount--;
+                    return;
+                }
+            }
+            auto task = std::move(Tasks.front());
+            Tasks.pop_front();
+            lock.unlock();
+            try
+            {
+                task();
+            }
+            catch (...) {}
+            task = {};
+            lock.lock();
+        }
+    }
+    void Post(std::function<void()> task)
+    {
+        {
+            std::unique_lock<std::mutex> lock(Mutex);
+            // only spawn when idle threads are not enough, spawn first so that failure leaves no task behind
+            if (IdleCount <= Tasks.size() && ThreadCount < MaxThreadCount)
+            {
+                std::thread([this]() { WorkerLoop(); }).detach();
+                ThreadCount++;
+            }
+            Tasks.push_back(std::move(task));
+        }
+        NewTask.notify_one();
+    }
+};
+// never destroyed, detached threads may still wait on it during exit, and joining in static destructor could deadlock
+[[nodiscard]] static WorkerPoolHost& GetWorkerPoolHost() noexcept
+{
+    static WorkerPoolHost* const Host = new WorkerPoolHost();
+    return *Host;
+}
+
+void WorkerPool::Post(std::function<void()> task)
+{
+    GetWorkerPoolHost().Post(std::move(task));
+}
+
+void WorkerPool::ParallelRun(const uint32_t count, const std::function<void(uint32_t)>& func)
+{
+    if (count == 0)
+        return;
+    // shared with helper tasks, which may start after the call returns, when all indexes have been taken
+    struct Batch
+    {
+        const std::function<void(uint32_t)>& Func;
+        std::mutex Mutex;
+        std::condition_variable Finished;
+        std::exception_ptr Exception;
+        std::atomic<uint32_t> NextIdx = 0;
+        const uint32_t Count;
+        uint32_t Pending;
+        Batch(const std::function<void(uint32_t)>& func, const uint32_t count) noexcept :
+            Func(func), Count(count), Pending(count) { }
+        void Run() noexcept
+        {
+            while (true)
+            {
+                const auto idx = NextIdx++;
+                if (idx >= Count)
+                    return;
+                // Func is only touched when an index is taken, when the caller is still waiting
+                std::exception_ptr ex;
+                try
+                {
+                    Func(idx);
+                }
+                catch (...)
+                {
+                    ex = std::current_exception();
+                }
+                std::unique_lock<std::mutex> lock(Mutex);
+                if (ex && !Exception)
+                    Exception = ex;
+                if (--Pending == 0)
+                    Finished.notify_all();
+            }
+        }
+    };
+    auto& host = GetWorkerPoolHost();
+    const auto batch = std::make_shared<Batch>(func, count);
+    const auto helperCount = std::min(count, host.MaxThreadCount) - 1;
+    try
+    {
+        for (uint32_t i = 0; i < helperCount; ++i)
+            host.Post([batch]() { batch->Run(); });
+    }
+    catch (...) {} // the caller can still finish all of them
+    batch->Run();
+    std::unique_lock<std::mutex> lock(batch->Mutex);
+    batch->Finished.wait(lock, [&]() { return batch->Pending == 0; });
+    if (batch->Exception)
+        std::rethrow_exception(batch->Exception);
+}
+
+uint32_t WorkerPool::GetMaxThreadCount() noexcept
+{
+    return GetWorkerPoolHost().MaxThreadCount;
+}
+
+
 struct CPUFeature
 {
     std::vector<std::string_view> FeatureText;
@@ -4,10 +4,12 @@
 #include "MiscIntrins.h"
 #include "common/STLEx.hpp"
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <string_view>
 #include <memory>
 #include <optional>
+#include <vector>
 
 #if !defined(_MANAGED) && !defined(_M_CEE)
 #   include <thread>
@@ -108,6 +110,22 @@ public:
         const auto& info = TopologyInfo::Get();
         return MiscIntrin.PopCountRange<std::byte>({ GetRawData(), info.GetGroupCount() * info.BitsPerGroup / 8 });
     }
+    ThreadAffinity& operator&=(const ThreadAffinity& other) noexcept
+    {
+        const auto& info = TopologyInfo::Get();
+        const auto bytes = info.GetGroupCount() * info.BitsPerGroup / 8;
+        for (uint32_t i = 0; i < bytes; ++i)
+            Mask.Data()[i] &= other.Mask.Data()[i];
+        return *this;
+    }
+    ThreadAffinity& operator|=(const ThreadAffinity& other) noexcept
+    {
+        const auto& info = TopologyInfo::Get();
+        const auto bytes = info.GetGroupCount() * info.BitsPerGroup / 8;
+        for (uint32_t i = 0; i < bytes; ++i)
+            Mask.Data()[i] |= other.Mask.Data()[i];
+        return *this;
+    }
     SYSCOMMONAPI [[nodiscard]] std::string ToString(std::pair<char, char> ch = { 'x','.' }) const noexcept;
 };
 
@@ -122,6 +140,26 @@ struct CPUPartition
 };
 
 
+// logical processors sharing the same physical core, cache or NUMA node
+struct CPUDomain
+{
+    enum class Levels : uint8_t { Core = 0, L2, L3, NUMA };
+    ThreadAffinity Affinity;
+    uint32_t Id;
+    uint32_t CacheSize = 0; // in bytes, only for cache level
+    Levels Level;
+    CPUDomain(Levels level, uint32_t id) noexcept : Id(id), Level(level) {}
+    // each logical processor belongs to at most one domain of the same level
+    SYSCOMMONAPI [[nodiscard]] static span<const CPUDomain> GetDomains(Levels level) noexcept;
+    // domain of the level that contains the logical processor
+    SYSCOMMONAPI [[nodiscard]] static const CPUDomain* Locate(uint32_t group, uint32_t idx, Levels level) noexcept;
+    // split the affinity with domains of the level, empty parts are skipped
+    SYSCOMMONAPI [[nodiscard]] static std::vector<ThreadAffinity> Split(const ThreadAffinity& affinity, Levels level);
+    // only keep the first logical processor of each physical core
+    SYSCOMMONAPI [[nodiscard]] static ThreadAffinity ExcludeSMTSiblings(const ThreadAffinity& affinity) noexcept;
+};
+
+
 enum class ThreadQoS
 {
     Default, Background, Utility, Burst, High
@@ -187,4 +225,18 @@ public:
 #endif
 
 
+// process-wide worker threads, shared by modules instead of each keeping its own pool.
+// threads are created on demand and exit after being idle for a while, they are never joined at exit
+class WorkerPool
+{
+public:
+    // run task on a worker thread, task should not throw
+    SYSCOMMONAPI static void Post(std::function<void()> task);
+    // run func(0~count-1) and return after all finished, the caller thread also takes part so it always makes progress.
+    // an index can be run on any thread, the first exception is rethrown after all finished
+    SYSCOMMONAPI static void ParallelRun(const uint32_t count, const std::function<void(uint32_t)>& func);
+    SYSCOMMONAPI [[nodiscard]] static uint32_t GetMaxThreadCount() noexcept;
+};
+
+
 }
\ No newline at end of file
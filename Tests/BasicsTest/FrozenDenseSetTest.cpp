@@ -0,0 +1,116 @@
+#include "pch.h"
+#include "common/FrozenDenseSet.hpp"
+#include "common/ContainerEx.hpp"
+
+using namespace std::string_view_literals;
+using common::container::FrozenDenseSet;
+using common::container::FrozenDenseStringSet;
+using common::container::FrozenDenseStringSetSimple;
+
+
+TEST(FrozenDenseSet, Find)
+{
+    // cover empty, full and partial last level of the eytzinger tree
+    for (uint32_t count = 0; count < 70; ++count)
+    {
+        std::vector<uint32_t> src;
+        for (uint32_t i = count; i-- > 0;)
+            src.push_back(i * 3 + 1);
+        const FrozenDenseSet<uint32_t> set(std::move(src));
+        ASSERT_EQ(set.Size(), count);
+        const auto& data = set.RawData();
+        EXPECT_TRUE(std::is_sorted(data.cbegin(), data.cend()));
+        for (uint32_t i = 0; i < count * 3 + 2; ++i)
+        {
+            const auto ptr = set.Find(i);
+            if (i % 3 == 1 && i / 3 < count)
+            {
+                ASSERT_NE(ptr, nullptr) << "count " << count << " key " << i;
+                EXPECT_EQ(*ptr, i);
+                EXPECT_EQ(ptr, data.data() + i / 3);
+            }
+            else
+                EXPECT_EQ(ptr, nullptr) << "count " << count << " key " << i;
+        }
+    }
+}
+
+TEST(FrozenDenseSet, FindByKey)
+{
+    struct Item
+    {
+        std::string Name;
+        uint32_t Value;
+    };
+    using Lesser = common::container::SetKeyLess<Item, &Item::Name>;
+    std::vector<Item> src;
+    for (const auto name : { "pos"sv, "normal"sv, "uv"sv, "tangent"sv, "color"sv, "weight"sv, "bone"sv })
+        src.push_back({ std::string(name), static_cast<uint32_t>(src.size()) });
+    const FrozenDenseSet<Item, Lesser> set(src);
+    const auto& data = set.RawData();
+    // returned pointers are used as handles and checked against RawData by callers
+    std::map<const Item*, uint32_t> handles;
+    for (const auto& item : src)
+    {
+        const auto ptr = set.Find(std::string_view(item.Name));
+        ASSERT_NE(ptr, nullptr);
+        EXPECT_EQ(ptr->Value, item.Value);
+        EXPECT_GE(ptr, data.data());
+        EXPECT_LT(ptr, data.data() + data.size());
+        handles.emplace(ptr, item.Value);
+    }
+    EXPECT_EQ(handles.size(), src.size());
+    for (const auto& item : data)
+        EXPECT_EQ(handles[&item], item.Value);
+    EXPECT_EQ(set.Find("Pos"sv), nullptr);
+    EXPECT_FALSE(set.Has("z"sv));
+}
+
+TEST(FrozenDenseSet, StringFind)
+{
+    const std::vector<std::string_view> src = { "delta"sv, "alpha"sv, "charlie"sv, "bravo"sv, "alpha"sv, ""sv, "echo"sv };
+    const FrozenDenseStringSet<char> set(src);
+    ASSERT_EQ(set.Size(), 5u);
+    constexpr std::string_view Ordered[] = { "alpha"sv, "bravo"sv, "charlie"sv, "delta"sv, "echo"sv };
+    std::vector<std::string_view> items;
+    for (const auto str : set)
+        items.push_back(str);
+    EXPECT_THAT(items, testing::ElementsAreArray(Ordered));
+    for (size_t i = 0; i < std::size(Ordered); ++i)
+    {
+        EXPECT_EQ(set.Find(Ordered[i]), Ordered[i]);
+        EXPECT_EQ(set.GetIndex(Ordered[i]), i);
+        EXPECT_EQ(set[i], Ordered[i]);
+    }
+    EXPECT_FALSE(set.Has("alph"sv));
+    EXPECT_FALSE(set.Has("foxtrot"sv));
+    EXPECT_EQ(set.GetIndex("foxtrot"sv), SIZE_MAX);
+
+    const FrozenDenseStringSetSimple<char> simple(src);
+    EXPECT_EQ(simple.Size(), 5u);
+    for (const auto str : Ordered)
+        EXPECT_EQ(simple.Find(str), str);
+    EXPECT_FALSE(simple.Has("Echo"sv));
+}
+
+TEST(FrozenDenseSet, StringCollision)
+{
+    // DJBHash only depends on c0*33+c1 for two chars, so these share one hash
+    static_assert(common::DJBHash::HashC("Ab"sv) == common::DJBHash::HashC("BA"sv));
+    static_assert(common::DJBHash::HashC("Ab"sv) == common::DJBHash::HashC("C "sv));
+    static_assert(common::DJBHash::HashC("AbAb"sv) == common::DJBHash::HashC("BABA"sv));
+    const std::vector<std::string_view> src = { "AbAb"sv, "x"sv, "BABA"sv, "AbBA"sv, "Ab"sv, "BAAb"sv, "BA"sv, "y"sv };
+    const FrozenDenseStringSet<char> set(src);
+    ASSERT_EQ(set.Size(), src.size());
+    for (const auto str : src)
+    {
+        EXPECT_EQ(set.Find(str), str);
+        const auto idx = set.GetIndex(str);
+        ASSERT_NE(idx, SIZE_MAX) << str;
+        EXPECT_EQ(set[idx], str);
+    }
+    // same hash and length, but not inserted
+    EXPECT_FALSE(set.Has("C "sv));
+    EXPECT_FALSE(set.Has("C C "sv));
+    EXPECT_FALSE(set.Has("AbC "sv));
+}
@@ -0,0 +1,112 @@
+#include "pch.h"
+#include "common/LockFreeQueue.hpp"
+#include <thread>
+
+using common::container::MPMCBoundedQueue;
+using common::container::SPSCRing;
+
+
+TEST(LockFreeQueue, MPMCBasic)
+{
+    MPMCBoundedQueue<int> queue(3);
+    EXPECT_EQ(queue.Capacity(), 4u);
+    EXPECT_TRUE(queue.IsEmpty());
+    for (int i = 0; i < 4; ++i)
+        EXPECT_TRUE(queue.TryPush(i));
+    EXPECT_FALSE(queue.TryPush(4));
+    EXPECT_FALSE(queue.IsEmpty());
+    int val = -1;
+    for (int i = 0; i < 4; ++i)
+    {
+        ASSERT_TRUE(queue.TryPop(val));
+        EXPECT_EQ(val, i);
+    }
+    EXPECT_FALSE(queue.TryPop(val));
+    EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(LockFreeQueue, MPMCNonTrivial)
+{
+    auto ptr = std::make_shared<int>(1);
+    {
+        MPMCBoundedQueue<std::shared_ptr<int>> queue(8);
+        EXPECT_TRUE(queue.TryPush(ptr));
+        EXPECT_TRUE(queue.TryPush(ptr));
+        std::shared_ptr<int> out;
+        EXPECT_TRUE(queue.TryPop(out));
+        EXPECT_EQ(out, ptr);
+        EXPECT_EQ(ptr.use_count(), 3);
+    } // left item released by queue
+    EXPECT_EQ(ptr.use_count(), 1);
+}
+
+TEST(LockFreeQueue, MPMCConcurrent)
+{
+    constexpr uint32_t Producers = 4, Consumers = 4, PerProducer = 20000;
+    MPMCBoundedQueue<uint32_t> queue(256);
+    std::atomic<uint64_t> sum{ 0 };
+    std::atomic<uint32_t> count{ 0 };
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < Producers; ++p)
+    {
+        threads.emplace_back([&, p]()
+        {
+            for (uint32_t i = 0; i < PerProducer; ++i)
+            {
+                while (!queue.TryPush(p * PerProducer + i))
+                    std::this_thread::yield();
+            }
+        });
+    }
+    for (uint32_t c = 0; c < Consumers; ++c)
+    {
+        threads.emplace_back([&]()
+        {
+            uint32_t val = 0;
+            while (count.load() < Producers * PerProducer)
+            {
+                if (queue.TryPop(val))
+                {
+                    sum += val;
+                    count++;
+                }
+                else
+                    std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    constexpr uint64_t Total = uint64_t(Producers) * PerProducer;
+    EXPECT_EQ(count.load(), Total);
+    EXPECT_EQ(sum.load(), Total * (Total - 1) / 2);
+    EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(LockFreeQueue, SPSCConcurrent)
+{
+    constexpr uint32_t Count = 100000;
+    SPSCRing<uint32_t> ring(64);
+    EXPECT_EQ(ring.Capacity(), 64u);
+    std::thread producer([&]()
+    {
+        for (uint32_t i = 0; i < Count; ++i)
+        {
+            while (!ring.TryPush(i))
+                std::this_thread::yield();
+        }
+    });
+    uint32_t expected = 0, val = 0;
+    bool inOrder = true;
+    while (expected < Count)
+    {
+        if (ring.TryPop(val))
+            inOrder &= (val == expected++);
+        else
+            std::this_thread::yield();
+    }
+    producer.join();
+    EXPECT_TRUE(inOrder);
+    EXPECT_TRUE(ring.IsEmpty());
+    EXPECT_FALSE(ring.TryPop(val));
+}
@@ -0,0 +1,138 @@
+#include "pch.h"
+#include "common/ResourceDict.hpp"
+
+using namespace std::string_view_literals;
+using common::container::ResourceDict;
+
+
+struct TestDict : public ResourceDict
+{
+    using ResourceDict::ResourceDict;
+    size_t AllocatedSlot() const noexcept { return Items.GetAllocatedSlot(); }
+};
+
+#define CHECK_INT(dict, key, val) do { const auto ptr_ = dict.QueryItem<int>(key); ASSERT_NE(ptr_, nullptr) << key; EXPECT_EQ(*ptr_, val); } while(0)
+
+
+TEST(ResourceDict, AddQuery)
+{
+    ResourceDict dict;
+    EXPECT_EQ(dict.Size(), 0u);
+    EXPECT_EQ(dict.QueryItem("a"sv), nullptr);
+    EXPECT_TRUE(dict.Add("a", 1));
+    EXPECT_TRUE(dict.Add(std::string("b"), std::string("bb")));
+    EXPECT_TRUE(dict.Add("c"sv, 3.0));
+    EXPECT_EQ(dict.Size(), 3u);
+    CHECK_INT(dict, "a"sv, 1);
+    EXPECT_EQ(dict.QueryItem<int>("b"sv), nullptr); // type mismatch
+    ASSERT_NE(dict.QueryItem<std::string>("b"sv), nullptr);
+    EXPECT_EQ(*dict.QueryItem<std::string>("b"sv), "bb");
+    // overwrite keeps the key
+    EXPECT_FALSE(dict.Add("a", 2));
+    EXPECT_EQ(dict.Size(), 3u);
+    CHECK_INT(dict, "a"sv, 2);
+    EXPECT_FALSE(dict.Remove("d"sv));
+    EXPECT_TRUE(dict.Remove("b"sv));
+    EXPECT_FALSE(dict.Remove("b"sv));
+    EXPECT_EQ(dict.QueryItem("b"sv), nullptr);
+    EXPECT_EQ(dict.Size(), 2u);
+}
+
+TEST(ResourceDict, CollisionRemove)
+{
+    // DJBHash only depends on c0*33+c1 for two chars, so these keys share one home slot
+    static_assert(common::DJBHash::HashC("Ab"sv) == common::DJBHash::HashC("BA"sv));
+    static_assert(common::DJBHash::HashC("Ab"sv) == common::DJBHash::HashC("C "sv));
+    constexpr std::string_view Keys[] = { "Ab"sv, "BA"sv, "C "sv };
+    for (size_t removed = 0; removed < std::size(Keys); ++removed)
+    {
+        ResourceDict dict;
+        for (int i = 0; i < 3; ++i)
+            dict.Add(Keys[i], i);
+        dict.Add("x", 10);
+        ASSERT_TRUE(dict.Remove(Keys[removed]));
+        // backward shift must keep the rest of the probe chain reachable
+        for (int i = 0; i < 3; ++i)
+        {
+            if (static_cast<size_t>(i) == removed)
+                EXPECT_EQ(dict.QueryItem(Keys[i]), nullptr);
+            else
+                CHECK_INT(dict, Keys[i], i);
+        }
+        CHECK_INT(dict, "x"sv, 10);
+        EXPECT_TRUE(dict.Add(Keys[removed], 20));
+        CHECK_INT(dict, Keys[removed], 20);
+        EXPECT_EQ(dict.Size(), 4u);
+    }
+}
+
+TEST(ResourceDict, ReuseSlot)
+{
+    TestDict dict;
+    std::vector<std::string> keys;
+    for (int i = 0; i < 16; ++i)
+        keys.push_back("key" + std::to_string(i));
+    for (int i = 0; i < 16; ++i)
+        dict.Add(keys[i], i);
+    EXPECT_EQ(dict.AllocatedSlot(), 16u);
+    for (int i = 0; i < 16; i += 2)
+        EXPECT_TRUE(dict.Remove(keys[i]));
+    EXPECT_EQ(dict.Size(), 8u);
+    for (int i = 0; i < 16; i += 2)
+        EXPECT_TRUE(dict.Add("new" + std::to_string(i), i * 10));
+    EXPECT_EQ(dict.AllocatedSlot(), 16u);
+    for (int i = 0; i < 16; ++i)
+    {
+        if (i % 2)
+            CHECK_INT(dict, keys[i], i);
+        else
+        {
+            EXPECT_EQ(dict.QueryItem(keys[i]), nullptr);
+            CHECK_INT(dict, "new" + std::to_string(i), i * 10);
+        }
+    }
+}
+
+TEST(ResourceDict, Random)
+{
+    ResourceDict dict;
+    std::map<std::string, int> ref;
+    std::mt19937 gen(42);
+    for (int round = 0; round < 4000; ++round)
+    {
+        const auto key = "k" + std::to_string(gen() % 97);
+        const auto val = static_cast<int>(gen() % 1000);
+        if (gen() % 3 == 0)
+            EXPECT_EQ(dict.Remove(key), ref.erase(key) > 0) << key;
+        else
+            EXPECT_EQ(dict.Add(key, val), ref.insert_or_assign(key, val).second) << key;
+        ASSERT_EQ(dict.Size(), ref.size());
+    }
+    for (int i = 0; i < 97; ++i)
+    {
+        const auto key = "k" + std::to_string(i);
+        if (const auto it = ref.find(key); it != ref.end())
+            CHECK_INT(dict, key, it->second);
+        else
+            EXPECT_EQ(dict.QueryItem(key), nullptr);
+    }
+}
+
+TEST(ResourceDict, Move)
+{
+    ResourceDict dict;
+    dict.Add("a", 1);
+    dict.Add("b", 2);
+    dict.Remove("a"sv);
+    ResourceDict dict2(std::move(dict));
+    EXPECT_EQ(dict2.Size(), 1u);
+    CHECK_INT(dict2, "b"sv, 2);
+    EXPECT_EQ(dict.Size(), 0u);
+    EXPECT_EQ(dict.QueryItem("b"sv), nullptr);
+    EXPECT_FALSE(dict.Remove("b"sv));
+    // moved-from dict stays usable
+    EXPECT_TRUE(dict.Add("c", 3));
+    CHECK_INT(dict, "c"sv, 3);
+    EXPECT_TRUE(dict2.Add("a", 4));
+    CHECK_INT(dict2, "a"sv, 4);
+}
@@ -0,0 +1,62 @@
+#include "pch.h"
+#include "common/StaticLookup.hpp"
+
+using namespace std::string_view_literals;
+
+
+enum class Color : uint8_t { Red, Green, Blue };
+
+static constexpr auto IntBinary = BuildStaticLookup(uint32_t, std::string_view,
+    { 0u, "zero"sv }, { 1u, "one"sv }, { 42u, "answer"sv }, { 0xffffffffu, "max"sv });
+static constexpr auto IntHash = BuildStaticHashLookup(uint32_t, std::string_view,
+    { 0u, "zero"sv }, { 1u, "one"sv }, { 42u, "answer"sv }, { 0xffffffffu, "max"sv });
+static constexpr auto StrHash = BuildStaticHashLookup(std::string_view, Color,
+    { "red"sv, Color::Red }, { "green"sv, Color::Green }, { "blue"sv, Color::Blue });
+static constexpr auto ShortStrHash = BuildStaticHashLookup(common::str::ShortStrVal<3>, uint16_t,
+    { "==", 1 }, { "!=", 2 }, { "<", 3 }, { "<=", 4 }, { ">", 5 }, { ">=", 6 });
+
+static_assert(IntHash(42u).value() == "answer"sv);
+static_assert(!IntHash(2u).has_value());
+static_assert(StrHash("blue"sv).value() == Color::Blue);
+static_assert(ShortStrHash(U"<="sv).value() == 4);
+
+
+TEST(StaticLookup, Integer)
+{
+    for (const auto key : { 0u, 1u, 42u, 0xffffffffu, 2u, 43u, 0xfffffffeu })
+    {
+        EXPECT_EQ(IntHash(key), IntBinary(key)) << "key: " << key;
+    }
+}
+
+TEST(StaticLookup, String)
+{
+    EXPECT_EQ(StrHash("red"sv), Color::Red);
+    EXPECT_EQ(StrHash("green"sv), Color::Green);
+    EXPECT_FALSE(StrHash("gree"sv).has_value());
+    EXPECT_FALSE(StrHash(""sv).has_value());
+    EXPECT_EQ(ShortStrHash(U"=="sv), 1);
+    EXPECT_EQ(ShortStrHash(U">"sv), 5);
+    EXPECT_FALSE(ShortStrHash(U"<<"sv).has_value());
+    EXPECT_FALSE(ShortStrHash(U"===="sv).has_value());
+}
+
+#define ITEM(i) { (i) * 0x9e3779b1u, (i) },
+#define ITEM8(i) ITEM(i * 8 + 0) ITEM(i * 8 + 1) ITEM(i * 8 + 2) ITEM(i * 8 + 3) ITEM(i * 8 + 4) ITEM(i * 8 + 5) ITEM(i * 8 + 6) ITEM(i * 8 + 7)
+static constexpr std::pair<uint32_t, uint32_t> BigTable[] =
+{
+    ITEM8(0)  ITEM8(1)  ITEM8(2)  ITEM8(3)  ITEM8(4)  ITEM8(5)  ITEM8(6)  ITEM8(7)
+    ITEM8(8)  ITEM8(9)  ITEM8(10) ITEM8(11) ITEM8(12) ITEM8(13) ITEM8(14) ITEM8(15)
+};
+#undef ITEM8
+#undef ITEM
+
+TEST(StaticLookup, Large)
+{
+    static constexpr auto table = BuildStaticHashLookupFrom(uint32_t, uint32_t, BigTable);
+    for (uint32_t i = 0; i < 128; ++i)
+    {
+        EXPECT_EQ(table(i * 0x9e3779b1u), i);
+        EXPECT_FALSE(table(i * 0x9e3779b1u + 1).has_value());
+    }
+}
@@ -0,0 +1,98 @@
+#include "pch.h"
+#include "common/StringPool.hpp"
+
+using namespace std::string_view_literals;
+using common::HashedStringPool;
+using common::StringPiece;
+using common::str::HashedStrView;
+
+
+TEST(StringPool, Interning)
+{
+    HashedStringPool<char> pool(true);
+    const auto p0 = pool.AllocateString("alpha"sv);
+    const auto p1 = pool.AllocateString("beta"sv);
+    const auto p2 = pool.AllocateString("alpha"sv);
+    EXPECT_EQ(pool.UniqueCount(), 2u);
+    EXPECT_EQ(pool.GetStringView(p0), "alpha"sv);
+    EXPECT_EQ(pool.GetStringView(p1), "beta"sv);
+    EXPECT_EQ(p2.GetOffset(), p0.GetOffset());
+    EXPECT_TRUE(pool.IsSame(p0, p2));
+    EXPECT_FALSE(pool.IsSame(p0, p1));
+    EXPECT_EQ(pool.GetHashedStr(p1), HashedStrView<char>("beta"sv));
+    // empty string is never stored
+    const auto empty = pool.AllocateString(""sv);
+    EXPECT_EQ(empty.GetLength(), 0u);
+    EXPECT_EQ(pool.UniqueCount(), 2u);
+}
+
+TEST(StringPool, NonInterning)
+{
+    HashedStringPool<char16_t> pool;
+    const auto p0 = pool.AllocateString(u"gamma"sv);
+    const auto p1 = pool.AllocateString(u"gamma"sv);
+    const auto p2 = pool.AllocateString(u"gamme"sv);
+    EXPECT_NE(p0.GetOffset(), p1.GetOffset());
+    // different pieces holding the same string are still the same
+    EXPECT_TRUE(pool.IsSame(p0, p1));
+    EXPECT_FALSE(pool.IsSame(p0, p2));
+    EXPECT_EQ(pool.GetHashedStr(p1).Hash, common::DJBHash::HashC(u"gamma"sv));
+}
+
+TEST(StringPool, Find)
+{
+    HashedStringPool<char32_t> pool(true);
+    EXPECT_FALSE(pool.Find(U"x"sv).has_value());
+    const auto px = pool.AllocateString(U"x"sv);
+    const auto py = pool.AllocateString(U"yy"sv);
+    {
+        const auto found = pool.Find(U"x"sv);
+        ASSERT_TRUE(found.has_value());
+        EXPECT_TRUE(pool.IsSame(*found, px));
+    }
+    {
+        const auto found = pool.Find(U"yy"sv);
+        ASSERT_TRUE(found.has_value());
+        EXPECT_TRUE(pool.IsSame(*found, py));
+    }
+    EXPECT_FALSE(pool.Find(U"y"sv).has_value());
+    EXPECT_FALSE(pool.Find(U"xx"sv).has_value());
+    // same hash but different content should probe past the stored one
+    const HashedStrView<char32_t> fake(HashedStrView<char32_t>(U"x"sv).Hash, U"z"sv);
+    EXPECT_FALSE(pool.Find(fake).has_value());
+    const auto pz = pool.AllocateString(fake);
+    EXPECT_FALSE(pool.IsSame(pz, px));
+    EXPECT_EQ(pool.GetStringView(pz), U"z"sv);
+    const auto found = pool.Find(fake);
+    ASSERT_TRUE(found.has_value());
+    EXPECT_TRUE(pool.IsSame(*found, pz));
+    EXPECT_EQ(pool.UniqueCount(), 3u);
+}
+
+TEST(StringPool, Rehash)
+{
+    HashedStringPool<char> pool(true);
+    std::vector<std::string> strs;
+    std::vector<StringPiece<char>> pieces;
+    for (uint32_t i = 0; i < 300; ++i)
+    {
+        strs.push_back("str" + std::to_string(i * 7919));
+        pieces.push_back(pool.AllocateString(std::string_view(strs.back())));
+        // re-adding an earlier string returns its piece even after the table has grown
+        const auto idx = i / 2;
+        const auto again = pool.AllocateString(std::string_view(strs[idx]));
+        EXPECT_TRUE(pool.IsSame(again, pieces[idx]));
+    }
+    EXPECT_EQ(pool.UniqueCount(), strs.size());
+    for (size_t i = 0; i < strs.size(); ++i)
+    {
+        const auto found = pool.Find(std::string_view(strs[i]));
+        ASSERT_TRUE(found.has_value()) << strs[i];
+        EXPECT_TRUE(pool.IsSame(*found, pieces[i]));
+        EXPECT_EQ(pool.GetStringView(*found), strs[i]);
+    }
+    EXPECT_FALSE(pool.Find("str1"sv).has_value());
+    pool.Clear();
+    EXPECT_EQ(pool.UniqueCount(), 0u);
+    EXPECT_FALSE(pool.Find(std::string_view(strs[0])).has_value());
+}
@@ -829,5 +829,14 @@ TEST(NailangParser, ReplaceEngine)
         EXPECT_EQ(replacer.Funcs[1].first, U"y"sv);
         EXPECT_THAT(replacer.Funcs[1].second, testing::ElementsAre(UR"(56 + "" / 7)"sv));
     }
+    {
+        Replacer replacer(U"l"sv);
+        const auto source = U"He$$!{ab}$$!{cd}o Wor$$!{ef}d"sv;
+        common::str::StringRope<char32_t> rope;
+        replacer.ProcessVariable(rope, source, U"$$!{"sv, U"}"sv);
+        EXPECT_EQ(rope.Size(), 11u);
+        EXPECT_EQ(rope.SegmentCount(), 5u); // "He", "ll", "o Wor", "l", "d"
+        EXPECT_EQ(rope.Materialize(), U"Hello World"sv);
+    }
 }
 
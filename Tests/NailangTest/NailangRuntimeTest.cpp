@@ -2,6 +2,7 @@
 #include "Nailang/NailangParserRely.h"
 #include "Nailang/NailangParser.h"
 #include "Nailang/NailangRuntime.h"
+#include "Nailang/NailangProfiler.h"
 #include "SystemCommon/MiscIntrins.h"
 #include "SystemCommon/StringConvert.h"
 #include "SystemCommon/Format.h"
@@ -33,6 +34,7 @@ using xziar::nailang::EvalTempStore;
 using xziar::nailang::NailangFrame;
 using xziar::nailang::NailangExecutor;
 using xziar::nailang::NailangRuntime;
+using xziar::nailang::NailangProfiler;
 using xziar::nailang::EvaluateContext;
 using xziar::nailang::BasicEvaluateContext;
 using xziar::nailang::LargeEvaluateContext;
@@ -87,6 +89,19 @@ public:
 
     using NailangRuntime::LookUpArg;
 
+    void SetProfiler(NailangProfiler* profiler) { Executor.SetProfiler(profiler); }
+    auto GetDispatchKind(const xziar::nailang::FuncCall& call) const
+    {
+        return static_cast<xziar::nailang::NailangExecutor::DispatchKind>(call.Cache.Get(FrameStack.GetDispatchStamp()).first);
+    }
+    auto GetDispatchStamp() const { return FrameStack.GetDispatchStamp(); }
+    size_t GetDispatchFuncCount() const noexcept { return DispatchFuncs.size(); }
+    using NailangRuntime::MaxDispatchFuncs;
+    auto PushFrame(std::shared_ptr<xziar::nailang::EvaluateContext> ctx)
+    {
+        return Executor.PushFrame(std::move(ctx), NailangFrame::FrameFlags::Empty);
+    }
+
     auto GetCtx() const { return std::dynamic_pointer_cast<EvalCtx>(RootContext); }
     auto SetRootArg(std::u32string_view name, Arg val)
     {
@@ -143,6 +158,77 @@ TEST(NailangBase, ArgToString)
     ChkStr(CustomVar{ &BaseCustomVarHandler, 0,0,0 }, U"{BaseCustomVar}"sv);
 }
 
+TEST(NailangBase, ArgString)
+{
+    {
+        const Arg arg(std::u32string(U"abc")); // inline
+        CHECK_ARG(arg, U32Str, U"abc"sv);
+        Arg copied(arg);
+        CHECK_ARG(copied, U32Str, U"abc"sv);
+        const Arg moved(std::move(copied));
+        CHECK_ARG(moved, U32Str, U"abc"sv);
+        EXPECT_TRUE(copied.IsEmpty());
+        const auto ret = arg.HandleBinary(EmbedOps::Add, moved);
+        CHECK_ARG(ret, U32Str, U"abcabc"sv);
+        EXPECT_EQ(arg.Compare(U"abd"sv).GetResult(), xziar::nailang::CompareResultCore::Less);
+    }
+    {
+        // inline string lives inside the Arg, so copy and store never allocate
+        const auto isInside = [](const Arg& arg)
+        {
+            const auto ptr = reinterpret_cast<uintptr_t>(arg.GetStr()->data()), self = reinterpret_cast<uintptr_t>(&arg);
+            return ptr >= self && ptr < self + sizeof(Arg);
+        };
+        std::vector<Arg> args;
+        args.emplace_back(std::u32string(U"tiny"));
+        EXPECT_TRUE(isInside(args[0]));
+        const Arg copied(args[0]);
+        EXPECT_TRUE(isInside(copied));
+        const auto copiedStr = copied.GetStr().value();
+        Arg assigned(std::u32string(U"long string"));
+        assigned = copied;
+        EXPECT_TRUE(isInside(assigned));
+        Arg stored;
+        ASSERT_TRUE(Arg(&stored).Set(Arg(std::u32string(U"abcd"))));
+        EXPECT_TRUE(isInside(stored));
+        const auto toStr = args[0].ToString(); // owned, outlives the move of args[0]
+        for (uint32_t i = 0; i < 64; ++i)
+            args.emplace_back(std::u32string(U"x"));
+        const Arg movedStored(std::move(stored));
+        EXPECT_EQ(copiedStr, U"tiny"sv); // copy itself is not moved
+        EXPECT_EQ(toStr.StrView(), U"tiny"sv);
+        CHECK_ARG(args[0], U32Str, U"tiny"sv);
+        CHECK_ARG(assigned, U32Str, U"tiny"sv);
+        CHECK_ARG(movedStored, U32Str, U"abcd"sv);
+        EXPECT_TRUE(isInside(movedStored));
+    }
+    {
+        const Arg arg(std::u32string(U"long string")); // shared
+        CHECK_ARG(arg, U32Str, U"long string"sv);
+        Arg copied = arg;
+        EXPECT_EQ(copied.GetStr()->data(), arg.GetStr()->data());
+        copied = Arg(std::u32string(U"tiny"));
+        CHECK_ARG(copied, U32Str, U"tiny"sv);
+        CHECK_ARG(arg, U32Str, U"long string"sv);
+    }
+    {
+        const Arg arg(std::u32string{});
+        CHECK_ARG(arg, U32Str, U""sv);
+        EXPECT_EQ(arg.GetBool(), false);
+    }
+}
+
+TEST(NailangBase, IdentifierPool)
+{
+    using xziar::nailang::IdentifierPool;
+    const std::u32string name1 = U"someVar", name2 = U"someVar";
+    const auto str1 = IdentifierPool::Intern(name1), str2 = IdentifierPool::Intern(name2);
+    EXPECT_EQ(str1, U"someVar"sv);
+    EXPECT_EQ(str1.data(), str2.data());
+    EXPECT_NE(str1.data(), name1.data());
+    EXPECT_NE(IdentifierPool::Intern(U"otherVar"sv).data(), str1.data());
+}
+
 TEST(NailangRuntime, EvalEmbedOp)
 {
     using Type = Arg::Type;
@@ -1060,6 +1146,194 @@ m = $gcd(m,n);
     EXPECT_EQ(Run2Arg(runtime, algoBlock, 17u, 5u), std::gcd(17u, 5u));
 }
 
+TEST(NailangRuntime, Profiler)
+{
+    MemoryPool pool;
+    NailangRT runtime;
+    NailangProfiler profiler(64);
+    runtime.SetProfiler(&profiler);
+
+    constexpr auto gcdTxt = UR"(
+@DefFunc(m,n)
+#Block("gcd")
+{
+    tmp := m % n;
+    @If(tmp==0)
+    $Return(n);
+
+    $Return($gcd(n, tmp));
+}
+m = $gcd(m,n);
+)"sv;
+    const auto algoBlock = BlkParser::GetBlock(pool, gcdTxt);
+    EXPECT_EQ(Run2Arg(runtime, algoBlock, 17u, 5u), std::gcd(17u, 5u)); // gcd(17,5)->gcd(5,2)->gcd(2,1)
+    runtime.SetProfiler(nullptr);
+    EXPECT_EQ(Run2Arg(runtime, algoBlock, 15u, 5u), std::gcd(15u, 5u)); // not recorded
+
+    const auto stats = profiler.GetStats();
+    const auto findStat = [&](NailangProfiler::EntryType type, std::u32string_view name) -> const NailangProfiler::Stat*
+    {
+        for (const auto& stat : stats)
+            if (stat.Type == type && stat.Name == name)
+                return &stat;
+        return nullptr;
+    };
+    const auto callStat  = findStat(NailangProfiler::EntryType::FuncCall,  U"gcd"sv);
+    const auto localStat = findStat(NailangProfiler::EntryType::LocalFunc, U"gcd"sv);
+    const auto blockStat = findStat(NailangProfiler::EntryType::Block,     U"gcd"sv);
+    ASSERT_NE(callStat, nullptr);
+    ASSERT_NE(localStat, nullptr);
+    ASSERT_NE(blockStat, nullptr);
+    EXPECT_EQ(callStat->Count, 3u);
+    EXPECT_EQ(localStat->Count, 3u);
+    EXPECT_EQ(blockStat->Count, 3u);
+    EXPECT_EQ(findStat(NailangProfiler::EntryType::Native, U"gcd"sv), nullptr);
+    EXPECT_GE(callStat->InclusiveNs, localStat->InclusiveNs);
+    EXPECT_GE(localStat->InclusiveNs, blockStat->InclusiveNs);
+
+    const auto folded = profiler.ExportFoldedStacks();
+    EXPECT_NE(folded.find("FuncCall:gcd;LocalFunc:gcd;Block:gcd"), std::string::npos);
+    const auto trace = profiler.ExportChromeTrace();
+    EXPECT_NE(trace.find("\"traceEvents\""), std::string::npos);
+    EXPECT_NE(trace.find("\"cat\":\"LocalFunc\""), std::string::npos);
+}
+
+TEST(NailangRuntime, DispatchCache)
+{
+    using DispatchKind = xziar::nailang::NailangExecutor::DispatchKind;
+    MemoryPool pool;
+    NailangRT runtime;
+
+    const auto ParseCall = [&](const std::u32string_view src) -> const xziar::nailang::FuncCall&
+    {
+        ParserContext context(src);
+        const auto rawarg = NailangParser::ParseSingleExpr(pool, context);
+        EXPECT_EQ(rawarg.TypeData, Expr::Type::Func);
+        return *rawarg.GetVar<Expr::Type::Func>();
+    };
+    const auto& callScale = ParseCall(U"$scale(3);"sv);
+    const auto& callMath  = ParseCall(U"$Math.Max(1,2);"sv);
+    const auto& callFmt   = ParseCall(U"$Format(\"{}\", 1);"sv);
+    const auto scale2Block = BlkParser::GetBlock(pool, UR"(
+@DefFunc(x)
+#Block("scale")
+{
+    $Return(x * 2);
+}
+)"sv);
+    const auto scale3Block = BlkParser::GetBlock(pool, UR"(
+@DefFunc(x)
+#Block("scale")
+{
+    $Return(x * 3);
+}
+)"sv);
+
+    EXPECT_ANY_THROW(runtime.EvaluateExpr(&callScale));
+    EXPECT_EQ(runtime.GetDispatchKind(callScale), DispatchKind::Unknown);
+
+    runtime.ExecuteBlock(scale2Block, {}, runtime.RootContext);
+    EXPECT_EQ(runtime.GetDispatchKind(callScale), DispatchKind::None); // invalidated by new func
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        const auto arg = runtime.EvaluateExpr(&callScale);
+        CHECK_ARG(arg, Int, 6);
+        EXPECT_EQ(runtime.GetDispatchKind(callScale), DispatchKind::LocalFunc);
+    }
+
+    runtime.ExecuteBlock(scale3Block, {}, runtime.RootContext);
+    {
+        const auto arg = runtime.EvaluateExpr(&callScale);
+        CHECK_ARG(arg, Int, 9);
+        EXPECT_EQ(runtime.GetDispatchKind(callScale), DispatchKind::LocalFunc);
+    }
+    {
+        const auto arg = runtime.EvaluateExpr(&callMath);
+        CHECK_ARG(arg, Int, 2);
+        EXPECT_EQ(runtime.GetDispatchKind(callMath), DispatchKind::MathFunc);
+    }
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        const auto arg = runtime.EvaluateExpr(&callFmt);
+        ASSERT_TRUE(CheckArg(arg, Arg::Type::U32Str));
+        EXPECT_EQ(arg.GetStr().value(), U"1"sv);
+        EXPECT_EQ(runtime.GetDispatchKind(callFmt), DispatchKind::Format);
+    }
+
+    NailangRT runtime2; // cache made by other runtime should not be used
+    EXPECT_EQ(runtime2.GetDispatchKind(callScale), DispatchKind::None);
+    EXPECT_ANY_THROW(runtime2.EvaluateExpr(&callScale));
+
+    // name-only result survives invalidation
+    runtime.ExecuteBlock(scale2Block, {}, runtime.RootContext);
+    EXPECT_EQ(runtime.GetDispatchKind(callScale), DispatchKind::None);
+    EXPECT_EQ(runtime.GetDispatchKind(callMath), DispatchKind::MathFunc);
+    EXPECT_EQ(runtime.GetDispatchKind(callFmt), DispatchKind::Format);
+
+    const auto stamp = runtime.GetDispatchStamp();
+    {
+        auto frame = runtime.PushFrame(std::make_shared<EvalCtx2>()); // no local func, lookup is not changed
+        EXPECT_EQ(runtime.GetDispatchStamp(), stamp);
+    }
+    const auto funcCtx = std::make_shared<EvalCtx2>();
+    runtime.ExecuteBlock(scale3Block, {}, funcCtx);
+    const auto stamp2 = runtime.GetDispatchStamp();
+    EXPECT_NE(stamp2, stamp);
+    {
+        const auto arg = runtime.EvaluateExpr(&callScale);
+        CHECK_ARG(arg, Int, 6);
+        EXPECT_EQ(runtime.GetDispatchKind(callScale), DispatchKind::LocalFunc);
+    }
+    // each call site keeps only one result, so use different sites for outer and inner frames
+    const auto& callOuter = ParseCall(U"$scale(4);"sv);
+    const auto& callInner = ParseCall(U"$scale(5);"sv);
+    {
+        const auto arg = runtime.EvaluateExpr(&callOuter);
+        CHECK_ARG(arg, Int, 8);
+    }
+    uint64_t innerStamp = 0;
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        {
+            auto frame = runtime.PushFrame(funcCtx); // shadow scale with local func
+            if (i == 0)
+            {
+                innerStamp = runtime.GetDispatchStamp();
+                EXPECT_NE(innerStamp, stamp2);
+                EXPECT_EQ(runtime.GetDispatchKind(callScale), DispatchKind::None);
+                EXPECT_EQ(runtime.GetDispatchKind(callInner), DispatchKind::None);
+            }
+            else // same context on the same chain reuses the stamp
+            {
+                EXPECT_EQ(runtime.GetDispatchStamp(), innerStamp);
+                EXPECT_EQ(runtime.GetDispatchKind(callInner), DispatchKind::LocalFunc);
+            }
+            EXPECT_EQ(runtime.GetDispatchKind(callOuter), DispatchKind::None);
+            const auto arg = runtime.EvaluateExpr(&callScale);
+            CHECK_ARG(arg, Int, 9);
+            const auto arg2 = runtime.EvaluateExpr(&callInner);
+            CHECK_ARG(arg2, Int, 15);
+        }
+        // restored since nothing changed, results made before push are valid again
+        EXPECT_EQ(runtime.GetDispatchStamp(), stamp2);
+        EXPECT_EQ(runtime.GetDispatchKind(callOuter), DispatchKind::LocalFunc);
+        EXPECT_EQ(runtime.GetDispatchKind(callScale), DispatchKind::None); // overwritten in inner frame
+        const auto arg = runtime.EvaluateExpr(&callScale);
+        CHECK_ARG(arg, Int, 6);
+        EXPECT_EQ(runtime.GetDispatchKind(callScale), DispatchKind::LocalFunc);
+    }
+
+    // each redefinition makes a new stamp and a new cached func, they are dropped once reaching the cap
+    for (uint32_t i = 0; i < NailangRT::MaxDispatchFuncs + 8; ++i)
+    {
+        runtime.ExecuteBlock(scale3Block, {}, runtime.RootContext);
+        const auto arg = runtime.EvaluateExpr(&callScale);
+        CHECK_ARG(arg, Int, 9);
+        EXPECT_EQ(runtime.GetDispatchKind(callScale), DispatchKind::LocalFunc);
+        ASSERT_LE(runtime.GetDispatchFuncCount(), NailangRT::MaxDispatchFuncs);
+    }
+}
+
 TEST(NailangRuntime, sumOdd)
 {
     MemoryPool pool;
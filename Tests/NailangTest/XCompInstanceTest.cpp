@@ -0,0 +1,258 @@
+#include "rely.h"
+#include "XComputeBase/XCompNailang.h"
+
+
+using namespace std::string_literals;
+using namespace std::string_view_literals;
+using xziar::nailang::Arg;
+using xziar::nailang::FuncEvalPack;
+using xcomp::XCNLContext;
+using xcomp::XCNLExtension;
+using xcomp::XCNLExecutor;
+using xcomp::XCNLRuntime;
+using xcomp::XCNLRawExecutor;
+using xcomp::OutputBlock;
+using xcomp::InstanceContext;
+
+
+namespace
+{
+
+class TestContext : public XCNLContext
+{
+public:
+    std::vector<std::u32string_view> Kernels;
+    TestContext() : XCNLContext(common::CLikeDefines{}) { }
+    ~TestContext() override { }
+};
+
+// records instance begins and patch requests, so merged states can be compared with sequential ones
+class TestExtension : public XCNLExtension
+{
+private:
+    size_t MergedCount = 0;
+    size_t MergedLogs = 0;
+    std::u32string PatchBlock(std::u32string_view id, bool isConfig)
+    {
+        Context.AddPatchedBlock(id, [&]() { return U"patch "s.append(id); });
+        Logs.push_back((isConfig ? U"config "s : U"patch "s).append(id));
+        return U"use "s.append(id);
+    }
+public:
+    std::vector<std::u32string> Logs;
+    using XCNLExtension::XCNLExtension;
+    ~TestExtension() override { }
+    void BeginInstance(XCNLRuntime&, InstanceContext&) override
+    {
+        Logs.push_back(U"begin"s);
+    }
+    xcomp::ReplaceResult ReplaceFunc(XCNLRawExecutor&, std::u32string_view func, xcomp::U32StrSpan args) override
+    {
+        if (func == U"xctest.Patch"sv && args.size() == 1)
+        {
+            auto str = PatchBlock(args[0], false);
+            return xcomp::ReplaceResult(std::move(str), args[0]);
+        }
+        return {};
+    }
+    std::optional<Arg> ConfigFunc(XCNLExecutor&, FuncEvalPack& func) override
+    {
+        if (func.FullFuncName() == U"xctest.Patch"sv)
+        {
+            PatchBlock(func.Params[0].GetStr().value(), true);
+            return Arg{};
+        }
+        return {};
+    }
+    std::unique_ptr<XCNLExtension> CreateInstanceWorker(XCNLContext& context) const override
+    {
+        return std::make_unique<TestExtension>(context);
+    }
+    void MergeInstance(XCNLExtension& worker_, const OutputBlock&) override
+    {
+        auto& worker = static_cast<TestExtension&>(worker_);
+        MergedCount++;
+        // each instance starts with a "begin"
+        Expects(worker.Logs[worker.MergedLogs] == U"begin"sv);
+        do
+        {
+            Logs.push_back(worker.Logs[worker.MergedLogs++]);
+        } while (worker.MergedLogs < worker.Logs.size() && worker.Logs[worker.MergedLogs] != U"begin"sv);
+    }
+    constexpr size_t GetMergedCount() const noexcept { return MergedCount; }
+};
+
+class TestExecutor : public XCNLExecutor
+{
+protected:
+    using XCNLExecutor::XCNLExecutor;
+};
+
+class TestConfigurator final : public TestExecutor, public xcomp::XCNLConfigurator
+{
+private:
+    XCNLExecutor& GetExecutor() noexcept final { return *this; }
+public:
+    using TestExecutor::TestExecutor;
+};
+
+class TestRawExecutor final : public TestExecutor, public XCNLRawExecutor
+{
+private:
+    const XCNLExecutor& GetExecutor() const noexcept final { return *this; }
+    XCNLExecutor& GetExecutor() noexcept final { return *this; }
+    std::unique_ptr<InstanceContext> PrepareInstance(const OutputBlock& block) final
+    {
+        static_cast<TestContext&>(GetContext()).Kernels.push_back(block.Name());
+        return std::make_unique<InstanceContext>();
+    }
+    void OutputInstance(const OutputBlock& block, std::u32string& output) final
+    {
+        output.append(U"kernel "sv).append(block.Name()).append(U"\n"sv).append(GetInstanceInfo().Content).append(U"\n"sv);
+    }
+public:
+    using TestExecutor::TestExecutor;
+    using TestExecutor::HandleException;
+};
+
+class TestStructHandler final : public TestExecutor, public xcomp::XCNLStructHandler
+{
+private:
+    const XCNLExecutor& GetExecutor() const noexcept final { return *this; }
+    XCNLExecutor& GetExecutor() noexcept final { return *this; }
+    void OutputStruct(const xcomp::XCNLStruct&, std::u32string&) final { }
+public:
+    using TestExecutor::TestExecutor;
+};
+
+class TestRuntime final : public XCNLRuntime
+{
+private:
+    TestContext& Context;
+    TestConfigurator Configurator;
+    TestRawExecutor RawExecutor;
+    TestStructHandler StructHandler;
+    size_t MergedKernels = 0;
+    xcomp::XCNLConfigurator& GetConfigurator() noexcept final { return Configurator; }
+    XCNLRawExecutor& GetRawExecutor() noexcept final { return RawExecutor; }
+    xcomp::XCNLStructHandler& GetStructHandler() noexcept final { return StructHandler; }
+    std::unique_ptr<XCNLRuntime> CreateInstanceWorker() final
+    {
+        return std::make_unique<TestRuntime>(Logger, std::make_shared<TestContext>());
+    }
+    void MergeInstance(XCNLRuntime& worker_, const OutputBlock& block) final
+    {
+        auto& worker = static_cast<TestRuntime&>(worker_);
+        Expects(worker.Context.Kernels[worker.MergedKernels++] == block.Name());
+        Context.Kernels.push_back(block.Name());
+    }
+public:
+    TestRuntime(common::mlog::MiniLogger<false>& logger, std::shared_ptr<TestContext> context) :
+        XCNLRuntime(logger, context), Context(*context), Configurator(this), RawExecutor(this), StructHandler(this)
+    { }
+    ~TestRuntime() override { }
+    xcomp::VTypeInfo TryParseVecType(const std::u32string_view, bool) const noexcept final { return {}; }
+    std::u32string_view GetVecTypeName(xcomp::VTypeInfo) const noexcept final { return {}; }
+};
+
+class TestProgStub : public xcomp::XCNLProgStub
+{
+public:
+    TestProgStub(const std::shared_ptr<const xcomp::XCNLProgram>& program, const std::shared_ptr<TestContext>& context,
+        common::mlog::MiniLogger<false>& logger) :
+        XCNLProgStub(program, std::shared_ptr<XCNLContext>(context), std::make_unique<TestRuntime>(logger, context))
+    { }
+    std::string Generate(uint32_t concurrency)
+    {
+        constexpr std::u32string_view prepares[] = { U"xcomp.Prepare"sv };
+        Prepare(prepares);
+        constexpr std::u32string_view collects[] = { U"xcomp."sv };
+        Collect(collects);
+        Runtime->SetInstanceConcurrency(concurrency);
+        return Runtime->GenerateOutput();
+    }
+};
+
+struct GenerateResult
+{
+    std::string Output;
+    std::vector<std::u32string_view> Kernels;
+    std::vector<std::u32string> Logs;
+    size_t MergedCount;
+};
+
+common::mlog::MiniLogger<false>& GetLogger()
+{
+    static common::mlog::MiniLogger<false> logger(u"XCompTest", {});
+    return logger;
+}
+
+GenerateResult Generate(const std::shared_ptr<xcomp::XCNLProgram>& prog, uint32_t concurrency)
+{
+    prog->AttachExtension([](common::mlog::MiniLogger<false>&, XCNLContext& context) -> std::unique_ptr<XCNLExtension>
+        {
+            return std::make_unique<TestExtension>(context);
+        });
+    auto context = std::make_shared<TestContext>();
+    TestProgStub stub(prog, context, GetLogger());
+    GenerateResult ret;
+    ret.Output = stub.Generate(concurrency);
+    ret.Kernels = context->Kernels;
+    const auto ext = context->GetXCNLExt<TestExtension>();
+    ret.Logs = ext->Logs;
+    ret.MergedCount = ext->GetMergedCount();
+    return ret;
+}
+
+std::shared_ptr<xcomp::XCNLProgram> CreateProgram(size_t kernelCount, size_t failIdx = SIZE_MAX)
+{
+    std::u32string src = UR"(
+#Block.xcomp.Prepare("test")
+{
+    `Ratio = 3;
+    $xctest.Patch("config");
+}
+)";
+    for (size_t i = 0; i < kernelCount; ++i)
+    {
+        const auto name = U"k"s.append(1, static_cast<char32_t>(U'a' + i));
+        src.append(U"@xcomp.Replace()\n#Raw.xcomp.Kernel(\""sv).append(name).append(U"\")\n{@@Kernel\n"sv);
+        src.append(U"ratio $$!{Ratio}\n$$!xctest.Patch(config)\n"sv);
+        // later kernels share patched blocks with earlier ones, which may be generated by other workers
+        src.append(U"$$!xctest.Patch(shared"sv).append(1, static_cast<char32_t>(U'0' + i % 3)).append(U")\n"sv);
+        src.append(U"$$!xctest.Patch("sv).append(name).append(U")\n"sv);
+        if (i == failIdx)
+            src.append(U"$$!xctest.Unknown()\n"sv);
+        src.append(U"@@Kernel}\n"sv);
+    }
+    return xcomp::XCNLProgram::Create(std::move(src), u"test"s);
+}
+
+}
+
+
+TEST(XCompInstance, ParallelMatchSequential)
+{
+    constexpr size_t KernelCount = 12;
+    const auto seq = Generate(CreateProgram(KernelCount), 1);
+    ASSERT_EQ(seq.Kernels.size(), KernelCount);
+    EXPECT_EQ(seq.MergedCount, 0u);
+    EXPECT_NE(seq.Output.find("ratio 3"), std::string::npos);
+    EXPECT_NE(seq.Output.find("Patched Block [config]"), std::string::npos);
+    for (const uint32_t concurrency : { 2u, 3u, 5u })
+    {
+        const auto par = Generate(CreateProgram(KernelCount), concurrency);
+        EXPECT_EQ(par.MergedCount, KernelCount);
+        EXPECT_EQ(par.Output, seq.Output);
+        EXPECT_EQ(par.Kernels, seq.Kernels);
+        EXPECT_EQ(par.Logs, seq.Logs);
+    }
+}
+
+TEST(XCompInstance, ParallelException)
+{
+    constexpr size_t KernelCount = 8;
+    EXPECT_ANY_THROW(Generate(CreateProgram(KernelCount, 5), 1));
+    EXPECT_ANY_THROW(Generate(CreateProgram(KernelCount, 5), 4));
+    EXPECT_ANY_THROW(Generate(CreateProgram(KernelCount, 0), 4));
+}
@@ -0,0 +1,124 @@
+#include "rely.h"
+#include "Model/MeshOptimizer.hpp"
+#include <random>
+
+namespace meshopt = dizz::detail::meshopt;
+using Triangle = std::array<uint32_t, 3>;
+
+
+// grid of w*h quads, triangles are shuffled so there's something to optimize
+static std::vector<uint32_t> GenerateGrid(const uint32_t w, const uint32_t h, const uint32_t seed)
+{
+    std::vector<Triangle> tris;
+    for (uint32_t y = 0; y < h; ++y)
+    {
+        for (uint32_t x = 0; x < w; ++x)
+        {
+            const auto v0 = y * (w + 1) + x, v1 = v0 + 1, v2 = v0 + w + 1, v3 = v2 + 1;
+            tris.push_back({ v0, v1, v3 });
+            tris.push_back({ v0, v3, v2 });
+        }
+    }
+    std::mt19937 gen(seed);
+    std::shuffle(tris.begin(), tris.end(), gen);
+    std::vector<uint32_t> idxs;
+    for (const auto& tri : tris)
+        idxs.insert(idxs.end(), tri.begin(), tri.end());
+    return idxs;
+}
+
+static std::vector<Triangle> SortedTriangles(const uint32_t* idxs, const size_t count)
+{
+    std::vector<Triangle> tris;
+    for (size_t i = 0; i + 3 <= count; i += 3)
+        tris.push_back({ idxs[i], idxs[i + 1], idxs[i + 2] });
+    std::sort(tris.begin(), tris.end());
+    return tris;
+}
+
+
+TEST(MeshOptimizer, ACMR)
+{
+    // strip-like order, each triangle brings one new vertex after the first
+    const std::vector<uint32_t> idxs = { 0, 1, 2, 1, 2, 3, 2, 3, 4 };
+    EXPECT_FLOAT_EQ(meshopt::CalcACMR(idxs, 5, 16), 5.f / 3.f);
+    // cache of 2 evicts the shared vertex
+    const std::vector<uint32_t> fan = { 0, 1, 2, 0, 2, 3, 0, 3, 4 };
+    EXPECT_FLOAT_EQ(meshopt::CalcACMR(fan, 5, 16), 5.f / 3.f);
+    EXPECT_FLOAT_EQ(meshopt::CalcACMR(fan, 5, 2), 2.f);
+}
+
+TEST(MeshOptimizer, TipsifyGroups)
+{
+    constexpr uint32_t W = 24, H = 20;
+    const auto vertCount = (W + 1) * (H + 1);
+    const auto src = GenerateGrid(W, H, 42);
+    // uneven groups, the last one is left to the tail call like ModelMesh does
+    const std::vector<uint32_t> groups = { 0, 3 * 1, 3 * 7, 3 * 300, 3 * 301, static_cast<uint32_t>(src.size()) };
+    auto idxs = src;
+    meshopt::Tipsifier tipsifier(vertCount, 16);
+    for (size_t g = 0; g + 1 < groups.size(); ++g)
+        tipsifier.Optimize(common::span<uint32_t>(idxs.data() + groups[g], groups[g + 1] - groups[g]));
+    ASSERT_EQ(idxs.size(), src.size());
+    // triangles never cross groups and keep their winding
+    for (size_t g = 0; g + 1 < groups.size(); ++g)
+    {
+        const auto count = groups[g + 1] - groups[g];
+        EXPECT_EQ(SortedTriangles(idxs.data() + groups[g], count), SortedTriangles(src.data() + groups[g], count)) << "group " << g;
+    }
+    // tipsifier is reused, so internal state should be reset after each group
+    auto whole = src;
+    tipsifier.Optimize(whole);
+    EXPECT_EQ(SortedTriangles(whole.data(), whole.size()), SortedTriangles(src.data(), src.size()));
+    const auto before = meshopt::CalcACMR(src, vertCount, 16), after = meshopt::CalcACMR(whole, vertCount, 16);
+    EXPECT_LT(after, before * 0.5f);
+    EXPECT_LT(after, 1.f);
+}
+
+TEST(MeshOptimizer, TipsifyDisjoint)
+{
+    // isolated triangles and a vertex shared by many triangles, cover dead-end handling
+    std::vector<uint32_t> src;
+    for (uint32_t i = 0; i < 40; ++i)
+        src.insert(src.end(), { 100 + i * 3, 101 + i * 3, 102 + i * 3 });
+    for (uint32_t i = 0; i < 40; ++i)
+        src.insert(src.end(), { 0, 1 + i, 2 + i });
+    std::mt19937 gen(7);
+    std::vector<Triangle> tris;
+    for (size_t i = 0; i < src.size(); i += 3)
+        tris.push_back({ src[i], src[i + 1], src[i + 2] });
+    std::shuffle(tris.begin(), tris.end(), gen);
+    src.clear();
+    for (const auto& tri : tris)
+        src.insert(src.end(), tri.begin(), tri.end());
+    // trailing indexes that don't form a triangle are left untouched
+    src.push_back(5);
+    auto idxs = src;
+    meshopt::Tipsifier tipsifier(300, 8);
+    tipsifier.Optimize(idxs);
+    EXPECT_EQ(idxs.back(), 5u);
+    EXPECT_EQ(SortedTriangles(idxs.data(), idxs.size() - 1), SortedTriangles(src.data(), src.size() - 1));
+}
+
+TEST(MeshOptimizer, VertexFetch)
+{
+    constexpr uint32_t W = 8, H = 8;
+    const auto src = GenerateGrid(W, H, 1);
+    // one more vertex that's never used
+    std::vector<uint32_t> verts((W + 1) * (H + 1) + 1);
+    for (uint32_t i = 0; i < verts.size(); ++i)
+        verts[i] = i * 10;
+    auto idxs = src;
+    meshopt::OptimizeVertexFetch(verts, idxs);
+    EXPECT_EQ(verts.size(), (W + 1) * (H + 1));
+    uint32_t maxIdx = 0;
+    for (size_t i = 0; i < idxs.size(); ++i)
+    {
+        // vertices are numbered in order of first use
+        EXPECT_LE(idxs[i], maxIdx) << i;
+        if (idxs[i] == maxIdx)
+            maxIdx++;
+        EXPECT_EQ(verts[idxs[i]], src[i] * 10) << i;
+    }
+    EXPECT_EQ(maxIdx, verts.size());
+}
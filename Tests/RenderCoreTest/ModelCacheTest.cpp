@@ -0,0 +1,203 @@
+#include "rely.h"
+#include "Model/ModelCache.hpp"
+#include <atomic>
+#include <thread>
+
+using dizz::detail::ModelCache;
+namespace fs = common::fs;
+
+
+struct StubMesh
+{
+    size_t Size;
+    uint32_t Version;
+    StubMesh(const size_t size, const uint32_t version) noexcept : Size(size), Version(version) { }
+    [[nodiscard]] size_t GetMemorySize() const noexcept { return Size; }
+};
+using Cache = ModelCache<StubMesh>;
+using Item = Cache::Item;
+using LookupResult = Cache::LookupResult;
+
+// a real file, since cached items are validated by modify time
+struct StubFile
+{
+    fs::path Path;
+    std::u16string Name;
+    StubFile(std::string_view name) : Path(fs::temp_directory_path() / name), Name(Path.u16string())
+    {
+        common::file::WriteAll(Path, std::string("stub"));
+    }
+    ~StubFile()
+    {
+        std::error_code ec;
+        fs::remove(Path, ec);
+    }
+    void Touch() const
+    {
+        fs::last_write_time(Path, fs::last_write_time(Path) + std::chrono::seconds(10));
+    }
+};
+
+// the same flow as _ModelMesh::GetModel
+static Item GetItem(Cache& cache, const std::u16string& fname, const size_t size, std::atomic<uint32_t>& loadCount)
+{
+    fs::file_time_type modifyTime;
+    Item mesh;
+    common::PromiseResult<Item> waiter;
+    switch (cache.Lookup(fname, modifyTime, mesh, waiter))
+    {
+    case LookupResult::Hit:     return mesh;
+    case LookupResult::Waiting: return waiter->Get();
+    default:
+        return cache.Load(fname, modifyTime, [&]()
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                return std::make_shared<StubMesh>(size, ++loadCount);
+            });
+    }
+}
+
+
+TEST(ModelCache, SharedLoad)
+{
+    StubFile file("modelcache_shared.obj");
+    Cache cache;
+    fs::file_time_type modifyTime;
+    Item mesh;
+    common::PromiseResult<Item> waiter1, waiter2;
+    ASSERT_EQ(cache.Lookup(file.Name, modifyTime, mesh, waiter1), LookupResult::NeedLoad);
+    // following requests wait for the loading one
+    EXPECT_EQ(cache.Lookup(file.Name, modifyTime, mesh, waiter1), LookupResult::Waiting);
+    EXPECT_EQ(cache.Lookup(file.Name, modifyTime, mesh, waiter2), LookupResult::Waiting);
+    EXPECT_FALSE(cache.IsCached(file.Name));
+    const auto loaded = cache.Load(file.Name, modifyTime, []() { return std::make_shared<StubMesh>(100, 1); });
+    EXPECT_EQ(waiter1->Get(), loaded);
+    EXPECT_EQ(waiter2->Get(), loaded);
+    EXPECT_TRUE(cache.IsCached(file.Name));
+    EXPECT_EQ(cache.Lookup(file.Name, modifyTime, mesh, waiter1), LookupResult::Hit);
+    EXPECT_EQ(mesh, loaded);
+
+    // concurrent requests only load once
+    StubFile file2("modelcache_shared2.obj");
+    std::atomic<uint32_t> loadCount = 0;
+    std::vector<Item> results(8);
+    std::vector<std::thread> threads;
+    for (auto& result : results)
+        threads.emplace_back([&]() { result = GetItem(cache, file2.Name, 100, loadCount); });
+    for (auto& thread : threads)
+        thread.join();
+    EXPECT_EQ(loadCount.load(), 1u);
+    for (const auto& result : results)
+        EXPECT_EQ(result, results[0]);
+    EXPECT_EQ(GetItem(cache, file2.Name, 100, loadCount), results[0]);
+    EXPECT_EQ(loadCount.load(), 1u);
+}
+
+TEST(ModelCache, LRUEviction)
+{
+    StubFile a("modelcache_a.obj"), b("modelcache_b.obj"), c("modelcache_c.obj"), d("modelcache_d.obj");
+    Cache cache;
+    std::atomic<uint32_t> loadCount = 0;
+    for (const auto file : { &a, &b, &c })
+        GetItem(cache, file->Name, 100, loadCount);
+    EXPECT_EQ(cache.GetCachedSize(), 300u);
+    // least recently used one goes first
+    cache.SetBudget(250);
+    EXPECT_FALSE(cache.IsCached(a.Name));
+    EXPECT_TRUE(cache.IsCached(b.Name));
+    EXPECT_TRUE(cache.IsCached(c.Name));
+    // hit refreshes b, so c is evicted when adding d
+    GetItem(cache, b.Name, 100, loadCount);
+    GetItem(cache, d.Name, 100, loadCount);
+    EXPECT_EQ(loadCount.load(), 4u);
+    EXPECT_TRUE(cache.IsCached(b.Name));
+    EXPECT_FALSE(cache.IsCached(c.Name));
+    EXPECT_TRUE(cache.IsCached(d.Name));
+    EXPECT_EQ(cache.GetCachedSize(), 200u);
+    // in-use ones are kept even beyond budget
+    {
+        const auto held = GetItem(cache, d.Name, 100, loadCount);
+        cache.SetBudget(0);
+        EXPECT_FALSE(cache.IsCached(b.Name));
+        EXPECT_TRUE(cache.IsCached(d.Name));
+        EXPECT_EQ(GetItem(cache, d.Name, 100, loadCount), held);
+    }
+    cache.Trim();
+    EXPECT_FALSE(cache.IsCached(d.Name));
+    EXPECT_EQ(cache.GetCachedSize(), 0u);
+    // evicted one is loaded again
+    GetItem(cache, a.Name, 100, loadCount);
+    EXPECT_EQ(loadCount.load(), 5u);
+}
+
+TEST(ModelCache, ReloadModified)
+{
+    StubFile file("modelcache_modified.obj");
+    Cache cache;
+    std::atomic<uint32_t> loadCount = 0;
+    const auto first = GetItem(cache, file.Name, 100, loadCount);
+    EXPECT_EQ(GetItem(cache, file.Name, 100, loadCount), first);
+    file.Touch();
+    const auto second = GetItem(cache, file.Name, 100, loadCount);
+    EXPECT_NE(second, first);
+    EXPECT_EQ(second->Version, 2u);
+    // stale one is still usable by its holders, only the new one is cached
+    EXPECT_EQ(first->Version, 1u);
+    EXPECT_EQ(cache.GetCachedSize(), 100u);
+    EXPECT_EQ(GetItem(cache, file.Name, 100, loadCount), second);
+    EXPECT_EQ(loadCount.load(), 2u);
+}
+
+TEST(ModelCache, FailLoad)
+{
+    StubFile file("modelcache_fail.obj");
+    Cache cache;
+    fs::file_time_type modifyTime;
+    Item mesh;
+    common::PromiseResult<Item> waiter;
+    // dropped task fails the waiters, and the next request loads again
+    ASSERT_EQ(cache.Lookup(file.Name, modifyTime, mesh, waiter), LookupResult::NeedLoad);
+    {
+        Cache::LoadTicket ticket(cache, file.Name);
+        EXPECT_EQ(cache.Lookup(file.Name, modifyTime, mesh, waiter), LookupResult::Waiting);
+    }
+    EXPECT_ANY_THROW(waiter->Get());
+    EXPECT_FALSE(cache.IsCached(file.Name));
+    // exception from loading is passed to waiters as well
+    ASSERT_EQ(cache.Lookup(file.Name, modifyTime, mesh, waiter), LookupResult::NeedLoad);
+    EXPECT_EQ(cache.Lookup(file.Name, modifyTime, mesh, waiter), LookupResult::Waiting);
+    EXPECT_ANY_THROW(cache.Load(file.Name, modifyTime, []() -> Item { COMMON_THROW(common::BaseException, u"stub failure"); }));
+    EXPECT_ANY_THROW(waiter->Get());
+    // taken ticket does not touch the loading
+    ASSERT_EQ(cache.Lookup(file.Name, modifyTime, mesh, waiter), LookupResult::NeedLoad);
+    EXPECT_EQ(cache.Lookup(file.Name, modifyTime, mesh, waiter), LookupResult::Waiting);
+    {
+        Cache::LoadTicket ticket(cache, file.Name);
+        ticket.Take();
+    }
+    const auto loaded = cache.Load(file.Name, modifyTime, []() { return std::make_shared<StubMesh>(100, 1); });
+    EXPECT_EQ(waiter->Get(), loaded);
+    EXPECT_TRUE(cache.IsCached(file.Name));
+}
+
+TEST(ModelCache, PutDuringLoad)
+{
+    StubFile file("modelcache_put.obj");
+    Cache cache;
+    fs::file_time_type modifyTime;
+    Item mesh;
+    common::PromiseResult<Item> waiter;
+    const auto put1 = std::make_shared<StubMesh>(100, 10), put2 = std::make_shared<StubMesh>(100, 20);
+    // put is ignored while loading, the loading one wins
+    ASSERT_EQ(cache.Lookup(file.Name, modifyTime, mesh, waiter), LookupResult::NeedLoad);
+    cache.Put(file.Name, put1);
+    EXPECT_FALSE(cache.IsCached(file.Name));
+    const auto loaded = cache.Load(file.Name, modifyTime, []() { return std::make_shared<StubMesh>(100, 1); });
+    ASSERT_EQ(cache.Lookup(file.Name, modifyTime, mesh, waiter), LookupResult::Hit);
+    EXPECT_EQ(mesh, loaded);
+    // otherwise it replaces the cached one
+    cache.Put(file.Name, put2);
+    ASSERT_EQ(cache.Lookup(file.Name, modifyTime, mesh, waiter), LookupResult::Hit);
+    EXPECT_EQ(mesh, put2);
+    EXPECT_EQ(cache.GetCachedSize(), 100u);
+}
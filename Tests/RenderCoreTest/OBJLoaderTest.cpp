@@ -0,0 +1,185 @@
+#include "rely.h"
+#include "Model/OBJLoader.hpp"
+#include <map>
+#include <random>
+
+using namespace std::string_view_literals;
+using dizz::detail::OBJLoder;
+using dizz::detail::OBJMesh;
+using dizz::detail::VertexSoA;
+using Corner = OBJMesh::Corner;
+
+
+static std::string GenerateOBJ(const uint32_t faceCount)
+{
+    std::mt19937 gen(42);
+    std::string text = "# generated\nmtllib a.mtl\n";
+    uint32_t points = 0, texcs = 0, norms = 0;
+    for (uint32_t i = 0; i < faceCount; ++i)
+    {
+        // elements are interleaved with faces, so chunks need correct bases
+        for (uint32_t j = gen() % 3; j-- > 0;)
+            text.append("v ").append(std::to_string(points++)).append(" 1.5 -2\n");
+        for (uint32_t j = gen() % 2; j-- > 0;)
+            text.append("vt 0.").append(std::to_string(texcs++)).append(" 0.25\r\n");
+        for (uint32_t j = gen() % 2; j-- > 0;)
+            text.append("vn 0 ").append(std::to_string(norms++)).append(" 1\n");
+        if (i % 16 == 0)
+            text.append("usemtl m").append(std::to_string(i)).append("\n");
+        if (points < 3 || texcs < 1 || norms < 1)
+            continue;
+        const auto corners = 3 + gen() % 3;
+        text.append("f");
+        for (uint32_t j = 0; j < corners; ++j)
+        {
+            // mix absolute and relative indexes, repeat small ranges so dedup has work to do
+            const auto v = points - (gen() % std::min(points, 4u));
+            const auto t = texcs - (gen() % std::min(texcs, 2u));
+            const auto n = norms - (gen() % std::min(norms, 2u));
+            if (gen() % 2)
+                text.append(" -").append(std::to_string(points - v + 1));
+            else
+                text.append(" ").append(std::to_string(v));
+            text.append("/").append(std::to_string(t)).append("/").append(std::to_string(n));
+        }
+        text.append(i % 5 ? "\n" : "\r\n");
+    }
+    return text;
+}
+
+static void CheckSameMesh(const OBJMesh& ref, const OBJMesh& mesh, const uint32_t threadCount)
+{
+    ASSERT_EQ(mesh.Points.size(), ref.Points.size()) << threadCount;
+    for (size_t i = 0; i < ref.Points.size(); ++i)
+    {
+        EXPECT_EQ(mesh.Points[i].X, ref.Points[i].X);
+        EXPECT_EQ(mesh.Points[i].Y, ref.Points[i].Y);
+        EXPECT_EQ(mesh.Points[i].Z, ref.Points[i].Z);
+    }
+    ASSERT_EQ(mesh.Texcs.size(), ref.Texcs.size()) << threadCount;
+    for (size_t i = 0; i < ref.Texcs.size(); ++i)
+    {
+        EXPECT_EQ(mesh.Texcs[i].X, ref.Texcs[i].X);
+        EXPECT_EQ(mesh.Texcs[i].Y, ref.Texcs[i].Y);
+    }
+    ASSERT_EQ(mesh.Normals.size(), ref.Normals.size()) << threadCount;
+    for (size_t i = 0; i < ref.Normals.size(); ++i)
+        EXPECT_EQ(mesh.Normals[i].Y, ref.Normals[i].Y);
+    EXPECT_TRUE(mesh.Corners == ref.Corners) << threadCount;
+    ASSERT_EQ(mesh.Directives.size(), ref.Directives.size()) << threadCount;
+    for (size_t i = 0; i < ref.Directives.size(); ++i)
+    {
+        EXPECT_EQ(mesh.Directives[i].Type, ref.Directives[i].Type);
+        EXPECT_EQ(mesh.Directives[i].Param, ref.Directives[i].Param);
+        EXPECT_EQ(mesh.Directives[i].Offset, ref.Directives[i].Offset);
+    }
+    EXPECT_EQ(mesh.Notes, ref.Notes);
+    EXPECT_EQ(mesh.BadFaces, ref.BadFaces);
+}
+
+
+TEST(OBJLoader, Triangulate)
+{
+    constexpr auto Text = "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 0 2 0\n"
+        "vt 0.5 1.25\nvn 0 0 1\n"
+        "f 1 2 3\n"
+        "f 1/1 2/1 3/1 4/1\n"
+        "f 1//1 2//1 3//1 4//1 5//1\n"
+        "f 1 2\n"
+        "f 1 1 2\n"sv;
+    const auto mesh = OBJLoder::ParseText(Text, 1);
+    // index 0 is the default element
+    ASSERT_EQ(mesh.Points.size(), 6u);
+    EXPECT_EQ(mesh.Points[3].X, 1.f);
+    EXPECT_EQ(mesh.Points[3].Y, 1.f);
+    ASSERT_EQ(mesh.Texcs.size(), 2u);
+    EXPECT_EQ(mesh.Texcs[1].X, 0.5f);
+    EXPECT_EQ(mesh.Texcs[1].Y, 0.25f); // only fraction is kept
+    const std::vector<Corner> expected =
+    {
+        { 1, 0, 0 }, { 2, 0, 0 }, { 3, 0, 0 },
+        // quad is split as fan
+        { 1, 1, 0 }, { 2, 1, 0 }, { 3, 1, 0 },
+        { 1, 1, 0 }, { 3, 1, 0 }, { 4, 1, 0 },
+        { 1, 0, 1 }, { 2, 0, 1 }, { 3, 0, 1 },
+        { 1, 0, 1 }, { 3, 0, 1 }, { 4, 0, 1 },
+        { 1, 0, 1 }, { 4, 0, 1 }, { 5, 0, 1 },
+    };
+    EXPECT_TRUE(mesh.Corners == expected);
+    EXPECT_THAT(mesh.BadFaces, testing::ElementsAre("f 1 2"sv, "f 1 1 2"sv));
+}
+
+TEST(OBJLoader, NegativeIndex)
+{
+    constexpr auto Text = "v 1 0 0\nv 2 0 0\nv 3 0 0\nvn 0 0 1\n"
+        "f -3//-1 -2//-1 -1//-1\n"
+        "v 4 0 0\n"
+        "f -1 -2 -4\n"
+        // out of range ones fallback to the default element
+        "f -5 1 2\n"
+        "f 9 1 2\n"sv;
+    for (uint32_t threadCount = 1; threadCount <= 8; ++threadCount)
+    {
+        const auto mesh = OBJLoder::ParseText(Text, threadCount);
+        // relative index is based on elements before the line, even when they're in previous chunks
+        const std::vector<Corner> expected =
+        {
+            { 1, 0, 1 }, { 2, 0, 1 }, { 3, 0, 1 },
+            { 4, 0, 0 }, { 3, 0, 0 }, { 1, 0, 0 },
+            { 0, 0, 0 }, { 1, 0, 0 }, { 2, 0, 0 },
+            { 0, 0, 0 }, { 1, 0, 0 }, { 2, 0, 0 },
+        };
+        EXPECT_TRUE(mesh.Corners == expected) << threadCount;
+        EXPECT_TRUE(mesh.BadFaces.empty());
+    }
+}
+
+TEST(OBJLoader, ChunkBoundary)
+{
+    const auto text = GenerateOBJ(600);
+    const auto ref = OBJLoder::ParseText(text, 1);
+    ASSERT_GT(ref.Corners.size(), 600u);
+    EXPECT_EQ(ref.Directives.size(), 600u / 16 + 2);
+    EXPECT_THAT(ref.Notes, testing::ElementsAre("# generated"sv));
+    // cover chunks splitting inside lines, between "\r\n" and empty chunks
+    for (const uint32_t threadCount : { 2u, 3u, 7u, 16u, 61u, 257u })
+        CheckSameMesh(ref, OBJLoder::ParseText(text, threadCount), threadCount);
+    // no trailing newline
+    const auto trimmed = std::string_view(text).substr(0, text.size() - (text.back() == '\n' ? 1 : 0));
+    const auto refTrim = OBJLoder::ParseText(trimmed, 1);
+    EXPECT_TRUE(refTrim.Corners == ref.Corners);
+    CheckSameMesh(refTrim, OBJLoder::ParseText(trimmed, 5), 5);
+}
+
+TEST(OBJLoader, Dedup)
+{
+    const auto text = GenerateOBJ(2000);
+    const auto mesh = OBJLoder::ParseText(text, 4);
+    // serial reference, vertices are in order of first occurrence
+    std::map<std::tuple<uint32_t, uint32_t, uint32_t>, uint32_t> lookup;
+    std::vector<uint32_t> refIdxs, firsts;
+    for (uint32_t i = 0; i < mesh.Corners.size(); ++i)
+    {
+        const auto& c = mesh.Corners[i];
+        const auto [it, isNew] = lookup.try_emplace({ c.Vert, c.Texc, c.Norm }, static_cast<uint32_t>(firsts.size()));
+        if (isNew)
+            firsts.push_back(i);
+        refIdxs.push_back(it->second);
+    }
+    ASSERT_LT(firsts.size(), mesh.Corners.size());
+    for (const uint32_t threadCount : { 1u, 2u, 3u, 8u })
+    {
+        VertexSoA verts;
+        std::vector<uint32_t> idxs;
+        dizz::detail::BuildVertices(mesh, verts, idxs, threadCount);
+        EXPECT_EQ(idxs, refIdxs) << threadCount;
+        ASSERT_EQ(verts.Size(), firsts.size()) << threadCount;
+        for (size_t i = 0; i < firsts.size(); ++i)
+        {
+            const auto& c = mesh.Corners[firsts[i]];
+            EXPECT_EQ(verts.Pos[0][i], mesh.Points[c.Vert].X);
+            EXPECT_EQ(verts.Texc[0][i], mesh.Texcs[c.Texc].X);
+            EXPECT_EQ(verts.Norm[1][i], mesh.Normals[c.Norm].Y);
+        }
+    }
+}
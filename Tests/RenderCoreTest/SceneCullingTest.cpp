@@ -0,0 +1,250 @@
+#include "rely.h"
+#include "SceneCulling.h"
+#include <optional>
+#include <random>
+
+namespace mbase = common::math::base;
+using dizz::BoundingBox;
+using dizz::detail::Frustum;
+using dizz::detail::BVH;
+using Result = Frustum::Result;
+
+
+static mbase::Mat4 MakeProjection(const float aspect, const float zNear, const float zFar)
+{
+    const float cot = 1.f / std::tan(0.5f), depthR = 1.f / (zFar - zNear);
+    return mbase::Mat4
+    {
+        { cot / aspect, 0.f, 0.f, 0.f },
+        { 0.f, cot, 0.f, 0.f },
+        { 0.f, 0.f, (zFar + zNear) * depthR, (-2 * zFar * zNear) * depthR },
+        { 0.f, 0.f, 1.f, 0.f }
+    };
+}
+
+// rotate around Y then move, so the camera looks at different parts of the scene
+static mbase::Mat4 MakePV(const float angle, const mbase::Vec3& pos, const float zFar = 60.f)
+{
+    const float c = std::cos(angle), s = std::sin(angle);
+    const mbase::Mat4 view
+    {
+        { c, 0.f, -s, -(c * pos.X - s * pos.Z) },
+        { 0.f, 1.f, 0.f, -pos.Y },
+        { s, 0.f, c, -(s * pos.X + c * pos.Z) },
+        { 0.f, 0.f, 0.f, 1.f }
+    };
+    return MakeProjection(1.5f, 0.5f, zFar) * view;
+}
+
+static std::vector<BoundingBox> GenerateBoxes(const uint32_t count, std::mt19937& gen)
+{
+    std::uniform_real_distribution<float> posDist(-50.f, 50.f), sizeDist(0.1f, 6.f);
+    std::vector<BoundingBox> boxes;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const mbase::Vec3 center(posDist(gen), posDist(gen) * 0.2f, posDist(gen));
+        const mbase::Vec3 extent(sizeDist(gen), sizeDist(gen), sizeDist(gen));
+        boxes.emplace_back(center - extent, center + extent);
+    }
+    return boxes;
+}
+
+// test 8 corners against each plane in double, nullopt when a corner is too close to a plane to tell
+static std::optional<Result> BruteForceTest(const mbase::Mat4& pvMat, const BoundingBox& box)
+{
+    bool inside = true;
+    for (uint8_t p = 0; p < 6; ++p)
+    {
+        const double sign = (p & 1) ? -1. : 1.;
+        double plane[4];
+        for (uint8_t c = 0; c < 4; ++c)
+            plane[c] = double(pvMat[3][c]) + sign * double(pvMat[p / 2][c]);
+        uint32_t outside = 0;
+        for (uint8_t corner = 0; corner < 8; ++corner)
+        {
+            const double x = (corner & 1) ? box.Max.X : box.Min.X;
+            const double y = (corner & 2) ? box.Max.Y : box.Min.Y;
+            const double z = (corner & 4) ? box.Max.Z : box.Min.Z;
+            const auto dist = plane[0] * x + plane[1] * y + plane[2] * z + plane[3];
+            const auto scale = std::abs(plane[0] * x) + std::abs(plane[1] * y) + std::abs(plane[2] * z) + std::abs(plane[3]);
+            if (std::abs(dist) <= scale * 1e-4)
+                return {};
+            if (dist < 0)
+                outside++;
+        }
+        if (outside == 8)
+            return Result::Outside;
+        if (outside > 0)
+            inside = false;
+    }
+    return inside ? Result::Inside : Result::Intersect;
+}
+
+// items which are definitely visible must be included, definitely invisible ones must not
+static void CheckCulled(const mbase::Mat4& pvMat, const std::vector<BoundingBox>& boxes, std::vector<uint32_t> items)
+{
+    std::sort(items.begin(), items.end());
+    EXPECT_EQ(std::adjacent_find(items.begin(), items.end()), items.end()) << "duplicated items";
+    for (uint32_t i = 0; i < boxes.size(); ++i)
+    {
+        const auto ref = BruteForceTest(pvMat, boxes[i]);
+        if (!ref)
+            continue;
+        EXPECT_EQ(std::binary_search(items.begin(), items.end(), i), *ref != Result::Outside) << "item " << i;
+    }
+}
+
+static std::vector<uint32_t> CullOne(const BVH& bvh, const Frustum& frustum)
+{
+    std::vector<uint32_t> items;
+    bvh.Cull(common::span<const Frustum>(&frustum, 1), common::span<std::vector<uint32_t>>(&items, 1));
+    return items;
+}
+
+static void CheckBVHNodes(const BVH& bvh, const std::vector<BoundingBox>& boxes)
+{
+    const auto nodes = bvh.GetNodes();
+    ASSERT_FALSE(nodes.empty());
+    EXPECT_EQ(nodes[0].Count, boxes.size());
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        const auto& node = nodes[i];
+        if (node.IsLeaf())
+        {
+            EXPECT_LE(node.Count, BVH::LeafSize) << i;
+            continue;
+        }
+        // children cover parent's range and are enclosed by parent's box
+        const auto& l = nodes[node.Left], & r = nodes[node.Left + 1];
+        EXPECT_EQ(l.Parent, i);
+        EXPECT_EQ(r.Parent, i);
+        EXPECT_EQ(l.Begin, node.Begin);
+        EXPECT_EQ(r.Begin, l.Begin + l.Count);
+        EXPECT_EQ(l.Count + r.Count, node.Count);
+        auto merged = l.Box;
+        merged.Merge(r.Box);
+        EXPECT_EQ(merged.Min.X, node.Box.Min.X) << i;
+        EXPECT_EQ(merged.Min.Y, node.Box.Min.Y) << i;
+        EXPECT_EQ(merged.Max.Z, node.Box.Max.Z) << i;
+    }
+}
+
+static float TreeCost(const BVH& bvh)
+{
+    float cost = 0.f;
+    for (const auto& node : bvh.GetNodes())
+        cost += node.Box.HalfArea();
+    return cost;
+}
+
+
+TEST(SceneCulling, FrustumTest)
+{
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> angleDist(0.f, 6.28f), posDist(-20.f, 20.f);
+    const auto boxes = GenerateBoxes(2000, gen);
+    uint32_t counts[3] = { 0, 0, 0 };
+    for (uint32_t round = 0; round < 8; ++round)
+    {
+        const auto pvMat = MakePV(angleDist(gen), { posDist(gen), posDist(gen) * 0.1f, posDist(gen) });
+        const Frustum frustum(pvMat);
+        for (size_t i = 0; i < boxes.size(); ++i)
+        {
+            const auto ref = BruteForceTest(pvMat, boxes[i]);
+            if (!ref)
+                continue;
+            const auto ret = frustum.Test(boxes[i]);
+            EXPECT_EQ(ret, *ref) << "round " << round << " box " << i;
+            counts[static_cast<uint8_t>(ret)]++;
+        }
+    }
+    // all cases should be covered
+    EXPECT_GT(counts[0], 1000u);
+    EXPECT_GT(counts[1], 100u);
+    EXPECT_GT(counts[2], 100u);
+}
+
+TEST(SceneCulling, BVHRefitRebuild)
+{
+    std::mt19937 gen(7);
+    auto boxes = GenerateBoxes(301, gen);
+    BVH bvh;
+    EXPECT_TRUE(bvh.IsRebuildPending());
+    bvh.Reset(boxes);
+    bvh.Update();
+    ASSERT_FALSE(bvh.IsRebuildPending());
+    EXPECT_EQ(bvh.Size(), boxes.size());
+    CheckBVHNodes(bvh, boxes);
+    const auto pvMat = MakePV(0.3f, { 0.f, 0.f, -10.f }, 80.f);
+    const Frustum frustum(pvMat);
+    CheckCulled(pvMat, boxes, CullOne(bvh, frustum));
+
+    // small moves only refit the tree
+    const auto nodeCount = bvh.GetNodes().size();
+    std::uniform_real_distribution<float> moveDist(-1.f, 1.f);
+    for (uint32_t i = 0; i < boxes.size(); i += 7)
+    {
+        const mbase::Vec3 offset(moveDist(gen), moveDist(gen), moveDist(gen));
+        boxes[i] = { boxes[i].Min + offset, boxes[i].Max + offset };
+        bvh.SetBox(i, boxes[i]);
+    }
+    bvh.Update();
+    ASSERT_FALSE(bvh.IsRebuildPending());
+    EXPECT_EQ(bvh.GetNodes().size(), nodeCount);
+    CheckBVHNodes(bvh, boxes);
+    CheckCulled(pvMat, boxes, CullOne(bvh, frustum));
+
+    // scatter items far away, refitted tree is much worse, so it gets rebuilt
+    std::uniform_real_distribution<float> farDist(-500.f, 500.f);
+    for (uint32_t i = 0; i < boxes.size(); i += 2)
+    {
+        const mbase::Vec3 offset(farDist(gen), farDist(gen), farDist(gen));
+        boxes[i] = { boxes[i].Min + offset, boxes[i].Max + offset };
+        bvh.SetBox(i, boxes[i]);
+    }
+    bvh.Update();
+    ASSERT_FALSE(bvh.IsRebuildPending());
+    CheckBVHNodes(bvh, boxes);
+    CheckCulled(pvMat, boxes, CullOne(bvh, frustum));
+    // build is deterministic, so a rebuilt tree is the same as a fresh one
+    BVH fresh;
+    fresh.Reset(boxes);
+    fresh.Update();
+    EXPECT_EQ(TreeCost(bvh), TreeCost(fresh));
+
+    bvh.Reset({});
+    bvh.Update();
+    EXPECT_TRUE(bvh.GetNodes().empty());
+    EXPECT_TRUE(CullOne(bvh, frustum).empty());
+}
+
+TEST(SceneCulling, MultiFrustum)
+{
+    std::mt19937 gen(1);
+    const auto boxes = GenerateBoxes(1000, gen);
+    BVH bvh;
+    bvh.Reset(boxes);
+    bvh.Update();
+    std::uniform_real_distribution<float> angleDist(0.f, 6.28f), posDist(-30.f, 30.f);
+    for (const size_t count : { size_t(1), size_t(3), size_t(5), BVH::MaxFrustum })
+    {
+        std::vector<mbase::Mat4> pvMats;
+        std::vector<Frustum> frusta;
+        for (size_t i = 0; i < count; ++i)
+        {
+            pvMats.push_back(MakePV(angleDist(gen), { posDist(gen), 0.f, posDist(gen) }));
+            frusta.emplace_back(pvMats.back());
+        }
+        std::vector<std::vector<uint32_t>> outs(count);
+        bvh.Cull(frusta, outs);
+        // shared traversal should give the same set as culling each frustum alone
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto single = CullOne(bvh, frusta[i]);
+            std::sort(single.begin(), single.end());
+            std::sort(outs[i].begin(), outs[i].end());
+            EXPECT_EQ(outs[i], single) << count << " frusta, #" << i;
+            CheckCulled(pvMats[i], boxes, outs[i]);
+        }
+    }
+}
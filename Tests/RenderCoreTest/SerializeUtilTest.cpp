@@ -0,0 +1,261 @@
+#include "rely.h"
+#include <random>
+
+namespace respak = xziar::respak;
+namespace ejson = xziar::ejson;
+using respak::SerializeUtil;
+using respak::DeserializeUtil;
+using respak::ResourceCodec;
+using respak::detail::ResourceItem;
+
+
+class RespakTestObject : public respak::Serializable
+{
+public:
+    std::string Name;
+    std::vector<std::byte> Data;
+    RESPAK_DECL_SIMP_DESERIALIZE("test#RespakTestObject")
+    void Serialize(SerializeUtil& context, ejson::JObject& jself) const override
+    {
+        jself.Add("name", Name);
+        jself.Add("data", context.PutResource(Data.data(), Data.size()));
+    }
+    void Deserialize(DeserializeUtil& context, const ejson::JObjectRef<true>& object) override
+    {
+        Name = object.Get<std::string>("name");
+        const auto data = context.GetResource(object.Get<std::string>("data"));
+        Data.assign(data.GetRawPtr(), data.GetRawPtr() + data.GetSize());
+    }
+};
+RESPAK_IMPL_SIMP_DESERIALIZE(RespakTestObject)
+
+
+static std::vector<std::byte> RandomBytes(const size_t size, std::mt19937& gen)
+{
+    std::vector<std::byte> data(size);
+    for (auto& dat : data)
+        dat = std::byte(gen());
+    return data;
+}
+
+// repeated short words, deflate should save much more than 1/8
+static std::vector<std::byte> CompressibleBytes(const size_t size, std::mt19937& gen)
+{
+    std::vector<std::byte> data(size);
+    for (size_t i = 0; i < size; ++i)
+        data[i] = std::byte('a' + (i / 16 + gen() % 2) % 8);
+    return data;
+}
+
+static bool IsSame(const common::AlignedBuffer& buf, const std::vector<std::byte>& data)
+{
+    return buf.GetSize() == data.size() && std::equal(data.begin(), data.end(), buf.GetRawPtr());
+}
+
+struct RespakFile
+{
+    common::fs::path Path;
+    RespakFile(std::string_view name) : Path(common::fs::temp_directory_path() / name)
+    {
+        Clean();
+    }
+    ~RespakFile()
+    {
+        Clean();
+    }
+    void Clean() const
+    {
+        std::error_code ec;
+        common::fs::remove(common::fs::path(Path).replace_extension(u".xzrp"), ec);
+        common::fs::remove(common::fs::path(Path).replace_extension(u".xzrp.json"), ec);
+    }
+    // resource index from the tail of respak
+    std::vector<ResourceItem> ReadIndex() const
+    {
+        const auto file = common::file::ReadAll<std::byte>(common::fs::path(Path).replace_extension(u".xzrp"));
+        EXPECT_GE(file.size(), sizeof(ResourceItem));
+        if (file.size() < sizeof(ResourceItem))
+            return {};
+        ResourceItem sumdata;
+        memcpy(&sumdata, file.data() + file.size() - sizeof(ResourceItem), sizeof(ResourceItem));
+        const auto count = sumdata.GetIndex();
+        EXPECT_EQ(sumdata.GetOffset() + count * sizeof(ResourceItem) + sizeof(ResourceItem), file.size());
+        std::vector<ResourceItem> items(count);
+        memcpy(items.data(), file.data() + sumdata.GetOffset(), count * sizeof(ResourceItem));
+        return items;
+    }
+};
+
+
+TEST(SerializeUtil, ResourceRoundTrip)
+{
+    std::mt19937 gen(42);
+    const auto small = RandomBytes(100, gen), random = RandomBytes(20000, gen),
+        text = CompressibleBytes(30000, gen), text2 = CompressibleBytes(5000, gen), empty = std::vector<std::byte>{};
+    std::vector<std::vector<std::byte>> batch;
+    for (uint32_t i = 0; i < 24; ++i)
+        batch.push_back(i % 2 ? RandomBytes(700 + i * 100, gen) : CompressibleBytes(700 + i * 100, gen));
+    batch.push_back(batch[3]); // duplicated inside batch
+    batch.push_back(text); // duplicated with previous one
+
+    RespakFile file("respak_test_resource.dat");
+    std::string hSmall, hRandom, hText, hText2, hEmpty;
+    std::vector<std::string> hBatch;
+    {
+        SerializeUtil serializer(file.Path, 2);
+        hSmall = serializer.PutResource(small.data(), small.size(), "small");
+        hText = serializer.PutResource(text.data(), text.size());
+        serializer.Codec = ResourceCodec::None;
+        hText2 = serializer.PutResource(text2.data(), text2.size());
+        serializer.Codec = ResourceCodec::Deflate;
+        hRandom = serializer.PutResource(random.data(), random.size());
+        hEmpty = serializer.PutResource(empty.data(), empty.size());
+        // same content returns the same handle, and is only stored once
+        EXPECT_EQ(serializer.PutResource(text.data(), text.size()), hText);
+        EXPECT_EQ(serializer.PutResource(small.data(), small.size()), hSmall);
+        EXPECT_EQ(serializer.LookupResource("small"), hSmall);
+        EXPECT_EQ(serializer.LookupResource("none"), "");
+
+        std::vector<SerializeUtil::ResourceBlob> blobs;
+        for (const auto& dat : batch)
+            blobs.push_back({ dat, "" });
+        hBatch = serializer.PutResources(blobs);
+        ASSERT_EQ(hBatch.size(), batch.size());
+        EXPECT_EQ(hBatch[24], hBatch[3]);
+        EXPECT_EQ(hBatch[25], hText);
+        serializer.Root.Add("small", hSmall);
+        serializer.Finish();
+        EXPECT_ANY_THROW(serializer.PutResource(small.data(), small.size()));
+    }
+
+    const auto items = file.ReadIndex();
+    // 5 single ones and 24 unique ones in batch
+    ASSERT_EQ(items.size(), 5u + 24u);
+    std::map<std::string, const ResourceItem*> itemMap;
+    for (uint32_t i = 0; i < items.size(); ++i)
+    {
+        const auto& item = items[i];
+        EXPECT_EQ(item.GetIndex(), i);
+        itemMap.emplace(item.ExtractHandle(), &item);
+        // Dummy[0] is codec, Dummy[4,12) is stored size when compressed
+        const auto codec = item.GetCodec();
+        EXPECT_TRUE(codec == ResourceCodec::None || codec == ResourceCodec::Deflate);
+        uint64_t storedSize = 0;
+        for (uint32_t j = 0; j < 8; ++j)
+            storedSize |= std::to_integer<uint64_t>(item.Dummy[4 + j]) << (j * 8);
+        if (codec == ResourceCodec::None)
+        {
+            EXPECT_EQ(storedSize, 0u);
+            EXPECT_EQ(item.GetStoredSize(), item.GetSize());
+        }
+        else
+        {
+            EXPECT_EQ(item.GetStoredSize(), storedSize);
+            EXPECT_LE(storedSize, item.GetSize() - item.GetSize() / 8);
+        }
+    }
+    ASSERT_EQ(itemMap.size(), items.size());
+    // small and incompressible ones are kept raw, as well as those put when codec is None
+    EXPECT_EQ(itemMap[hSmall]->GetCodec(), ResourceCodec::None);
+    EXPECT_EQ(itemMap[hRandom]->GetCodec(), ResourceCodec::None);
+    EXPECT_EQ(itemMap[hText2]->GetCodec(), ResourceCodec::None);
+    EXPECT_EQ(itemMap[hEmpty]->GetCodec(), ResourceCodec::None);
+    EXPECT_EQ(itemMap[hText]->GetCodec(), ResourceCodec::Deflate);
+    EXPECT_EQ(itemMap[hBatch[0]]->GetCodec(), ResourceCodec::Deflate);
+    EXPECT_EQ(itemMap[hBatch[1]]->GetCodec(), ResourceCodec::None);
+    // file layout is the same as putting them in order
+    EXPECT_EQ(itemMap[hSmall]->GetIndex(), 0u);
+    EXPECT_EQ(itemMap[hText]->GetIndex(), 1u);
+    EXPECT_EQ(itemMap[hBatch[0]]->GetIndex(), 5u);
+    EXPECT_EQ(itemMap[hBatch[23]]->GetIndex(), 28u);
+
+    DeserializeUtil deserializer(file.Path);
+    EXPECT_EQ(deserializer.Root.Get<std::string>("small"), hSmall);
+    EXPECT_TRUE(IsSame(deserializer.GetResource(hSmall), small));
+    EXPECT_TRUE(IsSame(deserializer.GetResource(hText), text));
+    EXPECT_TRUE(IsSame(deserializer.GetResource(hText2), text2));
+    EXPECT_TRUE(IsSame(deserializer.GetResource(hEmpty), empty));
+    for (size_t i = 0; i < batch.size(); ++i)
+        EXPECT_TRUE(IsSame(deserializer.GetResource(hBatch[i]), batch[i])) << "batch " << i;
+    {
+        // raw resource comes from the mapping, large one is page aligned
+        const auto res = deserializer.GetResource(hRandom);
+        EXPECT_TRUE(IsSame(res, random));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(res.GetRawPtr()) % 4096, 0u);
+        EXPECT_EQ(deserializer.GetResource(hRandom, false).GetRawPtr(), res.GetRawPtr());
+        const auto res2 = deserializer.GetResource(hText2);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(res2.GetRawPtr()) % 4096, 0u);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(deserializer.GetResource(hSmall).GetRawPtr()) % sizeof(ResourceItem), 0u);
+    }
+    {
+        // compressed resource is decoded once when cached
+        const auto res = deserializer.GetResource(hText);
+        EXPECT_EQ(deserializer.GetResource(hText).GetRawPtr(), res.GetRawPtr());
+        const auto res2 = deserializer.GetResource(hText, false);
+        EXPECT_NE(res2.GetRawPtr(), res.GetRawPtr());
+        EXPECT_TRUE(IsSame(res2, text));
+    }
+    EXPECT_EQ(deserializer.GetResource("@" + std::string(64, '0')).GetSize(), 0u);
+    EXPECT_ANY_THROW(deserializer.GetResource("wrong"));
+}
+
+TEST(SerializeUtil, ObjectRoundTrip)
+{
+    std::mt19937 gen(7);
+    std::vector<RespakTestObject> objects(6);
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        objects[i].Name = "obj" + std::to_string(i);
+        objects[i].Data = i % 2 ? RandomBytes(300 + i * 1000, gen) : CompressibleBytes(300 + i * 1000, gen);
+    }
+    // ids that need escaping are located without being unescaped
+    const std::string ids[] = { "plain", "with space", "quote\"", "back\\slash", "line\nbreak", "" };
+    for (const bool isPretty : { false, true })
+    {
+        RespakFile file("respak_test_object.dat");
+        std::vector<std::string> handles;
+        {
+            SerializeUtil serializer(file.Path);
+            serializer.IsPretty = isPretty;
+            for (size_t i = 0; i < objects.size(); ++i)
+                handles.push_back(serializer.AddObject(objects[i], ids[i]));
+            // added object is only written once
+            EXPECT_EQ(serializer.AddObject(objects[1], ids[1]), handles[1]);
+            EXPECT_EQ(handles[0], "$plain");
+            auto jhandles = serializer.NewArray();
+            for (const auto& handle : handles)
+                jhandles.Push(handle);
+            serializer.Root.Add("shared", jhandles);
+            serializer.AddObject(serializer.Root, "inline", objects[2]);
+            serializer.Root.Add("count", static_cast<uint32_t>(objects.size()));
+            serializer.Finish();
+        }
+        // shared objects are streamed ahead of the rest
+        const auto json = common::file::ReadAllText(common::fs::path(file.Path).replace_extension(u".xzrp.json"));
+        EXPECT_EQ(json.rfind(isPretty ? "{\n    \"#shared\":{" : "{\"#shared\":{", 0), 0u) << json.substr(0, 32);
+
+        DeserializeUtil deserializer(file.Path);
+        EXPECT_EQ(deserializer.Root.Get<uint32_t>("count"), objects.size());
+        const auto jhandles = deserializer.Root.GetArray("shared");
+        ASSERT_EQ(jhandles.Size(), handles.size());
+        // shared objects are parsed lazily in any order, and stay the same node afterwards
+        for (size_t i = handles.size(); i-- > 0;)
+        {
+            const auto handle = jhandles.Get<std::string>(static_cast<uint32_t>(i));
+            EXPECT_EQ(handle, handles[i]);
+            const auto obj = deserializer.DeserializeShare<RespakTestObject>(handle);
+            ASSERT_NE(obj, nullptr) << "object " << i;
+            EXPECT_EQ(obj->Name, objects[i].Name);
+            EXPECT_EQ(obj->Data, objects[i].Data);
+            EXPECT_EQ(deserializer.DeserializeShare<RespakTestObject>(handle), obj);
+            const auto obj2 = deserializer.Deserialize<RespakTestObject>(handle);
+            ASSERT_NE(obj2, nullptr);
+            EXPECT_EQ(obj2->Data, objects[i].Data);
+        }
+        EXPECT_EQ(deserializer.DeserializeShare<RespakTestObject>(std::string_view("$missing")), nullptr);
+        const auto inlineObj = deserializer.Deserialize<RespakTestObject>(deserializer.Root.GetObject("inline"));
+        ASSERT_NE(inlineObj, nullptr);
+        EXPECT_EQ(inlineObj->Name, objects[2].Name);
+        EXPECT_EQ(inlineObj->Data, objects[2].Data);
+    }
+}
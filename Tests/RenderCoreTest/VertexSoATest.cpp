@@ -0,0 +1,120 @@
+#include "rely.h"
+#include "Model/VertexSoA.hpp"
+#include <random>
+
+namespace mbase = common::math::base;
+using dizz::detail::VertexSoA;
+using oglu::PointEx;
+
+
+// bumpy grid with shared vertices, triangle count is not a multiple of 4 so padded lanes are covered
+static void GenerateMesh(const uint32_t w, const uint32_t h, VertexSoA& verts, std::vector<PointEx>& pts, std::vector<uint32_t>& idxs)
+{
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    const auto count = (w + 1) * (h + 1);
+    verts.Resize(count);
+    pts.resize(count);
+    for (uint32_t y = 0, i = 0; y <= h; ++y)
+    {
+        for (uint32_t x = 0; x <= w; ++x, ++i)
+        {
+            const mbase::Vec3 pos(x + dist(gen) * 0.3f, y + dist(gen) * 0.3f, dist(gen));
+            const mbase::Normal norm(mbase::Vec3(dist(gen) * 0.5f, dist(gen) * 0.5f, 1.f));
+            // flip some of texcoords, so handness differs
+            const mbase::Vec2 texc((x % 3 == 2 ? -0.5f * x : 0.5f * x) + dist(gen) * 0.1f, 0.5f * y + dist(gen) * 0.1f);
+            verts.Set(i, pos, norm, texc);
+            pts[i] = PointEx(pos, norm, texc);
+        }
+    }
+    for (uint32_t y = 0; y < h; ++y)
+    {
+        for (uint32_t x = 0; x < w; ++x)
+        {
+            const auto v0 = y * (w + 1) + x, v1 = v0 + 1, v2 = v0 + w + 1, v3 = v2 + 1;
+            idxs.insert(idxs.end(), { v0, v1, v3, v0, v3, v2 });
+        }
+    }
+}
+
+
+TEST(VertexSoA, Tangents)
+{
+    VertexSoA verts;
+    std::vector<PointEx> pts;
+    std::vector<uint32_t> idxs;
+    GenerateMesh(7, 5, verts, pts, idxs);
+    ASSERT_NE(idxs.size() / 3 % 4, 0u);
+    verts.GenerateTangents(idxs);
+    for (size_t t = 0; t < idxs.size(); t += 3)
+        oglu::GenerateTanPoint(pts[idxs[t]], pts[idxs[t + 1]], pts[idxs[t + 2]]);
+    std::vector<PointEx> output;
+    verts.ToInterleaved(output);
+    ASSERT_EQ(output.size(), pts.size());
+    for (size_t i = 0; i < pts.size(); ++i)
+    {
+        const auto& ref = pts[i].tan;
+        EXPECT_NEAR(verts.Tan[0][i], ref.X, 1e-4f) << i;
+        EXPECT_NEAR(verts.Tan[1][i], ref.Y, 1e-4f) << i;
+        EXPECT_NEAR(verts.Tan[2][i], ref.Z, 1e-4f) << i;
+        // handness is a sum of +-1
+        EXPECT_EQ(verts.Tan[3][i], ref.W) << i;
+        EXPECT_EQ(output[i].tan.W, ref.W);
+        EXPECT_EQ(output[i].pos.X, pts[i].pos.X);
+        EXPECT_EQ(output[i].tcoord.Y, pts[i].tcoord.Y);
+    }
+}
+
+TEST(VertexSoA, FixInvertNormals)
+{
+    VertexSoA verts;
+    std::vector<PointEx> pts;
+    std::vector<uint32_t> idxs;
+    GenerateMesh(6, 6, verts, pts, idxs);
+    // flip some normals
+    for (uint32_t i = 0; i < pts.size(); i += 3)
+    {
+        for (uint8_t c = 0; c < 3; ++c)
+            verts.Norm[c][i] = -verts.Norm[c][i];
+        pts[i].norm = pts[i].norm.Negative(); // it's normalized again, so only compare with ulps
+    }
+    verts.FixInvertNormals(idxs);
+    for (size_t t = 0; t < idxs.size(); t += 3)
+        oglu::FixInvertNormal(pts[idxs[t]], pts[idxs[t + 1]], pts[idxs[t + 2]]);
+    for (size_t i = 0; i < pts.size(); ++i)
+    {
+        EXPECT_FLOAT_EQ(verts.Norm[0][i], pts[i].norm.X) << i;
+        EXPECT_FLOAT_EQ(verts.Norm[1][i], pts[i].norm.Y) << i;
+        EXPECT_FLOAT_EQ(verts.Norm[2][i], pts[i].norm.Z) << i;
+    }
+}
+
+TEST(VertexSoA, Bounds)
+{
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<float> dist(-100.f, 100.f);
+    // cover sizes less than, equal to and not aligned to 4
+    for (const uint32_t count : { 1u, 3u, 4u, 9u, 64u, 131u })
+    {
+        VertexSoA verts;
+        verts.Resize(count);
+        mbase::Vec3 minV(std::numeric_limits<float>::max()), maxV(std::numeric_limits<float>::lowest());
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const mbase::Vec3 pos(dist(gen), dist(gen), dist(gen));
+            verts.Set(i, pos, mbase::Vec3::Zeros(), mbase::Vec2::Zeros());
+            minV.X = std::min(minV.X, pos.X), minV.Y = std::min(minV.Y, pos.Y), minV.Z = std::min(minV.Z, pos.Z);
+            maxV.X = std::max(maxV.X, pos.X), maxV.Y = std::max(maxV.Y, pos.Y), maxV.Z = std::max(maxV.Z, pos.Z);
+        }
+        const auto [bmin, bmax] = verts.CalcBounds();
+        EXPECT_EQ(bmin.X, minV.X) << count;
+        EXPECT_EQ(bmin.Y, minV.Y) << count;
+        EXPECT_EQ(bmin.Z, minV.Z) << count;
+        EXPECT_EQ(bmax.X, maxV.X) << count;
+        EXPECT_EQ(bmax.Y, maxV.Y) << count;
+        EXPECT_EQ(bmax.Z, maxV.Z) << count;
+    }
+    const auto [emin, emax] = VertexSoA{}.CalcBounds();
+    EXPECT_EQ(emin.X, 0.f);
+    EXPECT_EQ(emax.Z, 0.f);
+}
@@ -0,0 +1,4 @@
+#include "rely.h"
+
+
+GTEST_DEFAULT_MAIN
\ No newline at end of file
@@ -0,0 +1,4 @@
+#pragma once
+#include "3rdParty/Projects/googletest/gtest-enhanced.h"
+// model headers are internal ones, which rely on RenderCore's pch
+#include "RenderCore/RenderCorePch.h"
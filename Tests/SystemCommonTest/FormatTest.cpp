@@ -1340,6 +1340,143 @@ TEST(Format, FormatUTF)
     }
 }
 
+TEST(Format, Sink)
+{
+    Formatter<char> fmter{};
+    const auto ref = fmt::format("{},{:>6},{:#X}", "hello", 42, 255);
+    {
+        const auto size = fmter.FormattedSize(FmtString("{},{:>6},{:#X}"sv), "hello", 42, 255);
+        EXPECT_EQ(size, ref.size());
+    }
+    {
+        char buf[64] = { 0 };
+        SpanSink<char> sink(buf);
+        fmter.FormatToStatic(sink, FmtString("{},{:>6},{:#X}"sv), "hello", 42, 255);
+        EXPECT_FALSE(sink.IsTruncated());
+        EXPECT_EQ(sink.View(), ref);
+    }
+    {
+        char buf[8] = { 0 };
+        SpanSink<char> sink(buf);
+        fmter.FormatToStatic(sink, FmtString("{},{:>6},{:#X}"sv), "hello", 42, 255);
+        EXPECT_TRUE(sink.IsTruncated());
+        EXPECT_EQ(sink.Required, ref.size());
+        EXPECT_EQ(sink.View(), std::string_view(ref).substr(0, 8));
+    }
+    {
+        StackSink<char, 16> sink;
+        fmter.FormatToStatic(sink, FmtString("{}"sv), "hello");
+        EXPECT_FALSE(sink.IsSpilled());
+        EXPECT_EQ(sink.View(), "hello"sv);
+        fmter.FormatToStatic(sink, FmtString(",{:>6},{:#X}"sv), 42, 255);
+        EXPECT_TRUE(sink.IsSpilled());
+        EXPECT_EQ(sink.View(), ref);
+    }
+    {
+        std::vector<char> out;
+        auto sink = MakeIteratorSink<char>(std::back_inserter(out));
+        fmter.FormatToDynamic(sink, "{},{:>6},{:#X}"sv, "hello", 42, 255);
+        EXPECT_EQ(std::string_view(out.data(), out.size()), ref);
+    }
+    {
+        auto cachedFmter = FormatSpecCacher::CreateFrom(FmtString(u"{:我^4d},{}"), (uint16_t)u'a', false);
+        StackSink<char16_t, 32> sink;
+        cachedFmter.Format(sink, (uint16_t)u'a', false);
+        EXPECT_EQ(sink.View(), u"我97我,false"sv);
+    }
+}
+
+TEST(Format, SinkLong)
+{
+    Formatter<char> fmter{};
+    // around and beyond the local batching buffer
+    for (const size_t len : { 200u, 256u, 1000u, 70000u })
+    {
+        const std::string str(len, 'x');
+        const auto ref = fmt::format("[{}],{:>6},{:_^9}", str, 42, "ab");
+        EXPECT_EQ(fmter.FormattedSize(FmtString("[{}],{:>6},{:_^9}"sv), str, 42, "ab"), ref.size());
+        {
+            StackSink<char, 64> sink;
+            fmter.FormatToStatic(sink, FmtString("[{}],{:>6},{:_^9}"sv), str, 42, "ab");
+            EXPECT_EQ(sink.View(), ref);
+        }
+        {
+            std::vector<char> buf(ref.size() / 2);
+            SpanSink<char> sink(buf);
+            fmter.FormatToDynamic(sink, "[{}],{:>6},{:_^9}"sv, str, 42, "ab");
+            EXPECT_TRUE(sink.IsTruncated());
+            EXPECT_EQ(sink.Required, ref.size());
+            EXPECT_EQ(sink.View(), std::string_view(ref).substr(0, buf.size()));
+        }
+    }
+    {
+        std::string ref;
+        StackSink<char, 16> sink;
+        for (uint32_t i = 0; i < 500; ++i)
+        {
+            fmt::format_to(std::back_inserter(ref), "{:#x},", i);
+            fmter.FormatToStatic(sink, FmtString("{:#x},"sv), i);
+        }
+        EXPECT_EQ(sink.View(), ref);
+    }
+    {
+        StackSink<char, 4> sink;
+        fmter.FormatToStatic(sink, FmtString("{},{}"sv), TypeC{}, TypeD{});
+        EXPECT_EQ(sink.View(), "5,7.5"sv);
+    }
+    {
+        const auto t = std::chrono::time_point_cast<std::chrono::microseconds>(std::chrono::system_clock::now());
+        const auto ref = fmt::format(std::locale::classic(), "{:%Y-%m-%d %H:%M:%S}"sv, t);
+        StackSink<char, 8> sink;
+        fmter.FormatToStatic(sink, FmtString("{:T%Y-%m-%d %H:%M:%S}"sv), t);
+        EXPECT_EQ(sink.View(), ref);
+    }
+    {
+        StackSink<char16_t, 32> sink;
+        SinkBuffer<char16_t> buffer(sink);
+        BasicExecutor<char16_t, SinkBuffer<char16_t>> executor;
+        executor.FormatToStatic(buffer, FmtString(u"{},{:#x},{}"sv), TypeC{}, 255, u"end"sv);
+        EXPECT_EQ(buffer.size(), 10u);
+        buffer.Flush();
+        EXPECT_EQ(sink.View(), u"5,0xff,end"sv);
+    }
+}
+
+TEST(Format, FormatStringCache)
+{
+    using Cache = FormatStringCache<char32_t>;
+    Cache::Clear();
+    Formatter<char32_t> fmter{};
+    const std::u32string syntax = U"{},{:>4},{:#x}";
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        const auto ret = fmter.FormatDynamic(syntax, U"a"sv, i, 255u);
+        EXPECT_EQ(ret, U"a,   " + std::u32string(1, U'0' + i) + U",0xff");
+    }
+    {
+        const auto stats = Cache::GetStats();
+        EXPECT_EQ(stats.Misses, 1u);
+        EXPECT_EQ(stats.Hits, 2u);
+        EXPECT_EQ(stats.Count, 1u);
+    }
+    {
+        const std::u32string syntax2 = syntax; // different pointer, same content
+        const auto ret = fmter.FormatDynamic(syntax2, U"b"sv, 1, 16);
+        EXPECT_EQ(ret, U"b,   1,0x10");
+        EXPECT_EQ(Cache::GetStats().Hits, 3u);
+    }
+    EXPECT_THROW(fmter.FormatDynamic(syntax, U"a"sv), ArgMismatchException);
+    Cache::SetCapacity(2);
+    for (const auto str : { U"1{}"sv, U"2{}"sv, U"3{}"sv, U"4{}"sv })
+    {
+        const auto ret = fmter.FormatDynamic(str, 0);
+        EXPECT_EQ(ret.substr(1), U"0"sv);
+    }
+    EXPECT_LE(Cache::GetStats().Count, 2u);
+    Cache::SetCapacity(Cache::DefaultCapacity);
+    Cache::Clear();
+}
+
 TEST(Format, MultiFormat)
 {
     Formatter<char> fmter{};
@@ -0,0 +1,164 @@
+#include "rely.h"
+#include "common/math/MatBatch.hpp"
+#include <random>
+#include <vector>
+
+namespace msimd = common::math::simd;
+namespace batch = common::math::simd::batch;
+
+
+static std::vector<msimd::Vec4> RandomVecs(const size_t count, const float range = 10.f)
+{
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> dist(-range, range);
+    std::vector<msimd::Vec4> ret;
+    ret.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        ret.emplace_back(dist(gen), dist(gen), dist(gen), dist(gen));
+    return ret;
+}
+static std::vector<msimd::Mat4> RandomMats(const size_t count)
+{
+    const auto vecs = RandomVecs(count * 4, 2.f);
+    std::vector<msimd::Mat4> ret;
+    ret.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        ret.emplace_back(vecs[i * 4 + 0], vecs[i * 4 + 1], vecs[i * 4 + 2], vecs[i * 4 + 3]);
+    return ret;
+}
+static std::vector<msimd::Vec4> RandomQuats(const size_t count)
+{
+    auto ret = RandomVecs(count, 1.f);
+    for (auto& q : ret)
+        q = q / std::sqrt(Dot(q, q));
+    return ret;
+}
+
+#define EXPECT_VEC_NEAR(a, b, n) for (uint8_t c_ = 0; c_ < n; ++c_) EXPECT_NEAR(a[c_], b[c_], 1e-3f)
+#define EXPECT_MAT_NEAR(a, b, n) for (uint8_t r_ = 0; r_ < n; ++r_) { EXPECT_VEC_NEAR(a[r_], b[r_], n); }
+
+
+TEST(MathBatch, Transform)
+{
+    const auto mat = RandomMats(1)[0];
+    for (const size_t count : { 0, 3, 4, 8, 15, 37 }) // cover both SIMD width and remainder
+    {
+        const auto in = RandomVecs(count);
+        std::vector<msimd::Vec4> out(count);
+        batch::Transform(mat, in, out);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto ref = mat * in[i];
+            EXPECT_VEC_NEAR(out[i], ref, 4);
+        }
+        auto inplace = in;
+        batch::Transform(mat, inplace, inplace);
+        for (size_t i = 0; i < count; ++i)
+            EXPECT_VEC_NEAR(inplace[i], out[i], 4);
+    }
+}
+
+TEST(MathBatch, TransformPositions)
+{
+    const auto mat = RandomMats(1)[0];
+    constexpr size_t Count = 29;
+    const auto pos = RandomVecs(Count);
+    std::vector<float> cols[3];
+    for (uint8_t c = 0; c < 3; ++c)
+        for (const auto& p : pos)
+            cols[c].push_back(p[c]);
+    const float* const src[3] = { cols[0].data(), cols[1].data(), cols[2].data() };
+    float* const dst[3] = { cols[0].data(), cols[1].data(), cols[2].data() };
+    batch::TransformPositions(mat, src, dst, Count);
+    for (size_t i = 0; i < Count; ++i)
+    {
+        const auto ref = mat * msimd::Vec4(pos[i].X, pos[i].Y, pos[i].Z, 1.f);
+        for (uint8_t c = 0; c < 3; ++c)
+            EXPECT_NEAR(cols[c][i], ref[c], 1e-3f);
+    }
+}
+
+TEST(MathBatch, Multiply)
+{
+    for (const size_t count : { 0, 3, 4, 8, 13, 29 }) // cover both SIMD width and remainder
+    {
+        const auto left = RandomMats(count), right = RandomMats(count + 1);
+        const auto rights = common::span<const msimd::Mat4>(right).subspan(1);
+        std::vector<msimd::Mat4> out(count);
+        batch::Multiply(left, rights, out);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto ref = left[i] * right[i + 1];
+            EXPECT_MAT_NEAR(out[i], ref, 4);
+        }
+        auto inplace = left;
+        batch::Multiply(inplace, rights, inplace);
+        for (size_t i = 0; i < count; ++i)
+            EXPECT_MAT_NEAR(inplace[i], out[i], 4);
+    }
+    constexpr size_t Count = 13;
+    const auto left = RandomMats(Count), right = RandomMats(Count + 1);
+    std::vector<msimd::Mat4> out(Count);
+    batch::Multiply(right[0], left, out);
+    for (size_t i = 0; i < Count; ++i)
+    {
+        const auto ref = right[0] * left[i];
+        EXPECT_MAT_NEAR(out[i], ref, 4);
+    }
+}
+
+TEST(MathBatch, QuatToMat)
+{
+    {
+        // 90 degree around z
+        const auto mat = common::math::RotateMatFromQuat<msimd::Mat3>(msimd::Vec4(0.f, 0.f, std::sqrt(0.5f), std::sqrt(0.5f)));
+        const msimd::Mat3 ref{ {0.f, -1.f, 0.f}, {1.f, 0.f, 0.f}, {0.f, 0.f, 1.f} };
+        EXPECT_MAT_NEAR(mat, ref, 3);
+    }
+    constexpr size_t Count = 11;
+    const auto quats = RandomQuats(Count);
+    std::vector<msimd::Mat3> out3(Count);
+    std::vector<msimd::Mat4> out4(Count);
+    batch::QuatToMat<msimd::Mat3>(quats, out3);
+    batch::QuatToMat<msimd::Mat4>(quats, out4);
+    for (size_t i = 0; i < Count; ++i)
+    {
+        const auto ref = common::math::RotateMatFromQuat<msimd::Mat3>(quats[i]);
+        EXPECT_MAT_NEAR(out3[i], ref, 3);
+        const auto ref4 = common::math::ToHomoCoord<msimd::Mat4>(ref);
+        EXPECT_MAT_NEAR(out4[i], ref4, 4);
+    }
+}
+
+
+#if CM_DEBUG == 0
+TEST(MathBatch, Perf)
+{
+    constexpr size_t Count = 4096;
+    const auto mats = RandomMats(Count);
+    const auto vecs = RandomVecs(Count);
+    const auto quats = RandomQuats(Count);
+    const auto& mat = mats[0];
+    std::vector<msimd::Vec4> outVec(Count);
+    const std::vector<msimd::Mat4> rmats(mats.rbegin(), mats.rend());
+    std::vector<msimd::Mat4> outMat(Count);
+    std::vector<msimd::Mat3> outMat3(Count);
+
+    PerfTester("MathTransform", Count).ManaulTest(
+        "single", [&]() { for (size_t i = 0; i < Count; ++i) outVec[i] = mat * vecs[i]; },
+        "batch ", [&]() { batch::Transform(mat, vecs, outVec); }
+    );
+    PerfTester("MathMultiply", Count).ManaulTest(
+        "single", [&]() { for (size_t i = 0; i < Count; ++i) outMat[i] = mat * mats[i]; },
+        "batch ", [&]() { batch::Multiply(mat, mats, outMat); }
+    );
+    PerfTester("MathMultiplyPairs", Count).ManaulTest(
+        "single", [&]() { for (size_t i = 0; i < Count; ++i) outMat[i] = mats[i] * rmats[i]; },
+        "batch ", [&]() { batch::Multiply(mats, rmats, outMat); }
+    );
+    PerfTester("MathQuatToMat", Count).ManaulTest(
+        "single", [&]() { for (size_t i = 0; i < Count; ++i) outMat3[i] = common::math::RotateMatFromQuat<msimd::Mat3>(quats[i]); },
+        "batch ", [&]() { batch::QuatToMat<msimd::Mat3>(quats, outMat3); }
+    );
+}
+#endif
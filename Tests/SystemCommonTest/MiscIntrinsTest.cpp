@@ -438,6 +438,20 @@ INTRIN_TEST(MiscIntrins, Hex2Str)
 }
 
 
+TEST_F(MiscIntrins, Calibrate)
+{
+    const auto items = common::MiscIntrins::Calibrate();
+    const common::MiscIntrins host(items);
+    EXPECT_TRUE(host.IsComplete());
+    const auto profile = common::MiscIntrins::SerializeProfile(items);
+    const auto loaded = common::MiscIntrins::LoadProfile(profile);
+    EXPECT_EQ(loaded, items);
+    // unknown method falls back to the default one
+    const auto fallback = common::MiscIntrins::LoadProfile("# comment\nPopCounts=NotExist\n");
+    EXPECT_TRUE(common::MiscIntrins(fallback).IsComplete());
+}
+
+
 INTRIN_TESTSUITE(DigestFuncs, common::DigestFuncs, common::DigestFunc);
 
 
@@ -472,6 +486,79 @@ INTRIN_TEST(DigestFuncs, Sha256)
     }
 }
 
+INTRIN_TEST(DigestFuncs, Crc32c)
+{
+    const auto CRC32C = [&](std::string_view dat, uint32_t crc = 0)
+    {
+        return Intrin->CRC32C(common::to_span(dat), crc);
+    };
+    EXPECT_EQ(CRC32C(""), 0x0u);
+    EXPECT_EQ(CRC32C("123456789"), 0xe3069283u);
+    {
+        std::string txt(32, '\0');
+        EXPECT_EQ(CRC32C(txt), 0x8a9136aau);
+        txt.assign(32, '\xff');
+        EXPECT_EQ(CRC32C(txt), 0x62a8ab43u);
+    }
+    {
+        // chained
+        std::string_view txt = "123456789";
+        for (size_t i = 0; i <= txt.size(); ++i)
+            EXPECT_EQ(CRC32C(txt.substr(i), CRC32C(txt.substr(0, i))), 0xe3069283u) << "split at " << i;
+    }
+}
+
+INTRIN_TEST(DigestFuncs, Xxh3)
+{
+    const auto XXH3 = [&](std::string_view dat)
+    {
+        return Intrin->XXH3_64(common::to_span(dat));
+    };
+    // 0
+    EXPECT_EQ(XXH3(""), 0x2d06800538d394c2u);
+    // 1-3
+    EXPECT_EQ(XXH3("a"), 0xe6c632b61e964e1fu);
+    EXPECT_EQ(XXH3("abc"), 0x78af5f94892f3950u);
+    // 9-16
+    EXPECT_EQ(XXH3("message digest"), 0x160d8e9329be94f9u);
+    // 17-128
+    EXPECT_EQ(XXH3("abcdefghijklmnopqrstuvwxyz"), 0x810f9ca067fbb90cu);
+    EXPECT_EQ(XXH3("0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ+-"), 0x679cc073379e376fu);
+    // 129-240
+    EXPECT_EQ(XXH3("abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu"
+        "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu"), 0x9161bcebf725ec54u);
+    // long
+    std::string txt(1000000, 'a');
+    EXPECT_EQ(XXH3(txt), 0xb1fd6fae5285c4ebu);
+}
+
+INTRIN_TEST(DigestFuncs, Xxh128)
+{
+    using U128 = std::array<uint64_t, 2>;
+    const auto XXH128 = [&](std::string_view dat)
+    {
+        return Intrin->XXH3_128(common::to_span(dat));
+    };
+    // 0
+    EXPECT_EQ(XXH128(""), (U128{ 0x6001c324468d497fu, 0x99aa06d3014798d8u }));
+    // 1-3
+    EXPECT_EQ(XXH128("a"), (U128{ 0xe6c632b61e964e1fu, 0xa96faf705af16834u }));
+    EXPECT_EQ(XXH128("abc"), (U128{ 0x78af5f94892f3950u, 0x06b05ab6733a6185u }));
+    // 4-8
+    EXPECT_EQ(XXH128("abcd1234"), (U128{ 0x32500856f68ba7c2u, 0xea07bff96e7b492eu }));
+    // 9-16
+    EXPECT_EQ(XXH128("message digest"), (U128{ 0x0abfabecb8e3a424u, 0x34ab715d95e3b649u }));
+    // 17-128
+    EXPECT_EQ(XXH128("abcdefghijklmnopqrstuvwxyz"), (U128{ 0xebe162220154e1e6u, 0xdb7ca44e84843d67u }));
+    EXPECT_EQ(XXH128("0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ+-"), (U128{ 0x3c67a784ba4a319eu, 0x5d860f33cc148d07u }));
+    // 129-240
+    EXPECT_EQ(XXH128("abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu"
+        "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu"), (U128{ 0xca1b39e8b44daf5bu, 0x492beb50b0f888fcu }));
+    // long, low64 is the same as 64bit version
+    std::string txt(1000000, 'a');
+    EXPECT_EQ(XXH128(txt), (U128{ 0xb1fd6fae5285c4ebu, 0xa545df8e384a9579u }));
+}
+
 
 #if CM_DEBUG == 0
 
@@ -664,4 +751,34 @@ TEST(IntrinPerf, Sha256)
     });
 }
 
+TEST(IntrinPerf, Crc32c)
+{
+    std::vector<std::byte> inputs(1024 * 1024);
+    PerfTester tester("Crc32c", inputs.size());
+    tester.FastPathTest<common::DigestFuncs>([&](const common::DigestFuncs& host)
+    {
+        [[maybe_unused]] const auto ret = host.CRC32C(common::to_span(inputs));
+    });
+}
+
+TEST(IntrinPerf, Xxh3)
+{
+    std::vector<std::byte> inputs(1024 * 1024);
+    PerfTester tester("Xxh3", inputs.size());
+    tester.FastPathTest<common::DigestFuncs>([&](const common::DigestFuncs& host)
+    {
+        [[maybe_unused]] const auto ret = host.XXH3_64(common::to_span(inputs));
+    });
+}
+
+TEST(IntrinPerf, Xxh128)
+{
+    std::vector<std::byte> inputs(1024 * 1024);
+    PerfTester tester("Xxh128", inputs.size());
+    tester.FastPathTest<common::DigestFuncs>([&](const common::DigestFuncs& host)
+    {
+        [[maybe_unused]] const auto ret = host.XXH3_128(common::to_span(inputs));
+    });
+}
+
 #endif
\ No newline at end of file
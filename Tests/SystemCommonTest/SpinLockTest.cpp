@@ -0,0 +1,116 @@
+#include "rely.h"
+#include "SystemCommon/SpinLock.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+
+template<typename Lock, typename F>
+static void ContendedRun(Lock& lock, F&& func, const uint32_t threads, const uint32_t loops)
+{
+    std::vector<std::thread> workers;
+    for (uint32_t i = 0; i < threads; ++i)
+        workers.emplace_back([&]()
+            {
+                for (uint32_t j = 0; j < loops; ++j)
+                    func(lock);
+            });
+    for (auto& worker : workers)
+        worker.join();
+}
+
+
+TEST(SpinLock, SpinLocker)
+{
+    common::spinlock::SpinLocker lock;
+    uint64_t counter = 0;
+    ContendedRun(lock, [&](auto& l) { const auto scope = l.LockScope(); counter++; }, 4, 20000);
+    EXPECT_EQ(counter, 80000u);
+}
+
+TEST(SpinLock, WRSpinLock)
+{
+    common::spinlock::WRSpinLock lock;
+    uint64_t counter = 0;
+    std::atomic<uint64_t> reads{ 0 };
+    ContendedRun(lock, [&](auto& l)
+        {
+            {
+                const auto scope = l.WriteScope();
+                counter++;
+            }
+            {
+                const auto scope = l.ReadScope();
+                reads += counter > 0 ? 1 : 0;
+            }
+        }, 4, 20000);
+    EXPECT_EQ(counter, 80000u);
+    EXPECT_EQ(reads.load(), 80000u);
+}
+
+TEST(SpinLock, RWSpinLock)
+{
+    common::spinlock::RWSpinLock lock;
+    uint64_t counter = 0;
+    ContendedRun(lock, [&](auto& l)
+        {
+            l.LockWrite();
+            counter++;
+            l.DowngradeToRead();
+            EXPECT_GT(counter, 0u);
+            l.UnlockRead();
+        }, 4, 20000);
+    EXPECT_EQ(counter, 80000u);
+}
+
+TEST(SpinLock, PreferSpinLock)
+{
+    // weak and strong are mutually exclusive, but each side can be shared
+    common::spinlock::PreferSpinLock lock;
+    std::atomic<uint32_t> weaks{ 0 }, strongs{ 0 };
+    std::atomic<uint64_t> conflicts{ 0 };
+    std::atomic<uint32_t> threadIdx{ 0 };
+    ContendedRun(lock, [&](auto& l)
+        {
+            thread_local const bool isStrong = (threadIdx++ & 1) == 0;
+            if (isStrong)
+            {
+                const auto scope = l.StrongScope();
+                strongs++;
+                conflicts += weaks.load() > 0 ? 1 : 0;
+                strongs--;
+            }
+            else
+            {
+                const auto scope = l.WeakScope();
+                weaks++;
+                conflicts += strongs.load() > 0 ? 1 : 0;
+                weaks--;
+            }
+        }, 4, 20000);
+    EXPECT_EQ(conflicts.load(), 0u);
+}
+
+TEST(SpinLock, Park)
+{
+    common::spinlock::SpinLockStats stats;
+    common::spinlock::WRSpinLock lock;
+    lock.SetStats(&stats);
+    lock.LockWrite();
+    EXPECT_EQ(stats.Contended.load(), 0u);
+    std::atomic<bool> acquired{ false };
+    std::thread waiter([&]()
+        {
+            const auto scope = lock.ReadScope();
+            acquired = true;
+        });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_FALSE(acquired.load());
+    lock.UnlockWrite();
+    waiter.join();
+    EXPECT_TRUE(acquired.load());
+    EXPECT_EQ(stats.Contended.load(), 1u);
+#if SYSCOMMON_SPINLOCK_PARK
+    EXPECT_EQ(stats.Parked.load(), 1u);
+#endif
+}
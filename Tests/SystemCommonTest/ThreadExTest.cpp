@@ -0,0 +1,214 @@
+#include "rely.h"
+#include "SystemCommon/ThreadEx.h"
+#include <atomic>
+#include <future>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using common::TopologyInfo;
+using common::ThreadAffinity;
+using common::CPUDomain;
+using Levels = CPUDomain::Levels;
+
+
+static constexpr Levels AllLevels[] = { Levels::Core, Levels::L2, Levels::L3, Levels::NUMA };
+
+static std::vector<uint32_t> ToList(const ThreadAffinity& affinity)
+{
+    std::vector<uint32_t> ret;
+    const auto total = TopologyInfo::Get().GetTotalProcessorCount();
+    for (uint32_t i = 0; i < total; ++i)
+    {
+        if (affinity.Get(i))
+            ret.push_back(i);
+    }
+    return ret;
+}
+
+static ThreadAffinity RandomAffinity(std::mt19937& gen)
+{
+    ThreadAffinity affinity;
+    const auto total = TopologyInfo::Get().GetTotalProcessorCount();
+    for (uint32_t i = 0; i < total; ++i)
+        affinity.Set(i, gen() % 2 == 0);
+    return affinity;
+}
+
+static ThreadAffinity FullAffinity()
+{
+    ThreadAffinity affinity;
+    affinity.SetAll(true);
+    return affinity;
+}
+
+static const CPUDomain* LocateLinear(const uint32_t idx, const Levels level)
+{
+    const auto [gid, i] = TopologyInfo::Get().TranslateLinearIdx(idx);
+    return CPUDomain::Locate(gid, i, level);
+}
+
+// processors that are covered by some domain of the level
+static ThreadAffinity CoveredBy(const Levels level)
+{
+    ThreadAffinity ret;
+    for (const auto& domain : CPUDomain::GetDomains(level))
+        ret |= domain.Affinity;
+    return ret;
+}
+
+
+TEST(ThreadEx, AffinityOps)
+{
+    const auto total = TopologyInfo::Get().GetTotalProcessorCount();
+    ASSERT_GT(total, 0u);
+    EXPECT_EQ(FullAffinity().GetCount(), total);
+    EXPECT_EQ(ThreadAffinity().GetCount(), 0u);
+    std::mt19937 gen(42);
+    for (uint32_t round = 0; round < 16; ++round)
+    {
+        const auto a = RandomAffinity(gen), b = RandomAffinity(gen);
+        auto andRet = a, orRet = a;
+        andRet &= b;
+        orRet |= b;
+        for (uint32_t i = 0; i < total; ++i)
+        {
+            EXPECT_EQ(andRet.Get(i), a.Get(i) && b.Get(i)) << "cpu " << i;
+            EXPECT_EQ(orRet.Get(i), a.Get(i) || b.Get(i)) << "cpu " << i;
+        }
+        EXPECT_EQ(andRet.GetCount() + orRet.GetCount(), a.GetCount() + b.GetCount());
+        // (a | b) & b == b, and & empty clears all
+        EXPECT_EQ(ToList(orRet &= b), ToList(b));
+        EXPECT_EQ((andRet &= ThreadAffinity()).GetCount(), 0u);
+    }
+}
+
+TEST(ThreadEx, DomainLocate)
+{
+    const auto total = TopologyInfo::Get().GetTotalProcessorCount();
+    for (const auto level : AllLevels)
+    {
+        const auto domains = CPUDomain::GetDomains(level);
+        for (const auto& domain : domains)
+        {
+            EXPECT_EQ(domain.Level, level);
+            EXPECT_GT(domain.Affinity.GetCount(), 0u);
+        }
+        // each logical processor belongs to at most one domain of the same level
+        for (size_t i = 0; i < domains.size(); ++i)
+        {
+            for (size_t j = i + 1; j < domains.size(); ++j)
+            {
+                auto overlap = domains[i].Affinity;
+                overlap &= domains[j].Affinity;
+                EXPECT_EQ(overlap.GetCount(), 0u) << "level " << static_cast<int>(level) << " domain " << i << " & " << j;
+            }
+        }
+        for (uint32_t i = 0; i < total; ++i)
+        {
+            const auto domain = LocateLinear(i, level);
+            if (!domain)
+                continue;
+            EXPECT_EQ(domain->Level, level);
+            EXPECT_TRUE(domain->Affinity.Get(i)) << "level " << static_cast<int>(level) << " cpu " << i;
+            EXPECT_GE(domain, domains.data());
+            EXPECT_LT(domain, domains.data() + domains.size());
+        }
+    }
+}
+
+TEST(ThreadEx, DomainSplit)
+{
+    std::mt19937 gen(7);
+    std::vector<ThreadAffinity> inputs;
+    inputs.push_back(FullAffinity());
+    inputs.push_back(ThreadAffinity());
+    for (uint32_t round = 0; round < 8; ++round)
+        inputs.push_back(RandomAffinity(gen));
+    for (const auto level : AllLevels)
+    {
+        const auto covered = CoveredBy(level);
+        for (const auto& input : inputs)
+        {
+            const auto parts = CPUDomain::Split(input, level);
+            ThreadAffinity merged;
+            uint32_t count = 0;
+            for (const auto& part : parts)
+            {
+                EXPECT_GT(part.GetCount(), 0u);
+                // each part stays inside a single domain
+                const auto first = ToList(part).front();
+                const auto domain = LocateLinear(first, level);
+                ASSERT_NE(domain, nullptr);
+                auto inside = part;
+                inside &= domain->Affinity;
+                EXPECT_EQ(inside.GetCount(), part.GetCount());
+                count += part.GetCount();
+                merged |= part;
+            }
+            // parts do not overlap, and their union is the input (limited to processors known by the level)
+            EXPECT_EQ(count, merged.GetCount());
+            auto expected = input;
+            expected &= covered;
+            EXPECT_EQ(ToList(merged), ToList(expected)) << "level " << static_cast<int>(level);
+        }
+    }
+    EXPECT_EQ(CPUDomain::Split(ThreadAffinity(), Levels::NUMA).size(), 0u);
+    const auto numa = CPUDomain::Split(FullAffinity(), Levels::NUMA);
+    EXPECT_EQ(numa.size(), CPUDomain::GetDomains(Levels::NUMA).size());
+}
+
+TEST(ThreadEx, ExcludeSMTSiblings)
+{
+    std::mt19937 gen(13);
+    std::vector<ThreadAffinity> inputs;
+    inputs.push_back(FullAffinity());
+    for (uint32_t round = 0; round < 8; ++round)
+        inputs.push_back(RandomAffinity(gen));
+    const auto cores = CPUDomain::GetDomains(Levels::Core);
+    for (const auto& input : inputs)
+    {
+        const auto ret = CPUDomain::ExcludeSMTSiblings(input);
+        // result is a subset of the input
+        auto inside = ret;
+        inside &= input;
+        EXPECT_EQ(inside.GetCount(), ret.GetCount());
+        // at most one logical processor per core, and each core used by the input keeps exactly one
+        for (const auto& core : cores)
+        {
+            auto kept = ret, used = input;
+            kept &= core.Affinity;
+            used &= core.Affinity;
+            EXPECT_EQ(kept.GetCount(), used.GetCount() > 0 ? 1u : 0u) << "core " << core.Id;
+        }
+    }
+    if (!cores.empty())
+        EXPECT_EQ(CPUDomain::ExcludeSMTSiblings(FullAffinity()).GetCount(), cores.size());
+}
+
+TEST(ThreadEx, WorkerPool)
+{
+    using common::WorkerPool;
+    EXPECT_GT(WorkerPool::GetMaxThreadCount(), 0u);
+    for (const uint32_t count : { 0u, 1u, 3u, 17u, 100u })
+    {
+        std::vector<std::atomic<uint32_t>> hits(count);
+        WorkerPool::ParallelRun(count, [&](uint32_t i) { hits[i]++; });
+        for (uint32_t i = 0; i < count; ++i)
+            EXPECT_EQ(hits[i].load(), 1u) << "count " << count << " index " << i;
+    }
+    // nested calls still finish, since the caller always takes part
+    std::atomic<uint32_t> total = 0;
+    WorkerPool::ParallelRun(8, [&](uint32_t)
+        {
+            WorkerPool::ParallelRun(8, [&](uint32_t) { total++; });
+        });
+    EXPECT_EQ(total.load(), 64u);
+    EXPECT_THROW(WorkerPool::ParallelRun(10, [](uint32_t i) { if (i == 5) throw std::runtime_error("test"); }), std::runtime_error);
+
+    std::promise<uint64_t> pms;
+    WorkerPool::Post([&]() { pms.set_value(common::ThreadObject::GetCurrentThreadId()); });
+    auto ret = pms.get_future();
+    ASSERT_EQ(ret.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_NE(ret.get(), common::ThreadObject::GetCurrentThreadId());
+}
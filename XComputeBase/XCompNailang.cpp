@@ -1,10 +1,12 @@
 #include "XCompNailang.h"
 #include "SystemCommon/StackTrace.h"
 #include "SystemCommon/StringConvert.h"
+#include "SystemCommon/ThreadEx.h"
 #include "common/StrParsePack.hpp"
 #include "common/StaticLookup.hpp"
 #include <shared_mutex>
 #include <mutex>
+#include <atomic>
 
 namespace xcomp
 {
@@ -94,24 +96,9 @@ void NamedTextHolder::ForceAdd(std::vector<NamedText>& container, std::u32string
         if (dep == id) // early check for self-dependency
             COMMON_THROW(common::BaseException, FMTSTR2(u"self dependency at [{}] for [{}]"sv, &dep - depends.data(), id));
 
-        bool match = false;
-        for (size_t i = 0; i < container.size(); ++i)
-        {
-            const auto& item = container[i];
-            if (GetID(item) == dep)
-            {
-                const auto idx = gsl::narrow_cast<uint32_t>(i);
-                Dependencies.emplace_back(item.IDStr, idx);
-                match = true;
-                break;
-            }
-        }
-
-        if (!match)
-        {
-            const auto str = Names.AllocateString(dep);
-            Dependencies.emplace_back(str, UINT32_MAX);
-        }
+        const auto str = Names.AllocateString(dep);
+        const auto idx = CheckExists(container, str);
+        Dependencies.emplace_back(str, idx.value_or(UINT32_MAX));
     }
     const auto idstr = Names.AllocateString(id);
     container.push_back({ content.ExtractStr(), idstr, offset, depends.size() });
@@ -351,6 +338,12 @@ InstanceArgCustomVar InstanceArgCustomVar::Handler;
 XCNLExtension::XCNLExtension(XCNLContext& context) : Context(context)
 { }
 XCNLExtension::~XCNLExtension() { }
+std::unique_ptr<XCNLExtension> XCNLExtension::CreateInstanceWorker(XCNLContext&) const
+{
+    return {};
+}
+void XCNLExtension::MergeInstance(XCNLExtension&, const OutputBlock&)
+{ }
 
 
 struct ExtHolder
@@ -408,7 +401,7 @@ XCNLExtension* XCNLContext::FindExt(std::function<bool(const XCNLExtension*)> fu
 size_t XCNLContext::FindStruct(std::u32string_view name) const
 {
     size_t i = 0;
-    for (const auto& target : CustomStructs)
+    for (const auto& target : GetCustomStructs())
     {
         if (target->GetName() == name)
             return i;
@@ -417,6 +410,31 @@ size_t XCNLContext::FindStruct(std::u32string_view name) const
     return SIZE_MAX;
 }
 
+void XCNLContext::ImportSnapshot(const XCNLContext& source)
+{
+    Expects(&source != this && !source.ConfigSource);
+    CopyFrom(source);
+    ConfigSource = &source;
+    ImportPatchedBlocks(source, 0, source.PatchedBlocks.size());
+}
+
+void XCNLContext::ImportPatchedBlocks(const XCNLContext& source, size_t begin, size_t end)
+{
+    Expects(begin <= end && end <= source.PatchedBlocks.size());
+    std::vector<std::u32string_view> depends;
+    for (size_t i = begin; i < end; ++i)
+    {
+        const auto& item = source.PatchedBlocks[i];
+        const auto id = source.GetID(item);
+        if (CheckExists(PatchedBlocks, id))
+            continue;
+        depends.clear();
+        for (uint32_t j = 0; j < item.DependCount(); ++j)
+            depends.push_back(source.GetDepend(item, j));
+        ForceAdd(PatchedBlocks, id, std::u32string(item.Content), depends);
+    }
+}
+
 void XCNLContext::Write(std::u32string& output, const NamedText& item) const
 {
     APPEND_FMT(output, U"/* Patched Block [{}] */\r\n"sv, GetID(item));
@@ -426,42 +444,70 @@ void XCNLContext::Write(std::u32string& output, const NamedText& item) const
 
 Arg XCNLExecutor::EvaluateFunc(FuncEvalPack& func)
 {
-    if (func.NamePartCount() >= 2 && func.NamePart(0) == U"xcomp"sv)
+    // only xcomp builtins are cached here, kinds from base executor are not trusted, since extensions come first
+    bool checkXComp = true;
+    switch (GetDispatchCache(func).first)
+    {
+    case XCompVec:
+        return GetRuntime().CreateGVec(func.NamePart(2), func);
+    case XCompArg:
+        return InstanceArgCustomVar::Create(GetRuntime().ParseInstanceArg(func.NamePart(2), func));
+    case XCompPrintStruct:
+        return PrintStruct(func);
+    case XCompCommonFunc:
+        if (auto ret = GetRuntime().CommonFunc(func.NamePart(1), func); ret.has_value())
+            return std::move(ret.value());
+        checkXComp = false;
+        break;
+    default:
+        break;
+    }
+    if (checkXComp && func.NamePartCount() >= 2 && func.NamePart(0) == U"xcomp"sv)
     {
         if (func.NamePart(1) == U"vec"sv)
         {
+            SetDispatchCache(func, XCompVec);
             return GetRuntime().CreateGVec(func.NamePart(2), func);
         }
         else if (func.NamePart(1) == U"Arg"sv)
         {
+            SetDispatchCache(func, XCompArg);
             return InstanceArgCustomVar::Create(GetRuntime().ParseInstanceArg(func.NamePart(2), func));
         }
         else if (func.NamePart(1) == U"PrintStruct"sv)
         {
-            ThrowByParamTypes<1>(func, { Arg::Type::String });
-            const auto& ctx = GetContext();
-            const auto name = func.Params[0].GetStr().value();
-            const auto idx = ctx.FindStruct(name);
-            if (idx == SIZE_MAX)
-                NLRT_THROW_EX(FMTSTR2(u"Cannot find struct named [{}]"sv, name), func);
-            GetRuntime().PrintStruct(*ctx.CustomStructs[idx]);
-            return {};
+            SetDispatchCache(func, XCompPrintStruct);
+            return PrintStruct(func);
         }
         else if (func.NamePartCount() == 2)
         {
             auto ret = GetRuntime().CommonFunc(func.NamePart(1), func);
             if (ret.has_value())
+            {
+                SetDispatchCache(func, XCompCommonFunc);
                 return std::move(ret.value());
+            }
         }
     }
+    // extensions may decide by args or state, so they are always asked
     for (const auto& ext : GetExtensions())
     {
-        auto ret = ext->ConfigFunc(*this, func);
-        if (ret)
+        if (auto ret = ext->ConfigFunc(*this, func); ret)
             return std::move(ret.value());
     }
     return NailangExecutor::EvaluateFunc(func);
 }
+Arg XCNLExecutor::PrintStruct(FuncEvalPack& func)
+{
+    ThrowByParamTypes<1>(func, { Arg::Type::String });
+    const auto& ctx = GetContext();
+    const auto name = func.Params[0].GetStr().value();
+    const auto idx = ctx.FindStruct(name);
+    if (idx == SIZE_MAX)
+        NLRT_THROW_EX(FMTSTR2(u"Cannot find struct named [{}]"sv, name), func);
+    GetRuntime().PrintStruct(*ctx.GetCustomStructs()[idx]);
+    return {};
+}
 
 
 XCNLConfigurator::XCNLConfigurator() {}
@@ -604,7 +650,7 @@ std::optional<common::str::StrVariant<char32_t>> XCNLRawExecutor::CommonReplaceF
     {
         ThrowByReplacerArgCount(call, args, 1, ArgLimits::AtLeast);
         const OutputBlock* block = nullptr;
-        for (const auto& blk : runtime.XCContext.TemplateBlocks)
+        for (const auto& blk : runtime.XCContext.GetConfigContext().TemplateBlocks)
             if (blk.Block->Name == args[0])
             {
                 block = &blk; break;
@@ -802,20 +848,43 @@ void XCNLRawExecutor::DirectOutput(const OutputBlock& block, std::u32string& dst
     auto& runtime = GetRuntime();
     Expects(runtime.CurFrame() != nullptr);
     OutputConditions(block.MetaFunc, dst);
-    common::str::StrVariant<char32_t> source(block.Block->Source);
     EvalTempStore store;
     for (const auto& [var, arg] : block.PreAssignArgs)
     {
         runtime.LocateArg(var, true).Set(executor.EvaluateExpr(arg, store));
         store.Reset();
     }
-    if (block.ReplaceVar || block.ReplaceFunc)
-        source = ProcessOptBlock(source.StrView(), U"$$@"sv, U"@$$"sv);
+    std::u32string_view source = block.Block->Source;
+    if (!block.ReplaceVar && !block.ReplaceFunc)
+    {
+        dst.append(source);
+        return;
+    }
+    // each pass only records slices and generated pieces, intermediate text is materialized once per pass
+    U32Rope rope;
+    std::u32string buffers[2];
+    uint8_t bufIdx = 0;
+    const auto nextPass = [&]()
+    {
+        auto& buf = buffers[bufIdx];
+        bufIdx ^= 1;
+        buf.clear();
+        rope.MaterializeTo(buf);
+        rope.Clear();
+        source = buf;
+    };
+    ProcessOptBlock(rope, source, U"$$@"sv, U"@$$"sv);
     if (block.ReplaceVar)
-        source = ProcessVariable(source.StrView(), U"$$!{"sv, U"}"sv);
+    {
+        nextPass();
+        ProcessVariable(rope, source, U"$$!{"sv, U"}"sv);
+    }
     if (block.ReplaceFunc)
-        source = ProcessFunction(source.StrView(), U"$$!"sv, U""sv);
-    dst.append(source.StrView());
+    {
+        nextPass();
+        ProcessFunction(rope, source, U"$$!"sv, U""sv);
+    }
+    rope.MaterializeTo(dst);
 }
 
 void XCNLRawExecutor::ProcessGlobal(const OutputBlock& block, std::u32string& output)
@@ -1007,7 +1076,7 @@ void XCNLRuntime::PrintStruct(const XCNLStruct& target) const
     {
         std::u32string_view typeName;
         if (field.Type.IsCustomType())
-            typeName = XCContext.CustomStructs[field.Type.ToIndex()]->GetName();
+            typeName = XCContext.GetCustomStructs()[field.Type.ToIndex()]->GetName();
         else
             typeName = StringifyVDataType(field.Type);
         APPEND_FMT(str, u"[{:4}] {} {}"sv, field.Offset, typeName, target.GetFieldName(field));
@@ -1255,9 +1324,110 @@ InstanceArgData XCNLRuntime::ParseInstanceArg(std::u32string_view argTypeName, F
     return { std::move(args), std::move(name), std::move(dtype), argType, texType };
 }
 
-void XCNLRuntime::BeforeFinishOutput(std::u32string&, std::u32string&, std::u32string&, std::u32string&)
+void XCNLRuntime::BeforeFinishOutput(U32Rope&, U32Rope&, U32Rope&, U32Rope&)
 { }
 
+std::unique_ptr<XCNLRuntime> XCNLRuntime::CreateInstanceWorker()
+{
+    return {};
+}
+
+void XCNLRuntime::MergeInstance(XCNLRuntime&, const OutputBlock&)
+{ }
+
+void XCNLRuntime::GenerateInstances(common::span<const OutputBlock* const> blocks, std::u32string& output)
+{
+    auto& rawExe = GetRawExecutor();
+    const auto concurrency = InstanceConcurrency ? InstanceConcurrency : common::TopologyInfo::Get().GetTotalProcessorCount();
+    const auto workerCount = std::min<size_t>(concurrency, blocks.size());
+    std::vector<std::unique_ptr<XCNLRuntime>> workers;
+    const auto prepareWorker = [&]() -> bool
+    {
+        auto worker = CreateInstanceWorker();
+        if (!worker)
+            return false;
+        worker->XCContext.ImportSnapshot(XCContext);
+        // extensions are index-matched with the source, so their states can be merged back
+        for (const auto& ext : XCContext.Extensions)
+        {
+            auto workerExt = ext->CreateInstanceWorker(worker->XCContext);
+            if (!workerExt)
+                return false;
+            worker->XCContext.Extensions.push_back(std::move(workerExt));
+        }
+        workers.push_back(std::move(worker));
+        return true;
+    };
+    if (workerCount > 1)
+    {
+        for (size_t i = 0; i < workerCount; ++i)
+        {
+            if (!prepareWorker())
+            {
+                workers.clear();
+                break;
+            }
+        }
+    }
+    if (workers.empty())
+    {
+        for (const auto block : blocks)
+            rawExe.ProcessInstance(*block, output);
+        return;
+    }
+
+    struct InstanceResult
+    {
+        std::u32string Text;
+        std::exception_ptr Exception;
+        XCNLRuntime* Worker = nullptr;
+        size_t PatchBegin = 0, PatchEnd = 0;
+    };
+    std::vector<InstanceResult> results(blocks.size());
+    std::atomic<size_t> nextIdx = 0;
+    std::atomic_bool hasError = false;
+    // workers are independent, so each of them can be run on any thread of the shared pool
+    common::WorkerPool::ParallelRun(static_cast<uint32_t>(workers.size()), [&](const uint32_t workerIdx)
+        {
+            const auto worker = workers[workerIdx].get();
+            // each worker takes instances in increasing order, so patched blocks can be merged by block order.
+            // taken instance is always processed, so all instances before the failed one have results
+            while (!hasError)
+            {
+                const auto idx = nextIdx++;
+                if (idx >= blocks.size())
+                    break;
+                auto& result = results[idx];
+                result.Worker = worker;
+                result.PatchBegin = worker->XCContext.PatchedBlocks.size();
+                try
+                {
+                    worker->GetRawExecutor().ProcessInstance(*blocks[idx], result.Text);
+                }
+                catch (...)
+                {
+                    result.Exception = std::current_exception();
+                    hasError = true;
+                }
+                result.PatchEnd = worker->XCContext.PatchedBlocks.size();
+            }
+        });
+
+    // merge in block order, so that output is the same as sequential generation
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        auto& result = results[i];
+        if (result.Exception)
+            std::rethrow_exception(result.Exception);
+        Ensures(result.Worker);
+        output.append(result.Text);
+        XCContext.ImportPatchedBlocks(result.Worker->XCContext, result.PatchBegin, result.PatchEnd);
+        MergeInstance(*result.Worker, *blocks[i]);
+        for (size_t j = 0; j < XCContext.Extensions.size(); ++j)
+            XCContext.Extensions[j]->MergeInstance(*result.Worker->XCContext.Extensions[j], *blocks[i]);
+    }
+}
+
 void XCNLRuntime::ProcessConfigBlock(const Block& block, MetaFuncs metas)
 {
     auto& executor = GetConfigurator().GetExecutor();
@@ -1326,24 +1496,40 @@ std::string XCNLRuntime::GenerateOutput()
         if (block.Type == OutputBlock::BlockType::Global)
             rawExe.ProcessGlobal(block, globals);
     }
+    std::vector<const OutputBlock*> instances;
     for (const auto& block : XCContext.OutputBlocks)
     {
         if (block.Type == OutputBlock::BlockType::Instance)
-            rawExe.ProcessInstance(block, kernels);
+            instances.push_back(&block);
     }
+    GenerateInstances(instances, kernels);
     for (const auto& ext : XCContext.Extensions)
     {
         ext->FinishXCNL(*this);
     }
 
-    BeforeFinishOutput(prefixes, structs, globals, kernels);
+    std::array<U32Rope, 4> parts;
+    parts[0].AppendSlice(prefixes);
+    parts[1].AppendSlice(structs);
+    parts[2].AppendSlice(globals);
+    parts[3].AppendSlice(kernels);
+    BeforeFinishOutput(parts[0], parts[1], parts[2], parts[3]);
 
     // Output patched blocks
-    XCContext.WritePatchedBlock(structs);
+    parts[1].AppendGenerated([&](std::u32string& buf) { XCContext.WritePatchedBlock(buf); });
+
+    // transcode each piece into UTF8
     std::string output;
-    for (const auto& part : std::array<std::u32string_view, 4>{ prefixes, structs, globals, kernels })
+    size_t totalLen = 0;
+    for (const auto& part : parts)
+        totalLen += part.Size();
+    output.reserve(totalLen + totalLen / 8);
+    for (const auto& part : parts)
     {
-        output.append(common::str::to_string(part, Encoding::UTF8, Encoding::UTF32));
+        part.MaterializeTo(output, [](std::u32string_view piece, std::string& dst)
+            {
+                dst.append(common::str::to_string(piece, Encoding::UTF8, Encoding::UTF32));
+            });
     }
 
     return output;
@@ -28,6 +28,7 @@ class ReplaceDepend;
 
 
 using U32StrSpan    = ::common::span<const std::u32string_view>;
+using U32Rope       = ::common::str::StringRope<char32_t>;
 using MetaFuncs     = ::common::span<const xziar::nailang::FuncCall>;
 
 
@@ -58,7 +59,7 @@ struct OutputBlock
 class XCOMPBASAPI NamedTextHolder
 {
 private:
-    common::StringPool<char32_t> Names;
+    common::HashedStringPool<char32_t> Names; // interned, so pieces can be compared directly
     std::vector<std::pair<common::StringPiece<char32_t>, uint32_t>> Dependencies;
 public:
     struct NamedText
@@ -72,6 +73,7 @@ public:
         common::StringPiece<char32_t> IDStr;
         std::pair<uint32_t, uint32_t> Dependency = { 0,0 };
     };
+    NamedTextHolder() noexcept : Names(true) {}
     virtual ~NamedTextHolder();
 protected:
     forceinline std::u32string_view GetID(const NamedText& item) const noexcept
@@ -90,27 +92,33 @@ protected:
         if (depIdx != UINT32_MAX)
             return depIdx;
         // late bind dependency
-        const auto depName = Names.GetStringView(depStr);
         for (uint32_t i = 0; i < container.size(); ++i)
         {
-            if (GetID(container[i]) == depName)
+            if (Names.IsSame(container[i].IDStr, depStr))
             {
                 return i;
             }
         }
         return {};
     }
-    forceinline std::optional<uint32_t> CheckExists(std::vector<NamedText>& container, std::u32string_view id) const noexcept
+    forceinline std::optional<uint32_t> CheckExists(const std::vector<NamedText>& container, common::StringPiece<char32_t> idstr) const noexcept
     {
         uint32_t idx = 0;
         for (const auto& item : container)
         {
-            if (GetID(item) == id)
+            if (Names.IsSame(item.IDStr, idstr))
                 return idx;
             idx++;
         }
         return {};
     }
+    forceinline std::optional<uint32_t> CheckExists(const std::vector<NamedText>& container, std::u32string_view id) const noexcept
+    {
+        // not interned means never added
+        if (const auto idstr = Names.Find(id); idstr)
+            return CheckExists(container, *idstr);
+        return {};
+    }
     forceinline bool Add(std::vector<NamedText>& container, std::u32string_view id, common::str::StrVariant<char32_t> content, U32StrSpan depends)
     {
         // check exists
@@ -433,6 +441,10 @@ public:
     {
         return {};
     }
+    // create extension of the worker context to generate instances concurrently, nullptr means instances can only be generated sequentially
+    [[nodiscard]] virtual std::unique_ptr<XCNLExtension> CreateInstanceWorker(XCNLContext& context) const;
+    // merge states produced by worker extension when generating the instance, called in block order
+    virtual void MergeInstance(XCNLExtension& worker, const OutputBlock& block);
 
     using XCNLExtGen = std::unique_ptr<XCNLExtension>(*)(common::mlog::MiniLogger<false>&, XCNLContext&);
     template<typename T>
@@ -568,7 +580,21 @@ protected:
     std::vector<OutputBlock> TemplateBlocks;
     std::vector<NamedText> PatchedBlocks;
     std::vector<std::unique_ptr<XCNLStruct>> CustomStructs;
+    // the context being snapshotted when this is a worker context, it's read-only during instance generation
+    const XCNLContext* ConfigSource = nullptr;
     [[nodiscard]] size_t FindStruct(std::u32string_view name) const;
+    [[nodiscard]] forceinline const XCNLContext& GetConfigContext() const noexcept
+    {
+        return ConfigSource ? *ConfigSource : *this;
+    }
+    [[nodiscard]] forceinline common::span<const std::unique_ptr<XCNLStruct>> GetCustomStructs() const noexcept
+    {
+        return GetConfigContext().CustomStructs;
+    }
+    // copy root args and local funcs, structs and template blocks are referenced from source
+    void ImportSnapshot(const XCNLContext& source);
+    // append patched blocks in [begin, end) of source which does not exist yet, in order
+    void ImportPatchedBlocks(const XCNLContext& source, size_t begin, size_t end);
 private:
     COMMON_NO_COPY(XCNLContext)
     [[nodiscard]] XCNLExtension* FindExt(std::function<bool(const XCNLExtension*)> func) const;
@@ -589,6 +615,7 @@ protected:
 
     XCNLContext& XCContext;
     common::mlog::MiniLogger<false>& Logger;
+    uint32_t InstanceConcurrency = 0;
 
     XCNLRuntime(common::mlog::MiniLogger<false>& logger, std::shared_ptr<XCNLContext> evalCtx);
     [[nodiscard]] std::optional<xziar::nailang::Arg> CommonFunc(const std::u32string_view name, xziar::nailang::FuncEvalPack& func);
@@ -596,12 +623,19 @@ protected:
 
     [[nodiscard]] virtual OutputBlock::BlockType GetBlockType(const RawBlock& block, MetaFuncs metas) const noexcept;
     virtual void HandleInstanceArg(const InstanceArgInfo& arg, InstanceContext& ctx, const xziar::nailang::FuncPack& meta, const xziar::nailang::Arg* source);
-    virtual void BeforeFinishOutput(std::u32string& prefixes, std::u32string& structs, std::u32string& globals, std::u32string& kernels);
+    // parts are ropes over generated sections, prefer Append/Prepend pieces rather than rebuilding
+    virtual void BeforeFinishOutput(U32Rope& prefixes, U32Rope& structs, U32Rope& globals, U32Rope& kernels);
+    // create a runtime with a fresh context of the same kind to generate instances on worker thread, nullptr means sequential.
+    // instance generation inside worker should only modify worker's own states
+    [[nodiscard]] virtual std::unique_ptr<XCNLRuntime> CreateInstanceWorker();
+    // merge states produced when worker generating the instance, called in block order
+    virtual void MergeInstance(XCNLRuntime& worker, const OutputBlock& block);
 private:
     virtual XCNLConfigurator& GetConfigurator() noexcept = 0;
     virtual XCNLRawExecutor& GetRawExecutor() noexcept = 0;
     virtual XCNLStructHandler& GetStructHandler() noexcept = 0;
     InstanceArgData ParseInstanceArg(std::u32string_view argTypeName, xziar::nailang::FuncPack& func);
+    void GenerateInstances(common::span<const OutputBlock* const> blocks, std::u32string& output);
 public:
     ~XCNLRuntime() override;
     COMMON_NO_COPY(XCNLRuntime)
@@ -626,6 +660,8 @@ public:
     void ProcessConfigBlock(const Block& block, MetaFuncs metas);
     void ProcessStructBlock(const Block& block, MetaFuncs metas);
     void CollectRawBlock(const RawBlock& block, MetaFuncs metas);
+    // max worker count when generating instances, 0 means processor count
+    void SetInstanceConcurrency(uint32_t count) noexcept { InstanceConcurrency = count; }
 
     std::string GenerateOutput();
 };
@@ -664,6 +700,12 @@ protected:
     {
         return GetRuntime().ConstructEvalContext();
     }
+    // dispatch kinds of xcomp builtins cached at call site, extensions are not cached
+    static constexpr auto XCompVec          = static_cast<DispatchKind>(common::enum_cast(DispatchKind::Extension) + 0);
+    static constexpr auto XCompArg          = static_cast<DispatchKind>(common::enum_cast(DispatchKind::Extension) + 1);
+    static constexpr auto XCompPrintStruct  = static_cast<DispatchKind>(common::enum_cast(DispatchKind::Extension) + 2);
+    static constexpr auto XCompCommonFunc   = static_cast<DispatchKind>(common::enum_cast(DispatchKind::Extension) + 3);
+    [[nodiscard]] xziar::nailang::Arg PrintStruct(xziar::nailang::FuncEvalPack& func);
     [[nodiscard]] xziar::nailang::Arg EvaluateFunc(xziar::nailang::FuncEvalPack& func) override;
     using NailangExecutor::NailangExecutor;
 };
@@ -787,9 +829,9 @@ protected:
         return dynamic_cast<StructFrame*>(&GetExecutor().GetFrame());
     }
     [[nodiscard]] XCNLStruct& GetStruct() const;
-    [[nodiscard]] common::span<std::unique_ptr<XCNLStruct>> GetCustomStructs() const noexcept
+    [[nodiscard]] common::span<const std::unique_ptr<XCNLStruct>> GetCustomStructs() const noexcept
     {
-        return GetExecutor().GetContext().CustomStructs;
+        return GetExecutor().GetContext().GetCustomStructs();
     }
     void StringifyBasicField(const XCNLStruct::Field& field, const XCNLStruct& target, std::u32string& output) const noexcept;
     [[nodiscard]] xziar::nailang::NailangFrameStack::FrameHolder<xziar::nailang::NailangBlockFrame> PushFrame(
@@ -52,7 +52,7 @@ std::string PCI_BDF::ToString() const noexcept
     PERPFX(PPCAT(tstr, bit),  type, bit, false), \
     PERPFX(PPCAT(tstr, bit+), type, bit, true)
 
-static constexpr auto S2TMapping = BuildStaticLookup(common::str::ShortStrVal<8>, VTypeInfo,
+static constexpr auto S2TMapping = BuildStaticHashLookup(common::str::ShortStrVal<8>, VTypeInfo,
     MIN2(u, Unsigned, 8),
     MIN2(u, Unsigned, 16),
     MIN2(u, Unsigned, 32),
@@ -89,7 +89,7 @@ VTypeInfo ParseVDataType(const std::u32string_view type) noexcept
     MIN2(PPCAT(pfx, v8),  type, bit, 8), \
     MIN2(PPCAT(pfx, v16), type, bit, 16)
 
-static constexpr auto T2SMapping = BuildStaticLookup(uint32_t, std::u32string_view,
+static constexpr auto T2SMapping = BuildStaticHashLookup(uint32_t, std::u32string_view,
     PERPFX(u8,  Unsigned, 8),
     PERPFX(u16, Unsigned, 16),
     PERPFX(u32, Unsigned, 32),
@@ -435,6 +435,19 @@ public:
         doc.Val.Swap(rawdoc);
         return doc;
     }
+    // parse in-place, strings refer to the buffer so it should outlive the doc.
+    // when stopWhenDone, parsing ends after the first complete value, so the buffer needs no null-terminator
+    [[nodiscard]] static JDoc ParseInsitu(char* json, const bool stopWhenDone = false)
+    {
+        JDoc doc(rapidjson::kNullType);
+        rapidjson::Document rawdoc(doc.MemPool.get());
+        if (stopWhenDone)
+            rawdoc.ParseInsitu<rapidjson::kParseStopWhenDoneFlag>(json);
+        else
+            rawdoc.ParseInsitu(json);
+        doc.Val.Swap(rawdoc);
+        return doc;
+    }
 };
 
 template<bool IsConst>
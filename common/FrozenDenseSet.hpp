@@ -14,12 +14,61 @@
 namespace common::container
 {
 
+namespace detail
+{
+// Eytzinger (BFS) layout of a sorted array, children of node k are 2k+1 and 2k+2.
+// The top levels share few cache lines and the descent has no unpredictable branch.
+struct EytzingerLayout
+{
+    // order[k] is the sorted index placed at node k
+    static std::vector<uint32_t> BuildOrder(const size_t count)
+    {
+        Expects(count < UINT32_MAX);
+        std::vector<uint32_t> order(count);
+        uint32_t idx = 0;
+        Fill(order, idx, 0);
+        return order;
+    }
+    // returns the node of the first element that is not less than target, SIZE_MAX when not found
+    template<typename F>
+    static forceinline size_t LowerBound(const size_t count, F&& isLess) noexcept
+    {
+        size_t k = 0, ret = SIZE_MAX;
+        while (k < count)
+        {
+            const bool goRight = isLess(k);
+            ret = goRight ? ret : k;
+            k = 2 * k + 1 + (goRight ? 1 : 0);
+        }
+        return ret;
+    }
+private:
+    static void Fill(std::vector<uint32_t>& order, uint32_t& idx, const size_t k) noexcept
+    {
+        if (k >= order.size())
+            return;
+        Fill(order, idx, 2 * k + 1);
+        order[k] = idx++;
+        Fill(order, idx, 2 * k + 2);
+    }
+};
+}
+
 
 template<typename T, typename Compare = std::less<>>
 class FrozenDenseSet
 {
 private:
     std::vector<T> Data;
+    std::vector<T> SearchKeys; // copy of Data in eytzinger order, so the descent does not go through Layout
+    std::vector<uint32_t> Layout; // index inside Data in eytzinger order, only used to map the found node back
+    void BuildLayout()
+    {
+        Layout = detail::EytzingerLayout::BuildOrder(Data.size());
+        SearchKeys.reserve(Layout.size());
+        for (const auto idx : Layout)
+            SearchKeys.push_back(Data[idx]);
+    }
 public:
     FrozenDenseSet() noexcept {}
     template<typename T1, typename Alloc>
@@ -28,16 +77,19 @@ public:
         Data.reserve(data.size());
         for (const auto& dat : data)
             Data.emplace_back(dat);
+        BuildLayout();
     }
     template<typename T1, typename Alloc>
     FrozenDenseSet(const std::vector<T1, Alloc>& data)
     {
         Data.resize(data.size());
         std::partial_sort_copy(data.cbegin(), data.cend(), Data.begin(), Data.end(), Compare());
+        BuildLayout();
     }
     FrozenDenseSet(std::vector<T>&& data) : Data(std::move(data))
     {
         std::sort(Data.begin(), Data.end(), Compare());
+        BuildLayout();
     }
     forceinline decltype(auto) begin() const noexcept { return Data.cbegin(); }
     forceinline decltype(auto) end()   const noexcept { return Data.cend(); }
@@ -47,14 +99,17 @@ public:
     template<typename E>
     constexpr bool Has(E&& element) const
     {
-        return std::binary_search(Data.cbegin(), Data.cend(), element, Compare());
+        return Find(element) != nullptr;
     }
     template<typename E>
     constexpr const T* Find(E&& element) const
     {
-        const auto ret = std::lower_bound(Data.cbegin(), Data.cend(), element, Compare());
-        if (ret != Data.cend() && !Compare()(element, *ret))
-            return &*ret;
+        const Compare comp;
+        const auto node = detail::EytzingerLayout::LowerBound(SearchKeys.size(),
+            [&](size_t idx) { return comp(SearchKeys[idx], element); });
+        // always point into Data, callers rely on the address being inside RawData()
+        if (node != SIZE_MAX && !comp(element, SearchKeys[node]))
+            return &Data[Layout[node]];
         else
             return nullptr;
     }
@@ -69,9 +124,15 @@ class FrozenDenseStringSetBase
 {
 protected:
     using SVType = std::basic_string_view<Ch>;
+    struct SearchNode
+    {
+        uint64_t Hash;
+        uint32_t Index; // index inside Pieces
+    };
     StringPool<Ch> Pool;
     std::vector<HashedStringPiece<Ch>> Pieces;
     std::vector<StringPiece<Ch>> OrderedView;
+    std::vector<SearchNode> SearchLayout; // hash of Pieces in eytzinger order
 
     forceinline constexpr bool InnerSearch(SVType element, uint64_t hash) const noexcept
     {
@@ -120,11 +181,13 @@ protected:
             }
         }
         std::sort(Pieces.begin(), Pieces.end());
+        SearchLayout.reserve(Pieces.size());
+        for (const auto idx : detail::EytzingerLayout::BuildOrder(Pieces.size()))
+            SearchLayout.push_back({ Pieces[idx].GetHash(), idx });
     }
-public:
-    forceinline size_t Size() const noexcept { return Pieces.size(); }
+    // returns index inside Pieces, SIZE_MAX when not found
     template<typename E>
-    constexpr SVType Find(E&& element) const noexcept
+    constexpr size_t FindIndex(E&& element) const noexcept
     {
         using TmpType = std::conditional_t<std::is_base_of_v<str::PreHashed<DJBHash>, std::decay_t<E>>,
             std::decay_t<E>, SVType>;
@@ -139,14 +202,32 @@ public:
             static_assert(std::is_constructible_v<SVType, const E&>, "element should be able to construct string_view");
             hash = DJBHash::HashC(tmp);
         }
+        size_t length = SIZE_MAX;
+        if constexpr (std::is_convertible_v<const TmpType&, SVType>)
+            length = static_cast<SVType>(tmp).size();
 
-        for (auto it = std::lower_bound(Pieces.cbegin(), Pieces.cend(), hash);
-            it != Pieces.cend() && it->GetHash() == hash; ++it)
+        const auto node = detail::EytzingerLayout::LowerBound(SearchLayout.size(),
+            [&](size_t idx) { return SearchLayout[idx].Hash < hash; });
+        if (node == SIZE_MAX || SearchLayout[node].Hash != hash)
+            return SIZE_MAX;
+        // hash collision is rare, following pieces are only touched when needed
+        for (size_t idx = SearchLayout[node].Index; idx < Pieces.size() && Pieces[idx].GetHash() == hash; ++idx)
         {
-            if (const auto target = Pool.GetStringView(*it); tmp == target)
-                return target;
+            const auto& piece = Pieces[idx];
+            if (length != SIZE_MAX && piece.GetLength() != length)
+                continue;
+            if (tmp == Pool.GetStringView(piece))
+                return idx;
         }
-        return {};
+        return SIZE_MAX;
+    }
+public:
+    forceinline size_t Size() const noexcept { return Pieces.size(); }
+    template<typename E>
+    constexpr SVType Find(E&& element) const noexcept
+    {
+        const auto idx = FindIndex(std::forward<E>(element));
+        return idx == SIZE_MAX ? SVType{} : Pool.GetStringView(Pieces[idx]);
     }
     template<typename E>
     constexpr bool Has(E&& element) const noexcept
@@ -188,6 +269,19 @@ class FrozenDenseStringSet : public FrozenDenseStringSetBase<Ch>
 private:
     using SVType = typename FrozenDenseStringSetBase<Ch>::SVType;
     std::vector<StringPiece<Ch>> OrderedView;
+    std::vector<uint32_t> PieceOrder; // index inside OrderedView of each piece
+    void BuildPieceOrder()
+    {
+        // OrderedView keeps allocation order, so its offsets are ascending
+        PieceOrder.reserve(this->Pieces.size());
+        for (const auto& piece : this->Pieces)
+        {
+            const auto it = std::lower_bound(OrderedView.cbegin(), OrderedView.cend(), piece.GetOffset(),
+                [](const StringPiece<Ch>& view, size_t offset) { return view.GetOffset() < offset; });
+            Expects(it != OrderedView.cend() && it->GetOffset() == piece.GetOffset());
+            PieceOrder.push_back(static_cast<uint32_t>(it - OrderedView.cbegin()));
+        }
+    }
     constexpr SVType GetAt(size_t idx) const noexcept
     {
         return this->Pool.GetStringView(this->OrderedView[idx]);
@@ -201,6 +295,7 @@ public:
     {
         static_assert(std::is_constructible_v<SVType, const T&>, "element should be able to construct string_view");
         this->FillFrom(data, &this->OrderedView);
+        BuildPieceOrder();
     }
     template<typename C, typename Compare>
     FrozenDenseStringSet(const C& data, Compare compare)
@@ -212,21 +307,16 @@ public:
         tmp.assign(data.begin(), data.end());
         std::sort(tmp.begin(), tmp.end(), compare);
         this->FillFrom(tmp, &this->OrderedView);
+        BuildPieceOrder();
     }
     template<typename C>
     FrozenDenseStringSet(const C& data) : FrozenDenseStringSet(data, std::less{}) {}
     template<typename E>
     constexpr size_t GetIndex(E&& element) const noexcept
     {
-        const auto target = this->Find(std::forward<E>(element));
-        if (target.empty()) return SIZE_MAX;
-        for (size_t i = 0; i < OrderedView.size(); ++i)
-        {
-            if (const auto tmp = this->Pool.GetStringView(OrderedView[i]); tmp.data() == target.data())
-                return i;
-        }
-        Expects(false);
-        return SIZE_MAX;
+        const auto idx = this->FindIndex(std::forward<E>(element));
+        if (idx == SIZE_MAX) return SIZE_MAX;
+        return PieceOrder[idx];
     }
     constexpr SVType operator[](size_t idx) const noexcept
     {
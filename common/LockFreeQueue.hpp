@@ -0,0 +1,245 @@
+#pragma once
+#include "CommonRely.hpp"
+#include <atomic>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if COMMON_COMPILER_MSVC
+#   pragma warning(push)
+#   pragma warning(disable:4324)
+#endif
+
+namespace common::container
+{
+
+namespace detail
+{
+inline constexpr size_t QueueCacheLineSize = 64;
+
+inline constexpr size_t QueueCapacity(const size_t capacity) noexcept
+{
+    size_t ret = 2;
+    while (ret < capacity)
+        ret <<= 1;
+    return ret;
+}
+
+template<typename T>
+struct QueueSlot
+{
+    alignas(T) std::byte Data[sizeof(T)];
+    forceinline T* Ptr() noexcept { return std::launder(reinterpret_cast<T*>(Data)); }
+    template<typename... Args>
+    forceinline void Construct(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>)
+    {
+        new (Data) T(std::forward<Args>(args)...);
+    }
+    forceinline void MoveTo(T& dst) noexcept(std::is_nothrow_move_assignable_v<T>)
+    {
+        auto ptr = Ptr();
+        dst = std::move(*ptr);
+        ptr->~T();
+    }
+};
+}
+
+
+// bounded multi-producer multi-consumer queue, based on Dmitry Vyukov's design.
+// Each cell carries a sequence number, so producers and consumers only contend on their own index.
+// Construction must not throw, a claimed cell that never gets published blocks all consumers behind it.
+template<typename T>
+class MPMCBoundedQueue
+{
+private:
+    struct Cell : public detail::QueueSlot<T>
+    {
+        std::atomic<size_t> Sequence;
+    };
+    alignas(detail::QueueCacheLineSize) std::atomic<size_t> EnqueuePos{ 0 };
+    alignas(detail::QueueCacheLineSize) std::atomic<size_t> DequeuePos{ 0 };
+    alignas(detail::QueueCacheLineSize) std::unique_ptr<Cell[]> Cells;
+    size_t Mask;
+    // returns the cell to write, nullptr when full
+    forceinline Cell* AcquireEnqueue(size_t& pos) noexcept
+    {
+        pos = EnqueuePos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            auto& cell = Cells[pos & Mask];
+            const auto seq = cell.Sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (EnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    return &cell;
+            }
+            else if (diff < 0)
+                return nullptr;
+            else
+                pos = EnqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+public:
+    using value_type = T;
+    /**
+     * @brief create a queue
+     * @param capacity will be rounded up to power of 2
+    */
+    explicit MPMCBoundedQueue(const size_t capacity) :
+        Cells(new Cell[detail::QueueCapacity(capacity)]), Mask(detail::QueueCapacity(capacity) - 1)
+    {
+        for (size_t i = 0; i <= Mask; ++i)
+            Cells[i].Sequence.store(i, std::memory_order_relaxed);
+    }
+    ~MPMCBoundedQueue()
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            const auto tail = EnqueuePos.load(std::memory_order_acquire);
+            for (auto head = DequeuePos.load(std::memory_order_relaxed); head != tail; ++head)
+                Cells[head & Mask].Ptr()->~T();
+        }
+    }
+    COMMON_NO_COPY(MPMCBoundedQueue)
+    COMMON_NO_MOVE(MPMCBoundedQueue)
+
+    template<typename... Args>
+    [[nodiscard]] bool TryEmplace(Args&&... args) noexcept
+    {
+        static_assert(std::is_nothrow_constructible_v<T, Args...>, "T should be nothrow constructible from Args");
+        size_t pos = 0;
+        const auto cell = AcquireEnqueue(pos);
+        if (!cell)
+            return false;
+        cell->Construct(std::forward<Args>(args)...);
+        cell->Sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+    [[nodiscard]] bool TryPush(const T& val) noexcept
+    {
+        return TryEmplace(val);
+    }
+    [[nodiscard]] bool TryPush(T&& val) noexcept
+    {
+        return TryEmplace(std::move(val));
+    }
+    [[nodiscard]] bool TryPop(T& val) noexcept(std::is_nothrow_move_assignable_v<T>)
+    {
+        auto pos = DequeuePos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            auto& cell = Cells[pos & Mask];
+            const auto seq = cell.Sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (DequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell.MoveTo(val);
+                    cell.Sequence.store(pos + Mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = DequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+    // only a snapshot, may be changed by other threads immediately
+    [[nodiscard]] bool IsEmpty() const noexcept
+    {
+        const auto pos = DequeuePos.load(std::memory_order_relaxed);
+        const auto seq = Cells[pos & Mask].Sequence.load(std::memory_order_acquire);
+        return static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0;
+    }
+    [[nodiscard]] forceinline size_t Capacity() const noexcept { return Mask + 1; }
+};
+
+
+// bounded single-producer single-consumer ring buffer.
+// Each side caches the other side's index, so the shared line is only touched when it looks full/empty.
+template<typename T>
+class SPSCRing
+{
+private:
+    alignas(detail::QueueCacheLineSize) std::atomic<size_t> Head{ 0 }; // written by consumer
+    size_t CachedTail = 0; // consumer only
+    alignas(detail::QueueCacheLineSize) std::atomic<size_t> Tail{ 0 }; // written by producer
+    size_t CachedHead = 0; // producer only
+    alignas(detail::QueueCacheLineSize) std::unique_ptr<detail::QueueSlot<T>[]> Slots;
+    size_t Mask;
+public:
+    using value_type = T;
+    /**
+     * @brief create a ring
+     * @param capacity will be rounded up to power of 2
+    */
+    explicit SPSCRing(const size_t capacity) :
+        Slots(new detail::QueueSlot<T>[detail::QueueCapacity(capacity)]), Mask(detail::QueueCapacity(capacity) - 1)
+    { }
+    ~SPSCRing()
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            const auto tail = Tail.load(std::memory_order_acquire);
+            for (auto head = Head.load(std::memory_order_relaxed); head != tail; ++head)
+                Slots[head & Mask].Ptr()->~T();
+        }
+    }
+    COMMON_NO_COPY(SPSCRing)
+    COMMON_NO_MOVE(SPSCRing)
+
+    // producer only
+    template<typename... Args>
+    [[nodiscard]] bool TryEmplace(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>)
+    {
+        const auto tail = Tail.load(std::memory_order_relaxed);
+        if (tail - CachedHead > Mask)
+        {
+            CachedHead = Head.load(std::memory_order_acquire);
+            if (tail - CachedHead > Mask)
+                return false;
+        }
+        Slots[tail & Mask].Construct(std::forward<Args>(args)...);
+        Tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    [[nodiscard]] bool TryPush(const T& val) noexcept(std::is_nothrow_copy_constructible_v<T>)
+    {
+        return TryEmplace(val);
+    }
+    [[nodiscard]] bool TryPush(T&& val) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        return TryEmplace(std::move(val));
+    }
+    // consumer only
+    [[nodiscard]] bool TryPop(T& val) noexcept(std::is_nothrow_move_assignable_v<T>)
+    {
+        const auto head = Head.load(std::memory_order_relaxed);
+        if (head == CachedTail)
+        {
+            CachedTail = Tail.load(std::memory_order_acquire);
+            if (head == CachedTail)
+                return false;
+        }
+        Slots[head & Mask].MoveTo(val);
+        Head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+    // only a snapshot when called from the other side
+    [[nodiscard]] bool IsEmpty() const noexcept
+    {
+        return Head.load(std::memory_order_acquire) == Tail.load(std::memory_order_acquire);
+    }
+    [[nodiscard]] forceinline size_t Capacity() const noexcept { return Mask + 1; }
+};
+
+
+}
+
+#if COMMON_COMPILER_MSVC
+#   pragma warning(pop)
+#endif
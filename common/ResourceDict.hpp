@@ -6,6 +6,7 @@
 #include <any>
 #include <string_view>
 #include <string>
+#include <vector>
 
 
 namespace common::container
@@ -22,6 +23,7 @@ protected:
     {
         const char* Key = nullptr;
         size_t Len = SIZE_MAX;
+        uint64_t Hash = 0;
         std::any Val;
         constexpr bool IsEmpty() const noexcept { return Len == SIZE_MAX; }
         constexpr size_t GetLen() const noexcept { return Len & SizeMask; }
@@ -33,14 +35,15 @@ protected:
         }
         void ResetStr()
         {
-            if ((Len & SizeTag) == 0) // allocated
-                delete Key;
+            if (!IsEmpty() && (Len & SizeTag) == 0) // allocated
+                delete[] Key;
             Key = nullptr;
             Len = SIZE_MAX;
         }
-        void SetStr(const std::string_view str, const bool shouldCopy)
+        void SetStr(const std::string_view str, const uint64_t hash, const bool shouldCopy)
         {
             ResetStr();
+            Hash = hash;
             if (shouldCopy)
             {
                 Len = str.size();
@@ -54,15 +57,94 @@ protected:
                 Key = str.data();
             }
         }
+        template<typename T>
+        void SetVal(T&& val)
+        {
+            using U = std::decay_t<T>;
+            if constexpr (std::is_same_v<U, std::any>)
+                Val = std::forward<T>(val);
+            else
+                Val.emplace<U>(std::forward<T>(val));
+        }
+    };
+    // open addressing with linear probing, item points into Items so it stays valid
+    struct IndexEntry
+    {
+        uint64_t Hash = 0;
+        RawItem* Item = nullptr;
     };
     TrunckedContainer<RawItem> Items{ 8 };
+    std::vector<IndexEntry> Index;
+    std::vector<RawItem*> FreeItems; // removed items that stay inside Items, reused by Add
     size_t UsedSlot = 0;
+
+    forceinline size_t GetMask() const noexcept { return Index.size() - 1; }
+    forceinline static size_t GetIndexPos(const uint64_t hash, const size_t mask) noexcept
+    {
+        return static_cast<size_t>(hash ^ (hash >> 29)) & mask;
+    }
+    // returns the position of the key, or the empty position to put it
+    size_t LocateKey(const std::string_view key, const uint64_t hash) const noexcept
+    {
+        const auto mask = GetMask();
+        for (auto pos = GetIndexPos(hash, mask); ; pos = (pos + 1) & mask)
+        {
+            const auto& entry = Index[pos];
+            if (!entry.Item || (entry.Hash == hash && *entry.Item == key))
+                return pos;
+        }
+    }
+    RawItem* FindItem(const std::string_view key) const noexcept
+    {
+        if (UsedSlot == 0)
+            return nullptr;
+        return Index[LocateKey(key, DJBHash::HashC(key))].Item;
+    }
+    void Rehash(const size_t size)
+    {
+        std::vector<IndexEntry> index(size);
+        const auto mask = size - 1;
+        for (const auto& entry : Index)
+        {
+            if (!entry.Item)
+                continue;
+            auto pos = GetIndexPos(entry.Hash, mask);
+            while (index[pos].Item)
+                pos = (pos + 1) & mask;
+            index[pos] = entry;
+        }
+        Index.swap(index);
+    }
+    void EraseIndex(size_t pos) noexcept
+    {
+        // backward shift deletion, keeps probe sequences intact without tombstones
+        const auto mask = GetMask();
+        for (auto next = (pos + 1) & mask; Index[next].Item; next = (next + 1) & mask)
+        {
+            const auto home = GetIndexPos(Index[next].Hash, mask);
+            // move back when its home is not inside (pos, next]
+            if (((next - home) & mask) >= ((next - pos) & mask))
+            {
+                Index[pos] = Index[next];
+                pos = next;
+            }
+        }
+        Index[pos] = {};
+    }
 public:
+    ResourceDict() noexcept {}
+    ResourceDict(ResourceDict&& other) noexcept :
+        Items(std::move(other.Items)), Index(std::move(other.Index)), FreeItems(std::move(other.FreeItems)),
+        UsedSlot(std::exchange(other.UsedSlot, 0))
+    {
+        other.Index.clear();
+        other.FreeItems.clear();
+    }
     ~ResourceDict()
     {
         for (auto& item : Items)
         {
-            if (item.IsEmpty())
+            if (!item.IsEmpty())
             {
                 item.ResetStr();
                 item.Val.reset();
@@ -72,57 +154,47 @@ public:
     template<typename T, typename S>
     bool Add(const S& key_, T&& val)
     {
-        using U = std::decay_t<T>;
         constexpr bool NeedCopy = str::StrAcceptor<char, S>::NeedCopy;
         std::string_view key{ key_ };
-        for (auto& item : Items)
+        const auto hash = DJBHash::HashC(key);
+        if ((UsedSlot + 1) * 2 > Index.size()) // keep load factor under 0.5
+            Rehash(Index.empty() ? 8 : Index.size() * 2);
+        auto& entry = Index[LocateKey(key, hash)];
+        if (entry.Item)
         {
-            if (item == key)
-            {
-                if constexpr (std::is_same_v<U, std::any>)
-                    item.Val = std::forward<T>(val);
-                else
-                    item.Val.emplace<U>(std::forward<T>(val));
-                return false;
-            }
+            entry.Item->SetVal(std::forward<T>(val));
+            return false;
         }
-        for (auto& item : Items)
+        RawItem* target = nullptr;
+        if (!FreeItems.empty()) // destructed by TryDealloc
         {
-            if (item.IsEmpty())
-            {
-                item.SetStr(key, NeedCopy);
-                if constexpr (std::is_same_v<U, std::any>)
-                    item.Val = std::forward<T>(val);
-                else
-                    item.Val.emplace<U>(std::forward<T>(val));
-                UsedSlot++;
-                return true;
-            }
+            target = FreeItems.back();
+            FreeItems.pop_back();
         }
-        auto& item = Items.AllocOne();
-        new (&item) RawItem();
-        item.SetStr(key, NeedCopy); 
-        if constexpr (std::is_same_v<U, std::any>)
-            item.Val = std::forward<T>(val);
         else
-            item.Val.emplace<U>(std::forward<T>(val));
+            target = &Items.AllocOne();
+        new (target) RawItem();
+        target->SetStr(key, hash, NeedCopy);
+        target->SetVal(std::forward<T>(val));
+        entry = { hash, target };
         UsedSlot++;
         return true;
     }
     bool Remove(const std::string_view& key)
     {
-        for (auto& item : Items)
-        {
-            if (item == key)
-            {
-                item.ResetStr();
-                item.Val.reset();
-                UsedSlot--;
-                [[maybe_unused]] const auto dummy = Items.TryDealloc(item);
-                return true;
-            }
-        }
-        return false;
+        if (UsedSlot == 0)
+            return false;
+        const auto pos = LocateKey(key, DJBHash::HashC(key));
+        const auto item = Index[pos].Item;
+        if (!item)
+            return false;
+        EraseIndex(pos);
+        item->ResetStr();
+        item->Val.reset();
+        UsedSlot--;
+        if (!Items.TryDealloc(*item)) // not the last one, slot is kept
+            FreeItems.push_back(item);
+        return true;
     }
     /*struct Item
     {
@@ -135,30 +207,21 @@ public:
     };*/
     const std::any* QueryItem(const std::string_view key) const noexcept
     {
-        for (auto& item : Items)
-        {
-            if (item == key)
-            {
-                return &item.Val;
-            }
-        }
+        if (const auto item = FindItem(key); item)
+            return &item->Val;
         return nullptr;
     }
     template<typename T>
     const T* QueryItem(const std::string_view key) const noexcept
     {
-        for (auto& item : Items)
+        if (const auto item = FindItem(key); item)
         {
-            if (item == key)
-            {
-                if (item.Val.type() == typeid(T))
-                    return std::any_cast<T>(&item.Val);
-                else
-                    return nullptr;
-            }
+            if (item->Val.type() == typeid(T))
+                return std::any_cast<T>(&item->Val);
         }
         return nullptr;
     }
+    [[nodiscard]] forceinline size_t Size() const noexcept { return UsedSlot; }
 
 };
 
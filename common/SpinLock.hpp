@@ -257,10 +257,10 @@ public:
     //}
     void DowngradeToRead() noexcept
     {
-        uint32_t expected = (Flag.load() | 0x80000000u) + 1;
-        while (!Flag.compare_exchange_weak(expected, expected & 0x7fffffffu))
+        uint32_t expected = Flag.load() | 0x80000000u;
+        while (!Flag.compare_exchange_weak(expected, (expected & 0x7fffffffu) + 1)) //writer becomes a reader
         {
-            expected = (expected | 0x80000000u) + 1; //ensure there's a writer
+            expected |= 0x80000000u; //ensure there's a writer
         }
     }
 };
@@ -85,6 +85,152 @@ struct StaticLookupTable
     }
 };
 
+// hash-and-displace perfect hash, keys are grouped into buckets, each bucket finds a seed that places all its keys into free slots
+struct StaticHashHelper
+{
+    template<typename T, typename = void>
+    struct HasVal : std::false_type {};
+    template<typename T>
+    struct HasVal<T, std::void_t<decltype(std::declval<const T&>().Val)>> : std::true_type {};
+
+    template<typename K>
+    static constexpr uint64_t Hash(const K& key) noexcept
+    {
+        if constexpr (std::is_integral_v<K> || std::is_enum_v<K>)
+            return static_cast<uint64_t>(key);
+        else if constexpr (is_specialization<K, std::basic_string_view>::value)
+            return DJBHash::HashC(key);
+        else if constexpr (HasVal<K>::value) // ShortStrVal
+            return static_cast<uint64_t>(key.Val);
+        else
+        {
+            static_assert(!AlwaysTrue<K>, "unsupported key type for perfect hash");
+            return 0;
+        }
+    }
+    // murmur3 fmix64
+    static constexpr uint64_t Mix(uint64_t x) noexcept
+    {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdull;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ull;
+        x ^= x >> 33;
+        return x;
+    }
+    static constexpr size_t CeilPow2(size_t n) noexcept
+    {
+        size_t ret = 1;
+        while (ret < n)
+            ret <<= 1;
+        return ret;
+    }
+};
+
+template<typename K, typename V, size_t N>
+struct StaticPerfectHashTable
+{
+    static_assert(N > 0, "perfect hash table cannot be empty");
+    static constexpr size_t SlotCount   = StaticHashHelper::CeilPow2(N * 2);
+    static constexpr size_t BucketCount = StaticHashHelper::CeilPow2((N + 1) / 2);
+    static constexpr uint32_t MaxSeedTries = 1u << 16;
+    // empty slots hold a key placed elsewhere, so a single compare is enough
+    std::array<detail::StaticLookupItem<K, V>, SlotCount> Items = {};
+    std::array<uint32_t, BucketCount> Seeds = {};
+    bool IsValid = false;
+
+    template<typename T>
+    constexpr std::optional<V> operator()(const T& key) const noexcept
+    {
+        const auto keyVal = static_cast<K>(key);
+        const auto hash = StaticHashHelper::Mix(StaticHashHelper::Hash(keyVal));
+        const auto seed = Seeds[hash & (BucketCount - 1)];
+        const auto& item = Items[StaticHashHelper::Mix(hash ^ seed) & (SlotCount - 1)];
+        if (item.Key == keyVal)
+            return item.Value;
+        return {};
+    }
+    template<typename NK, typename NV, typename T>
+    constexpr bool Build(const T& src) noexcept
+    {
+        std::array<uint64_t, N> hashes = {};
+        std::array<uint32_t, BucketCount + 1> bucketBegin = {};
+        for (size_t i = 0; i < N; ++i)
+        {
+            hashes[i] = StaticHashHelper::Mix(StaticHashHelper::Hash(static_cast<K>(NK(src[i].first))));
+            bucketBegin[(hashes[i] & (BucketCount - 1)) + 1]++;
+        }
+        // group keys by bucket, so each seed try only touches keys of that bucket
+        uint32_t maxSize = 0;
+        for (size_t b = 0; b < BucketCount; ++b)
+        {
+            maxSize = bucketBegin[b + 1] > maxSize ? bucketBegin[b + 1] : maxSize;
+            bucketBegin[b + 1] += bucketBegin[b];
+        }
+        std::array<uint32_t, N> members = {};
+        {
+            std::array<uint32_t, BucketCount> cursor = {};
+            for (size_t b = 0; b < BucketCount; ++b)
+                cursor[b] = bucketBegin[b];
+            for (size_t i = 0; i < N; ++i)
+                members[cursor[hashes[i] & (BucketCount - 1)]++] = static_cast<uint32_t>(i);
+        }
+        std::array<bool, SlotCount> used = {};
+        std::array<size_t, N> placed = {};
+        // place larger buckets first
+        for (auto size = maxSize; size > 0; --size)
+        {
+            for (size_t b = 0; b < BucketCount; ++b)
+            {
+                const auto begin = bucketBegin[b], end = bucketBegin[b + 1];
+                if (end - begin != size)
+                    continue;
+                bool found = false;
+                for (uint32_t seed = 0; seed < MaxSeedTries && !found; ++seed)
+                {
+                    size_t count = 0;
+                    found = true;
+                    for (auto j = begin; j < end; ++j)
+                    {
+                        const auto slot = StaticHashHelper::Mix(hashes[members[j]] ^ seed) & (SlotCount - 1);
+                        if (used[slot])
+                        {
+                            found = false;
+                            break;
+                        }
+                        used[slot] = true;
+                        placed[count++] = slot;
+                    }
+                    if (found)
+                    {
+                        Seeds[b] = seed;
+                        for (auto j = begin; j < end; ++j)
+                        {
+                            const auto i = members[j];
+                            Items[placed[j - begin]].Key   = static_cast<K>(NK(src[i].first));
+                            Items[placed[j - begin]].Value = static_cast<V>(NV(src[i].second));
+                        }
+                    }
+                    else
+                    {
+                        for (size_t j = 0; j < count; ++j)
+                            used[placed[j]] = false;
+                    }
+                }
+                if (!found)
+                    return false;
+            }
+        }
+        const auto fillKey = static_cast<K>(NK(src[0].first));
+        for (size_t i = 0; i < SlotCount; ++i)
+        {
+            if (!used[i])
+                Items[i].Key = fillKey;
+        }
+        return true;
+    }
+};
+
 template<typename Type>
 constexpr inline auto BuildTableStore(Type&&) noexcept
 {
@@ -133,6 +279,23 @@ constexpr inline auto BuildTableStoreFrom(const std::array<std::pair<K, V>, N>&
 }
 
 
+template<typename NK, typename NV, typename K, typename V, size_t N>
+constexpr inline auto BuildHashTableStoreFrom(const std::pair<K, V> (&arr)[N]) noexcept
+{
+    StaticPerfectHashTable<NK, NV, N> table;
+    table.IsValid = table.template Build<NK, NV>(arr);
+    return table;
+}
+template<typename NK, typename NV, size_t M, typename K, typename V, size_t N>
+constexpr inline auto BuildHashTableStoreFrom(const std::array<std::pair<K, V>, N>& arr) noexcept
+{
+    static_assert(M <= N);
+    StaticPerfectHashTable<NK, NV, M> table;
+    table.IsValid = table.template Build<NK, NV>(arr);
+    return table;
+}
+
+
 }
 
 #if 0
@@ -166,4 +329,27 @@ constexpr inline auto BuildTableStoreFrom(const std::array<std::pair<K, V>, N>&
     return ::common::detail::BuildTableStoreFrom<k, v, k, v>(tmp);  \
 }()
 
-}
\ No newline at end of file
+// single-probe lookup through compile-time perfect hash, only for integral, enum, string_view and ShortStrVal keys.
+// seed search only visits keys of the same bucket, so tables of a few hundred entries are still cheap to build
+#define BuildStaticHashLookupFrom(k, v, src) []()                               \
+{                                                                               \
+    using K = decltype(src[0].first);                                           \
+    using V = decltype(src[0].second);                                          \
+    static_assert(::common::detail::StaticLookupItem<K, V>::                    \
+        CheckUnique(src), "cannot contain repeat key");                         \
+    constexpr auto table = ::common::detail::BuildHashTableStoreFrom<k, v, K, V>(src); \
+    static_assert(table.IsValid, "failed to build perfect hash");               \
+    return table;                                                               \
+}()
+
+#define BuildStaticHashLookup(k, v, ...) []()                                   \
+{                                                                               \
+    constexpr std::pair<k, v> tmp[] = { __VA_ARGS__ };                          \
+    static_assert(::common::detail::StaticLookupItem<k, v>::                    \
+        CheckUnique(tmp), "cannot contain repeat key");                         \
+    constexpr auto table = ::common::detail::BuildHashTableStoreFrom<k, v, k, v>(tmp); \
+    static_assert(table.IsValid, "failed to build perfect hash");               \
+    return table;                                                               \
+}()
+
+}
@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include <string_view>
+#include <optional>
 
 namespace common
 {
@@ -117,8 +118,48 @@ private:
     static_assert(alignof(std::max_align_t) % alignof(uint64_t) == 0);
     static constexpr size_t UnitCount = sizeof(uint64_t) / sizeof(T);
     static constexpr size_t SizeMask = ~(UnitCount - 1);
-public:
-    StringPiece<T> AllocateString(const str::HashedStrView<T>& str)
+    // open addressing table over stored strings, empty slot has zero length, only used when interning
+    std::vector<StringPiece<T>> Slots;
+    size_t SlotUsed = 0;
+    bool Interning;
+
+    forceinline uint64_t GetStoredHash(const StringPiece<T>& piece) const noexcept
+    {
+        return *reinterpret_cast<const uint64_t*>(&this->Pool[piece.Offset - UnitCount]);
+    }
+    forceinline static size_t GetSlotIndex(uint64_t hash, size_t mask) noexcept
+    {
+        return static_cast<size_t>(hash ^ (hash >> 29)) & mask;
+    }
+    // returns the slot of the string, or the empty slot to put it
+    size_t LocateSlot(const str::HashedStrView<T>& str) const noexcept
+    {
+        const auto mask = Slots.size() - 1;
+        for (auto idx = GetSlotIndex(str.Hash, mask); ; idx = (idx + 1) & mask)
+        {
+            const auto& piece = Slots[idx];
+            if (piece.Length == 0)
+                return idx;
+            if (piece.Length == str.View.size() && GetStoredHash(piece) == str.Hash && this->GetStringView(piece) == str.View)
+                return idx;
+        }
+    }
+    void Rehash(const size_t size)
+    {
+        std::vector<StringPiece<T>> slots(size);
+        const auto mask = size - 1;
+        for (const auto& piece : Slots)
+        {
+            if (piece.Length == 0)
+                continue;
+            auto idx = GetSlotIndex(GetStoredHash(piece), mask);
+            while (slots[idx].Length != 0)
+                idx = (idx + 1) & mask;
+            slots[idx] = piece;
+        }
+        Slots.swap(slots);
+    }
+    StringPiece<T> AppendString(const str::HashedStrView<T>& str)
     {
         const auto view = str.View;
         const auto padding = ((view.size() + UnitCount - 1) & SizeMask) - view.size();
@@ -132,13 +173,63 @@ public:
             this->Pool.insert(this->Pool.end(), padding, static_cast<T>('\0'));
         return { offset, size };
     }
+public:
+    /**
+     * @brief create a pool
+     * @param interning whether to return the existing piece for duplicated string,
+     *        pieces from an interning pool can be compared directly
+    */
+    explicit HashedStringPool(const bool interning = false) noexcept : Interning(interning) {}
+    StringPiece<T> AllocateString(const str::HashedStrView<T>& str)
+    {
+        if (!Interning)
+            return AppendString(str);
+        if (str.View.empty())
+            return {};
+        if ((SlotUsed + 1) * 2 > Slots.size()) // keep load factor under 0.5
+            Rehash(Slots.empty() ? 16 : Slots.size() * 2);
+        auto& slot = Slots[LocateSlot(str)];
+        if (slot.Length == 0)
+        {
+            slot = AppendString(str);
+            SlotUsed++;
+        }
+        return slot;
+    }
+    // only available when interning
+    std::optional<StringPiece<T>> Find(const str::HashedStrView<T>& str) const noexcept
+    {
+        Expects(Interning);
+        if (str.View.empty())
+            return StringPiece<T>{};
+        if (Slots.empty())
+            return {};
+        const auto& slot = Slots[LocateSlot(str)];
+        if (slot.Length == 0)
+            return {};
+        return slot;
+    }
     str::HashedStrView<T> GetHashedStr(StringPiece<T> piece) const noexcept
     {
         if (piece.Length == 0) return {};
         Expects(piece.Offset >= UnitCount && (piece.Offset % UnitCount == 0));
-        const auto* ptr = reinterpret_cast<const uint64_t*>(&this->Pool[piece.Offset - UnitCount]);
-        return str::HashedStrView<T>{ *ptr, { &this->Pool[piece.Offset], piece.Length } };
+        return str::HashedStrView<T>{ GetStoredHash(piece), { &this->Pool[piece.Offset], piece.Length } };
+    }
+    void Clear() noexcept
+    {
+        this->Pool.clear();
+        Slots.clear();
+        SlotUsed = 0;
     }
+    // pieces from an interning pool hold the same string iff they are the same piece
+    [[nodiscard]] forceinline bool IsSame(const StringPiece<T>& lhs, const StringPiece<T>& rhs) const noexcept
+    {
+        if (Interning)
+            return lhs.Offset == rhs.Offset && lhs.Length == rhs.Length;
+        return lhs.Length == rhs.Length && this->GetStringView(lhs) == this->GetStringView(rhs);
+    }
+    [[nodiscard]] forceinline bool IsInterning() const noexcept { return Interning; }
+    [[nodiscard]] forceinline size_t UniqueCount() const noexcept { return SlotUsed; }
     using StringPool<T>::GetStringView;
     using StringPool<T>::IsEmpty;
     using StringPool<T>::Reserve;
@@ -146,4 +237,3 @@ public:
 
 
 }
-
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "CommonRely.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace common::str
+{
+
+
+// A segment-list string builder.
+// Slices of external source are only referenced (caller ensures their lifetime until materialize),
+// generated pieces are appended into an owned buffer, the final string is materialized once.
+template<typename Char>
+class StringRope
+{
+private:
+    struct Segment
+    {
+        const Char* Source; // nullptr means generated piece
+        size_t Offset;      // offset inside Generated when it's generated piece
+        size_t Length;
+    };
+    std::vector<Segment> Segments;
+    std::basic_string<Char> Generated;
+    size_t TotalLength = 0;
+
+    forceinline std::basic_string_view<Char> GetPiece(const Segment& seg) const noexcept
+    {
+        if (seg.Source)
+            return { seg.Source, seg.Length };
+        return { Generated.data() + seg.Offset, seg.Length };
+    }
+    void AddGenerated(const size_t offset, const size_t length)
+    {
+        if (length == 0)
+            return;
+        TotalLength += length;
+        if (!Segments.empty())
+        {
+            auto& last = Segments.back();
+            if (!last.Source && last.Offset + last.Length == offset) // merge with previous generated piece
+            {
+                last.Length += length;
+                return;
+            }
+        }
+        Segments.push_back({ nullptr, offset, length });
+    }
+public:
+    using value_type = Char;
+
+    // only keep reference to the slice
+    void AppendSlice(const std::basic_string_view<Char> str)
+    {
+        if (str.empty())
+            return;
+        TotalLength += str.size();
+        if (!Segments.empty())
+        {
+            auto& last = Segments.back();
+            if (last.Source && last.Source + last.Length == str.data()) // merge with continuous slice
+            {
+                last.Length += str.size();
+                return;
+            }
+        }
+        Segments.push_back({ str.data(), 0, str.size() });
+    }
+    void PrependSlice(const std::basic_string_view<Char> str)
+    {
+        if (str.empty())
+            return;
+        TotalLength += str.size();
+        Segments.insert(Segments.begin(), Segment{ str.data(), 0, str.size() });
+    }
+    // copy the content into owned buffer
+    void Append(const std::basic_string_view<Char> str)
+    {
+        const auto offset = Generated.size();
+        Generated.append(str);
+        AddGenerated(offset, str.size());
+    }
+    void Append(const Char ch)
+    {
+        const auto offset = Generated.size();
+        Generated.push_back(ch);
+        AddGenerated(offset, 1);
+    }
+    void Prepend(const std::basic_string_view<Char> str)
+    {
+        if (str.empty())
+            return;
+        const auto offset = Generated.size();
+        Generated.append(str);
+        TotalLength += str.size();
+        Segments.insert(Segments.begin(), Segment{ nullptr, offset, str.size() });
+    }
+    // let generator append directly into owned buffer, it should only append
+    template<typename F>
+    void AppendGenerated(F&& generator)
+    {
+        const auto offset = Generated.size();
+        generator(Generated);
+        Expects(Generated.size() >= offset);
+        AddGenerated(offset, Generated.size() - offset);
+    }
+    void Append(const StringRope<Char>& other)
+    {
+        if (&other == this)
+        {
+            const auto copy = other;
+            Append(copy);
+            return;
+        }
+        Generated.reserve(Generated.size() + other.Generated.size());
+        for (const auto& seg : other.Segments)
+        {
+            if (seg.Source)
+                AppendSlice({ seg.Source, seg.Length });
+            else
+                Append(other.GetPiece(seg));
+        }
+    }
+
+    [[nodiscard]] forceinline size_t Size() const noexcept { return TotalLength; }
+    [[nodiscard]] forceinline bool Empty() const noexcept { return TotalLength == 0; }
+    [[nodiscard]] forceinline size_t SegmentCount() const noexcept { return Segments.size(); }
+    void Reserve(const size_t segments, const size_t generated = 0)
+    {
+        Segments.reserve(segments);
+        Generated.reserve(generated);
+    }
+    void Clear() noexcept
+    {
+        Segments.clear();
+        Generated.clear();
+        TotalLength = 0;
+    }
+
+    template<typename F>
+    void ForEachPiece(F&& func) const
+    {
+        for (const auto& seg : Segments)
+            func(GetPiece(seg));
+    }
+    void MaterializeTo(std::basic_string<Char>& dst) const
+    {
+        dst.reserve(dst.size() + TotalLength);
+        for (const auto& seg : Segments)
+            dst.append(GetPiece(seg));
+    }
+    // conv(piece, dst) should append converted piece into dst
+    template<typename T, typename F>
+    void MaterializeTo(std::basic_string<T>& dst, F&& conv, const size_t sizeHint = 0) const
+    {
+        dst.reserve(dst.size() + (sizeHint ? sizeHint : TotalLength));
+        for (const auto& seg : Segments)
+            conv(GetPiece(seg), dst);
+    }
+    [[nodiscard]] std::basic_string<Char> Materialize() const
+    {
+        std::basic_string<Char> ret;
+        MaterializeTo(ret);
+        return ret;
+    }
+};
+
+
+}
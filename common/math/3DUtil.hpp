@@ -68,6 +68,21 @@ inline constexpr T RotateMat(const V& rv) noexcept
      **/
 }
 
+//Vec4's xyz define imaginary part, w define real part, should be normalized
+template<typename T, typename V>
+inline constexpr T RotateMatFromQuat(const V& q) noexcept
+{
+    const float xx = q.X * q.X, yy = q.Y * q.Y, zz = q.Z * q.Z;
+    const float xy = q.X * q.Y, xz = q.X * q.Z, yz = q.Y * q.Z;
+    const float wx = q.W * q.X, wy = q.W * q.Y, wz = q.W * q.Z;
+    return
+    {
+        {1.f - 2.f * (yy + zz), 2.f * (xy - wz), 2.f * (xz + wy)},
+        {2.f * (xy + wz), 1.f - 2.f * (xx + zz), 2.f * (yz - wx)},
+        {2.f * (xz - wy), 2.f * (yz + wx), 1.f - 2.f * (xx + yy)}
+    };
+}
+
 template<typename T>
 inline constexpr T RotateMatX(const float rad) noexcept
 {
@@ -0,0 +1,277 @@
+#pragma once
+#include "MatSIMD.hpp"
+#include "3DUtil.hpp"
+#if COMMON_ARCH_X86 && COMMON_SIMD_LV >= 200
+#   define XCOMP_HAS_SIMD256 1
+#   include "../simd/SIMD256.hpp"
+#endif
+
+
+// batched operations over arrays.
+// Instead of using SIMD lanes for components of one vector, each lane holds the same component of different elements (SoA),
+// so dot products become plain FMAs and no horizontal operation is needed.
+namespace common::math::simd::batch
+{
+
+namespace detail
+{
+using F32x4 = COMMON_SIMD_NAMESPACE::F32x4;
+#ifdef XCOMP_HAS_SIMD256
+using F32x8 = COMMON_SIMD_NAMESPACE::F32x8;
+#endif
+
+// 4x4 transpose, for 256bit it's done inside each lane
+template<typename V>
+forceinline void Transpose4(V& a, V& b, V& c, V& d) noexcept
+{
+    if constexpr (V::Count == 4)
+    {
+        const auto t0 = a.ZipLo(c), t1 = a.ZipHi(c), t2 = b.ZipLo(d), t3 = b.ZipHi(d); // a0,c0,a1,c1 | a2,c2,a3,c3 | b0,d0,b1,d1 | b2,d2,b3,d3
+        a = t0.ZipLo(t2), b = t0.ZipHi(t2), c = t1.ZipLo(t3), d = t1.ZipHi(t3);
+    }
+    else
+    {
+        const auto t0 = a.ZipLoLane(c), t1 = a.ZipHiLane(c), t2 = b.ZipLoLane(d), t3 = b.ZipHiLane(d);
+        a = t0.ZipLoLane(t2), b = t0.ZipHiLane(t2), c = t1.ZipLoLane(t3), d = t1.ZipHiLane(t3);
+    }
+}
+
+template<typename V>
+forceinline void BroadcastMat(const Mat4& mat, V(&out)[16]) noexcept
+{
+    for (uint8_t i = 0; i < 16; ++i)
+        out[i] = V(mat[i / 4][i % 4]);
+}
+
+template<typename V>
+forceinline V DotRow(const V* row, const V& x, const V& y, const V& z, const V& w) noexcept
+{
+    return row[0].MulAdd(x, row[1].MulAdd(y, row[2].MulAdd(z, row[3] * w)));
+}
+
+// V::Count xyzw vectors are transposed into x,y,z,w components.
+// For 256bit, lo lane holds even elements and hi lane holds odd elements, the 2nd transpose restores the order
+template<typename V>
+forceinline void TransformBlock(const V(&m)[16], const float* src, float* dst) noexcept
+{
+    V x(src), y(src + V::Count), z(src + V::Count * 2), w(src + V::Count * 3);
+    Transpose4(x, y, z, w);
+    auto rx = DotRow(m + 0, x, y, z, w), ry = DotRow(m + 4, x, y, z, w), rz = DotRow(m + 8, x, y, z, w), rw = DotRow(m + 12, x, y, z, w);
+    Transpose4(rx, ry, rz, rw);
+    rx.Save(dst), ry.Save(dst + V::Count), rz.Save(dst + V::Count * 2), rw.Save(dst + V::Count * 3);
+}
+
+template<typename V>
+forceinline void TransformPosBlock(const V(&m)[16], const float* const (&src)[3], float* const (&dst)[3], const size_t idx) noexcept
+{
+    const V x(src[0] + idx), y(src[1] + idx), z(src[2] + idx);
+    // load before store, so src can be the same as dst
+    const auto rx = m[0].MulAdd(x, m[1].MulAdd(y, m[2].MulAdd(z, m[3])));
+    const auto ry = m[4].MulAdd(x, m[5].MulAdd(y, m[6].MulAdd(z, m[7])));
+    const auto rz = m[8].MulAdd(x, m[9].MulAdd(y, m[10].MulAdd(z, m[11])));
+    rx.Save(dst[0] + idx), ry.Save(dst[1] + idx), rz.Save(dst[2] + idx);
+}
+
+// read the same row of V::Count matrices, each output holds one component of the row.
+// For 256bit, lo lane holds even matrices and hi lane holds odd matrices
+template<typename V>
+forceinline void LoadRows(const Mat4* mats, const uint8_t row, V& a, V& b, V& c, V& d) noexcept
+{
+    if constexpr (V::Count == 4)
+        a = V(mats[0].Ptr() + row * 4), b = V(mats[1].Ptr() + row * 4), c = V(mats[2].Ptr() + row * 4), d = V(mats[3].Ptr() + row * 4);
+    else
+    {
+        a = V::Combine(F32x4(mats[0].Ptr() + row * 4), F32x4(mats[1].Ptr() + row * 4));
+        b = V::Combine(F32x4(mats[2].Ptr() + row * 4), F32x4(mats[3].Ptr() + row * 4));
+        c = V::Combine(F32x4(mats[4].Ptr() + row * 4), F32x4(mats[5].Ptr() + row * 4));
+        d = V::Combine(F32x4(mats[6].Ptr() + row * 4), F32x4(mats[7].Ptr() + row * 4));
+    }
+    Transpose4(a, b, c, d);
+}
+
+// write the same row of V::Count matrices, each input holds one component of the row, reverse of LoadRows
+template<typename V, typename T>
+forceinline void SaveRows(V a, V b, V c, V d, T* out, const uint8_t row) noexcept
+{
+    Transpose4(a, b, c, d);
+    if constexpr (V::Count == 4)
+        a.Save(out[0].Ptr() + row * 4), b.Save(out[1].Ptr() + row * 4), c.Save(out[2].Ptr() + row * 4), d.Save(out[3].Ptr() + row * 4);
+    else
+    {
+        a.GetLoLane().Save(out[0].Ptr() + row * 4), a.GetHiLane().Save(out[1].Ptr() + row * 4);
+        b.GetLoLane().Save(out[2].Ptr() + row * 4), b.GetHiLane().Save(out[3].Ptr() + row * 4);
+        c.GetLoLane().Save(out[4].Ptr() + row * 4), c.GetHiLane().Save(out[5].Ptr() + row * 4);
+        d.GetLoLane().Save(out[6].Ptr() + row * 4), d.GetHiLane().Save(out[7].Ptr() + row * 4);
+    }
+}
+
+// row r of V::Count results, r holds all components of right matrices
+template<typename V>
+forceinline void MultiplyRow(const V(&r)[16], const Mat4* left, Mat4* out, const uint8_t row) noexcept
+{
+    V l[4];
+    LoadRows(left, row, l[0], l[1], l[2], l[3]);
+    SaveRows(DotRow(l, r[0], r[4], r[8], r[12]), DotRow(l, r[1], r[5], r[9], r[13]),
+        DotRow(l, r[2], r[6], r[10], r[14]), DotRow(l, r[3], r[7], r[11], r[15]), out, row);
+}
+
+// V::Count pairs of matrices, each lane holds one pair, so row r of result is sum(left[r][k] * right.row[k]) without shuffle.
+// Row r of result only needs row r of left, so out can be the same as left or right
+template<typename V>
+forceinline void MultiplyBlock(const Mat4* left, const Mat4* right, Mat4* out) noexcept
+{
+    V r[16];
+    LoadRows(right, 0, r[0], r[1], r[2], r[3]);
+    LoadRows(right, 1, r[4], r[5], r[6], r[7]);
+    LoadRows(right, 2, r[8], r[9], r[10], r[11]);
+    LoadRows(right, 3, r[12], r[13], r[14], r[15]);
+    MultiplyRow(r, left, out, 0);
+    MultiplyRow(r, left, out, 1);
+    MultiplyRow(r, left, out, 2);
+    MultiplyRow(r, left, out, 3);
+}
+
+// rotation matrix of 4 quaternions
+template<typename T>
+forceinline void QuatToMatBlock(const float* src, T* out) noexcept
+{
+    F32x4 x(src), y(src + 4), z(src + 8), w(src + 12);
+    Transpose4(x, y, z, w);
+    const auto x2 = x + x, y2 = y + y, z2 = z + z;
+    const auto xx = x * x2, yy = y * y2, zz = z * z2;
+    const auto xy = x * y2, xz = x * z2, yz = y * z2;
+    const auto wx = w * x2, wy = w * y2, wz = w * z2;
+    const F32x4 one(1.f), zero = F32x4::AllZero();
+    SaveRows(one - (yy + zz), xy - wz, xz + wy, zero, out, 0);
+    SaveRows(xy + wz, one - (xx + zz), yz - wx, zero, out, 1);
+    SaveRows(xz - wy, yz + wx, one - (xx + yy), zero, out, 2);
+    if constexpr (std::is_same_v<T, Mat4>)
+        SaveRows(zero, zero, zero, one, out, 3);
+    else
+        SaveRows(zero, zero, zero, zero, out, 3);
+}
+}
+
+
+// out[i] = mat * in[i], out can be the same as in
+inline void Transform(const Mat4& mat, common::span<const Vec4> in, common::span<Vec4> out) noexcept
+{
+    Expects(out.size() >= in.size());
+    const auto count = in.size();
+    size_t i = 0;
+#ifdef XCOMP_HAS_SIMD256
+    {
+        detail::F32x8 m[16];
+        detail::BroadcastMat(mat, m);
+        for (; i + 8 <= count; i += 8)
+            detail::TransformBlock(m, in[i].Ptr(), out[i].Ptr());
+    }
+#endif
+    {
+        detail::F32x4 m[16];
+        detail::BroadcastMat(mat, m);
+        for (; i + 4 <= count; i += 4)
+            detail::TransformBlock(m, in[i].Ptr(), out[i].Ptr());
+    }
+    for (; i < count; ++i)
+        out[i] = mat * in[i];
+}
+
+// transform positions (w=1) stored as separate x/y/z arrays, result w is dropped so only affine matrix fits.
+// dst can be the same as src
+inline void TransformPositions(const Mat4& mat, const float* const (&src)[3], float* const (&dst)[3], const size_t count) noexcept
+{
+    size_t i = 0;
+#ifdef XCOMP_HAS_SIMD256
+    {
+        detail::F32x8 m[16];
+        detail::BroadcastMat(mat, m);
+        for (; i + 8 <= count; i += 8)
+            detail::TransformPosBlock(m, src, dst, i);
+    }
+#endif
+    {
+        detail::F32x4 m[16];
+        detail::BroadcastMat(mat, m);
+        for (; i + 4 <= count; i += 4)
+            detail::TransformPosBlock(m, src, dst, i);
+    }
+    for (; i < count; ++i)
+    {
+        const float x = src[0][i], y = src[1][i], z = src[2][i];
+        for (uint8_t r = 0; r < 3; ++r)
+            dst[r][i] = mat[r][0] * x + mat[r][1] * y + mat[r][2] * z + mat[r][3];
+    }
+}
+
+// out[i] = left[i] * right[i], out can be the same as left or right
+inline void Multiply(common::span<const Mat4> left, common::span<const Mat4> right, common::span<Mat4> out) noexcept
+{
+    Expects(left.size() == right.size() && out.size() >= left.size());
+    const auto count = left.size();
+    size_t i = 0;
+#ifdef XCOMP_HAS_SIMD256
+    // 4-pair block takes 2x shuffles per pair, which is slower than row-broadcast of single multiply
+    for (; i + 8 <= count; i += 8)
+        detail::MultiplyBlock<detail::F32x8>(&left[i], &right[i], &out[i]);
+#endif
+    for (; i < count; ++i)
+        out[i] = left[i] * right[i];
+}
+
+// out[i] = left * right[i], elements of left are broadcasted only once
+inline void Multiply(const Mat4& left, common::span<const Mat4> right, common::span<Mat4> out) noexcept
+{
+    Expects(out.size() >= right.size());
+#ifdef XCOMP_HAS_SIMD256
+    // row r of result is sum(left[r][k] * right.row[k]), 2 rows are computed in one F32x8
+    using detail::F32x4;
+    using detail::F32x8;
+    F32x8 lxy[4], lzw[4];
+    for (uint8_t k = 0; k < 4; ++k)
+    {
+        lxy[k] = F32x8::Combine(F32x4(left[0][k]), F32x4(left[1][k]));
+        lzw[k] = F32x8::Combine(F32x4(left[2][k]), F32x4(left[3][k]));
+    }
+    for (size_t i = 0; i < right.size(); ++i)
+    {
+        const auto r0 = F32x8::BroadcastLane(right[i].RowX), r1 = F32x8::BroadcastLane(right[i].RowY),
+            r2 = F32x8::BroadcastLane(right[i].RowZ), r3 = F32x8::BroadcastLane(right[i].RowW);
+        detail::DotRow(lxy, r0, r1, r2, r3).Save(out[i].Ptr());
+        detail::DotRow(lzw, r0, r1, r2, r3).Save(out[i].Ptr() + 8);
+    }
+#else
+    using detail::F32x4;
+    F32x4 l[16];
+    detail::BroadcastMat(left, l);
+    for (size_t i = 0; i < right.size(); ++i)
+    {
+        const auto& rx = right[i].RowX, & ry = right[i].RowY, & rz = right[i].RowZ, & rw = right[i].RowW;
+        for (uint8_t r = 0; r < 4; ++r)
+            detail::DotRow(l + r * 4, rx, ry, rz, rw).Save(out[i].Ptr() + r * 4);
+    }
+#endif
+}
+
+// rotation matrix of normalized quaternions (xyz is imaginary part, w is real part), T can be Mat3 or Mat4
+template<typename T>
+inline void QuatToMat(common::span<const Vec4> quats, common::span<T> out) noexcept
+{
+    static_assert(std::is_same_v<T, Mat3> || std::is_same_v<T, Mat4>, "only Mat3 and Mat4 are supported");
+    Expects(out.size() >= quats.size());
+    const auto count = quats.size();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        detail::QuatToMatBlock(quats[i].Ptr(), &out[i]);
+    for (; i < count; ++i)
+    {
+        if constexpr (std::is_same_v<T, Mat4>)
+            out[i] = ToHomoCoord<Mat4>(RotateMatFromQuat<Mat3>(quats[i]));
+        else
+            out[i] = RotateMatFromQuat<Mat3>(quats[i]);
+    }
+}
+
+}
+
+#undef XCOMP_HAS_SIMD256